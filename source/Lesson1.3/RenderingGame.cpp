@@ -2,11 +2,15 @@
 #include "RenderingGame.h"
 #include "GameException.h"
 #include "KeyboardComponent.h"
+#include "MouseComponent.h"
 #include "GamePadComponent.h"
 #include "FpsComponent.h"
+#include "FirstPersonCamera.h"
+#include "PointCloudComponent.h"
 #include "PointDemo.h"
 
 using namespace std;
+using namespace std::filesystem;
 using namespace DirectX;
 using namespace Library;
 
@@ -23,17 +27,45 @@ namespace Rendering
 		mComponents.push_back(mKeyboard);
 		mServices.AddService(KeyboardComponent::TypeIdClass(), mKeyboard.get());
 
+		mMouse = make_shared<MouseComponent>(*this, MouseModes::Absolute);
+		mComponents.push_back(mMouse);
+		mServices.AddService(MouseComponent::TypeIdClass(), mMouse.get());
+
 		mGamePad = make_shared<GamePadComponent>(*this);
 		mComponents.push_back(mGamePad);
 		mServices.AddService(GamePadComponent::TypeIdClass(), mGamePad.get());
 
+		auto camera = make_shared<FirstPersonCamera>(*this);
+		mComponents.push_back(camera);
+		mServices.AddService(Camera::TypeIdClass(), camera.get());
+
 		auto fpsComponent = make_shared<FpsComponent>(*this);
 		mComponents.push_back(fpsComponent);
 
-		auto pointDemo = make_shared<PointDemo>(*this);
-		mComponents.push_back(pointDemo);
+		// Point clouds are built with the PointCloudPipeline tool; without one, fall back to the point demo.
+		const wstring pointCloudFilename = mContentManager.RootDirectory() + PointCloudFilename;
+		if (exists(pointCloudFilename))
+		{
+			mPointCloud = make_shared<PointCloudComponent>(*this, camera, pointCloudFilename);
+			mComponents.push_back(mPointCloud);
+		}
+		else
+		{
+			auto pointDemo = make_shared<PointDemo>(*this);
+			mComponents.push_back(pointDemo);
+		}
 
 		Game::Initialize();
+
+		if (mPointCloud != nullptr)
+		{
+			// Start outside the cloud, looking down -Z at its center.
+			const auto& header = mPointCloud->GetPointCloud().GetHeader();
+			const float size = header.BoundsMax.x - header.BoundsMin.x;
+			camera->SetPosition((header.BoundsMin.x + header.BoundsMax.x) * 0.5f, (header.BoundsMin.y + header.BoundsMax.y) * 0.5f, header.BoundsMax.z + size);
+			camera->SetFarPlaneDistance(max(camera->FarPlaneDistance(), size * 4.0f));
+			camera->MovementRate() = size * 0.1f;
+		}
 	}
 
 	void RenderingGame::Update(const GameTime& gameTime)
@@ -43,6 +75,16 @@ namespace Rendering
 			Exit();
 		}
 
+		if (mMouse->WasButtonPressedThisFrame(MouseButtons::Left))
+		{
+			mMouse->SetMode(MouseModes::Relative);
+		}
+
+		if (mMouse->WasButtonReleasedThisFrame(MouseButtons::Left))
+		{
+			mMouse->SetMode(MouseModes::Absolute);
+		}
+
 		Game::Update(gameTime);
 	}
 
@@ -6,7 +6,9 @@
 namespace Library
 {
 	class KeyboardComponent;
+	class MouseComponent;
 	class GamePadComponent;
+	class PointCloudComponent;
 }
 
 namespace Rendering
@@ -24,8 +26,11 @@ namespace Rendering
 
 	private:
 		inline static const DirectX::XMVECTORF32 BackgroundColor{ DirectX::Colors::CornflowerBlue };
+		inline static const std::wstring PointCloudFilename{ L"PointClouds\\PointCloud.pointcloud" };
 
 		std::shared_ptr<Library::KeyboardComponent> mKeyboard;
+		std::shared_ptr<Library::MouseComponent> mMouse;
 		std::shared_ptr<Library::GamePadComponent> mGamePad;
+		std::shared_ptr<Library::PointCloudComponent> mPointCloud;
 	};
 }
\ No newline at end of file
@@ -53,11 +53,11 @@ namespace Rendering
 
 		ThrowIfFailed(mGame->Direct3DDevice()->CreateInputLayout(inputElementDescriptions, narrow_cast<uint32_t>(size(inputElementDescriptions)), compiledVertexShader.data(), compiledVertexShader.size(), mInputLayout.put()), "ID3D11Device::CreateInputLayout() failed.");
 
-		// Load the model
-		Library::Model model("Content\\Models\\Sphere.obj.bin");
+		// Load the model through the content manager, which resolves models written against a shared model
+		const auto model = mGame->Content().Load<Library::Model>(L"Models\\Sphere.obj.bin");
 
 		// Create vertex and index buffers for the model
-		Mesh* mesh = model.Meshes().at(0).get();
+		Mesh* mesh = model->Meshes().at(0).get();
 		CreateVertexBuffer(*mesh, not_null<ID3D11Buffer * *>(mVertexBuffer.put()));
 		mesh->CreateIndexBuffer(*mGame->Direct3DDevice(), not_null<ID3D11Buffer * *>(mIndexBuffer.put()));
 		mIndexCount = static_cast<uint32_t>(mesh->Indices().size());
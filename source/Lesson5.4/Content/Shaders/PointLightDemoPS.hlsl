@@ -1,9 +1,9 @@
 cbuffer CBufferPerFrame
 {
 	float3 CameraPosition;
-	float3 AmbientColor;
+	float4 AmbientColor;
 	float3 LightPosition;
-	float3 LightColor;
+	float4 LightColor;
 };
 
 cbuffer CBufferPerObject
@@ -39,8 +39,8 @@ float4 main(VS_OUTPUT IN) : SV_TARGET
 	float4 color = ColorMap.Sample(TextureSampler, IN.TextureCoordinates);
 	float specularClamp = SpecularMap.Sample(TextureSampler, IN.TextureCoordinates).x;
 
-	float3 ambient = color.rgb * AmbientColor;
-	float3 diffuse = color.rgb * lightCoefficients.x * LightColor * IN.Attenuation;
+	float3 ambient = color.rgb * AmbientColor.rgb;
+	float3 diffuse = color.rgb * lightCoefficients.x * LightColor.rgb * IN.Attenuation;
 	float3 specular = min(lightCoefficients.y, specularClamp) * SpecularColor * IN.Attenuation;
 
 	return float4(saturate(ambient + diffuse + specular), color.a);
@@ -0,0 +1,44 @@
+// Generated by CBufferGenerator from PointLightDemoPS.hlsl. Do not edit.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <DirectXMath.h>
+#include "ConstantBufferDirtyRange.h"
+
+namespace Rendering::PointLightDemoPS
+{
+	struct CBufferPerFrame final
+	{
+		DirectX::XMFLOAT3 CameraPosition{ };
+		float Padding0{ };
+		DirectX::XMFLOAT4 AmbientColor{ };
+		DirectX::XMFLOAT3 LightPosition{ };
+		float Padding1{ };
+		DirectX::XMFLOAT4 LightColor{ };
+
+		static constexpr Library::ConstantBufferField CameraPositionField{ 0, 12 };
+		static constexpr Library::ConstantBufferField AmbientColorField{ 16, 16 };
+		static constexpr Library::ConstantBufferField LightPositionField{ 32, 12 };
+		static constexpr Library::ConstantBufferField LightColorField{ 48, 16 };
+	};
+
+	static_assert(offsetof(CBufferPerFrame, CameraPosition) == 0);
+	static_assert(offsetof(CBufferPerFrame, AmbientColor) == 16);
+	static_assert(offsetof(CBufferPerFrame, LightPosition) == 32);
+	static_assert(offsetof(CBufferPerFrame, LightColor) == 48);
+	static_assert(sizeof(CBufferPerFrame) == 64);
+
+	struct CBufferPerObject final
+	{
+		DirectX::XMFLOAT3 SpecularColor{ };
+		float SpecularPower{ };
+
+		static constexpr Library::ConstantBufferField SpecularColorField{ 0, 12 };
+		static constexpr Library::ConstantBufferField SpecularPowerField{ 12, 4 };
+	};
+
+	static_assert(offsetof(CBufferPerObject, SpecularColor) == 0);
+	static_assert(offsetof(CBufferPerObject, SpecularPower) == 12);
+	static_assert(sizeof(CBufferPerObject) == 16);
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+// Generated by CBufferGenerator from PointLightDemoVS.hlsl. Do not edit.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <DirectXMath.h>
+#include "ConstantBufferDirtyRange.h"
+
+namespace Rendering::PointLightDemoVS
+{
+	struct CBufferPerFrame final
+	{
+		DirectX::XMFLOAT3 LightPosition{ };
+		float LightRadius{ };
+
+		static constexpr Library::ConstantBufferField LightPositionField{ 0, 12 };
+		static constexpr Library::ConstantBufferField LightRadiusField{ 12, 4 };
+	};
+
+	static_assert(offsetof(CBufferPerFrame, LightPosition) == 0);
+	static_assert(offsetof(CBufferPerFrame, LightRadius) == 12);
+	static_assert(sizeof(CBufferPerFrame) == 16);
+
+	struct CBufferPerObject final
+	{
+		DirectX::XMFLOAT4X4 WorldViewProjection{ };
+		DirectX::XMFLOAT4X4 World{ };
+
+		static constexpr Library::ConstantBufferField WorldViewProjectionField{ 0, 64 };
+		static constexpr Library::ConstantBufferField WorldField{ 64, 64 };
+	};
+
+	static_assert(offsetof(CBufferPerObject, WorldViewProjection) == 0);
+	static_assert(offsetof(CBufferPerObject, World) == 64);
+	static_assert(sizeof(CBufferPerObject) == 128);
+}
\ No newline at end of file
@@ -21,6 +21,13 @@ namespace Rendering
 	PointLightMaterial::PointLightMaterial(Game& game, shared_ptr<Texture2D> colorMap, shared_ptr<Texture2D> specularMap) :
 		Material(game), mColorMap(move(colorMap)), mSpecularMap(move(specularMap))
 	{
+		mVertexCBufferPerFrameData.LightRadius = 50.0f;
+		mVertexCBufferPerObjectData.WorldViewProjection = MatrixHelper::Identity;
+		mVertexCBufferPerObjectData.World = MatrixHelper::Identity;
+		XMStoreFloat4(&mPixelCBufferPerFrameData.AmbientColor, Colors::Black);
+		XMStoreFloat4(&mPixelCBufferPerFrameData.LightColor, Colors::White);
+		mPixelCBufferPerObjectData.SpecularColor = XMFLOAT3(1.0f, 1.0f, 1.0f);
+		mPixelCBufferPerObjectData.SpecularPower = 128.0f;
 	}
 
 	com_ptr<ID3D11SamplerState> PointLightMaterial::SamplerState() const
@@ -67,7 +74,7 @@ namespace Rendering
 	void PointLightMaterial::SetAmbientColor(const XMFLOAT4& color)
 	{
 		mPixelCBufferPerFrameData.AmbientColor = color;
-		mPixelCBufferPerFrameDataDirty = true;
+		mPixelCBufferPerFrameDirtyRange.Mark(PixelCBufferPerFrame::AmbientColorField);
 	}
 
 	const XMFLOAT3& PointLightMaterial::LightPosition() const
@@ -78,10 +85,10 @@ namespace Rendering
 	void PointLightMaterial::SetLightPosition(const XMFLOAT3& position)
 	{
 		mPixelCBufferPerFrameData.LightPosition = position;
-		mPixelCBufferPerFrameDataDirty = true;
+		mPixelCBufferPerFrameDirtyRange.Mark(PixelCBufferPerFrame::LightPositionField);
 
 		mVertexCBufferPerFrameData.LightPosition = position;
-		mVertexCBufferPerFrameDataDirty = true;
+		mVertexCBufferPerFrameDirtyRange.Mark(VertexCBufferPerFrame::LightPositionField);
 	}
 
 	const float PointLightMaterial::LightRadius() const
@@ -92,7 +99,7 @@ namespace Rendering
 	void PointLightMaterial::SetLightRadius(float radius)
 	{
 		mVertexCBufferPerFrameData.LightRadius = radius;
-		mVertexCBufferPerFrameDataDirty = true;
+		mVertexCBufferPerFrameDirtyRange.Mark(VertexCBufferPerFrame::LightRadiusField);
 	}
 
 	const XMFLOAT4& PointLightMaterial::LightColor() const
@@ -103,7 +110,7 @@ namespace Rendering
 	void PointLightMaterial::SetLightColor(const XMFLOAT4& color)
 	{
 		mPixelCBufferPerFrameData.LightColor = color;
-		mPixelCBufferPerFrameDataDirty = true;
+		mPixelCBufferPerFrameDirtyRange.Mark(PixelCBufferPerFrame::LightColorField);
 	}
 
 	const DirectX::XMFLOAT3& PointLightMaterial::SpecularColor() const
@@ -114,7 +121,7 @@ namespace Rendering
 	void PointLightMaterial::SetSpecularColor(const DirectX::XMFLOAT3& color)
 	{
 		mPixelCBufferPerObjectData.SpecularColor = color;
-		mPixelCBufferPerObjectDataDirty = true;
+		mPixelCBufferPerObjectDirtyRange.Mark(PixelCBufferPerObject::SpecularColorField);
 	}
 
 	const float PointLightMaterial::SpecularPower() const
@@ -125,7 +132,7 @@ namespace Rendering
 	void PointLightMaterial::SetSpecularPower(float power)
 	{
 		mPixelCBufferPerObjectData.SpecularPower = power;
-		mPixelCBufferPerObjectDataDirty = true;
+		mPixelCBufferPerObjectDirtyRange.Mark(PixelCBufferPerObject::SpecularPowerField);
 	}
 
 	uint32_t PointLightMaterial::VertexSize() const
@@ -179,7 +186,7 @@ namespace Rendering
 	void PointLightMaterial::UpdateCameraPosition(const DirectX::XMFLOAT3& position)
 	{
 		mPixelCBufferPerFrameData.CameraPosition = position;
-		mPixelCBufferPerFrameDataDirty = true;
+		mPixelCBufferPerFrameDirtyRange.Mark(PixelCBufferPerFrame::CameraPositionField);
 	}
 
 	void PointLightMaterial::UpdateTransforms(FXMMATRIX worldViewProjectionMatrix, CXMMATRIX worldMatrix)
@@ -195,23 +202,10 @@ namespace Rendering
 
 		auto direct3DDeviceContext = mGame->Direct3DDeviceContext();
 
-		if (mVertexCBufferPerFrameDataDirty)
-		{
-			direct3DDeviceContext->UpdateSubresource(mVertexCBufferPerFrame.get(), 0, nullptr, &mVertexCBufferPerFrameData, 0, 0);
-			mVertexCBufferPerFrameDataDirty = false;
-		}
-
-		if (mPixelCBufferPerFrameDataDirty)
-		{
-			direct3DDeviceContext->UpdateSubresource(mPixelCBufferPerFrame.get(), 0, nullptr, &mPixelCBufferPerFrameData, 0, 0);
-			mPixelCBufferPerFrameDataDirty = false;
-		}
-
-		if (mPixelCBufferPerObjectDataDirty)
-		{
-			direct3DDeviceContext->UpdateSubresource(mPixelCBufferPerObject.get(), 0, nullptr, &mPixelCBufferPerObjectData, 0, 0);
-			mPixelCBufferPerObjectDataDirty = false;
-		}
+		const bool partialUpdatesSupported = mGame->ConstantBufferPartialUpdatesSupported();
+		mVertexCBufferPerFrameDirtyRange.Update(direct3DDeviceContext, mVertexCBufferPerFrame.get(), &mVertexCBufferPerFrameData, partialUpdatesSupported);
+		mPixelCBufferPerFrameDirtyRange.Update(direct3DDeviceContext, mPixelCBufferPerFrame.get(), &mPixelCBufferPerFrameData, partialUpdatesSupported);
+		mPixelCBufferPerObjectDirtyRange.Update(direct3DDeviceContext, mPixelCBufferPerObject.get(), &mPixelCBufferPerObjectData, partialUpdatesSupported);
 	}
 
 	void PointLightMaterial::ResetPixelShaderResources()
@@ -5,6 +5,9 @@
 #include "VectorHelper.h"
 #include "MatrixHelper.h"
 #include "SamplerStates.h"
+#include "ConstantBufferDirtyRange.h"
+#include "PointLightDemoVSCBuffers.h"
+#include "PointLightDemoPSCBuffers.h"
 
 namespace Library
 {
@@ -59,33 +62,11 @@ namespace Rendering
 		void UpdateTransforms(DirectX::FXMMATRIX worldViewProjectionMatrix, DirectX::CXMMATRIX worldMatrix);
 		
 	private:
-		struct VertexCBufferPerFrame
-		{
-			DirectX::XMFLOAT3 LightPosition{ Library::Vector3Helper::Zero };
-			float LightRadius{ 50.0f };
-		};
-
-		struct VertexCBufferPerObject
-		{
-			DirectX::XMFLOAT4X4 WorldViewProjection{ Library::MatrixHelper::Identity };
-			DirectX::XMFLOAT4X4 World{ Library::MatrixHelper::Identity };
-		};
-
-		struct PixelCBufferPerFrame
-		{
-			DirectX::XMFLOAT3 CameraPosition{ Library::Vector3Helper::Zero };
-			float Padding;
-			DirectX::XMFLOAT4 AmbientColor{ DirectX::Colors::Black };
-			DirectX::XMFLOAT3 LightPosition{ 0.0f, 0.0f, 0.0f };
-			float Padding2;
-			DirectX::XMFLOAT4 LightColor{ DirectX::Colors::White };
-		};
-
-		struct PixelCBufferPerObject
-		{
-			DirectX::XMFLOAT3 SpecularColor{ 1.0f, 1.0f, 1.0f };
-			float SpecularPower{ 128.0f };
-		};
+		// Generated from the cbuffer declarations in Content\Shaders by CBufferGenerator.
+		using VertexCBufferPerFrame = PointLightDemoVS::CBufferPerFrame;
+		using VertexCBufferPerObject = PointLightDemoVS::CBufferPerObject;
+		using PixelCBufferPerFrame = PointLightDemoPS::CBufferPerFrame;
+		using PixelCBufferPerObject = PointLightDemoPS::CBufferPerObject;
 
 		virtual void BeginDraw() override;
 
@@ -99,9 +80,9 @@ namespace Rendering
 		VertexCBufferPerObject mVertexCBufferPerObjectData;
 		PixelCBufferPerFrame mPixelCBufferPerFrameData;
 		PixelCBufferPerObject mPixelCBufferPerObjectData;
-		bool mVertexCBufferPerFrameDataDirty{ true };
-		bool mPixelCBufferPerFrameDataDirty{ true };
-		bool mPixelCBufferPerObjectDataDirty{ true };
+		Library::ConstantBufferDirtyRange mVertexCBufferPerFrameDirtyRange{ sizeof(VertexCBufferPerFrame) };
+		Library::ConstantBufferDirtyRange mPixelCBufferPerFrameDirtyRange{ sizeof(PixelCBufferPerFrame) };
+		Library::ConstantBufferDirtyRange mPixelCBufferPerObjectDirtyRange{ sizeof(PixelCBufferPerObject) };
 		std::shared_ptr<Library::Texture2D> mColorMap;
 		std::shared_ptr<Library::Texture2D> mSpecularMap;
 		winrt::com_ptr<ID3D11SamplerState> mSamplerState{ Library::SamplerStates::TrilinearClamp };
@@ -28,10 +28,12 @@ struct VS_OUTPUT
 
 float4 main(VS_OUTPUT IN) : SV_TARGET
 {
+#if FOG_ENABLED
 	if (IN.FogAmount == 1.0f)
 	{
 		return float4(FogColor, 1.0f);
 	}
+#endif
 
 	float3 viewDirection = normalize(CameraPosition - IN.WorldPosition);
 
@@ -48,5 +50,9 @@ float4 main(VS_OUTPUT IN) : SV_TARGET
 	float3 diffuse = color.rgb * lightCoefficients.x * LightColor;
 	float3 specular = min(lightCoefficients.y, specularClamp) * SpecularColor;
 
+#if FOG_ENABLED
 	return float4(lerp(saturate(ambient + diffuse + specular), FogColor, IN.FogAmount), 1.0f);
+#else
+	return float4(saturate(ambient + diffuse + specular), 1.0f);
+#endif
 }
\ No newline at end of file
@@ -1,11 +1,12 @@
-cbuffer CBufferPerFrame
+// Explicit registers keep constant buffer slots stable when a permutation leaves one unreferenced.
+cbuffer CBufferPerFrame : register(b0)
 {
 	float3 CameraPosition;
 	float FogStart;
 	float FogRange;
 }
 
-cbuffer CBufferPerObject
+cbuffer CBufferPerObject : register(b1)
 {
 	float4x4 WorldViewProjection;
 	float4x4 World;
@@ -35,7 +36,11 @@ VS_OUTPUT main(VS_INPUT IN)
 	OUT.WorldPosition = mul(IN.ObjectPosition, World).xyz;
 	OUT.TextureCoordinates = IN.TextureCoordinates;
 	OUT.Normal = normalize(mul(float4(IN.Normal, 0), World).xyz);
+#if FOG_ENABLED
 	OUT.FogAmount = saturate((distance(CameraPosition, OUT.WorldPosition) - FogStart) / (FogRange));
+#else
+	OUT.FogAmount = 0;
+#endif
 
 	return OUT;
 }
\ No newline at end of file
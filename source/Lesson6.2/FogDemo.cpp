@@ -101,6 +101,16 @@ namespace Rendering
 		mMaterial->SetFogRange(fogRange);
 	}
 
+	bool FogDemo::FogEnabled() const
+	{
+		return mMaterial->FogEnabled();
+	}
+
+	void FogDemo::SetFogEnabled(bool enabled)
+	{
+		mMaterial->SetFogEnabled(enabled);
+	}
+
 	void FogDemo::Initialize()
 	{
 		auto direct3DDevice = mGame->Direct3DDevice();
@@ -47,6 +47,9 @@ namespace Rendering
 		float FogRange() const;
 		void SetFogRange(float fogRange);
 
+		bool FogEnabled() const;
+		void SetFogEnabled(bool enabled);
+
 		virtual void Initialize() override;
 		virtual void Update(const Library::GameTime& gameTime) override;
 		virtual void Draw(const Library::GameTime& gameTime) override;
@@ -137,6 +137,17 @@ namespace Rendering
 		mVertexCBufferPerFrameDataDirty = true;
 	}
 
+	bool FogMaterial::FogEnabled() const
+	{
+		return (FeatureMask() & static_cast<uint32_t>(Features::Fog)) != 0;
+	}
+
+	void FogMaterial::SetFogEnabled(bool enabled)
+	{
+		const uint32_t fogMask = static_cast<uint32_t>(Features::Fog);
+		SetFeatureMask(enabled ? FeatureMask() | fogMask : FeatureMask() & ~fogMask);
+	}
+
 	uint32_t FogMaterial::VertexSize() const
 	{
 		return sizeof(VertexPositionTextureNormal);
@@ -146,12 +157,12 @@ namespace Rendering
 	{
 		Material::Initialize();
 
-		auto& content = mGame->Content();
-		auto vertexShader = content.Load<VertexShader>(L"Shaders\\FogDemoVS.cso"s);
-		SetShader(vertexShader);
+		SetFeatureMask(static_cast<uint32_t>(Features::Fog));
+		LoadShaderVariants(ShaderStages::VS, L"Shaders\\FogDemoVS.cso"s, FeatureCount);
+		LoadShaderVariants(ShaderStages::PS, L"Shaders\\FogDemoPS.cso"s, FeatureCount);
 
-		auto pixelShader = content.Load<PixelShader>(L"Shaders\\FogDemoPS.cso");
-		SetShader(pixelShader);
+		// All vertex shader variants share an input signature.
+		auto vertexShader = mGame->Content().Load<VertexShader>(L"Shaders\\FogDemoVS.cso"s);
 
 		auto direct3DDevice = mGame->Direct3DDevice();
 		vertexShader->CreateInputLayout<VertexPositionTextureNormal>(direct3DDevice);
@@ -18,6 +18,12 @@ namespace Rendering
 		RTTI_DECLARATIONS(FogMaterial, Library::Material)
 
 	public:
+		// Shader permutation bits; see Content\Shaders\Shaders.permutations.
+		enum class Features : std::uint32_t
+		{
+			Fog = 0x1
+		};
+
 		FogMaterial(Library::Game& game, std::shared_ptr<Library::Texture2D> colormap, std::shared_ptr<Library::Texture2D> specularMap);
 		FogMaterial(const FogMaterial&) = default;
 		FogMaterial& operator=(const FogMaterial&) = default;
@@ -55,6 +61,9 @@ namespace Rendering
 		const float FogRange() const;
 		void SetFogRange(const float fogRange);
 
+		bool FogEnabled() const;
+		void SetFogEnabled(bool enabled);
+
 		virtual std::uint32_t VertexSize() const override;
 		virtual void Initialize() override;
 
@@ -62,6 +71,8 @@ namespace Rendering
 		void UpdateTransforms(DirectX::FXMMATRIX worldViewProjectionMatrix, DirectX::CXMMATRIX worldMatrix);
 		
 	private:
+		inline static const std::uint32_t FeatureCount{ 1 };
+
 		struct VertexCBufferPerFrame
 		{	
 			DirectX::XMFLOAT3 CameraPosition{ Library::Vector3Helper::Zero };
@@ -102,6 +102,11 @@ namespace Rendering
 				specularPowerLabel << "Specular Power (+O/-P): " << mFogDemo->SpecularPower();
 				ImGui::Text(specularPowerLabel.str().c_str());
 			}
+			{
+				stringstream fogEnabledLabel;
+				fogEnabledLabel << "Toggle Fog (F): " << (mFogDemo->FogEnabled() ? "On" : "Off");
+				ImGui::Text(fogEnabledLabel.str().c_str());
+			}
 			{
 				stringstream fogStartLabel;
 				fogStartLabel << "Fog Start (+K/-L): " << mFogDemo->FogStart();
@@ -290,6 +295,11 @@ namespace Rendering
 
 	void RenderingGame::UpdateFog(const GameTime& gameTime)
 	{
+		if (mKeyboard->WasKeyPressedThisFrame(Keys::F))
+		{
+			mFogDemo->SetFogEnabled(!mFogDemo->FogEnabled());
+		}
+
 		float elapsedTime = gameTime.ElapsedGameTimeSeconds().count();
 
 		if (mKeyboard->IsKeyDown(Keys::K))
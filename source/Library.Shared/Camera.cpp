@@ -95,6 +95,17 @@ namespace Library
 		return XMMatrixMultiply(viewMatrix, projectionMatrix);
 	}
 
+	const Frustum& Camera::ViewFrustum() const
+	{
+		if (mFrustumDataDirty)
+		{
+			mFrustum = Frustum(ViewProjectionMatrix());
+			mFrustumDataDirty = false;
+		}
+
+		return mFrustum;
+	}
+
 	const vector<function<void()>>& Camera::ViewMatrixUpdatedCallbacks() const
 	{
 		return mViewMatrixUpdatedCallbacks;
@@ -166,6 +177,7 @@ namespace Library
 
 		XMMATRIX viewMatrix = XMMatrixLookToRH(eyePosition, direction, upDirection);
 		XMStoreFloat4x4(&mViewMatrix, viewMatrix);
+		mFrustumDataDirty = true;
 
 		for (auto& callback : mViewMatrixUpdatedCallbacks)
 		{
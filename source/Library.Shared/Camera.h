@@ -1,6 +1,7 @@
 #pragma once
 
 #include "GameComponent.h"
+#include "Frustum.h"
 #include <DirectXMath.h>
 #include <vector>
 #include <functional>
@@ -41,6 +42,9 @@ namespace Library
 		DirectX::XMMATRIX ProjectionMatrix() const;
 		DirectX::XMMATRIX ViewProjectionMatrix() const;
 
+		// World-space view frustum, rebuilt on demand after the view or projection matrix changes.
+		const Frustum& ViewFrustum() const;
+
 		const std::vector<std::function<void()>>& ViewMatrixUpdatedCallbacks() const;
 		void AddViewMatrixUpdatedCallback(std::function<void()> callback);
 
@@ -76,6 +80,8 @@ namespace Library
 
 		bool mViewMatrixDataDirty{ true };
 		bool mProjectionMatrixDataDirty{ true };
+		mutable bool mFrustumDataDirty{ true };
+		mutable Frustum mFrustum;
 
 		std::vector<std::function<void()>> mViewMatrixUpdatedCallbacks;
 		std::vector<std::function<void()>> mProjectionMatrixUpdatedCallbacks;
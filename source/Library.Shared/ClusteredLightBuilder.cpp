@@ -0,0 +1,444 @@
+#include "pch.h"
+#include "ClusteredLightBuilder.h"
+#include "PerspectiveCamera.h"
+#include "SpotLight.h"
+#include "GameException.h"
+#include <execution>
+#include <numeric>
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+
+namespace Library
+{
+	namespace
+	{
+		// Light ranges are widened by this much (in normalized device coordinates, and relatively in depth) so
+		// that rounding never drops a cluster the light touches; the cluster tests decide the rest.
+		const float RangeTolerance{ 1e-4f };
+
+		// Rows of a light group: tile and slice ranges, the bounding sphere, then the cone.
+		enum class GroupRow
+		{
+			MinTileX,
+			MaxTileX,
+			MinTileY,
+			MaxTileY,
+			CenterX,
+			CenterY,
+			CenterZ,
+			RadiusSquared,
+			ApexX,
+			ApexY,
+			ApexZ,
+			AxisX,
+			AxisY,
+			AxisZ,
+			ConeCosine,
+			ConeSine,
+			Range
+		};
+
+		uint32_t TileIndex(float normalizedCoordinate, uint32_t tileCount)
+		{
+			const float tile = floor((normalizedCoordinate + 1.0f) * 0.5f * tileCount);
+			return static_cast<uint32_t>(clamp(tile, 0.0f, static_cast<float>(tileCount - 1)));
+		}
+	}
+
+	ClusteredLightBuilder::ClusteredLightBuilder(uint32_t tileCountX, uint32_t tileCountY, uint32_t sliceCount) :
+		mTileCountX(tileCountX), mTileCountY(tileCountY), mSliceCount(sliceCount)
+	{
+		if (tileCountX == 0 || tileCountY == 0 || sliceCount == 0)
+		{
+			throw GameException("Cluster counts must be non-zero.");
+		}
+
+		mSliceWork.resize(sliceCount);
+		mSliceIndices.resize(sliceCount);
+		iota(mSliceIndices.begin(), mSliceIndices.end(), 0U);
+	}
+
+	uint32_t ClusteredLightBuilder::TileCountX() const
+	{
+		return mTileCountX;
+	}
+
+	uint32_t ClusteredLightBuilder::TileCountY() const
+	{
+		return mTileCountY;
+	}
+
+	uint32_t ClusteredLightBuilder::SliceCount() const
+	{
+		return mSliceCount;
+	}
+
+	uint32_t ClusteredLightBuilder::ClusterCount() const
+	{
+		return mTileCountX * mTileCountY * mSliceCount;
+	}
+
+	void ClusteredLightBuilder::Build(const PerspectiveCamera& camera, const span<const PointLight* const>& lights)
+	{
+		Build(camera.ViewMatrix(), camera.FieldOfView(), camera.AspectRatio(), camera.NearPlaneDistance(), camera.FarPlaneDistance(), lights);
+	}
+
+	void ClusteredLightBuilder::Build(CXMMATRIX viewMatrix, float fieldOfView, float aspectRatio, float nearPlaneDistance, float farPlaneDistance, const span<const PointLight* const>& lights)
+	{
+		if (nearPlaneDistance <= 0.0f || farPlaneDistance <= nearPlaneDistance)
+		{
+			throw GameException("Clustered lighting requires a near plane in front of the camera and a far plane beyond it.");
+		}
+
+		UpdateClusterBounds(fieldOfView, aspectRatio, nearPlaneDistance, farPlaneDistance);
+
+		const uint32_t lightCount = narrow<uint32_t>(lights.size());
+		mLights.resize(lightCount);
+		mViewLights.resize(lightCount);
+		for (uint32_t i = 0; i < lightCount; i++)
+		{
+			PrepareLight(viewMatrix, i, *lights[i]);
+		}
+
+		for_each(execution::par, mSliceIndices.begin(), mSliceIndices.end(), [&](uint32_t slice)
+		{
+			AssignSlice(slice);
+		});
+
+		// Pack the slices' lists into one index list, in cluster order.
+		const uint32_t clustersPerSlice = mTileCountX * mTileCountY;
+		mClusters.resize(ClusterCount());
+		uint32_t offset = 0;
+		for (uint32_t slice = 0; slice < mSliceCount; slice++)
+		{
+			const SliceWork& work = mSliceWork[slice];
+			for (uint32_t i = 0; i < clustersPerSlice; i++)
+			{
+				mClusters[slice * clustersPerSlice + i] = { offset, work.ClusterCounts[i] };
+				offset += work.ClusterCounts[i];
+			}
+		}
+
+		mLightIndices.resize(offset);
+		for_each(execution::par, mSliceIndices.begin(), mSliceIndices.end(), [&](uint32_t slice)
+		{
+			const SliceWork& work = mSliceWork[slice];
+			copy(work.ClusterLightIndices.begin(), work.ClusterLightIndices.end(), mLightIndices.begin() + mClusters[slice * clustersPerSlice].Offset);
+		});
+	}
+
+	const vector<ClusteredLightData>& ClusteredLightBuilder::Lights() const
+	{
+		return mLights;
+	}
+
+	const vector<LightCluster>& ClusteredLightBuilder::Clusters() const
+	{
+		return mClusters;
+	}
+
+	const vector<uint32_t>& ClusteredLightBuilder::LightIndices() const
+	{
+		return mLightIndices;
+	}
+
+	const BoundingBox& ClusteredLightBuilder::ClusterBounds(uint32_t cluster) const
+	{
+		return mClusterBounds.at(cluster);
+	}
+
+	uint32_t ClusteredLightBuilder::ClusterIndex(uint32_t tileX, uint32_t tileY, uint32_t slice) const
+	{
+		return (slice * mTileCountY + tileY) * mTileCountX + tileX;
+	}
+
+	float ClusteredLightBuilder::SliceScale() const
+	{
+		return mSliceScale;
+	}
+
+	float ClusteredLightBuilder::SliceBias() const
+	{
+		return mSliceBias;
+	}
+
+	void ClusteredLightBuilder::UpdateClusterBounds(float fieldOfView, float aspectRatio, float nearPlaneDistance, float farPlaneDistance)
+	{
+		const XMFLOAT4 projection(fieldOfView, aspectRatio, nearPlaneDistance, farPlaneDistance);
+		if (!mClusterBounds.empty() && XMVector4Equal(XMLoadFloat4(&projection), XMLoadFloat4(&mProjection)))
+		{
+			return;
+		}
+
+		mProjection = projection;
+		mTanHalfFovY = tan(fieldOfView * 0.5f);
+		mTanHalfFovX = mTanHalfFovY * aspectRatio;
+		const float depthRatio = log(farPlaneDistance / nearPlaneDistance);
+		mSliceScale = mSliceCount / depthRatio;
+		mSliceBias = -log(nearPlaneDistance) * mSliceCount / depthRatio;
+
+		// Each cluster's box encloses the corners of its tile at the near and far depths of its slice.
+		mClusterBounds.resize(ClusterCount());
+		for (uint32_t slice = 0; slice < mSliceCount; slice++)
+		{
+			const float depths[2] =
+			{
+				nearPlaneDistance * pow(farPlaneDistance / nearPlaneDistance, static_cast<float>(slice) / mSliceCount),
+				nearPlaneDistance * pow(farPlaneDistance / nearPlaneDistance, static_cast<float>(slice + 1) / mSliceCount)
+			};
+
+			for (uint32_t tileY = 0; tileY < mTileCountY; tileY++)
+			{
+				const float normalizedY[2] = { 1.0f - 2.0f * (tileY + 1) / mTileCountY, 1.0f - 2.0f * tileY / mTileCountY };
+				for (uint32_t tileX = 0; tileX < mTileCountX; tileX++)
+				{
+					const float normalizedX[2] = { -1.0f + 2.0f * tileX / mTileCountX, -1.0f + 2.0f * (tileX + 1) / mTileCountX };
+					XMVECTOR minimum = XMVectorReplicate(numeric_limits<float>::max());
+					XMVECTOR maximum = XMVectorReplicate(numeric_limits<float>::lowest());
+					for (float depth : depths)
+					{
+						for (float x : normalizedX)
+						{
+							for (float y : normalizedY)
+							{
+								const XMVECTOR corner = XMVectorSet(x * depth * mTanHalfFovX, y * depth * mTanHalfFovY, -depth, 0.0f);
+								minimum = XMVectorMin(minimum, corner);
+								maximum = XMVectorMax(maximum, corner);
+							}
+						}
+					}
+
+					BoundingBox& bounds = mClusterBounds[ClusterIndex(tileX, tileY, slice)];
+					XMStoreFloat3(&bounds.Center, (minimum + maximum) * 0.5f);
+					XMStoreFloat3(&bounds.Extents, (maximum - minimum) * 0.5f);
+				}
+			}
+		}
+	}
+
+	void ClusteredLightBuilder::PrepareLight(CXMMATRIX viewMatrix, uint32_t lightIndex, const PointLight& light)
+	{
+		const SpotLight* spotLight = light.As<SpotLight>();
+		const float range = light.Radius();
+
+		ClusteredLightData& data = mLights[lightIndex];
+		data.Position = light.Position();
+		data.Radius = range;
+		data.Color = XMFLOAT3(light.Color().x, light.Color().y, light.Color().z);
+		data.Direction = (spotLight != nullptr ? spotLight->Direction() : XMFLOAT3(0.0f, 0.0f, 0.0f));
+		data.SpotInnerAngle = (spotLight != nullptr ? spotLight->InnerAngle() : -1.0f);
+		data.SpotOuterAngle = (spotLight != nullptr ? spotLight->OuterAngle() : -1.0f);
+
+		ViewLight& viewLight = mViewLights[lightIndex];
+		const XMVECTOR apex = XMVector3Transform(light.PositionVector(), viewMatrix);
+		XMStoreFloat3(&viewLight.Apex, apex);
+		viewLight.Range = range;
+
+		if (spotLight != nullptr)
+		{
+			// The spot factor is zero beyond the outer angle's cosine and beyond 90 degrees. The cone (capped by
+			// the light's range) is enclosed by the sphere through its apex and rim for narrow cones, and by the
+			// sphere around its rim for wide ones.
+			const XMVECTOR axis = XMVector3Normalize(XMVector3TransformNormal(spotLight->DirectionVector(), viewMatrix));
+			XMStoreFloat3(&viewLight.Axis, axis);
+			viewLight.ConeCosine = clamp(spotLight->OuterAngle(), 0.0f, 1.0f);
+			viewLight.ConeSine = sqrt(1.0f - viewLight.ConeCosine * viewLight.ConeCosine);
+
+			const bool narrowCone = (viewLight.ConeCosine > 0.70710678f);
+			const float centerDistance = (narrowCone ? range / (2.0f * viewLight.ConeCosine) : range * viewLight.ConeCosine);
+			XMStoreFloat3(&viewLight.Bounds.Center, apex + axis * centerDistance);
+			viewLight.Bounds.Radius = (narrowCone ? centerDistance : range * viewLight.ConeSine);
+		}
+		else
+		{
+			viewLight.Axis = XMFLOAT3(0.0f, 0.0f, 0.0f);
+			viewLight.ConeCosine = -1.0f;
+			viewLight.ConeSine = 0.0f;
+			viewLight.Bounds.Center = viewLight.Apex;
+			viewLight.Bounds.Radius = range;
+		}
+
+		// Only the part of the bounds beyond the near plane can touch a cluster; the extremes of its projection
+		// are at the corners of its box, clipped to that depth range.
+		const XMFLOAT3& center = viewLight.Bounds.Center;
+		const float radius = viewLight.Bounds.Radius;
+		const float nearPlaneDistance = mProjection.z;
+		const float farPlaneDistance = mProjection.w;
+		const float minDepth = max(-center.z - radius, nearPlaneDistance);
+		const float maxDepth = min(-center.z + radius, farPlaneDistance);
+		viewLight.Visible = (minDepth <= maxDepth && radius > 0.0f);
+		if (!viewLight.Visible)
+		{
+			return;
+		}
+
+		float minX = numeric_limits<float>::max();
+		float maxX = numeric_limits<float>::lowest();
+		float minY = numeric_limits<float>::max();
+		float maxY = numeric_limits<float>::lowest();
+		for (float depth : { minDepth, maxDepth })
+		{
+			for (float sign : { -1.0f, 1.0f })
+			{
+				const float x = (center.x + sign * radius) / (depth * mTanHalfFovX);
+				const float y = (center.y + sign * radius) / (depth * mTanHalfFovY);
+				minX = min(minX, x);
+				maxX = max(maxX, x);
+				minY = min(minY, y);
+				maxY = max(maxY, y);
+			}
+		}
+
+		minX -= RangeTolerance;
+		minY -= RangeTolerance;
+		maxX += RangeTolerance;
+		maxY += RangeTolerance;
+		viewLight.Visible = (maxX >= -1.0f && minX <= 1.0f && maxY >= -1.0f && minY <= 1.0f);
+		viewLight.MinTileX = TileIndex(minX, mTileCountX);
+		viewLight.MaxTileX = TileIndex(maxX, mTileCountX);
+		viewLight.MinTileY = mTileCountY - 1 - TileIndex(maxY, mTileCountY);
+		viewLight.MaxTileY = mTileCountY - 1 - TileIndex(minY, mTileCountY);
+		viewLight.MinSlice = Slice(minDepth * (1.0f - RangeTolerance));
+		viewLight.MaxSlice = Slice(maxDepth * (1.0f + RangeTolerance));
+	}
+
+	void ClusteredLightBuilder::AssignSlice(uint32_t slice)
+	{
+		SliceWork& work = mSliceWork[slice];
+		work.Groups.clear();
+		work.LightIndices.clear();
+		work.ClusterLightIndices.clear();
+		work.ClusterCounts.assign(mTileCountX * mTileCountY, 0);
+
+		// Gather the lights overlapping the slice into groups of four; unused lanes get an empty tile range.
+		size_t gatheredCount = 0;
+		for (uint32_t lightIndex = 0; lightIndex < mViewLights.size(); lightIndex++)
+		{
+			const ViewLight& light = mViewLights[lightIndex];
+			if (!light.Visible || slice < light.MinSlice || slice > light.MaxSlice)
+			{
+				continue;
+			}
+
+			const size_t lane = gatheredCount++ % 4;
+			if (lane == 0)
+			{
+				work.Groups.resize(work.Groups.size() + RowsPerGroup * 4, 0.0f);
+				work.LightIndices.insert(work.LightIndices.end(), 4, InvalidLight);
+				float* group = &work.Groups[work.Groups.size() - RowsPerGroup * 4];
+				for (size_t padding = 0; padding < 4; padding++)
+				{
+					group[static_cast<size_t>(GroupRow::MinTileX) * 4 + padding] = 1.0f;
+				}
+			}
+
+			float* group = &work.Groups[work.Groups.size() - RowsPerGroup * 4];
+			const float values[RowsPerGroup] =
+			{
+				static_cast<float>(light.MinTileX),
+				static_cast<float>(light.MaxTileX),
+				static_cast<float>(light.MinTileY),
+				static_cast<float>(light.MaxTileY),
+				light.Bounds.Center.x,
+				light.Bounds.Center.y,
+				light.Bounds.Center.z,
+				light.Bounds.Radius * light.Bounds.Radius,
+				light.Apex.x,
+				light.Apex.y,
+				light.Apex.z,
+				light.Axis.x,
+				light.Axis.y,
+				light.Axis.z,
+				light.ConeCosine,
+				light.ConeSine,
+				light.Range
+			};
+
+			for (uint32_t row = 0; row < RowsPerGroup; row++)
+			{
+				group[row * 4 + lane] = values[row];
+			}
+
+			work.LightIndices[work.LightIndices.size() - 4 + lane] = lightIndex;
+		}
+
+		const size_t groupCount = work.Groups.size() / (RowsPerGroup * 4);
+		const XMVECTOR zero = XMVectorZero();
+		for (uint32_t tileY = 0; tileY < mTileCountY; tileY++)
+		{
+			const XMVECTOR clusterY = XMVectorReplicate(static_cast<float>(tileY));
+			for (uint32_t tileX = 0; tileX < mTileCountX; tileX++)
+			{
+				const XMVECTOR clusterX = XMVectorReplicate(static_cast<float>(tileX));
+				const BoundingBox& bounds = mClusterBounds[ClusterIndex(tileX, tileY, slice)];
+				const XMVECTOR boxCenterX = XMVectorReplicate(bounds.Center.x);
+				const XMVECTOR boxCenterY = XMVectorReplicate(bounds.Center.y);
+				const XMVECTOR boxCenterZ = XMVectorReplicate(bounds.Center.z);
+				const XMVECTOR extentX = XMVectorReplicate(bounds.Extents.x);
+				const XMVECTOR extentY = XMVectorReplicate(bounds.Extents.y);
+				const XMVECTOR extentZ = XMVectorReplicate(bounds.Extents.z);
+				const XMVECTOR clusterRadius = XMVector3Length(XMLoadFloat3(&bounds.Extents));
+				const size_t firstIndex = work.ClusterLightIndices.size();
+
+				for (size_t groupIndex = 0; groupIndex < groupCount; groupIndex++)
+				{
+					const float* group = &work.Groups[groupIndex * RowsPerGroup * 4];
+					const auto row = [group](GroupRow groupRow)
+					{
+						return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(group + static_cast<size_t>(groupRow) * 4));
+					};
+
+					XMVECTOR hit = XMVectorAndInt(XMVectorGreaterOrEqual(clusterX, row(GroupRow::MinTileX)), XMVectorLessOrEqual(clusterX, row(GroupRow::MaxTileX)));
+					hit = XMVectorAndInt(hit, XMVectorAndInt(XMVectorGreaterOrEqual(clusterY, row(GroupRow::MinTileY)), XMVectorLessOrEqual(clusterY, row(GroupRow::MaxTileY))));
+					if (XMVector4EqualInt(hit, XMVectorFalseInt()))
+					{
+						continue;
+					}
+
+					// Bounding sphere against the cluster's box.
+					const XMVECTOR distanceX = XMVectorMax(XMVectorAbs(row(GroupRow::CenterX) - boxCenterX) - extentX, zero);
+					const XMVECTOR distanceY = XMVectorMax(XMVectorAbs(row(GroupRow::CenterY) - boxCenterY) - extentY, zero);
+					const XMVECTOR distanceZ = XMVectorMax(XMVectorAbs(row(GroupRow::CenterZ) - boxCenterZ) - extentZ, zero);
+					hit = XMVectorAndInt(hit, XMVectorLessOrEqual(distanceX * distanceX + distanceY * distanceY + distanceZ * distanceZ, row(GroupRow::RadiusSquared)));
+
+					// Cone against the cluster's bounding sphere (Bartosz Chodorowski); the distance it computes to
+					// the cone never exceeds the true distance, so no cluster the cone reaches is rejected.
+					const XMVECTOR toClusterX = boxCenterX - row(GroupRow::ApexX);
+					const XMVECTOR toClusterY = boxCenterY - row(GroupRow::ApexY);
+					const XMVECTOR toClusterZ = boxCenterZ - row(GroupRow::ApexZ);
+					const XMVECTOR lengthSquared = toClusterX * toClusterX + toClusterY * toClusterY + toClusterZ * toClusterZ;
+					const XMVECTOR axialDistance = toClusterX * row(GroupRow::AxisX) + toClusterY * row(GroupRow::AxisY) + toClusterZ * row(GroupRow::AxisZ);
+					const XMVECTOR radialDistance = XMVectorSqrt(XMVectorMax(lengthSquared - axialDistance * axialDistance, zero));
+					const XMVECTOR coneDistance = row(GroupRow::ConeCosine) * radialDistance - row(GroupRow::ConeSine) * axialDistance;
+					hit = XMVectorAndInt(hit, XMVectorLessOrEqual(coneDistance, clusterRadius));
+					hit = XMVectorAndInt(hit, XMVectorLessOrEqual(axialDistance, clusterRadius + row(GroupRow::Range)));
+					hit = XMVectorAndInt(hit, XMVectorGreaterOrEqual(axialDistance, -clusterRadius));
+					if (XMVector4EqualInt(hit, XMVectorFalseInt()))
+					{
+						continue;
+					}
+
+					uint32_t lanes[4];
+					XMStoreInt4(lanes, hit);
+					for (size_t lane = 0; lane < 4; lane++)
+					{
+						if (lanes[lane] != 0)
+						{
+							work.ClusterLightIndices.push_back(work.LightIndices[groupIndex * 4 + lane]);
+						}
+					}
+				}
+
+				work.ClusterCounts[tileY * mTileCountX + tileX] = narrow_cast<uint32_t>(work.ClusterLightIndices.size() - firstIndex);
+			}
+		}
+	}
+
+	uint32_t ClusteredLightBuilder::Slice(float viewDepth) const
+	{
+		const float slice = floor(log(max(viewDepth, numeric_limits<float>::min())) * mSliceScale + mSliceBias);
+		return static_cast<uint32_t>(clamp(slice, 0.0f, static_cast<float>(mSliceCount - 1)));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include <gsl\gsl>
+
+namespace Library
+{
+	class PerspectiveCamera;
+	class PointLight;
+
+	// A light as stored in the light buffer; each row is 16 bytes, matching HLSL packing. Spot lights keep the
+	// cosines of SpotLight's inner and outer angles; point lights have a zero direction and cosines of -1.
+	struct ClusteredLightData final
+	{
+		DirectX::XMFLOAT3 Position; // World space
+		float Radius;
+		DirectX::XMFLOAT3 Color;
+		float SpotInnerAngle;
+		DirectX::XMFLOAT3 Direction;
+		float SpotOuterAngle;
+	};
+
+	// A cluster's range of the light index list.
+	struct LightCluster final
+	{
+		std::uint32_t Offset;
+		std::uint32_t Count;
+	};
+
+	// Assigns lights to the clusters of a perspective view frustum on the CPU, for shading with hundreds of point
+	// and spot lights per view. The frustum is divided into screen tiles and into depth slices spaced
+	// exponentially between the near and far planes (froxels). Each light's bounding sphere selects a range of
+	// clusters, which are then tested four lights at a time: point lights against each cluster's bounding box,
+	// and spot lights also by their cone against the cluster's bounding sphere. Depth slices are processed in
+	// parallel, and the per-cluster lists are packed into one index list.
+	//
+	// A shader finds its cluster from the pixel's tile and its view depth:
+	// slice = floor(log(viewDepth) * SliceScale() + SliceBias()), cluster = (slice * TileCountY + tileY) * TileCountX + tileX,
+	// with tile (0, 0) at the top left of the screen.
+	class ClusteredLightBuilder final
+	{
+	public:
+		explicit ClusteredLightBuilder(std::uint32_t tileCountX = DefaultTileCountX, std::uint32_t tileCountY = DefaultTileCountY, std::uint32_t sliceCount = DefaultSliceCount);
+		ClusteredLightBuilder(const ClusteredLightBuilder&) = default;
+		ClusteredLightBuilder(ClusteredLightBuilder&&) = default;
+		ClusteredLightBuilder& operator=(const ClusteredLightBuilder&) = default;
+		ClusteredLightBuilder& operator=(ClusteredLightBuilder&&) = default;
+		~ClusteredLightBuilder() = default;
+
+		std::uint32_t TileCountX() const;
+		std::uint32_t TileCountY() const;
+		std::uint32_t SliceCount() const;
+		std::uint32_t ClusterCount() const;
+
+		// Spot lights are recognized by their type; any other light is treated as a point light.
+		void Build(const PerspectiveCamera& camera, const gsl::span<const PointLight* const>& lights);
+		void Build(DirectX::CXMMATRIX viewMatrix, float fieldOfView, float aspectRatio, float nearPlaneDistance, float farPlaneDistance, const gsl::span<const PointLight* const>& lights);
+
+		// The light data is in the order of the lights given to Build; the index list refers to it.
+		const std::vector<ClusteredLightData>& Lights() const;
+		const std::vector<LightCluster>& Clusters() const;
+		const std::vector<std::uint32_t>& LightIndices() const;
+
+		// View-space bounds of a cluster, for the view of the last build; view space looks down -z.
+		const DirectX::BoundingBox& ClusterBounds(std::uint32_t cluster) const;
+		std::uint32_t ClusterIndex(std::uint32_t tileX, std::uint32_t tileY, std::uint32_t slice) const;
+
+		float SliceScale() const;
+		float SliceBias() const;
+
+		inline static const std::uint32_t DefaultTileCountX{ 16 };
+		inline static const std::uint32_t DefaultTileCountY{ 9 };
+		inline static const std::uint32_t DefaultSliceCount{ 24 };
+
+	private:
+		// A light's bounds in view space, with the cone of spot lights. Point lights have a zero axis and a
+		// cone angle of 180 degrees, which no cluster fails.
+		struct ViewLight final
+		{
+			DirectX::BoundingSphere Bounds;
+			DirectX::XMFLOAT3 Apex;
+			float Range;
+			DirectX::XMFLOAT3 Axis;
+			float ConeCosine;
+			float ConeSine;
+			std::uint32_t MinTileX;
+			std::uint32_t MaxTileX;
+			std::uint32_t MinTileY;
+			std::uint32_t MaxTileY;
+			std::uint32_t MinSlice;
+			std::uint32_t MaxSlice;
+			bool Visible;
+		};
+
+		// The lights overlapping one slice, four to a group in structure-of-arrays form, and the slice's output.
+		struct SliceWork final
+		{
+			std::vector<float> Groups; // RowsPerGroup rows of four lanes per group
+			std::vector<std::uint32_t> LightIndices; // Per lane, padded with InvalidLight
+			std::vector<std::uint32_t> ClusterLightIndices;
+			std::vector<std::uint32_t> ClusterCounts;
+		};
+
+		void UpdateClusterBounds(float fieldOfView, float aspectRatio, float nearPlaneDistance, float farPlaneDistance);
+		void PrepareLight(DirectX::CXMMATRIX viewMatrix, std::uint32_t lightIndex, const PointLight& light);
+		void AssignSlice(std::uint32_t slice);
+		std::uint32_t Slice(float viewDepth) const;
+
+		inline static const std::uint32_t RowsPerGroup{ 17 };
+		inline static const std::uint32_t InvalidLight{ UINT32_MAX };
+
+		std::uint32_t mTileCountX;
+		std::uint32_t mTileCountY;
+		std::uint32_t mSliceCount;
+		DirectX::XMFLOAT4 mProjection{ 0.0f, 0.0f, 0.0f, 0.0f }; // Field of view, aspect ratio, near and far plane distances of the cluster bounds
+		float mSliceScale{ 0.0f };
+		float mSliceBias{ 0.0f };
+		float mTanHalfFovX{ 0.0f };
+		float mTanHalfFovY{ 0.0f };
+		std::vector<DirectX::BoundingBox> mClusterBounds;
+		std::vector<ClusteredLightData> mLights;
+		std::vector<ViewLight> mViewLights;
+		std::vector<LightCluster> mClusters;
+		std::vector<std::uint32_t> mLightIndices;
+		std::vector<SliceWork> mSliceWork;
+		std::vector<std::uint32_t> mSliceIndices;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "pch.h"
+#include "ConstantBufferDirtyRange.h"
+
+using namespace std;
+using namespace gsl;
+
+namespace Library
+{
+	ConstantBufferDirtyRange::ConstantBufferDirtyRange(uint32_t bufferSize) :
+		mRegisterCount((bufferSize + ConstantBufferField::RegisterSize - 1) / ConstantBufferField::RegisterSize)
+	{
+		MarkAll();
+	}
+
+	bool ConstantBufferDirtyRange::IsDirty() const
+	{
+		return mFirstRegister != NotDirty;
+	}
+
+	uint32_t ConstantBufferDirtyRange::FirstRegister() const
+	{
+		return mFirstRegister;
+	}
+
+	uint32_t ConstantBufferDirtyRange::LastRegister() const
+	{
+		return mLastRegister;
+	}
+
+	void ConstantBufferDirtyRange::Mark(const ConstantBufferField& field)
+	{
+		assert(field.Size > 0 && field.LastRegister() < mRegisterCount);
+
+		mLastRegister = (IsDirty() ? max(mLastRegister, field.LastRegister()) : field.LastRegister());
+		mFirstRegister = min(mFirstRegister, field.FirstRegister());
+	}
+
+	void ConstantBufferDirtyRange::MarkAll()
+	{
+		if (mRegisterCount > 0)
+		{
+			mFirstRegister = 0;
+			mLastRegister = mRegisterCount - 1;
+		}
+	}
+
+	void ConstantBufferDirtyRange::Clear()
+	{
+		mFirstRegister = NotDirty;
+		mLastRegister = 0;
+	}
+
+	void ConstantBufferDirtyRange::Update(not_null<ID3D11DeviceContext1*> deviceContext, not_null<ID3D11Buffer*> buffer, const void* data, bool partialUpdatesSupported)
+	{
+		if (IsDirty() == false)
+		{
+			return;
+		}
+
+		const bool isFullUpdate = (mFirstRegister == 0 && mLastRegister == mRegisterCount - 1);
+		if (isFullUpdate || partialUpdatesSupported == false)
+		{
+			deviceContext->UpdateSubresource(buffer, 0, nullptr, data, 0, 0);
+		}
+		else
+		{
+			D3D11_BOX box{ 0 };
+			box.left = mFirstRegister * ConstantBufferField::RegisterSize;
+			box.right = (mLastRegister + 1) * ConstantBufferField::RegisterSize;
+			box.bottom = 1;
+			box.back = 1;
+
+			// The source pointer addresses the first byte of the box, not the start of the buffer.
+			deviceContext->UpdateSubresource1(buffer, 0, &box, reinterpret_cast<const uint8_t*>(data) + box.left, 0, 0, 0);
+		}
+
+		Clear();
+	}
+}
\ No newline at end of file
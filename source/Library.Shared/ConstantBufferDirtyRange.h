@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <d3d11_1.h>
+#include <gsl\gsl>
+
+namespace Library
+{
+	// Byte range of a constant buffer member, as laid out under HLSL packing rules.
+	struct ConstantBufferField final
+	{
+		inline static constexpr std::uint32_t RegisterSize{ 16 };
+
+		std::uint32_t Offset;
+		std::uint32_t Size;
+
+		constexpr std::uint32_t FirstRegister() const { return Offset / RegisterSize; }
+		constexpr std::uint32_t LastRegister() const { return (Offset + Size - 1) / RegisterSize; }
+	};
+
+	// Tracks the 16-byte registers of a constant buffer touched since the last upload, so only those are copied.
+	class ConstantBufferDirtyRange final
+	{
+	public:
+		ConstantBufferDirtyRange() = default;
+		explicit ConstantBufferDirtyRange(std::uint32_t bufferSize);
+		ConstantBufferDirtyRange(const ConstantBufferDirtyRange&) = default;
+		ConstantBufferDirtyRange& operator=(const ConstantBufferDirtyRange&) = default;
+		ConstantBufferDirtyRange(ConstantBufferDirtyRange&&) = default;
+		ConstantBufferDirtyRange& operator=(ConstantBufferDirtyRange&&) = default;
+		~ConstantBufferDirtyRange() = default;
+
+		bool IsDirty() const;
+		std::uint32_t FirstRegister() const;
+		std::uint32_t LastRegister() const;
+
+		void Mark(const ConstantBufferField& field);
+		void MarkAll();
+		void Clear();
+
+		// Uploads the dirty registers of data (which mirrors the whole buffer) and clears the range.
+		// Falls back to a full update when the device does not support partial constant buffer updates.
+		void Update(gsl::not_null<ID3D11DeviceContext1*> deviceContext, gsl::not_null<ID3D11Buffer*> buffer, const void* data, bool partialUpdatesSupported);
+
+	private:
+		inline static const std::uint32_t NotDirty{ std::numeric_limits<std::uint32_t>::max() };
+
+		std::uint32_t mRegisterCount{ 0 };
+		std::uint32_t mFirstRegister{ NotDirty };
+		std::uint32_t mLastRegister{ 0 };
+	};
+}
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "ContentManager.h"
 #include "ContentTypeReaderManager.h"
 #include "GameException.h"
+#include "OverlappedFileReadBackend.h"
 
 using namespace std;
 
@@ -10,7 +11,7 @@ namespace Library
 	const wstring ContentManager::DefaultRootDirectory{ L"Content\\" };
 
 	ContentManager::ContentManager(Game& game, const wstring& rootDirectory) :
-		mGame(game), mRootDirectory(rootDirectory)
+		mGame(game), mRootDirectory(rootDirectory), mFileReader(make_shared<OverlappedFileReadBackend>())
 	{
 	}
 
@@ -27,6 +28,42 @@ namespace Library
 	void ContentManager::Clear()
 	{
 		mLoadedAssets.clear();
+		mPendingReads.clear();
+	}
+
+	void ContentManager::SetFileReader(const shared_ptr<FileReadBackend>& fileReader)
+	{
+		if (fileReader == nullptr)
+		{
+			throw GameException("File reader cannot be null.");
+		}
+
+		mFileReader = fileReader;
+	}
+
+	void ContentManager::Prefetch(const vector<wstring>& assetNames)
+	{
+		for (const auto& assetName : assetNames)
+		{
+			const wstring pathName = mRootDirectory + assetName;
+			if (mLoadedAssets.find(assetName) == mLoadedAssets.end() && mPendingReads.find(pathName) == mPendingReads.end())
+			{
+				mPendingReads.emplace(pathName, mFileReader->ReadFileAsync(pathName));
+			}
+		}
+	}
+
+	vector<char> ContentManager::ReadFile(const wstring& pathName)
+	{
+		auto it = mPendingReads.find(pathName);
+		if (it != mPendingReads.end())
+		{
+			future<vector<char>> pendingRead = move(it->second);
+			mPendingReads.erase(it);
+			return pendingRead.get();
+		}
+
+		return mFileReader->ReadFile(pathName);
 	}
 
 	shared_ptr<RTTI> ContentManager::ReadAsset(const int64_t targetTypeId, const wstring& assetName)
@@ -4,8 +4,11 @@
 #include <map>
 #include <algorithm>
 #include <functional>
+#include <future>
+#include <vector>
 #include "RTTI.h"
 #include "StringHelper.h"
+#include "FileReadBackend.h"
 
 namespace Library
 {
@@ -32,6 +35,17 @@ namespace Library
 		void RemoveAsset(const std::wstring& assetName);
 		void Clear();
 
+		// Content readers get file bytes through the backend; OverlappedFileReadBackend by default.
+		const std::shared_ptr<FileReadBackend>& FileReader() const;
+		void SetFileReader(const std::shared_ptr<FileReadBackend>& fileReader);
+
+		// Starts reading the files of the given assets all at once. A later Load of one of them takes the data
+		// already in flight instead of issuing its own read.
+		void Prefetch(const std::vector<std::wstring>& assetNames);
+
+		// Reads a file by its full path (root directory included, as passed to content readers).
+		std::vector<char> ReadFile(const std::wstring& pathName);
+
 	private:
 		static const std::wstring DefaultRootDirectory;
 
@@ -40,6 +54,8 @@ namespace Library
 		Library::Game& mGame;
 		std::map<std::wstring, std::shared_ptr<RTTI>> mLoadedAssets;
 		std::wstring mRootDirectory;
+		std::shared_ptr<FileReadBackend> mFileReader;
+		std::map<std::wstring, std::future<std::vector<char>>> mPendingReads;
 	};
 }
 
@@ -18,6 +18,11 @@ namespace Library
 		mRootDirectory = rootDirectory + (StringHelper::EndsWith(rootDirectory, L"\\") ? std::wstring() : L"\\");
 	}
 
+	inline const std::shared_ptr<FileReadBackend>& ContentManager::FileReader() const
+	{
+		return mFileReader;
+	}
+
 	template<typename T>
 	inline std::shared_ptr<T> ContentManager::Load(const std::wstring& assetName, bool reload, std::function<std::shared_ptr<T>(std::wstring&)> customReader)
 	{
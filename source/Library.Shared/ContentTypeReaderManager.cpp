@@ -5,6 +5,8 @@
 #include "VertexShaderReader.h"
 #include "PixelShaderReader.h"
 #include "ModelReader.h"
+#include "SphericalHarmonicsReader.h"
+#include "ShaderPackReader.h"
 
 using namespace std;
 
@@ -33,6 +35,8 @@ namespace Library
 			AddContentTypeReader(make_shared<VertexShaderReader>(game));
 			AddContentTypeReader(make_shared<PixelShaderReader>(game));
 			AddContentTypeReader(make_shared<ModelReader>(game));
+			AddContentTypeReader(make_shared<SphericalHarmonicsReader>(game));
+			AddContentTypeReader(make_shared<ShaderPackReader>(game));
 
 			sInitialized = true;
 		}
@@ -0,0 +1,68 @@
+#include "pch.h"
+#include "CpuFeatures.h"
+#include <intrin.h>
+
+namespace Library
+{
+	namespace
+	{
+		struct DetectedFeatures final
+		{
+			bool AVX{ false };
+			bool F16C{ false };
+			bool AVX2{ false };
+		};
+
+		DetectedFeatures Detect()
+		{
+			DetectedFeatures features;
+			int registers[4];
+			__cpuid(registers, 0);
+			const int maxLeaf = registers[0];
+			if (maxLeaf < 1)
+			{
+				return features;
+			}
+
+			// The operating system must also preserve the YMM registers across context switches.
+			__cpuid(registers, 1);
+			const bool osxsave = (registers[2] & (1 << 27)) != 0;
+			const bool avx = (registers[2] & (1 << 28)) != 0;
+			if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+			{
+				return features;
+			}
+
+			features.AVX = true;
+			features.F16C = (registers[2] & (1 << 29)) != 0;
+			if (maxLeaf >= 7)
+			{
+				__cpuidex(registers, 7, 0);
+				features.AVX2 = (registers[1] & (1 << 5)) != 0;
+			}
+
+			return features;
+		}
+
+		const DetectedFeatures& Features()
+		{
+			static const DetectedFeatures features = Detect();
+			return features;
+		}
+	}
+
+	bool CpuFeatures::HasAVX()
+	{
+		return Features().AVX;
+	}
+
+	bool CpuFeatures::HasF16C()
+	{
+		return Features().F16C;
+	}
+
+	bool CpuFeatures::HasAVX2()
+	{
+		return Features().AVX2;
+	}
+}
\ No newline at end of file
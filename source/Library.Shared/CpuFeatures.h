@@ -0,0 +1,16 @@
+#pragma once
+
+namespace Library
+{
+	// Instruction set extensions of the processor, detected once. Each AVX-based extension is only reported when
+	// the operating system also preserves the YMM registers across context switches.
+	class CpuFeatures final
+	{
+	public:
+		CpuFeatures() = delete;
+
+		static bool HasAVX();
+		static bool HasF16C(); // Half-precision conversions; implies AVX
+		static bool HasAVX2(); // Implies AVX
+	};
+}
\ No newline at end of file
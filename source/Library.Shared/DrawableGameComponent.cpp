@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "DrawableGameComponent.h"
+#include "Game.h"
 
 using namespace std;
 
@@ -22,6 +23,17 @@ namespace Library
 		mVisible = visible;
 	}
 
+	bool DrawableGameComponent::IsStatic() const
+	{
+		return mStatic;
+	}
+
+	void DrawableGameComponent::SetStatic(bool isStatic)
+	{
+		mStatic = isStatic;
+		mGame->InvalidateStaticScene();
+	}
+
 	shared_ptr<Camera> DrawableGameComponent::GetCamera()
 	{
 		return mCamera;
@@ -35,4 +47,9 @@ namespace Library
 	void DrawableGameComponent::Draw(const GameTime&)
 	{
 	}
+
+	bool DrawableGameComponent::GetBounds(DirectX::BoundingSphere&) const
+	{
+		return false;
+	}
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "GameComponent.h"
 #include <memory>
+#include <DirectXCollision.h>
 
 namespace Library
 {
@@ -23,13 +24,23 @@ namespace Library
         bool Visible() const;
         void SetVisible(bool visible);
 
+		// Static components with bounds are culled through the game's scene index rather than one by one; see
+		// Game::StaticScene. Their bounds and camera are expected to stay fixed (see Game::RefitStaticScene).
+		bool IsStatic() const;
+		void SetStatic(bool isStatic);
+
 		std::shared_ptr<Camera> GetCamera();
 		void SetCamera(const std::shared_ptr<Camera>& camera);
 
         virtual void Draw(const GameTime& gameTime);
 
+		// World-space bounds used by Game::Draw to skip components outside their camera's frustum. Components that
+		// return false (the default) are always drawn.
+		virtual bool GetBounds(DirectX::BoundingSphere& bounds) const;
+
     protected:
 		bool mVisible{ true };
+		bool mStatic{ false };
 		std::shared_ptr<Camera> mCamera;
     };
 }
\ No newline at end of file
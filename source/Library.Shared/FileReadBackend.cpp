@@ -0,0 +1,39 @@
+#include "pch.h"
+#include "FileReadBackend.h"
+#include "GameException.h"
+
+using namespace std;
+using namespace gsl;
+
+namespace Library
+{
+	void FileReadBackend::Read(const wstring& filename, const span<const FileReadRange>& ranges)
+	{
+		ReadAsync(filename, ranges).get();
+	}
+
+	future<vector<char>> FileReadBackend::ReadFileAsync(const wstring& filename)
+	{
+		error_code error;
+		const uintmax_t size = filesystem::file_size(filename, error);
+		if (error)
+		{
+			throw GameException("Could not open file.", HRESULT_FROM_WIN32(error.value()));
+		}
+
+		auto data = make_shared<vector<char>>(narrow<size_t>(size));
+		const FileReadRange range{ 0, span<char>(*data) };
+		future<void> completion = ReadAsync(filename, span<const FileReadRange>(&range, 1), data);
+
+		return async(launch::deferred, [data, completion = move(completion)]() mutable
+		{
+			completion.get();
+			return move(*data);
+		});
+	}
+
+	vector<char> FileReadBackend::ReadFile(const wstring& filename)
+	{
+		return ReadFileAsync(filename).get();
+	}
+}
\ No newline at end of file
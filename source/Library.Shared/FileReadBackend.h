@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include <gsl\gsl>
+
+namespace Library
+{
+	struct FileReadRange final
+	{
+		std::uint64_t Offset;
+		gsl::span<char> Destination;
+	};
+
+	// Source of file bytes for content loading. Implementations may keep many reads in flight at once; callers
+	// issue the reads they need up front and wait on the returned futures.
+	class FileReadBackend
+	{
+	public:
+		FileReadBackend() = default;
+		FileReadBackend(const FileReadBackend&) = delete;
+		FileReadBackend(FileReadBackend&&) = delete;
+		FileReadBackend& operator=(const FileReadBackend&) = delete;
+		FileReadBackend& operator=(FileReadBackend&&) = delete;
+		virtual ~FileReadBackend() = default;
+
+		// Reads every range of the file into its destination (a vectored read). The destinations must stay valid
+		// until the future is ready; destinationOwner, if given, is kept alive until then. The future reports
+		// failures, including reads past the end of the file.
+		virtual std::future<void> ReadAsync(const std::wstring& filename, const gsl::span<const FileReadRange>& ranges, std::shared_ptr<const void> destinationOwner = nullptr) = 0;
+		void Read(const std::wstring& filename, const gsl::span<const FileReadRange>& ranges);
+
+		std::future<std::vector<char>> ReadFileAsync(const std::wstring& filename);
+		std::vector<char> ReadFile(const std::wstring& filename);
+	};
+}
\ No newline at end of file
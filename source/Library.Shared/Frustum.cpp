@@ -0,0 +1,286 @@
+#include "pch.h"
+#include "Frustum.h"
+#include "GameException.h"
+#include "CpuFeatures.h"
+#include <immintrin.h>
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+
+namespace Library
+{
+	namespace
+	{
+		// The volume streams of either layout; boxes use all three extents, spheres only the first (the radius).
+		struct VolumeStreams final
+		{
+			const float* CenterX;
+			const float* CenterY;
+			const float* CenterZ;
+			const float* ExtentX;
+			const float* ExtentY;
+			const float* ExtentZ;
+			size_t Count;
+		};
+
+		template <bool IsBox>
+		bool IntersectsScalar(const array<XMFLOAT4, 6>& planes, const VolumeStreams& volumes, size_t i)
+		{
+			for (const XMFLOAT4& plane : planes)
+			{
+				const float distance = plane.x * volumes.CenterX[i] + plane.y * volumes.CenterY[i] + plane.z * volumes.CenterZ[i] + plane.w;
+				const float radius = (IsBox ? fabs(plane.x) * volumes.ExtentX[i] + fabs(plane.y) * volumes.ExtentY[i] + fabs(plane.z) * volumes.ExtentZ[i] : volumes.ExtentX[i]);
+				if (distance < -radius)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		// Each kernel tests whole groups of lanes and returns the index of the first volume it did not test.
+		template <bool IsBox>
+		size_t SSECull(const array<XMFLOAT4, 6>& planes, const VolumeStreams& volumes, uint32_t* visibility)
+		{
+			__m128 planeX[6], planeY[6], planeZ[6], planeW[6], absoluteX[6], absoluteY[6], absoluteZ[6];
+			const __m128 signMask = _mm_set1_ps(-0.0f);
+			for (size_t p = 0; p < 6; p++)
+			{
+				planeX[p] = _mm_set1_ps(planes[p].x);
+				planeY[p] = _mm_set1_ps(planes[p].y);
+				planeZ[p] = _mm_set1_ps(planes[p].z);
+				planeW[p] = _mm_set1_ps(planes[p].w);
+				absoluteX[p] = _mm_andnot_ps(signMask, planeX[p]);
+				absoluteY[p] = _mm_andnot_ps(signMask, planeY[p]);
+				absoluteZ[p] = _mm_andnot_ps(signMask, planeZ[p]);
+			}
+
+			const size_t vectorCount = volumes.Count & ~size_t(3);
+			for (size_t i = 0; i < vectorCount; i += 4)
+			{
+				const __m128 centerX = _mm_loadu_ps(volumes.CenterX + i);
+				const __m128 centerY = _mm_loadu_ps(volumes.CenterY + i);
+				const __m128 centerZ = _mm_loadu_ps(volumes.CenterZ + i);
+				const __m128 extentX = _mm_loadu_ps(volumes.ExtentX + i);
+				const __m128 extentY = (IsBox ? _mm_loadu_ps(volumes.ExtentY + i) : extentX);
+				const __m128 extentZ = (IsBox ? _mm_loadu_ps(volumes.ExtentZ + i) : extentX);
+
+				__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				for (size_t p = 0; p < 6; p++)
+				{
+					const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], centerX), _mm_mul_ps(planeY[p], centerY)), _mm_add_ps(_mm_mul_ps(planeZ[p], centerZ), planeW[p]));
+					const __m128 radius = (IsBox ? _mm_add_ps(_mm_add_ps(_mm_mul_ps(absoluteX[p], extentX), _mm_mul_ps(absoluteY[p], extentY)), _mm_mul_ps(absoluteZ[p], extentZ)) : extentX);
+					inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+				}
+
+				visibility[i / 32] |= static_cast<uint32_t>(_mm_movemask_ps(inside)) << (i % 32);
+			}
+
+			return vectorCount;
+		}
+
+		template <bool IsBox>
+		size_t AVXCull(const array<XMFLOAT4, 6>& planes, const VolumeStreams& volumes, uint32_t* visibility)
+		{
+			__m256 planeX[6], planeY[6], planeZ[6], planeW[6], absoluteX[6], absoluteY[6], absoluteZ[6];
+			const __m256 signMask = _mm256_set1_ps(-0.0f);
+			for (size_t p = 0; p < 6; p++)
+			{
+				planeX[p] = _mm256_set1_ps(planes[p].x);
+				planeY[p] = _mm256_set1_ps(planes[p].y);
+				planeZ[p] = _mm256_set1_ps(planes[p].z);
+				planeW[p] = _mm256_set1_ps(planes[p].w);
+				absoluteX[p] = _mm256_andnot_ps(signMask, planeX[p]);
+				absoluteY[p] = _mm256_andnot_ps(signMask, planeY[p]);
+				absoluteZ[p] = _mm256_andnot_ps(signMask, planeZ[p]);
+			}
+
+			const size_t vectorCount = volumes.Count & ~size_t(7);
+			for (size_t i = 0; i < vectorCount; i += 8)
+			{
+				const __m256 centerX = _mm256_loadu_ps(volumes.CenterX + i);
+				const __m256 centerY = _mm256_loadu_ps(volumes.CenterY + i);
+				const __m256 centerZ = _mm256_loadu_ps(volumes.CenterZ + i);
+				const __m256 extentX = _mm256_loadu_ps(volumes.ExtentX + i);
+				const __m256 extentY = (IsBox ? _mm256_loadu_ps(volumes.ExtentY + i) : extentX);
+				const __m256 extentZ = (IsBox ? _mm256_loadu_ps(volumes.ExtentZ + i) : extentX);
+
+				__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+				for (size_t p = 0; p < 6; p++)
+				{
+					const __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(planeX[p], centerX), _mm256_mul_ps(planeY[p], centerY)), _mm256_add_ps(_mm256_mul_ps(planeZ[p], centerZ), planeW[p]));
+					const __m256 radius = (IsBox ? _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(absoluteX[p], extentX), _mm256_mul_ps(absoluteY[p], extentY)), _mm256_mul_ps(absoluteZ[p], extentZ)) : extentX);
+					inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), _mm256_setzero_ps(), _CMP_GE_OQ));
+				}
+
+				visibility[i / 32] |= static_cast<uint32_t>(_mm256_movemask_ps(inside)) << (i % 32);
+			}
+
+			_mm256_zeroupper();
+			return vectorCount;
+		}
+
+		template <bool IsBox>
+		void CullVolumes(const array<XMFLOAT4, 6>& planes, const VolumeStreams& volumes, const span<uint32_t>& visibility)
+		{
+			const size_t wordCount = Frustum::VisibilityWordCount(volumes.Count);
+			if (static_cast<size_t>(visibility.size()) < wordCount)
+			{
+				throw GameException("Visibility mask is smaller than the volume count.");
+			}
+
+			uint32_t* words = visibility.data();
+			fill(words, words + wordCount, 0U);
+			const size_t first = (CpuFeatures::HasAVX() ? AVXCull<IsBox>(planes, volumes, words) : SSECull<IsBox>(planes, volumes, words));
+			for (size_t i = first; i < volumes.Count; i++)
+			{
+				if (IntersectsScalar<IsBox>(planes, volumes, i))
+				{
+					words[i / 32] |= 1U << (i % 32);
+				}
+			}
+		}
+	}
+
+#pragma region BoundingSphereArrays
+	size_t BoundingSphereArrays::Size() const
+	{
+		return Radius.size();
+	}
+
+	void BoundingSphereArrays::Clear()
+	{
+		CenterX.clear();
+		CenterY.clear();
+		CenterZ.clear();
+		Radius.clear();
+	}
+
+	void BoundingSphereArrays::Reserve(size_t capacity)
+	{
+		CenterX.reserve(capacity);
+		CenterY.reserve(capacity);
+		CenterZ.reserve(capacity);
+		Radius.reserve(capacity);
+	}
+
+	void BoundingSphereArrays::Add(const BoundingSphere& sphere)
+	{
+		CenterX.push_back(sphere.Center.x);
+		CenterY.push_back(sphere.Center.y);
+		CenterZ.push_back(sphere.Center.z);
+		Radius.push_back(sphere.Radius);
+	}
+#pragma endregion
+
+#pragma region BoundingBoxArrays
+	size_t BoundingBoxArrays::Size() const
+	{
+		return ExtentX.size();
+	}
+
+	void BoundingBoxArrays::Clear()
+	{
+		CenterX.clear();
+		CenterY.clear();
+		CenterZ.clear();
+		ExtentX.clear();
+		ExtentY.clear();
+		ExtentZ.clear();
+	}
+
+	void BoundingBoxArrays::Reserve(size_t capacity)
+	{
+		CenterX.reserve(capacity);
+		CenterY.reserve(capacity);
+		CenterZ.reserve(capacity);
+		ExtentX.reserve(capacity);
+		ExtentY.reserve(capacity);
+		ExtentZ.reserve(capacity);
+	}
+
+	void BoundingBoxArrays::Add(const BoundingBox& box)
+	{
+		CenterX.push_back(box.Center.x);
+		CenterY.push_back(box.Center.y);
+		CenterZ.push_back(box.Center.z);
+		ExtentX.push_back(box.Extents.x);
+		ExtentY.push_back(box.Extents.y);
+		ExtentZ.push_back(box.Extents.z);
+	}
+#pragma endregion
+
+#pragma region Frustum
+	Frustum::Frustum()
+	{
+		// Planes of zero pass every test, so a default frustum culls nothing.
+		mPlanes.fill(XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f));
+	}
+
+	Frustum::Frustum(CXMMATRIX viewProjectionMatrix)
+	{
+		// Clip space is -w <= x, y <= w and 0 <= z <= w; each plane is a sum or difference of matrix columns.
+		const XMMATRIX columns = XMMatrixTranspose(viewProjectionMatrix);
+		const XMVECTOR planes[PlaneCount] =
+		{
+			columns.r[2],
+			columns.r[3] - columns.r[2],
+			columns.r[3] + columns.r[0],
+			columns.r[3] - columns.r[0],
+			columns.r[3] - columns.r[1],
+			columns.r[3] + columns.r[1]
+		};
+
+		for (size_t i = 0; i < PlaneCount; i++)
+		{
+			XMStoreFloat4(&mPlanes[i], XMPlaneNormalize(planes[i]));
+		}
+	}
+
+	const array<XMFLOAT4, 6>& Frustum::Planes() const
+	{
+		return mPlanes;
+	}
+
+	const XMFLOAT4& Frustum::Plane(FrustumPlane plane) const
+	{
+		return mPlanes[static_cast<size_t>(plane)];
+	}
+
+	bool Frustum::Intersects(const BoundingSphere& sphere) const
+	{
+		const VolumeStreams volumes{ &sphere.Center.x, &sphere.Center.y, &sphere.Center.z, &sphere.Radius, nullptr, nullptr, 1 };
+		return IntersectsScalar<false>(mPlanes, volumes, 0);
+	}
+
+	bool Frustum::Intersects(const BoundingBox& box) const
+	{
+		const VolumeStreams volumes{ &box.Center.x, &box.Center.y, &box.Center.z, &box.Extents.x, &box.Extents.y, &box.Extents.z, 1 };
+		return IntersectsScalar<true>(mPlanes, volumes, 0);
+	}
+
+	void Frustum::Cull(const BoundingSphereArrays& spheres, const span<uint32_t>& visibility) const
+	{
+		const VolumeStreams volumes{ spheres.CenterX.data(), spheres.CenterY.data(), spheres.CenterZ.data(), spheres.Radius.data(), nullptr, nullptr, spheres.Size() };
+		CullVolumes<false>(mPlanes, volumes, visibility);
+	}
+
+	void Frustum::Cull(const BoundingBoxArrays& boxes, const span<uint32_t>& visibility) const
+	{
+		const VolumeStreams volumes{ boxes.CenterX.data(), boxes.CenterY.data(), boxes.CenterZ.data(), boxes.ExtentX.data(), boxes.ExtentY.data(), boxes.ExtentZ.data(), boxes.Size() };
+		CullVolumes<true>(mPlanes, volumes, visibility);
+	}
+
+	size_t Frustum::VisibilityWordCount(size_t volumeCount)
+	{
+		return (volumeCount + 31) / 32;
+	}
+
+	bool Frustum::IsVisible(const span<const uint32_t>& visibility, size_t index)
+	{
+		return (visibility[index / 32] & (1U << (index % 32))) != 0;
+	}
+#pragma endregion
+}
\ No newline at end of file
@@ -2,8 +2,10 @@
 #include "Game.h"
 #include "GameException.h"
 #include "DrawableGameComponent.h"
+#include "Camera.h"
 #include "DirectXHelper.h"
 #include "ContentTypeReaderManager.h"
+#include "ShaderPack.h"
 
 using namespace std;
 using namespace gsl;
@@ -29,6 +31,14 @@ namespace Library
 	void Game::Initialize()
 	{
 		ContentTypeReaderManager::Initialize(*this);
+
+		// When the content build produced a shader pack, all shader bytecode is served from that single read.
+		if (filesystem::exists(mContentManager.RootDirectory() + ShaderPack::DefaultAssetName))
+		{
+			auto shaderPack = mContentManager.Load<ShaderPack>(ShaderPack::DefaultAssetName);
+			mServices.AddService(ShaderPack::TypeIdClass(), shaderPack.get());
+		}
+
 		mGameClock.Reset();
 
 		for (auto& component : mComponents)
@@ -57,6 +67,9 @@ namespace Library
 		
 		mComponents.clear();
 		mComponents.shrink_to_fit();
+		mStaticSceneComponentList.clear();
+		mStaticSceneComponents.clear();
+		mStaticSceneDirty = true;
 
 		mDepthStencilView = nullptr;
 		mRenderTargetView = nullptr;
@@ -64,6 +77,7 @@ namespace Library
 		mDirect3DDeviceContext = nullptr;
 		mDirect3DDevice = nullptr;
 
+		mServices.RemoveService(ShaderPack::TypeIdClass());
 		mContentManager.Clear();
 		ContentTypeReaderManager::Shutdown();
 
@@ -85,16 +99,152 @@ namespace Library
 
 	void Game::Draw(const GameTime& gameTime)
 	{
-		for (auto& component : mComponents)
+		CullComponents();
+
+		for (size_t i = 0; i < mComponents.size(); ++i)
 		{
-			DrawableGameComponent* drawableGameComponent = component->As<DrawableGameComponent>();
-			if (drawableGameComponent != nullptr && drawableGameComponent->Visible())
+			DrawableGameComponent* drawableGameComponent = mComponents[i]->As<DrawableGameComponent>();
+			if (drawableGameComponent != nullptr && drawableGameComponent->Visible() && !mComponentCulled[i])
 			{
 				drawableGameComponent->Draw(gameTime);
 			}
 		}
 	}
 
+	void Game::RefitStaticScene()
+	{
+		for (size_t item = 0; item < mStaticSceneComponents.size(); ++item)
+		{
+			BoundingSphere bounds;
+			if (mStaticSceneComponents[item]->GetBounds(bounds))
+			{
+				BoundingBox::CreateFromSphere(mStaticSceneBounds[item], bounds);
+			}
+		}
+
+		mStaticScene.Refit(mStaticSceneBounds);
+	}
+
+	void Game::CullComponents()
+	{
+		// Compared by identity rather than count, so that replacing a component, or removing one and adding
+		// another, also rebuilds the index. The list held from the last build keeps its components alive, so a
+		// new component cannot reuse a removed one's address.
+		if (mStaticSceneDirty || mStaticSceneComponentList != mComponents)
+		{
+			BuildStaticScene();
+		}
+
+		mComponentCulled.assign(mComponents.size(), false);
+		mCullCandidates.clear();
+
+		for (size_t i = 0; i < mComponents.size(); ++i)
+		{
+			DrawableGameComponent* drawableGameComponent = mComponents[i]->As<DrawableGameComponent>();
+			if (drawableGameComponent == nullptr || !drawableGameComponent->Visible())
+			{
+				continue;
+			}
+
+			// Static components stay culled unless a query of the scene index below finds them.
+			if (mComponentInStaticScene[i])
+			{
+				mComponentCulled[i] = true;
+				continue;
+			}
+
+			const Camera* camera = drawableGameComponent->GetCamera().get();
+			BoundingSphere bounds;
+			if (camera != nullptr && drawableGameComponent->GetBounds(bounds))
+			{
+				mCullCandidates.push_back({ camera, i, bounds });
+			}
+		}
+
+		for (const Camera* camera : mStaticSceneCameras)
+		{
+			mStaticSceneVisibleItems.clear();
+			mStaticScene.Query(camera->ViewFrustum(), mStaticSceneVisibleItems);
+			for (const uint32_t item : mStaticSceneVisibleItems)
+			{
+				if (mStaticSceneItemCameras[item] == camera)
+				{
+					mComponentCulled[mStaticSceneComponentIndices[item]] = false;
+				}
+			}
+		}
+
+		// Components sharing a camera are culled in one batch against its cached frustum.
+		stable_sort(mCullCandidates.begin(), mCullCandidates.end(), [](const CullCandidate& lhs, const CullCandidate& rhs)
+		{
+			return lhs.SourceCamera < rhs.SourceCamera;
+		});
+
+		for (auto begin = mCullCandidates.begin(); begin != mCullCandidates.end();)
+		{
+			auto end = find_if(begin, mCullCandidates.end(), [begin](const CullCandidate& candidate) { return candidate.SourceCamera != begin->SourceCamera; });
+
+			mCullBounds.Clear();
+			for (auto candidate = begin; candidate != end; ++candidate)
+			{
+				mCullBounds.Add(candidate->Bounds);
+			}
+
+			mCullVisibility.resize(Frustum::VisibilityWordCount(mCullBounds.Size()));
+			begin->SourceCamera->ViewFrustum().Cull(mCullBounds, mCullVisibility);
+
+			for (size_t i = 0; i < mCullBounds.Size(); ++i)
+			{
+				if (!Frustum::IsVisible(mCullVisibility, i))
+				{
+					mComponentCulled[begin[i].ComponentIndex] = true;
+				}
+			}
+
+			begin = end;
+		}
+	}
+
+	void Game::BuildStaticScene()
+	{
+		mStaticSceneComponents.clear();
+		mStaticSceneComponentIndices.clear();
+		mStaticSceneItemCameras.clear();
+		mStaticSceneBounds.clear();
+		mComponentInStaticScene.assign(mComponents.size(), false);
+
+		for (size_t i = 0; i < mComponents.size(); ++i)
+		{
+			DrawableGameComponent* drawableGameComponent = mComponents[i]->As<DrawableGameComponent>();
+			if (drawableGameComponent == nullptr || !drawableGameComponent->IsStatic())
+			{
+				continue;
+			}
+
+			const Camera* camera = drawableGameComponent->GetCamera().get();
+			BoundingSphere bounds;
+			if (camera != nullptr && drawableGameComponent->GetBounds(bounds))
+			{
+				BoundingBox box;
+				BoundingBox::CreateFromSphere(box, bounds);
+				mStaticSceneComponents.push_back(drawableGameComponent);
+				mStaticSceneComponentIndices.push_back(i);
+				mStaticSceneItemCameras.push_back(camera);
+				mStaticSceneBounds.push_back(box);
+				mComponentInStaticScene[i] = true;
+			}
+		}
+
+		mStaticScene = SceneBvh(mStaticSceneBounds);
+
+		mStaticSceneCameras = mStaticSceneItemCameras;
+		sort(mStaticSceneCameras.begin(), mStaticSceneCameras.end());
+		mStaticSceneCameras.erase(unique(mStaticSceneCameras.begin(), mStaticSceneCameras.end()), mStaticSceneCameras.end());
+
+		mStaticSceneComponentList = mComponents;
+		mStaticSceneDirty = false;
+	}
+
 	void Game::UpdateRenderTargetSize()
 	{
 		CreateWindowSizeDependentResources();
@@ -153,6 +303,10 @@ namespace Library
 			throw GameException("Unsupported multi-sampling quality");
 		}
 
+		D3D11_FEATURE_DATA_D3D11_OPTIONS options{ 0 };
+		ThrowIfFailed(mDirect3DDevice->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options)), "CheckFeatureSupport() failed.");
+		mConstantBufferPartialUpdatesSupported = (options.ConstantBufferPartialUpdate != FALSE);
+
 #ifndef NDEBUG
 		com_ptr<ID3D11Debug> d3dDebug = mDirect3DDevice.as<ID3D11Debug>();
 		if (d3dDebug)
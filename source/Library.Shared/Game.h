@@ -22,10 +22,14 @@
 #include "ServiceContainer.h"
 #include "RenderTarget.h"
 #include "ContentManager.h"
+#include "Frustum.h"
+#include "SceneBvh.h"
 
 namespace Library
 {
 	class GameComponent;
+	class DrawableGameComponent;
+	class Camera;
 
 	class IDeviceNotify
 	{
@@ -63,10 +67,21 @@ namespace Library
 		const D3D11_VIEWPORT& Viewport() const;
 		std::uint32_t MultiSamplingCount() const;
 		std::uint32_t MultiSamplingQualityLevels() const;
+		bool ConstantBufferPartialUpdatesSupported() const;
 
 		const std::vector<std::shared_ptr<GameComponent>>& Components() const;
 		const ServiceContainer& Services() const;			
 
+		// Index over the bounds of static drawable components (see DrawableGameComponent::SetStatic), as of the
+		// last draw. It is rebuilt when drawing after any change to the component list or after InvalidateStaticScene;
+		// its items map to components through StaticSceneComponent.
+		const SceneBvh& StaticScene() const;
+		DrawableGameComponent* StaticSceneComponent(std::uint32_t item) const;
+		void InvalidateStaticScene();
+
+		// Refits the index to the current bounds of static components that have moved slightly.
+		void RefitStaticScene();
+
         virtual void Initialize();
 		virtual void Run();
 		virtual void Shutdown();  
@@ -91,6 +106,10 @@ namespace Library
 		virtual void CreateDeviceResources();
 		virtual void CreateWindowSizeDependentResources();
 
+		// Marks drawable components whose bounds lie outside their camera's frustum; see DrawableGameComponent::GetBounds.
+		void CullComponents();
+		void BuildStaticScene();
+
 		inline static const D3D_FEATURE_LEVEL DefaultFeatureLevel{ D3D_FEATURE_LEVEL_9_1 };
 		inline static const std::uint32_t DefaultFrameRate{ 60 };
 		inline static const std::uint32_t DefaultMultiSamplingCount{ 4 };
@@ -110,6 +129,7 @@ namespace Library
 		bool mIsFullScreen{ false };
 		std::uint32_t mMultiSamplingCount{ DefaultMultiSamplingCount };
 		std::uint32_t mMultiSamplingQualityLevels{ 0 };
+		bool mConstantBufferPartialUpdatesSupported{ false };
 
 		std::function<void*()> mGetWindow;
 		std::function<void(SIZE&)> mGetRenderTargetSize;
@@ -121,6 +141,30 @@ namespace Library
 		std::vector<std::shared_ptr<GameComponent>> mComponents;
 		ServiceContainer mServices;
 		ContentManager mContentManager;
+
+	private:
+		struct CullCandidate final
+		{
+			const Camera* SourceCamera;
+			std::size_t ComponentIndex;
+			DirectX::BoundingSphere Bounds;
+		};
+
+		std::vector<CullCandidate> mCullCandidates;
+		std::vector<std::uint8_t> mComponentCulled;
+		BoundingSphereArrays mCullBounds;
+		std::vector<std::uint32_t> mCullVisibility;
+
+		SceneBvh mStaticScene;
+		std::vector<DrawableGameComponent*> mStaticSceneComponents;
+		std::vector<std::size_t> mStaticSceneComponentIndices;
+		std::vector<const Camera*> mStaticSceneItemCameras;
+		std::vector<const Camera*> mStaticSceneCameras;
+		std::vector<DirectX::BoundingBox> mStaticSceneBounds;
+		std::vector<std::uint32_t> mStaticSceneVisibleItems;
+		std::vector<std::uint8_t> mComponentInStaticScene;
+		std::vector<std::shared_ptr<GameComponent>> mStaticSceneComponentList;
+		bool mStaticSceneDirty{ true };
     };
 }
 
@@ -60,6 +60,11 @@ namespace Library
 		return mMultiSamplingQualityLevels;
 	}
 
+	inline bool Game::ConstantBufferPartialUpdatesSupported() const
+	{
+		return mConstantBufferPartialUpdatesSupported;
+	}
+
 	inline const std::vector<std::shared_ptr<GameComponent>>& Game::Components() const
 	{
 		return mComponents;
@@ -70,6 +75,21 @@ namespace Library
 		return mServices;
 	}
 
+	inline const SceneBvh& Game::StaticScene() const
+	{
+		return mStaticScene;
+	}
+
+	inline DrawableGameComponent* Game::StaticSceneComponent(std::uint32_t item) const
+	{
+		return mStaticSceneComponents.at(item);
+	}
+
+	inline void Game::InvalidateStaticScene()
+	{
+		mStaticSceneDirty = true;
+	}
+
 	inline void Game::RegisterDeviceNotify(IDeviceNotify* deviceNotify)
 	{
 		mDeviceNotify = deviceNotify;
@@ -0,0 +1,510 @@
+#include "pch.h"
+#include "LooseOctree.h"
+#include "Frustum.h"
+#include "GameException.h"
+#include <execution>
+#include <numeric>
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+
+namespace Library
+{
+	namespace
+	{
+		enum class Overlap
+		{
+			None,
+			Partial,
+			Contained
+		};
+
+		float Component(const XMFLOAT3& value, uint32_t axis)
+		{
+			return (axis == 0 ? value.x : axis == 1 ? value.y : value.z);
+		}
+
+		// Squared distance from a point to the nearest point of an axis-aligned box.
+		float DistanceSquared(const XMFLOAT3& point, const XMFLOAT3& center, const XMFLOAT3& extents)
+		{
+			float distance = 0.0f;
+			for (uint32_t axis = 0; axis < 3; axis++)
+			{
+				const float outside = max(fabs(Component(point, axis) - Component(center, axis)) - Component(extents, axis), 0.0f);
+				distance += outside * outside;
+			}
+
+			return distance;
+		}
+	}
+
+	bool LooseOctree::Cell::operator==(const Cell& rhs) const
+	{
+		return Depth == rhs.Depth && Coordinates == rhs.Coordinates;
+	}
+
+	LooseOctree::LooseOctree(const BoundingBox& bounds, uint32_t depth) :
+		mSize(2.0f * max(max(bounds.Extents.x, bounds.Extents.y), bounds.Extents.z)), mDepth(depth)
+	{
+		if (depth > MaxDepth)
+		{
+			throw GameException("Octree depth exceeds the supported maximum.");
+		}
+
+		if (mSize <= 0.0f)
+		{
+			throw GameException("Octree bounds must not be empty.");
+		}
+
+		mMin = XMFLOAT3(bounds.Center.x - 0.5f * mSize, bounds.Center.y - 0.5f * mSize, bounds.Center.z - 0.5f * mSize);
+		AllocateNode({ 0, { 0, 0, 0 } }, InvalidIndex);
+	}
+
+	uint32_t LooseOctree::ObjectCount() const
+	{
+		return narrow_cast<uint32_t>(mObjects.size() - mFreeHandles.size());
+	}
+
+	uint32_t LooseOctree::NodeCount() const
+	{
+		return narrow_cast<uint32_t>(mNodes.size() - mFreeNodes.size());
+	}
+
+	LooseOctree::Handle LooseOctree::Insert(const BoundingSphere& bounds)
+	{
+		Handle handle;
+		if (mFreeHandles.empty())
+		{
+			handle = narrow<Handle>(mObjects.size());
+			mObjects.emplace_back();
+		}
+		else
+		{
+			handle = mFreeHandles.back();
+			mFreeHandles.pop_back();
+		}
+
+		mObjects[handle].Bounds = bounds;
+		Link(handle, Locate(bounds), 0);
+
+		return handle;
+	}
+
+	void LooseOctree::Remove(Handle handle)
+	{
+		if (handle >= mObjects.size() || mObjects[handle].Node == InvalidIndex)
+		{
+			throw GameException("Invalid octree handle.");
+		}
+
+		Unlink(handle, 0);
+		mFreeHandles.push_back(handle);
+	}
+
+	void LooseOctree::Clear()
+	{
+		for (Node& node : mNodes)
+		{
+			node.Objects.clear();
+		}
+
+		mFreeNodes.clear();
+		for (uint32_t nodeIndex = narrow<uint32_t>(mNodes.size()) - 1; nodeIndex > 0; nodeIndex--)
+		{
+			mFreeNodes.push_back(nodeIndex);
+		}
+
+		Node& root = mNodes.front();
+		root.Children.fill(InvalidIndex);
+		root.ChildCount = 0;
+
+		mObjects.clear();
+		mFreeHandles.clear();
+	}
+
+	const BoundingSphere& LooseOctree::Bounds(Handle handle) const
+	{
+		return mObjects.at(handle).Bounds;
+	}
+
+	void LooseOctree::Update(Handle handle, const BoundingSphere& bounds)
+	{
+		if (handle >= mObjects.size() || mObjects[handle].Node == InvalidIndex)
+		{
+			throw GameException("Invalid octree handle.");
+		}
+
+		Object& object = mObjects[handle];
+		object.Bounds = bounds;
+
+		const Cell cell = Locate(bounds);
+		if (!(cell == mNodes[object.Node].NodeCell))
+		{
+			Move(handle, cell);
+		}
+	}
+
+	void LooseOctree::Update(const span<const Handle>& handles, const span<const BoundingSphere>& bounds)
+	{
+		if (handles.size() != bounds.size())
+		{
+			throw GameException("Every updated object requires bounds.");
+		}
+
+		for (const Handle handle : handles)
+		{
+			if (handle >= mObjects.size() || mObjects[handle].Node == InvalidIndex)
+			{
+				throw GameException("Invalid octree handle.");
+			}
+		}
+
+		// Objects that stay in their cells are marked with an invalid depth.
+		const uint32_t count = narrow<uint32_t>(handles.size());
+		mUpdateCells.resize(count);
+		mUpdateIndices.resize(count);
+		iota(mUpdateIndices.begin(), mUpdateIndices.end(), 0U);
+		for_each(execution::par, mUpdateIndices.begin(), mUpdateIndices.end(), [&](uint32_t i)
+		{
+			Object& object = mObjects[handles[i]];
+			object.Bounds = bounds[i];
+
+			const Cell cell = Locate(object.Bounds);
+			mUpdateCells[i] = (cell == mNodes[object.Node].NodeCell ? Cell{ InvalidIndex, { 0, 0, 0 } } : cell);
+		});
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			if (mUpdateCells[i].Depth != InvalidIndex)
+			{
+				Move(handles[i], mUpdateCells[i]);
+			}
+		}
+	}
+
+	void LooseOctree::Query(const Frustum& frustum, vector<Handle>& handles) const
+	{
+		const array<XMFLOAT4, 6>& planes = frustum.Planes();
+
+		// Planes whose bit is clear in the mask are known to have the node entirely on their inner side.
+		const auto nodeTest = [&planes](const Node& node, uint32_t& planeMask)
+		{
+			const float extent = 2.0f * node.HalfSize;
+			for (uint32_t plane = 0; plane < Frustum::PlaneCount; plane++)
+			{
+				const uint32_t planeBit = 1U << plane;
+				if ((planeMask & planeBit) != 0)
+				{
+					const XMFLOAT4& p = planes[plane];
+					const float distance = p.x * node.Center.x + p.y * node.Center.y + p.z * node.Center.z + p.w;
+					const float radius = (fabs(p.x) + fabs(p.y) + fabs(p.z)) * extent;
+					if (distance + radius < 0.0f)
+					{
+						return Overlap::None;
+					}
+
+					if (distance - radius >= 0.0f)
+					{
+						planeMask &= ~planeBit;
+					}
+				}
+			}
+
+			return (planeMask == 0 ? Overlap::Contained : Overlap::Partial);
+		};
+
+		const auto objectTest = [&planes](const BoundingSphere& bounds, uint32_t planeMask)
+		{
+			for (uint32_t plane = 0; plane < Frustum::PlaneCount; plane++)
+			{
+				const XMFLOAT4& p = planes[plane];
+				if ((planeMask & (1U << plane)) != 0 && p.x * bounds.Center.x + p.y * bounds.Center.y + p.z * bounds.Center.z + p.w < -bounds.Radius)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		};
+
+		Traverse(handles, (1U << Frustum::PlaneCount) - 1, nodeTest, objectTest);
+	}
+
+	void LooseOctree::Query(const BoundingSphere& sphere, vector<Handle>& handles) const
+	{
+		const float radiusSquared = sphere.Radius * sphere.Radius;
+		const auto nodeTest = [&](const Node& node, uint32_t&)
+		{
+			const float extent = 2.0f * node.HalfSize;
+			if (DistanceSquared(sphere.Center, node.Center, XMFLOAT3(extent, extent, extent)) > radiusSquared)
+			{
+				return Overlap::None;
+			}
+
+			// The farthest corner of the node's bounds.
+			float farthest = 0.0f;
+			for (uint32_t axis = 0; axis < 3; axis++)
+			{
+				const float distance = fabs(Component(sphere.Center, axis) - Component(node.Center, axis)) + extent;
+				farthest += distance * distance;
+			}
+
+			return (farthest <= radiusSquared ? Overlap::Contained : Overlap::Partial);
+		};
+
+		const auto objectTest = [&](const BoundingSphere& bounds, uint32_t)
+		{
+			const XMFLOAT3 offset(bounds.Center.x - sphere.Center.x, bounds.Center.y - sphere.Center.y, bounds.Center.z - sphere.Center.z);
+			const float radius = bounds.Radius + sphere.Radius;
+			return offset.x * offset.x + offset.y * offset.y + offset.z * offset.z <= radius * radius;
+		};
+
+		Traverse(handles, 0, nodeTest, objectTest);
+	}
+
+	void LooseOctree::Query(const BoundingBox& box, vector<Handle>& handles) const
+	{
+		const auto nodeTest = [&](const Node& node, uint32_t&)
+		{
+			const float extent = 2.0f * node.HalfSize;
+			bool contained = true;
+			for (uint32_t axis = 0; axis < 3; axis++)
+			{
+				const float distance = fabs(Component(node.Center, axis) - Component(box.Center, axis));
+				if (distance > extent + Component(box.Extents, axis))
+				{
+					return Overlap::None;
+				}
+
+				contained = contained && (distance + extent <= Component(box.Extents, axis));
+			}
+
+			return (contained ? Overlap::Contained : Overlap::Partial);
+		};
+
+		const auto objectTest = [&](const BoundingSphere& bounds, uint32_t)
+		{
+			return DistanceSquared(bounds.Center, box.Center, box.Extents) <= bounds.Radius * bounds.Radius;
+		};
+
+		Traverse(handles, 0, nodeTest, objectTest);
+	}
+
+	LooseOctree::Cell LooseOctree::Locate(const BoundingSphere& bounds) const
+	{
+		const XMFLOAT3 relative((bounds.Center.x - mMin.x) / mSize, (bounds.Center.y - mMin.y) / mSize, (bounds.Center.z - mMin.z) / mSize);
+		const bool inside = (relative.x >= 0.0f && relative.x < 1.0f && relative.y >= 0.0f && relative.y < 1.0f && relative.z >= 0.0f && relative.z < 1.0f);
+		if (!inside || bounds.Radius > 0.5f * mSize)
+		{
+			return { 0, { 0, 0, 0 } };
+		}
+
+		// The deepest level whose margin (half the cell size) covers the radius.
+		uint32_t depth = mDepth;
+		if (bounds.Radius * static_cast<float>(2U << mDepth) > mSize)
+		{
+			depth = min(mDepth, static_cast<uint32_t>(ilogb(mSize / (2.0f * bounds.Radius))));
+		}
+
+		const uint32_t cellCount = 1U << depth;
+		const auto coordinate = [cellCount](float value)
+		{
+			return min(cellCount - 1, static_cast<uint32_t>(value * cellCount));
+		};
+
+		return { depth, { coordinate(relative.x), coordinate(relative.y), coordinate(relative.z) } };
+	}
+
+	void LooseOctree::Move(Handle handle, const Cell& cell)
+	{
+		// Objects usually move to a nearby cell; only the nodes below the deepest common ancestor of the two
+		// cells are released or created.
+		const Cell& currentCell = mNodes[mObjects[handle].Node].NodeCell;
+		uint32_t depth = min(currentCell.Depth, cell.Depth);
+		const auto sharesAncestor = [&](uint32_t ancestorDepth)
+		{
+			for (uint32_t axis = 0; axis < 3; axis++)
+			{
+				if ((currentCell.Coordinates[axis] >> (currentCell.Depth - ancestorDepth)) != (cell.Coordinates[axis] >> (cell.Depth - ancestorDepth)))
+				{
+					return false;
+				}
+			}
+
+			return true;
+		};
+
+		while (depth > 0 && !sharesAncestor(depth))
+		{
+			--depth;
+		}
+
+		const uint32_t ancestor = Unlink(handle, depth);
+		Link(handle, cell, ancestor);
+	}
+
+	void LooseOctree::Link(Handle handle, const Cell& cell, uint32_t ancestor)
+	{
+		// Each level's coordinates are the cell's coordinates shifted by the remaining depth.
+		uint32_t nodeIndex = ancestor;
+		for (uint32_t level = mNodes[ancestor].NodeCell.Depth + 1; level <= cell.Depth; level++)
+		{
+			const uint32_t shift = cell.Depth - level;
+			const Cell childCell{ level, { cell.Coordinates[0] >> shift, cell.Coordinates[1] >> shift, cell.Coordinates[2] >> shift } };
+			const uint32_t child = (childCell.Coordinates[0] & 1) | ((childCell.Coordinates[1] & 1) << 1) | ((childCell.Coordinates[2] & 1) << 2);
+
+			uint32_t childIndex = mNodes[nodeIndex].Children[child];
+			if (childIndex == InvalidIndex)
+			{
+				childIndex = AllocateNode(childCell, nodeIndex);
+				Node& node = mNodes[nodeIndex];
+				node.Children[child] = childIndex;
+				++node.ChildCount;
+			}
+
+			nodeIndex = childIndex;
+		}
+
+		Node& node = mNodes[nodeIndex];
+		Object& object = mObjects[handle];
+		object.Node = nodeIndex;
+		object.Slot = narrow_cast<uint32_t>(node.Objects.size());
+		node.Objects.push_back(handle);
+	}
+
+	uint32_t LooseOctree::Unlink(Handle handle, uint32_t ancestorDepth)
+	{
+		Object& object = mObjects[handle];
+		uint32_t nodeIndex = object.Node;
+		Node& node = mNodes[nodeIndex];
+
+		const Handle last = node.Objects.back();
+		node.Objects[object.Slot] = last;
+		mObjects[last].Slot = object.Slot;
+		node.Objects.pop_back();
+		object.Node = InvalidIndex;
+
+		// Empty nodes without children are released, up to the ancestor at the given depth, which is returned.
+		while (mNodes[nodeIndex].NodeCell.Depth > ancestorDepth)
+		{
+			const uint32_t parent = mNodes[nodeIndex].Parent;
+			if (mNodes[nodeIndex].Objects.empty() && mNodes[nodeIndex].ChildCount == 0)
+			{
+				ReleaseNode(nodeIndex);
+			}
+
+			nodeIndex = parent;
+		}
+
+		return nodeIndex;
+	}
+
+	uint32_t LooseOctree::AllocateNode(const Cell& cell, uint32_t parent)
+	{
+		uint32_t nodeIndex;
+		if (mFreeNodes.empty())
+		{
+			nodeIndex = narrow<uint32_t>(mNodes.size());
+			mNodes.emplace_back();
+		}
+		else
+		{
+			nodeIndex = mFreeNodes.back();
+			mFreeNodes.pop_back();
+		}
+
+		const float cellSize = mSize / static_cast<float>(1U << cell.Depth);
+		Node& node = mNodes[nodeIndex];
+		node.NodeCell = cell;
+		node.Center = XMFLOAT3(mMin.x + (cell.Coordinates[0] + 0.5f) * cellSize, mMin.y + (cell.Coordinates[1] + 0.5f) * cellSize, mMin.z + (cell.Coordinates[2] + 0.5f) * cellSize);
+		node.HalfSize = 0.5f * cellSize;
+		node.Parent = parent;
+		node.Children.fill(InvalidIndex);
+		node.ChildCount = 0;
+		node.Objects.clear();
+
+		return nodeIndex;
+	}
+
+	void LooseOctree::ReleaseNode(uint32_t nodeIndex)
+	{
+		const Node& node = mNodes[nodeIndex];
+		const uint32_t child = (node.NodeCell.Coordinates[0] & 1) | ((node.NodeCell.Coordinates[1] & 1) << 1) | ((node.NodeCell.Coordinates[2] & 1) << 2);
+		Node& parent = mNodes[node.Parent];
+		parent.Children[child] = InvalidIndex;
+		--parent.ChildCount;
+
+		mFreeNodes.push_back(nodeIndex);
+	}
+
+	template <typename NodeTest, typename ObjectTest>
+	void LooseOctree::Traverse(vector<Handle>& handles, uint32_t rootState, NodeTest nodeTest, ObjectTest objectTest) const
+	{
+		// The root is always visited, as it also holds the objects outside the octree's bounds. Each node pushes
+		// at most eight children, so the stack holds fewer than eight nodes per level.
+		pair<uint32_t, uint32_t> stack[8 * (MaxDepth + 1)];
+		uint32_t stackSize = 0;
+		stack[stackSize++] = { 0, rootState };
+		while (stackSize > 0)
+		{
+			const auto [nodeIndex, state] = stack[--stackSize];
+			const Node& node = mNodes[nodeIndex];
+			for (const Handle handle : node.Objects)
+			{
+				if (objectTest(mObjects[handle].Bounds, state))
+				{
+					handles.push_back(handle);
+				}
+			}
+
+			if (node.ChildCount == 0)
+			{
+				continue;
+			}
+
+			for (const uint32_t child : node.Children)
+			{
+				if (child == InvalidIndex)
+				{
+					continue;
+				}
+
+				uint32_t childState = state;
+				const Overlap overlap = nodeTest(mNodes[child], childState);
+				if (overlap == Overlap::Contained)
+				{
+					AppendSubtree(child, handles);
+				}
+				else if (overlap == Overlap::Partial)
+				{
+					assert(stackSize < size(stack));
+					stack[stackSize++] = { child, childState };
+				}
+			}
+		}
+	}
+
+	void LooseOctree::AppendSubtree(uint32_t nodeIndex, vector<Handle>& handles) const
+	{
+		uint32_t stack[8 * (MaxDepth + 1)];
+		uint32_t stackSize = 0;
+		stack[stackSize++] = nodeIndex;
+		while (stackSize > 0)
+		{
+			const Node& node = mNodes[stack[--stackSize]];
+			handles.insert(handles.end(), node.Objects.begin(), node.Objects.end());
+			if (node.ChildCount > 0)
+			{
+				for (const uint32_t child : node.Children)
+				{
+					if (child != InvalidIndex)
+					{
+						assert(stackSize < size(stack));
+						stack[stackSize++] = child;
+					}
+				}
+			}
+		}
+	}
+}
\ No newline at end of file
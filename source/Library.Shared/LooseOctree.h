@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include <gsl\gsl>
+
+namespace Library
+{
+	class Frustum;
+
+	// Loose octree over the bounding spheres of moving objects. Each node's bounds are its cell expanded by half
+	// the cell size on every side, so an object is stored at the depth where that margin covers its radius, in
+	// the cell containing its center; both follow directly from the object's bounds, without descending the
+	// tree. Moving an object within its cell only updates its bounds; moving it to another cell takes a bounded
+	// number of steps. Nodes are created on demand, released to a pool when they become empty, and reused.
+	// Objects whose center lies outside the octree's bounds are kept at the root, and are tested by every query.
+	class LooseOctree final
+	{
+	public:
+		using Handle = std::uint32_t;
+
+		// The octree is a cube enclosing the bounds. Its depth sets the size of the smallest cells; each cell
+		// should be large enough to hold several typical objects, as sparse deep levels slow both updates and
+		// queries (SpatialIndexBenchmark measures the effect).
+		explicit LooseOctree(const DirectX::BoundingBox& bounds, std::uint32_t depth = DefaultDepth);
+		LooseOctree(const LooseOctree&) = default;
+		LooseOctree(LooseOctree&&) = default;
+		LooseOctree& operator=(const LooseOctree&) = default;
+		LooseOctree& operator=(LooseOctree&&) = default;
+		~LooseOctree() = default;
+
+		std::uint32_t ObjectCount() const;
+		std::uint32_t NodeCount() const;
+
+		// Handles of removed objects are reused by later insertions.
+		Handle Insert(const DirectX::BoundingSphere& bounds);
+		void Remove(Handle handle);
+		void Clear();
+
+		const DirectX::BoundingSphere& Bounds(Handle handle) const;
+		void Update(Handle handle, const DirectX::BoundingSphere& bounds);
+
+		// Updates many objects at once; their new cells are found in parallel, and only the objects that change
+		// cells are then moved.
+		void Update(const gsl::span<const Handle>& handles, const gsl::span<const DirectX::BoundingSphere>& bounds);
+
+		// The queries append the handles of objects whose bounds are inside or intersect the volume, in no
+		// particular order. Objects in nodes entirely inside the volume are appended without being tested.
+		void Query(const Frustum& frustum, std::vector<Handle>& handles) const;
+		void Query(const DirectX::BoundingSphere& sphere, std::vector<Handle>& handles) const;
+		void Query(const DirectX::BoundingBox& box, std::vector<Handle>& handles) const;
+
+		inline static const std::uint32_t DefaultDepth{ 5 };
+		inline static const std::uint32_t MaxDepth{ 10 };
+
+	private:
+		// Cells are addressed by their depth and integer coordinates at that depth.
+		struct Cell final
+		{
+			std::uint32_t Depth;
+			std::array<std::uint32_t, 3> Coordinates;
+
+			bool operator==(const Cell& rhs) const;
+		};
+
+		struct Node final
+		{
+			Cell NodeCell;
+			DirectX::XMFLOAT3 Center;
+			float HalfSize; // Of the cell; the node's bounds extend twice as far from its center.
+			std::uint32_t Parent;
+			std::array<std::uint32_t, 8> Children;
+			std::uint32_t ChildCount;
+			std::vector<Handle> Objects; // Keeps its capacity while the node is pooled
+		};
+
+		struct Object final
+		{
+			DirectX::BoundingSphere Bounds;
+			std::uint32_t Node; // InvalidIndex for removed objects
+			std::uint32_t Slot; // Index into the node's objects
+		};
+
+		Cell Locate(const DirectX::BoundingSphere& bounds) const;
+		void Move(Handle handle, const Cell& cell);
+		void Link(Handle handle, const Cell& cell, std::uint32_t ancestor);
+		std::uint32_t Unlink(Handle handle, std::uint32_t ancestorDepth);
+		std::uint32_t AllocateNode(const Cell& cell, std::uint32_t parent);
+		void ReleaseNode(std::uint32_t nodeIndex);
+
+		// The tests carry a state from each node to its children and objects (the frustum test's plane mask).
+		template <typename NodeTest, typename ObjectTest>
+		void Traverse(std::vector<Handle>& handles, std::uint32_t rootState, NodeTest nodeTest, ObjectTest objectTest) const;
+		void AppendSubtree(std::uint32_t nodeIndex, std::vector<Handle>& handles) const;
+
+		inline static const std::uint32_t InvalidIndex{ UINT32_MAX };
+
+		DirectX::XMFLOAT3 mMin;
+		float mSize;
+		std::uint32_t mDepth;
+		std::vector<Node> mNodes;
+		std::vector<std::uint32_t> mFreeNodes;
+		std::vector<Object> mObjects;
+		std::vector<Handle> mFreeHandles;
+		std::vector<Cell> mUpdateCells;
+		std::vector<std::uint32_t> mUpdateIndices;
+	};
+}
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include "Game.h"
 #include "VertexShader.h"
 #include "PixelShader.h"
+#include "ShaderPack.h"
+#include "GameException.h"
 
 using namespace std;
 using namespace std::placeholders;
@@ -65,6 +67,47 @@ namespace Library
 		return (shaderStageInfo.first ? shaderStageInfo.second->Shader : nullptr);
 	}
 
+	void Material::LoadShaderVariants(ShaderStages shaderStage, const wstring& assetName, uint32_t featureCount)
+	{
+		assert(ShaderStageIsProgrammable(shaderStage));
+		if (featureCount > ShaderPack::MaxFeatureCount)
+		{
+			throw GameException("Too many shader features.");
+		}
+
+		auto& content = mGame->Content();
+		auto& variants = mShaderVariants[shaderStage];
+		variants.resize(size_t(1) << featureCount);
+		for (uint32_t featureMask = 0; featureMask < variants.size(); ++featureMask)
+		{
+			const wstring variantAssetName = ShaderPack::VariantAssetName(assetName, featureMask);
+			switch (shaderStage)
+			{
+			case ShaderStages::VS:
+				variants[featureMask] = content.Load<VertexShader>(variantAssetName);
+				break;
+
+			case ShaderStages::PS:
+				variants[featureMask] = content.Load<PixelShader>(variantAssetName);
+				break;
+
+			default:
+				throw GameException("Unsupported shader stage.");
+			}
+		}
+
+		SetShader(shaderStage, variants[mFeatureMask & (variants.size() - 1)]);
+	}
+
+	void Material::SetFeatureMask(uint32_t featureMask)
+	{
+		mFeatureMask = featureMask;
+		for (auto& [shaderStage, variants] : mShaderVariants)
+		{
+			mShaderStageData[shaderStage].Shader = variants[featureMask & (variants.size() - 1)];
+		}
+	}
+
 	ID3D11ClassInstance* Material::GetShaderClassInstance(ShaderStages shaderStage)
 	{
 		assert(ShaderStageIsProgrammable(shaderStage));
@@ -41,6 +41,12 @@ namespace Library
 		template <typename T>
 		void SetShader(std::shared_ptr<T> shader);
 
+		// Loads all 2^featureCount permutations of a shader into a flat table indexed by feature mask.
+		// Stages with fewer features ignore the higher bits of the mask.
+		void LoadShaderVariants(ShaderStages shaderStage, const std::wstring& assetName, std::uint32_t featureCount);
+		std::uint32_t FeatureMask() const;
+		void SetFeatureMask(std::uint32_t featureMask);
+
 		ID3D11ClassInstance* GetShaderClassInstance(ShaderStages shaderStage);
 		void SetShaderClassInstance(ShaderStages shaderStage, ID3D11ClassInstance* classInstance);
 
@@ -109,6 +115,8 @@ namespace Library
 		D3D_PRIMITIVE_TOPOLOGY mTopology;
 		winrt::com_ptr<ID3D11InputLayout> mInputLayout;
 		std::map<ShaderStages, ShaderStageData> mShaderStageData;
+		std::map<ShaderStages, std::vector<std::shared_ptr<Shader>>> mShaderVariants;
+		std::uint32_t mFeatureMask{ 0 };
 		std::function<void()> mDrawCallback;
 		std::function<void()> mUpdateMaterialCallback;
 		bool mAutoUnbindShaderResourcesEnabled{ false };
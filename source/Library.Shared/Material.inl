@@ -42,6 +42,11 @@ namespace Library
 		mShaderStageData[shaderStage].Shader = shader;
 	}
 
+	inline std::uint32_t Material::FeatureMask() const
+	{
+		return mFeatureMask;
+	}
+
 	inline void Material::SetShaderClassInstance(ShaderStages shaderStage, ID3D11ClassInstance* classInstance)
 	{
 		assert(ShaderStageIsProgrammable(shaderStage));
@@ -77,6 +77,11 @@ namespace Library
 		return mData.Indices;
 	}
 
+	MeshData& Mesh::Data()
+	{
+		return mData;
+	}
+
 	void Mesh::CreateIndexBuffer(ID3D11Device& device, gsl::not_null<ID3D11Buffer**> indexBuffer)
 	{
 		D3D11_BUFFER_DESC indexBufferDesc{ 0 };
@@ -141,7 +146,7 @@ namespace Library
 		streamHelper << narrow_cast<uint32_t>(mData.VertexColors.size());
 		for (const auto& vertexColorList : mData.VertexColors)
 		{
-			streamHelper << vertexColorList.size();
+			streamHelper << narrow_cast<uint32_t>(vertexColorList.size());
 			for (const XMFLOAT4& vertexColor : vertexColorList)
 			{
 				streamHelper << vertexColor.x << vertexColor.y << vertexColor.z << vertexColor.w;
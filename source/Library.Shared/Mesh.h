@@ -49,6 +49,8 @@ namespace Library
 		std::uint32_t FaceCount() const;
 		const std::vector<std::uint32_t>& Indices() const;
 
+		MeshData& Data();
+
         void CreateIndexBuffer(ID3D11Device& device, gsl::not_null<ID3D11Buffer**> indexBuffer);
 		void Save(OutputStreamHelper& streamHelper) const;
 
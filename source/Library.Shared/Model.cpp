@@ -4,6 +4,9 @@
 #include "StreamHelper.h"
 #include "GameException.h"
 #include "ModelMaterial.h"
+#include "MatrixHelper.h"
+#include <execution>
+#include <numeric>
 
 using namespace std;
 using namespace gsl;
@@ -13,19 +16,20 @@ namespace Library
 {
 	RTTI_DEFINITIONS(Model)
 
-	Model::Model(const string& filename)
+	Model::Model(const string& filename, const SharedModelResolver& sharedModelResolver)
 	{
-		Load(filename);
+		Load(filename, sharedModelResolver);
 	}
 
-	Model::Model(ifstream& file)
+	Model::Model(istream& stream, const SharedModelResolver& sharedModelResolver)
 	{
-		Load(file);
+		Load(stream, sharedModelResolver);
 	}
 
 	Model::Model(ModelData&& modelData) :
 		mData(move(modelData))
 	{
+		UpdateTransforms();
 	}
 
 	bool Model::HasMeshes() const
@@ -48,11 +52,96 @@ namespace Library
 		return mData.Materials;
 	}
 
+	const vector<ModelNode>& Model::Nodes() const
+	{
+		return mData.Nodes;
+	}
+
+	const ModelOccluder& Model::Occluder() const
+	{
+		return mData.Occluder;
+	}
+
+	const ModelLightmap& Model::Lightmap() const
+	{
+		return mData.Lightmap;
+	}
+
+	const vector<XMFLOAT4X4>& Model::NodeWorldTransforms() const
+	{
+		return mNodeWorldTransforms;
+	}
+
+	span<const XMFLOAT4X4> Model::MeshInstanceTransforms(uint32_t meshIndex) const
+	{
+		const uint32_t firstInstance = mMeshInstanceOffsets.at(meshIndex);
+		return span<const XMFLOAT4X4>(mMeshInstanceTransforms).subspan(firstInstance, mMeshInstanceOffsets.at(meshIndex + 1) - firstInstance);
+	}
+
 	ModelData& Model::Data()
 	{
 		return mData;
 	}
 
+	void Model::UpdateTransforms()
+	{
+		const auto& nodes = mData.Nodes;
+		const uint32_t meshCount = narrow<uint32_t>(mData.Meshes.size());
+
+		// Count the instances of each mesh, then convert the counts into offsets into a single transform array.
+		mNodeWorldTransforms.resize(nodes.size());
+		mMeshInstanceOffsets.assign(static_cast<size_t>(meshCount) + 1, 0);
+		for (size_t i = 0; i < nodes.size(); i++)
+		{
+			const ModelNode& node = nodes[i];
+			if (node.Parent < -1 || node.Parent >= static_cast<int32_t>(i))
+			{
+				throw GameException("Invalid model node table.");
+			}
+
+			XMMATRIX worldTransform = XMLoadFloat4x4(&node.Transform);
+			if (node.Parent >= 0)
+			{
+				worldTransform = XMMatrixMultiply(worldTransform, XMLoadFloat4x4(&mNodeWorldTransforms[node.Parent]));
+			}
+
+			XMStoreFloat4x4(&mNodeWorldTransforms[i], worldTransform);
+
+			for (uint32_t meshIndex : node.MeshIndices)
+			{
+				if (meshIndex >= meshCount)
+				{
+					throw GameException("Invalid model node table.");
+				}
+
+				++mMeshInstanceOffsets[meshIndex + 1];
+			}
+		}
+
+		if (nodes.empty())
+		{
+			fill(mMeshInstanceOffsets.begin() + 1, mMeshInstanceOffsets.end(), 1U);
+		}
+
+		partial_sum(mMeshInstanceOffsets.begin(), mMeshInstanceOffsets.end(), mMeshInstanceOffsets.begin());
+		mMeshInstanceTransforms.resize(mMeshInstanceOffsets.back());
+
+		if (nodes.empty())
+		{
+			fill(mMeshInstanceTransforms.begin(), mMeshInstanceTransforms.end(), MatrixHelper::Identity);
+			return;
+		}
+
+		vector<uint32_t> nextInstances(mMeshInstanceOffsets.begin(), mMeshInstanceOffsets.end() - 1);
+		for (size_t i = 0; i < nodes.size(); i++)
+		{
+			for (uint32_t meshIndex : nodes[i].MeshIndices)
+			{
+				mMeshInstanceTransforms[nextInstances[meshIndex]++] = mNodeWorldTransforms[i];
+			}
+		}
+	}
+
 	void Model::Save(const string& filename) const
 	{
 		ofstream file(filename.c_str(), ios::binary);
@@ -67,23 +156,109 @@ namespace Library
 	void Model::Save(ofstream& file) const
 	{
 		OutputStreamHelper streamHelper(file);
+		streamHelper << Magic << Version;
+
+		// Serialize the shared model reference; the meshes and materials it selects are not stored again.
+		const SharedModelReference& sharedModel = mData.SharedModel;
+		const bool hasSharedModel = !sharedModel.AssetName.empty();
+		streamHelper << sharedModel.AssetName;
+		if (hasSharedModel)
+		{
+			streamHelper << narrow_cast<uint32_t>(sharedModel.MaterialIndices.size());
+			for (uint32_t materialIndex : sharedModel.MaterialIndices)
+			{
+				streamHelper << materialIndex;
+			}
+
+			streamHelper << narrow_cast<uint32_t>(sharedModel.MeshIndices.size());
+			for (uint32_t meshIndex : sharedModel.MeshIndices)
+			{
+				streamHelper << meshIndex;
+			}
+		}
 
 		// Serialize materials
-		streamHelper << narrow_cast<uint32_t>(mData.Materials.size());
-		for (const auto& material : mData.Materials)
+		const uint32_t materialCount = (hasSharedModel ? 0 : narrow_cast<uint32_t>(mData.Materials.size()));
+		streamHelper << materialCount;
+		for (uint32_t i = 0; i < materialCount; i++)
+		{
+			mData.Materials[i]->Save(streamHelper);
+		}
+
+		// Serialize nodes
+		streamHelper << narrow_cast<uint32_t>(mData.Nodes.size());
+		for (const auto& node : mData.Nodes)
+		{
+			streamHelper << node.Name << node.Parent << node.Transform;
+			streamHelper << narrow_cast<uint32_t>(node.MeshIndices.size());
+			for (uint32_t meshIndex : node.MeshIndices)
+			{
+				streamHelper << meshIndex;
+			}
+		}
+
+		// Serialize the occluder
+		const ModelOccluder& occluder = mData.Occluder;
+		streamHelper << narrow_cast<uint32_t>(occluder.Vertices.size());
+		for (const XMFLOAT3& vertex : occluder.Vertices)
+		{
+			streamHelper << vertex.x << vertex.y << vertex.z;
+		}
+
+		streamHelper << narrow_cast<uint32_t>(occluder.Indices.size());
+		for (uint32_t index : occluder.Indices)
+		{
+			streamHelper << index;
+		}
+
+		streamHelper << mData.Lightmap.Width << mData.Lightmap.Height;
+
+		// Serialize meshes into separate buffers, so that their byte ranges are known before they are written.
+		const size_t meshCount = (hasSharedModel ? 0 : mData.Meshes.size());
+		vector<uint32_t> meshIndices(meshCount);
+		iota(meshIndices.begin(), meshIndices.end(), 0U);
+		vector<string> meshBuffers(meshCount);
+		vector<exception_ptr> errors(meshCount);
+		for_each(execution::par, meshIndices.begin(), meshIndices.end(), [&](uint32_t i)
 		{
-			material->Save(streamHelper);
+			try
+			{
+				ostringstream meshStream(ios::binary);
+				OutputStreamHelper meshStreamHelper(meshStream);
+				mData.Meshes[i]->Save(meshStreamHelper);
+				meshBuffers[i] = meshStream.str();
+			}
+			catch (...)
+			{
+				errors[i] = current_exception();
+			}
+		});
+
+		for (const auto& error : errors)
+		{
+			if (error != nullptr)
+			{
+				rethrow_exception(error);
+			}
 		}
 
-		// Serialize meshes
-		streamHelper << narrow_cast<uint32_t>(mData.Meshes.size());
-		for (auto& mesh : mData.Meshes)
+		// Mesh table: offset (relative to the first mesh) and size of each mesh
+		streamHelper << narrow_cast<uint32_t>(meshBuffers.size());
+		uint64_t offset = 0;
+		for (const auto& meshBuffer : meshBuffers)
 		{
-			mesh->Save(streamHelper);
+			const uint64_t size = meshBuffer.size();
+			streamHelper << offset << size;
+			offset += size;
+		}
+
+		for (const auto& meshBuffer : meshBuffers)
+		{
+			file.write(meshBuffer.data(), meshBuffer.size());
 		}
 	}
 
-	void Model::Load(const string& filename)
+	void Model::Load(const string& filename, const SharedModelResolver& sharedModelResolver)
 	{
 		ifstream file(filename.c_str(), ios::binary);
 		if (!file.good())
@@ -91,29 +266,238 @@ namespace Library
 			throw GameException("Could not open file.");
 		}
 
-		Load(file);
+		Load(file, sharedModelResolver);
 	}
 
-	void Model::Load(ifstream& file)
+	void Model::Load(istream& stream, const SharedModelResolver& sharedModelResolver)
 	{
-		InputStreamHelper streamHelper(file);
+		InputStreamHelper streamHelper(stream);
+
+		uint32_t magic;
+		streamHelper >> magic;
+		if (magic != Magic)
+		{
+			// Files without a header start with the material count, and their meshes follow each other without a table.
+			LoadMaterials(streamHelper, magic);
+
+			uint32_t meshCount;
+			streamHelper >> meshCount;
+			mData.Meshes.reserve(meshCount);
+			for (uint32_t i = 0; i < meshCount; i++)
+			{
+				mData.Meshes.emplace_back(make_shared<Mesh>(*this, streamHelper));
+			}
+
+			UpdateTransforms();
+			return;
+		}
+
+		uint32_t version;
+		streamHelper >> version;
+		if (version == 0 || version > Version)
+		{
+			throw GameException("Unsupported model version.");
+		}
+
+		if (version >= 3)
+		{
+			SharedModelReference& sharedModel = mData.SharedModel;
+			streamHelper >> sharedModel.AssetName;
+			if (!sharedModel.AssetName.empty())
+			{
+				uint32_t materialIndexCount;
+				streamHelper >> materialIndexCount;
+				sharedModel.MaterialIndices.resize(materialIndexCount);
+				for (auto& materialIndex : sharedModel.MaterialIndices)
+				{
+					streamHelper >> materialIndex;
+				}
+
+				uint32_t meshIndexCount;
+				streamHelper >> meshIndexCount;
+				sharedModel.MeshIndices.resize(meshIndexCount);
+				for (auto& meshIndex : sharedModel.MeshIndices)
+				{
+					streamHelper >> meshIndex;
+				}
+			}
+		}
 
-		// Desrialize materials
 		uint32_t materialCount;
 		streamHelper >> materialCount;
+		LoadMaterials(streamHelper, materialCount);
+
+		if (version >= 2)
+		{
+			LoadNodes(streamHelper);
+		}
+
+		if (version >= 4)
+		{
+			LoadOccluder(streamHelper);
+		}
+
+		if (version >= 5)
+		{
+			streamHelper >> mData.Lightmap.Width >> mData.Lightmap.Height;
+		}
+
+		uint32_t meshCount;
+		streamHelper >> meshCount;
+		LoadMeshes(streamHelper, meshCount);
+
+		if (!mData.SharedModel.AssetName.empty())
+		{
+			ResolveSharedModel(sharedModelResolver);
+		}
+
+		UpdateTransforms();
+	}
+
+	void Model::LoadMaterials(InputStreamHelper& streamHelper, uint32_t materialCount)
+	{
 		mData.Materials.reserve(materialCount);
 		for (uint32_t i = 0; i < materialCount; i++)
 		{
 			mData.Materials.emplace_back(make_shared<ModelMaterial>(*this, streamHelper));
 		}
+	}
 
-		// Desrialize meshes
-		uint32_t meshCount;
-		streamHelper >> meshCount;
-		mData.Meshes.reserve(meshCount);
-		for (uint32_t i = 0; i < meshCount; i++)
+	void Model::LoadNodes(InputStreamHelper& streamHelper)
+	{
+		uint32_t nodeCount;
+		streamHelper >> nodeCount;
+		mData.Nodes.resize(nodeCount);
+		for (auto& node : mData.Nodes)
+		{
+			streamHelper >> node.Name >> node.Parent >> node.Transform;
+
+			uint32_t meshIndexCount;
+			streamHelper >> meshIndexCount;
+			node.MeshIndices.resize(meshIndexCount);
+			for (auto& meshIndex : node.MeshIndices)
+			{
+				streamHelper >> meshIndex;
+			}
+		}
+	}
+
+	void Model::LoadOccluder(InputStreamHelper& streamHelper)
+	{
+		ModelOccluder& occluder = mData.Occluder;
+		uint32_t vertexCount;
+		streamHelper >> vertexCount;
+		occluder.Vertices.resize(vertexCount);
+		for (auto& vertex : occluder.Vertices)
+		{
+			streamHelper >> vertex.x >> vertex.y >> vertex.z;
+		}
+
+		uint32_t indexCount;
+		streamHelper >> indexCount;
+		occluder.Indices.resize(indexCount);
+		for (auto& index : occluder.Indices)
 		{
-			mData.Meshes.emplace_back(make_shared<Mesh>(*this, streamHelper));
+			streamHelper >> index;
+			if (index >= vertexCount)
+			{
+				throw GameException("Invalid model occluder index.");
+			}
 		}
 	}
+
+	void Model::ResolveSharedModel(const SharedModelResolver& sharedModelResolver)
+	{
+		if (sharedModelResolver == nullptr)
+		{
+			throw GameException("Model references a shared model, but no resolver was given.");
+		}
+
+		if (!mData.Materials.empty() || !mData.Meshes.empty())
+		{
+			throw GameException("Models referencing a shared model cannot store their own meshes or materials.");
+		}
+
+		mSharedModel = sharedModelResolver(mData.SharedModel.AssetName);
+		if (mSharedModel == nullptr)
+		{
+			throw GameException("Shared model could not be resolved.");
+		}
+
+		const auto& sharedMaterials = mSharedModel->Materials();
+		mData.Materials.reserve(mData.SharedModel.MaterialIndices.size());
+		for (uint32_t materialIndex : mData.SharedModel.MaterialIndices)
+		{
+			mData.Materials.push_back(sharedMaterials.at(materialIndex));
+		}
+
+		const auto& sharedMeshes = mSharedModel->Meshes();
+		mData.Meshes.reserve(mData.SharedModel.MeshIndices.size());
+		for (uint32_t meshIndex : mData.SharedModel.MeshIndices)
+		{
+			mData.Meshes.push_back(sharedMeshes.at(meshIndex));
+		}
+	}
+
+	void Model::LoadMeshes(InputStreamHelper& streamHelper, uint32_t meshCount)
+	{
+		struct MeshRange final
+		{
+			uint64_t Offset;
+			uint64_t Size;
+		};
+
+		vector<MeshRange> meshRanges(meshCount);
+		uint64_t meshDataSize = 0;
+		for (auto& meshRange : meshRanges)
+		{
+			streamHelper >> meshRange.Offset >> meshRange.Size;
+			if (meshRange.Offset + meshRange.Size < meshRange.Offset)
+			{
+				throw GameException("Invalid model mesh table.");
+			}
+
+			meshDataSize = max(meshDataSize, meshRange.Offset + meshRange.Size);
+		}
+
+		// The mesh data is read with a single call; each mesh is then decoded from its own view of the buffer.
+		vector<char> meshData(narrow<size_t>(meshDataSize));
+		istream& stream = streamHelper.Stream();
+		stream.read(meshData.data(), meshData.size());
+		if (static_cast<uint64_t>(stream.gcount()) != meshDataSize)
+		{
+			throw GameException("Unexpected end of model file.");
+		}
+
+		// Meshes only read the (already loaded) materials of the model, so they can be decoded concurrently.
+		// Exceptions must not escape the parallel algorithm; the first one is rethrown afterwards.
+		vector<uint32_t> meshIndices(meshCount);
+		iota(meshIndices.begin(), meshIndices.end(), 0U);
+		vector<shared_ptr<Mesh>> meshes(meshCount);
+		vector<exception_ptr> errors(meshCount);
+		for_each(execution::par, meshIndices.begin(), meshIndices.end(), [&](uint32_t i)
+		{
+			try
+			{
+				MemoryStreamBuffer meshStreamBuffer(span<const char>(meshData.data() + meshRanges[i].Offset, narrow<size_t>(meshRanges[i].Size)));
+				istream meshStream(&meshStreamBuffer);
+				InputStreamHelper meshStreamHelper(meshStream);
+				meshes[i] = make_shared<Mesh>(*this, meshStreamHelper);
+			}
+			catch (...)
+			{
+				errors[i] = current_exception();
+			}
+		});
+
+		for (const auto& error : errors)
+		{
+			if (error != nullptr)
+			{
+				rethrow_exception(error);
+			}
+		}
+
+		mData.Meshes = move(meshes);
+	}
 }
\ No newline at end of file
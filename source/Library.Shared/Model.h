@@ -1,9 +1,13 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include <map>
 #include <string>
 #include <fstream>
+#include <functional>
+#include <DirectXMath.h>
+#include <gsl\gsl>
 #include "RTTI.h"
 
 namespace Library
@@ -14,10 +18,48 @@ namespace Library
 	class OutputStreamHelper;
 	class InputStreamHelper;
 
+	// Parents precede their children in the node table, so world transforms can be computed in a single pass.
+	struct ModelNode final
+	{
+		std::string Name;
+		std::int32_t Parent{ -1 };
+		DirectX::XMFLOAT4X4 Transform;
+		std::vector<std::uint32_t> MeshIndices;
+	};
+
+	// Content builds that deduplicate across models store each unique mesh and material once, in a shared model.
+	// The indices select this model's meshes and materials, in order, from the shared model.
+	struct SharedModelReference final
+	{
+		std::string AssetName;
+		std::vector<std::uint32_t> MaterialIndices;
+		std::vector<std::uint32_t> MeshIndices;
+	};
+
+	// Simplified triangle list lying inside the model's surface, in model space, for software occlusion culling
+	// (see OcclusionCuller). Empty unless the content pipeline generated one.
+	struct ModelOccluder final
+	{
+		std::vector<DirectX::XMFLOAT3> Vertices;
+		std::vector<std::uint32_t> Indices;
+	};
+
+	// Size, in texels, of the lightmap atlas that texture coordinate channel 1 was packed for; bakes at another
+	// size change the padding between charts. Zero unless the content pipeline generated lightmap coordinates.
+	struct ModelLightmap final
+	{
+		std::uint32_t Width{ 0 };
+		std::uint32_t Height{ 0 };
+	};
+
 	struct ModelData final
 	{
 		std::vector<std::shared_ptr<Mesh>> Meshes;
 		std::vector<std::shared_ptr<ModelMaterial>> Materials;
+		std::vector<ModelNode> Nodes;
+		SharedModelReference SharedModel;
+		ModelOccluder Occluder;
+		ModelLightmap Lightmap;
 	};
 
     class Model final : public RTTI
@@ -25,9 +67,12 @@ namespace Library
 		RTTI_DECLARATIONS(Model, RTTI)
 
     public:
+		// Loads the shared model referenced by a model; required to load models that reference one.
+		using SharedModelResolver = std::function<std::shared_ptr<Model>(const std::string& assetName)>;
+
 		Model() = default;
-		Model(const std::string& filename);
-		Model(std::ifstream& file);
+		Model(const std::string& filename, const SharedModelResolver& sharedModelResolver = nullptr);
+		Model(std::istream& stream, const SharedModelResolver& sharedModelResolver = nullptr);
 		Model(ModelData&& modelData);
 		Model(const Model&) = default;
 		Model(Model&&) = default;
@@ -40,16 +85,45 @@ namespace Library
 
         const std::vector<std::shared_ptr<Mesh>>& Meshes() const;
 		const std::vector<std::shared_ptr<ModelMaterial>>& Materials() const;
+		const std::vector<ModelNode>& Nodes() const;
+		const ModelOccluder& Occluder() const;
+		const ModelLightmap& Lightmap() const;
+
+		// World transforms of the nodes, in node table order.
+		const std::vector<DirectX::XMFLOAT4X4>& NodeWorldTransforms() const;
+
+		// World transforms of every node that references the mesh, for instanced drawing. A model without nodes
+		// draws each mesh once, with an identity transform.
+		gsl::span<const DirectX::XMFLOAT4X4> MeshInstanceTransforms(std::uint32_t meshIndex) const;
 
 		ModelData& Data();
 
+		// Recomputes the world and instance transforms; call after modifying the nodes through Data().
+		void UpdateTransforms();
+
 		void Save(const std::string& filename) const;
 		void Save(std::ofstream& file) const;
 
+		// Models are saved with a table of per-mesh byte ranges so that meshes can be decoded concurrently.
+		// Files without the header (written before the table was introduced) are still read sequentially.
+		// Version 2 adds the node table; version 3 adds the shared model reference; version 4 adds the occluder;
+		// version 5 adds the lightmap size.
+		inline static const std::uint32_t Magic{ 0x4C444F4D }; // "MODL"
+		inline static const std::uint32_t Version{ 5 };
+
     private:
-		void Load(const std::string& filename);
-		void Load(std::ifstream& file);
+		void Load(const std::string& filename, const SharedModelResolver& sharedModelResolver);
+		void Load(std::istream& stream, const SharedModelResolver& sharedModelResolver);
+		void LoadMaterials(InputStreamHelper& streamHelper, std::uint32_t materialCount);
+		void LoadMeshes(InputStreamHelper& streamHelper, std::uint32_t meshCount);
+		void LoadNodes(InputStreamHelper& streamHelper);
+		void LoadOccluder(InputStreamHelper& streamHelper);
+		void ResolveSharedModel(const SharedModelResolver& sharedModelResolver);
 
 		ModelData mData;
+		std::shared_ptr<Model> mSharedModel;
+		std::vector<DirectX::XMFLOAT4X4> mNodeWorldTransforms;
+		std::vector<std::uint32_t> mMeshInstanceOffsets;
+		std::vector<DirectX::XMFLOAT4X4> mMeshInstanceTransforms;
     };
 }
\ No newline at end of file
@@ -1,8 +1,11 @@
 #include "pch.h"
 #include "ModelReader.h"
+#include "Game.h"
+#include "StreamHelper.h"
 #include "Utility.h"
 
 using namespace std;
+using namespace gsl;
 
 namespace Library
 {
@@ -15,6 +18,16 @@ namespace Library
 
 	shared_ptr<Model> ModelReader::_Read(const wstring& assetName)
 	{
-		return make_shared<Model>(Utility::ToString(assetName));
+		const vector<char> data = mGame->Content().ReadFile(assetName);
+		MemoryStreamBuffer streamBuffer{ span<const char>(data) };
+		istream stream(&streamBuffer);
+
+		// Shared models are loaded through the content manager, so every model referencing one shares a single copy.
+		const Model::SharedModelResolver sharedModelResolver = [this](const string& sharedAssetName)
+		{
+			return mGame->Content().Load<Model>(Utility::ToWideString(sharedAssetName));
+		};
+
+		return make_shared<Model>(stream, sharedModelResolver);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,438 @@
+#include "pch.h"
+#include "OcclusionCuller.h"
+#include "Camera.h"
+#include "Model.h"
+#include "GameException.h"
+#include "CpuFeatures.h"
+#include <immintrin.h>
+#include <execution>
+#include <numeric>
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+
+namespace Library
+{
+	namespace
+	{
+		// A span of rows within a tile; minX and maxX are multiples of eight.
+		struct PixelSpan final
+		{
+			float* Depth;
+			uint32_t Stride;
+			int32_t MinX;
+			int32_t MaxX;
+			int32_t MinY;
+			int32_t MaxY;
+		};
+
+		// The kernels evaluate the edge functions and the depth plane at the pixel centers of each group of lanes,
+		// and keep the nearer depth where all three edges are non-negative.
+		template <typename Triangle>
+		void SSERasterize(const Triangle& triangle, const PixelSpan& pixels)
+		{
+			const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+			const __m128 zero = _mm_setzero_ps();
+			const __m128 edgeA0 = _mm_set1_ps(triangle.EdgeA[0]);
+			const __m128 edgeA1 = _mm_set1_ps(triangle.EdgeA[1]);
+			const __m128 edgeA2 = _mm_set1_ps(triangle.EdgeA[2]);
+			const __m128 depthA = _mm_set1_ps(triangle.DepthA);
+			const __m128 maxDepth = _mm_set1_ps(triangle.MaxDepth);
+
+			for (int32_t y = pixels.MinY; y < pixels.MaxY; y++)
+			{
+				const float centerY = y + 0.5f;
+				const __m128 rowEdge0 = _mm_set1_ps(triangle.EdgeB[0] * centerY + triangle.EdgeC[0]);
+				const __m128 rowEdge1 = _mm_set1_ps(triangle.EdgeB[1] * centerY + triangle.EdgeC[1]);
+				const __m128 rowEdge2 = _mm_set1_ps(triangle.EdgeB[2] * centerY + triangle.EdgeC[2]);
+				const __m128 rowDepth = _mm_set1_ps(triangle.DepthB * centerY + triangle.DepthC);
+				float* row = pixels.Depth + static_cast<size_t>(y) * pixels.Stride;
+
+				for (int32_t x = pixels.MinX; x < pixels.MaxX; x += 4)
+				{
+					const __m128 centerX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffsets);
+					const __m128 edge0 = _mm_add_ps(_mm_mul_ps(edgeA0, centerX), rowEdge0);
+					const __m128 edge1 = _mm_add_ps(_mm_mul_ps(edgeA1, centerX), rowEdge1);
+					const __m128 edge2 = _mm_add_ps(_mm_mul_ps(edgeA2, centerX), rowEdge2);
+					const __m128 covered = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edge0, zero), _mm_cmpge_ps(edge1, zero)), _mm_cmpge_ps(edge2, zero));
+					if (_mm_movemask_ps(covered) == 0)
+					{
+						continue;
+					}
+
+					const __m128 depth = _mm_min_ps(_mm_add_ps(_mm_mul_ps(depthA, centerX), rowDepth), maxDepth);
+					const __m128 current = _mm_loadu_ps(row + x);
+					const __m128 nearer = _mm_min_ps(current, depth);
+					_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(covered, nearer), _mm_andnot_ps(covered, current)));
+				}
+			}
+		}
+
+		template <typename Triangle>
+		void AVXRasterize(const Triangle& triangle, const PixelSpan& pixels)
+		{
+			const __m256 laneOffsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+			const __m256 zero = _mm256_setzero_ps();
+			const __m256 edgeA0 = _mm256_set1_ps(triangle.EdgeA[0]);
+			const __m256 edgeA1 = _mm256_set1_ps(triangle.EdgeA[1]);
+			const __m256 edgeA2 = _mm256_set1_ps(triangle.EdgeA[2]);
+			const __m256 depthA = _mm256_set1_ps(triangle.DepthA);
+			const __m256 maxDepth = _mm256_set1_ps(triangle.MaxDepth);
+
+			for (int32_t y = pixels.MinY; y < pixels.MaxY; y++)
+			{
+				const float centerY = y + 0.5f;
+				const __m256 rowEdge0 = _mm256_set1_ps(triangle.EdgeB[0] * centerY + triangle.EdgeC[0]);
+				const __m256 rowEdge1 = _mm256_set1_ps(triangle.EdgeB[1] * centerY + triangle.EdgeC[1]);
+				const __m256 rowEdge2 = _mm256_set1_ps(triangle.EdgeB[2] * centerY + triangle.EdgeC[2]);
+				const __m256 rowDepth = _mm256_set1_ps(triangle.DepthB * centerY + triangle.DepthC);
+				float* row = pixels.Depth + static_cast<size_t>(y) * pixels.Stride;
+
+				for (int32_t x = pixels.MinX; x < pixels.MaxX; x += 8)
+				{
+					const __m256 centerX = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), laneOffsets);
+					const __m256 edge0 = _mm256_add_ps(_mm256_mul_ps(edgeA0, centerX), rowEdge0);
+					const __m256 edge1 = _mm256_add_ps(_mm256_mul_ps(edgeA1, centerX), rowEdge1);
+					const __m256 edge2 = _mm256_add_ps(_mm256_mul_ps(edgeA2, centerX), rowEdge2);
+					const __m256 covered = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(edge0, zero, _CMP_GE_OQ), _mm256_cmp_ps(edge1, zero, _CMP_GE_OQ)), _mm256_cmp_ps(edge2, zero, _CMP_GE_OQ));
+					if (_mm256_movemask_ps(covered) == 0)
+					{
+						continue;
+					}
+
+					const __m256 depth = _mm256_min_ps(_mm256_add_ps(_mm256_mul_ps(depthA, centerX), rowDepth), maxDepth);
+					const __m256 current = _mm256_loadu_ps(row + x);
+					_mm256_storeu_ps(row + x, _mm256_blendv_ps(current, _mm256_min_ps(current, depth), covered));
+				}
+			}
+
+			_mm256_zeroupper();
+		}
+	}
+
+	OcclusionCuller::OcclusionCuller(uint32_t width, uint32_t height) :
+		mWidth(width), mHeight(height), mTileCountX(width / TileWidth), mTileCountY(height / TileHeight)
+	{
+		if (width == 0 || height == 0 || width % TileWidth != 0 || height % TileHeight != 0)
+		{
+			throw GameException("Occlusion buffer dimensions must be non-zero multiples of the tile dimensions.");
+		}
+
+		const uint32_t tileCount = mTileCountX * mTileCountY;
+		mDepth.resize(static_cast<size_t>(width) * height, 1.0f);
+		mTileMaxDepth.resize(tileCount, 1.0f);
+		mTileTriangles.resize(tileCount);
+		mTileIndices.resize(tileCount);
+		iota(mTileIndices.begin(), mTileIndices.end(), 0U);
+		XMStoreFloat4x4(&mViewProjectionMatrix, XMMatrixIdentity());
+	}
+
+	uint32_t OcclusionCuller::Width() const
+	{
+		return mWidth;
+	}
+
+	uint32_t OcclusionCuller::Height() const
+	{
+		return mHeight;
+	}
+
+	void OcclusionCuller::Begin(const Camera& camera)
+	{
+		Begin(camera.ViewProjectionMatrix());
+	}
+
+	void OcclusionCuller::Begin(CXMMATRIX viewProjectionMatrix)
+	{
+		XMStoreFloat4x4(&mViewProjectionMatrix, viewProjectionMatrix);
+		fill(mDepth.begin(), mDepth.end(), 1.0f);
+		fill(mTileMaxDepth.begin(), mTileMaxDepth.end(), 1.0f);
+		mTriangles.clear();
+		for (auto& tileTriangles : mTileTriangles)
+		{
+			tileTriangles.clear();
+		}
+
+		mStatistics = OcclusionStatistics();
+	}
+
+	void OcclusionCuller::AddOccluder(const span<const XMFLOAT3>& vertices, const span<const uint32_t>& indices, CXMMATRIX worldMatrix)
+	{
+		const XMMATRIX transform = XMMatrixMultiply(worldMatrix, XMLoadFloat4x4(&mViewProjectionMatrix));
+		const size_t vertexCount = static_cast<size_t>(vertices.size());
+		const XMFLOAT3* vertexData = vertices.data();
+		mClipVertices.resize(vertexCount);
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			XMStoreFloat4(&mClipVertices[i], XMVector3Transform(XMLoadFloat3(&vertexData[i]), transform));
+		}
+
+		const float width = static_cast<float>(mWidth);
+		const float height = static_cast<float>(mHeight);
+		const size_t indexCount = static_cast<size_t>(indices.size());
+		const uint32_t* indexData = indices.data();
+		for (size_t i = 0; i + 2 < indexCount; i += 3)
+		{
+			++mStatistics.OccluderTriangleCount;
+
+			array<XMFLOAT3, 3> screen;
+			bool clipped = false;
+			for (size_t corner = 0; corner < 3; corner++)
+			{
+				const uint32_t index = indexData[i + corner];
+				if (index >= vertexCount)
+				{
+					throw GameException("Occluder index is out of range.");
+				}
+
+				// Triangles crossing the near plane would need clipping; skipping them only makes the buffer more
+				// conservative.
+				const XMFLOAT4& clip = mClipVertices[index];
+				if (clip.w <= 0.0f || clip.z < 0.0f)
+				{
+					clipped = true;
+					break;
+				}
+
+				const float inverseW = 1.0f / clip.w;
+				screen[corner] = XMFLOAT3((clip.x * inverseW * 0.5f + 0.5f) * width, (0.5f - clip.y * inverseW * 0.5f) * height, clip.z * inverseW);
+			}
+
+			if (clipped)
+			{
+				continue;
+			}
+
+			const XMFLOAT3& p0 = screen[0];
+			const XMFLOAT3& p1 = screen[1];
+			const XMFLOAT3& p2 = screen[2];
+			const float area = (p1.x - p0.x) * (p2.y - p0.y) - (p2.x - p0.x) * (p1.y - p0.y);
+			if (area == 0.0f)
+			{
+				continue;
+			}
+
+			ScreenTriangle triangle;
+			triangle.MinX = static_cast<int32_t>(floor(max(min({ p0.x, p1.x, p2.x }), 0.0f)));
+			triangle.MinY = static_cast<int32_t>(floor(max(min({ p0.y, p1.y, p2.y }), 0.0f)));
+			triangle.MaxX = static_cast<int32_t>(ceil(min(max({ p0.x, p1.x, p2.x }), width)));
+			triangle.MaxY = static_cast<int32_t>(ceil(min(max({ p0.y, p1.y, p2.y }), height)));
+			if (triangle.MinX >= triangle.MaxX || triangle.MinY >= triangle.MaxY)
+			{
+				continue;
+			}
+
+			// Each edge function is positive on the side of the opposite vertex, whichever the winding. Moving it
+			// inward by its largest change from a pixel's center to a corner (plus a margin for rounding) leaves
+			// it non-negative only at the centers of pixels entirely inside the edge.
+			const float orientation = (area > 0.0f ? 1.0f : -1.0f);
+			for (size_t edge = 0; edge < 3; edge++)
+			{
+				const XMFLOAT3& from = screen[edge];
+				const XMFLOAT3& to = screen[(edge + 1) % 3];
+				const float a = -(to.y - from.y) * orientation;
+				const float b = (to.x - from.x) * orientation;
+				triangle.EdgeA[edge] = a;
+				triangle.EdgeB[edge] = b;
+				triangle.EdgeC[edge] = -(a * from.x + b * from.y) - (fabs(a) + fabs(b)) * CoverageMargin;
+			}
+
+			// Depth is linear in screen space after the perspective divide.
+			triangle.DepthA = ((p1.z - p0.z) * (p2.y - p0.y) - (p2.z - p0.z) * (p1.y - p0.y)) / area;
+			triangle.DepthB = ((p2.z - p0.z) * (p1.x - p0.x) - (p1.z - p0.z) * (p2.x - p0.x)) / area;
+			triangle.DepthC = p0.z - triangle.DepthA * p0.x - triangle.DepthB * p0.y + (fabs(triangle.DepthA) + fabs(triangle.DepthB)) * 0.5f;
+			triangle.MaxDepth = max({ p0.z, p1.z, p2.z });
+
+			mTriangles.push_back(triangle);
+			++mStatistics.RasterizedTriangleCount;
+		}
+	}
+
+	void OcclusionCuller::AddOccluder(const ModelOccluder& occluder, CXMMATRIX worldMatrix)
+	{
+		AddOccluder(occluder.Vertices, occluder.Indices, worldMatrix);
+	}
+
+	void OcclusionCuller::Rasterize()
+	{
+		for (uint32_t triangleIndex = 0; triangleIndex < mTriangles.size(); ++triangleIndex)
+		{
+			const ScreenTriangle& triangle = mTriangles[triangleIndex];
+			const uint32_t firstTileX = static_cast<uint32_t>(triangle.MinX) / TileWidth;
+			const uint32_t lastTileX = static_cast<uint32_t>(triangle.MaxX - 1) / TileWidth;
+			const uint32_t firstTileY = static_cast<uint32_t>(triangle.MinY) / TileHeight;
+			const uint32_t lastTileY = static_cast<uint32_t>(triangle.MaxY - 1) / TileHeight;
+			for (uint32_t tileY = firstTileY; tileY <= lastTileY; ++tileY)
+			{
+				for (uint32_t tileX = firstTileX; tileX <= lastTileX; ++tileX)
+				{
+					mTileTriangles[tileY * mTileCountX + tileX].push_back(triangleIndex);
+					++mStatistics.BinnedTriangleCount;
+				}
+			}
+		}
+
+		for_each(execution::par, mTileIndices.begin(), mTileIndices.end(), [&](uint32_t tile)
+		{
+			RasterizeTile(tile);
+		});
+	}
+
+	bool OcclusionCuller::IsVisible(const BoundingBox& box) const
+	{
+		const XMMATRIX viewProjectionMatrix = XMLoadFloat4x4(&mViewProjectionMatrix);
+		array<XMFLOAT3, BoundingBox::CORNER_COUNT> corners;
+		box.GetCorners(corners.data());
+
+		const float width = static_cast<float>(mWidth);
+		const float height = static_cast<float>(mHeight);
+		float minX = numeric_limits<float>::max();
+		float minY = numeric_limits<float>::max();
+		float maxX = numeric_limits<float>::lowest();
+		float maxY = numeric_limits<float>::lowest();
+		float minDepth = numeric_limits<float>::max();
+		for (const XMFLOAT3& corner : corners)
+		{
+			XMFLOAT4 clip;
+			XMStoreFloat4(&clip, XMVector3Transform(XMLoadFloat3(&corner), viewProjectionMatrix));
+			if (clip.w <= 0.0f || clip.z < 0.0f)
+			{
+				return true;
+			}
+
+			const float inverseW = 1.0f / clip.w;
+			const float x = (clip.x * inverseW * 0.5f + 0.5f) * width;
+			const float y = (0.5f - clip.y * inverseW * 0.5f) * height;
+			minX = min(minX, x);
+			minY = min(minY, y);
+			maxX = max(maxX, x);
+			maxY = max(maxY, y);
+			minDepth = min(minDepth, clip.z * inverseW);
+		}
+
+		const int32_t firstX = static_cast<int32_t>(floor(max(minX, 0.0f)));
+		const int32_t firstY = static_cast<int32_t>(floor(max(minY, 0.0f)));
+		const int32_t lastX = static_cast<int32_t>(ceil(min(maxX, width)));
+		const int32_t lastY = static_cast<int32_t>(ceil(min(maxY, height)));
+		if (firstX >= lastX || firstY >= lastY)
+		{
+			return true;
+		}
+
+		// The box is occluded only if every pixel it overlaps is nearer than its nearest corner.
+		for (int32_t tileY = firstY / static_cast<int32_t>(TileHeight); tileY <= (lastY - 1) / static_cast<int32_t>(TileHeight); ++tileY)
+		{
+			for (int32_t tileX = firstX / static_cast<int32_t>(TileWidth); tileX <= (lastX - 1) / static_cast<int32_t>(TileWidth); ++tileX)
+			{
+				if (mTileMaxDepth[tileY * mTileCountX + tileX] < minDepth)
+				{
+					continue;
+				}
+
+				const int32_t rowBegin = max(firstY, tileY * static_cast<int32_t>(TileHeight));
+				const int32_t rowEnd = min(lastY, (tileY + 1) * static_cast<int32_t>(TileHeight));
+				const int32_t columnBegin = max(firstX, tileX * static_cast<int32_t>(TileWidth));
+				const int32_t columnEnd = min(lastX, (tileX + 1) * static_cast<int32_t>(TileWidth));
+				for (int32_t y = rowBegin; y < rowEnd; ++y)
+				{
+					const float* row = mDepth.data() + static_cast<size_t>(y) * mWidth;
+					for (int32_t x = columnBegin; x < columnEnd; ++x)
+					{
+						if (row[x] >= minDepth)
+						{
+							return true;
+						}
+					}
+				}
+			}
+		}
+
+		return false;
+	}
+
+	void OcclusionCuller::Test(const BoundingBoxArrays& boxes, const span<uint32_t>& visibility) const
+	{
+		const size_t boxCount = boxes.Size();
+		const size_t wordCount = Frustum::VisibilityWordCount(boxCount);
+		if (static_cast<size_t>(visibility.size()) < wordCount)
+		{
+			throw GameException("Visibility mask is smaller than the box count.");
+		}
+
+		vector<size_t> words(wordCount);
+		iota(words.begin(), words.end(), size_t(0));
+		uint32_t* visibilityData = visibility.data();
+		for_each(execution::par, words.begin(), words.end(), [&](size_t word)
+		{
+			uint32_t bits = 0;
+			const size_t end = min(boxCount, (word + 1) * 32);
+			for (size_t i = word * 32; i < end; ++i)
+			{
+				const BoundingBox box(XMFLOAT3(boxes.CenterX[i], boxes.CenterY[i], boxes.CenterZ[i]), XMFLOAT3(boxes.ExtentX[i], boxes.ExtentY[i], boxes.ExtentZ[i]));
+				if (IsVisible(box))
+				{
+					bits |= 1U << (i % 32);
+				}
+			}
+
+			visibilityData[word] = bits;
+		});
+	}
+
+	const vector<float>& OcclusionCuller::Depth() const
+	{
+		return mDepth;
+	}
+
+	const OcclusionStatistics& OcclusionCuller::Statistics() const
+	{
+		return mStatistics;
+	}
+
+	void OcclusionCuller::RasterizeTile(uint32_t tile)
+	{
+		const int32_t tileMinX = static_cast<int32_t>((tile % mTileCountX) * TileWidth);
+		const int32_t tileMinY = static_cast<int32_t>((tile / mTileCountX) * TileHeight);
+		const int32_t tileMaxX = tileMinX + static_cast<int32_t>(TileWidth);
+		const int32_t tileMaxY = tileMinY + static_cast<int32_t>(TileHeight);
+		const bool avxSupported = CpuFeatures::HasAVX();
+
+		for (uint32_t triangleIndex : mTileTriangles[tile])
+		{
+			// Spans are widened to whole groups of eight pixels, which the tile width is a multiple of; the
+			// extra pixels fail the edge tests.
+			const ScreenTriangle& triangle = mTriangles[triangleIndex];
+			const PixelSpan pixels
+			{
+				mDepth.data(),
+				mWidth,
+				max(tileMinX, triangle.MinX & ~7),
+				min(tileMaxX, (triangle.MaxX + 7) & ~7),
+				max(tileMinY, triangle.MinY),
+				min(tileMaxY, triangle.MaxY)
+			};
+
+			if (avxSupported)
+			{
+				AVXRasterize(triangle, pixels);
+			}
+			else
+			{
+				SSERasterize(triangle, pixels);
+			}
+		}
+
+		float maxDepth = 0.0f;
+		for (int32_t y = tileMinY; y < tileMaxY; ++y)
+		{
+			const float* row = mDepth.data() + static_cast<size_t>(y) * mWidth;
+			for (int32_t x = tileMinX; x < tileMaxX; ++x)
+			{
+				maxDepth = max(maxDepth, row[x]);
+			}
+		}
+
+		mTileMaxDepth[tile] = maxDepth;
+	}
+}
\ No newline at end of file
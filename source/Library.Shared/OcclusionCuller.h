@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include <gsl\gsl>
+#include "Frustum.h"
+
+namespace Library
+{
+	class Camera;
+	struct ModelOccluder;
+
+	struct OcclusionStatistics final
+	{
+		std::uint32_t OccluderTriangleCount{ 0 };
+		std::uint32_t RasterizedTriangleCount{ 0 }; // Excludes triangles crossing the near plane, off screen or too small to cover a pixel
+		std::uint32_t BinnedTriangleCount{ 0 }; // Triangles times the tiles each overlaps
+	};
+
+	// Software occlusion culling against a low-resolution depth buffer, without a graphics device. Occluders,
+	// usually simplified meshes, are rasterized conservatively: a pixel is written only where a triangle covers it
+	// entirely, with the triangle's farthest depth within the pixel, so the buffer never hides more than the
+	// occluders do. Objects are then tested by the nearest depth of their bounding box against the pixels its
+	// projection overlaps, skipping tiles whose farthest depth is already nearer.
+	//
+	// The buffer is divided into tiles; triangles are binned to the tiles they overlap, and the tiles are
+	// rasterized in parallel, eight pixels at a time with AVX where the CPU supports it and four at a time with SSE
+	// otherwise. Depth is post-projection z, increasing away from the camera.
+	class OcclusionCuller final
+	{
+	public:
+		explicit OcclusionCuller(std::uint32_t width = DefaultWidth, std::uint32_t height = DefaultHeight);
+		OcclusionCuller(const OcclusionCuller&) = default;
+		OcclusionCuller(OcclusionCuller&&) = default;
+		OcclusionCuller& operator=(const OcclusionCuller&) = default;
+		OcclusionCuller& operator=(OcclusionCuller&&) = default;
+		~OcclusionCuller() = default;
+
+		std::uint32_t Width() const;
+		std::uint32_t Height() const;
+
+		// Clears the buffer and the occluders, and sets the view-projection matrix for the frame. The projection
+		// must map the near plane to a depth of zero, as the camera projections do.
+		void Begin(const Camera& camera);
+		void Begin(DirectX::CXMMATRIX viewProjectionMatrix);
+
+		// Adds an occluder's triangle list, transformed by its world matrix. Both sides of each triangle occlude;
+		// triangles crossing the near plane are skipped.
+		void AddOccluder(const gsl::span<const DirectX::XMFLOAT3>& vertices, const gsl::span<const std::uint32_t>& indices, DirectX::CXMMATRIX worldMatrix);
+		void AddOccluder(const ModelOccluder& occluder, DirectX::CXMMATRIX worldMatrix);
+
+		// Rasterizes the occluders added since Begin.
+		void Rasterize();
+
+		// Boxes crossing the near plane or outside the screen are reported visible.
+		bool IsVisible(const DirectX::BoundingBox& box) const;
+
+		// Sets bit (i % 32) of visibility[i / 32] for each box i that is not occluded, as Frustum::Cull does; boxes
+		// are tested in parallel.
+		void Test(const BoundingBoxArrays& boxes, const gsl::span<std::uint32_t>& visibility) const;
+
+		// Row-major depth, for inspection; cleared to one.
+		const std::vector<float>& Depth() const;
+		const OcclusionStatistics& Statistics() const;
+
+		inline static const std::uint32_t DefaultWidth{ 256 };
+		inline static const std::uint32_t DefaultHeight{ 128 };
+		inline static const std::uint32_t TileWidth{ 32 };
+		inline static const std::uint32_t TileHeight{ 16 };
+
+	private:
+		// In pixel coordinates, sampled at pixel centers.
+		struct ScreenTriangle final
+		{
+			// Edge functions, offset so that they are non-negative only at the centers of pixels the triangle
+			// covers entirely.
+			std::array<float, 3> EdgeA;
+			std::array<float, 3> EdgeB;
+			std::array<float, 3> EdgeC;
+
+			// Depth plane, offset to the farthest depth within a pixel, and capped at the farthest vertex depth.
+			float DepthA;
+			float DepthB;
+			float DepthC;
+			float MaxDepth;
+
+			// Pixel bounds; the maximums are exclusive.
+			std::int32_t MinX;
+			std::int32_t MinY;
+			std::int32_t MaxX;
+			std::int32_t MaxY;
+		};
+
+		void RasterizeTile(std::uint32_t tile);
+
+		// Half a pixel, in units of an edge function's gradient, and a little more to absorb rounding.
+		inline static const float CoverageMargin{ 0.5f + 1.0f / 512.0f };
+
+		std::uint32_t mWidth;
+		std::uint32_t mHeight;
+		std::uint32_t mTileCountX;
+		std::uint32_t mTileCountY;
+		DirectX::XMFLOAT4X4 mViewProjectionMatrix;
+		std::vector<float> mDepth;
+		std::vector<float> mTileMaxDepth;
+		std::vector<ScreenTriangle> mTriangles;
+		std::vector<std::vector<std::uint32_t>> mTileTriangles;
+		std::vector<std::uint32_t> mTileIndices;
+		std::vector<DirectX::XMFLOAT4> mClipVertices;
+		OcclusionStatistics mStatistics;
+	};
+}
\ No newline at end of file
@@ -47,6 +47,8 @@ namespace Library
 		{
 			XMMATRIX projectionMatrix = XMMatrixOrthographicRH(mViewWidth, mViewHeight, mNearPlaneDistance, mFarPlaneDistance);
 			XMStoreFloat4x4(&mProjectionMatrix, projectionMatrix);
+			mProjectionMatrixDataDirty = false;
+			mFrustumDataDirty = true;
 
 			for (auto& callback : mProjectionMatrixUpdatedCallbacks)
 			{
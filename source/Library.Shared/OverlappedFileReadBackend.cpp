@@ -0,0 +1,160 @@
+#include "pch.h"
+#include "OverlappedFileReadBackend.h"
+#include "GameException.h"
+
+using namespace std;
+using namespace gsl;
+using namespace winrt;
+
+namespace Library
+{
+	OverlappedFileReadBackend::OverlappedFileReadBackend(uint32_t queueDepth, uint32_t chunkSize) :
+		mQueueDepth(max(queueDepth, 1U)), mChunkSize(max(chunkSize, 4096U))
+	{
+		mCompletionPort.attach(CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1));
+		if (!mCompletionPort)
+		{
+			throw GameException("CreateIoCompletionPort() failed.", HRESULT_FROM_WIN32(GetLastError()));
+		}
+
+		mCompletionThread = thread(&OverlappedFileReadBackend::CompletionThread, this);
+	}
+
+	OverlappedFileReadBackend::~OverlappedFileReadBackend()
+	{
+		// Reads still in flight write into caller memory and reference this object; let them finish first.
+		{
+			unique_lock<mutex> lock(mMutex);
+			mCondition.wait(lock, [this] { return mPendingChunkCount == 0; });
+		}
+
+		PostQueuedCompletionStatus(mCompletionPort.get(), 0, ShutdownKey, nullptr);
+		mCompletionThread.join();
+	}
+
+	uint32_t OverlappedFileReadBackend::QueueDepth() const
+	{
+		return mQueueDepth;
+	}
+
+	uint32_t OverlappedFileReadBackend::ChunkSize() const
+	{
+		return mChunkSize;
+	}
+
+	future<void> OverlappedFileReadBackend::ReadAsync(const wstring& filename, const span<const FileReadRange>& ranges, shared_ptr<const void> destinationOwner)
+	{
+		auto operation = make_shared<Operation>();
+		operation->DestinationOwner = move(destinationOwner);
+		future<void> completion = operation->Promise.get_future();
+
+		operation->File.attach(CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+		if (!operation->File)
+		{
+			throw GameException("Could not open file.", HRESULT_FROM_WIN32(GetLastError()));
+		}
+
+		if (CreateIoCompletionPort(operation->File.get(), mCompletionPort.get(), 0, 0) == nullptr)
+		{
+			throw GameException("CreateIoCompletionPort() failed.", HRESULT_FROM_WIN32(GetLastError()));
+		}
+
+		for (const FileReadRange& range : ranges)
+		{
+			const uint64_t rangeSize = static_cast<uint64_t>(range.Destination.size());
+			for (uint64_t position = 0; position < rangeSize; position += mChunkSize)
+			{
+				{
+					unique_lock<mutex> lock(mMutex);
+					mCondition.wait(lock, [this] { return mPendingChunkCount < mQueueDepth; });
+					++mPendingChunkCount;
+				}
+
+				auto chunkRead = make_unique<ChunkRead>();
+				ZeroMemory(&chunkRead->Overlapped, sizeof(OVERLAPPED));
+				const uint64_t offset = range.Offset + position;
+				chunkRead->Overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
+				chunkRead->Overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+				chunkRead->Owner = operation;
+				chunkRead->ByteCount = narrow_cast<uint32_t>(min<uint64_t>(mChunkSize, rangeSize - position));
+				++operation->PendingChunkCount;
+
+				if (::ReadFile(operation->File.get(), range.Destination.data() + position, chunkRead->ByteCount, nullptr, &chunkRead->Overlapped) == FALSE && GetLastError() != ERROR_IO_PENDING)
+				{
+					// No completion packet is queued for a read that failed to start.
+					CompleteChunk(*chunkRead, false);
+					continue;
+				}
+
+				// Owned by the completion thread from here on.
+				chunkRead.release();
+			}
+		}
+
+		ReleaseOperation(*operation);
+
+		return completion;
+	}
+
+	void OverlappedFileReadBackend::CompletionThread()
+	{
+		OVERLAPPED_ENTRY entries[CompletionBatchSize];
+		bool shutdown = false;
+		while (shutdown == false)
+		{
+			ULONG entryCount;
+			if (GetQueuedCompletionStatusEx(mCompletionPort.get(), entries, CompletionBatchSize, &entryCount, INFINITE, FALSE) == FALSE)
+			{
+				continue;
+			}
+
+			for (ULONG i = 0; i < entryCount; ++i)
+			{
+				const OVERLAPPED_ENTRY& entry = entries[i];
+				if (entry.lpCompletionKey == ShutdownKey)
+				{
+					shutdown = true;
+					continue;
+				}
+
+				unique_ptr<ChunkRead> chunkRead(CONTAINING_RECORD(entry.lpOverlapped, ChunkRead, Overlapped));
+				// Internal holds the NTSTATUS of the read; success codes are non-negative.
+				const bool succeeded = (static_cast<LONG>(entry.Internal) >= 0 && entry.dwNumberOfBytesTransferred == chunkRead->ByteCount);
+				CompleteChunk(*chunkRead, succeeded);
+			}
+		}
+	}
+
+	void OverlappedFileReadBackend::CompleteChunk(ChunkRead& chunkRead, bool succeeded)
+	{
+		if (succeeded == false)
+		{
+			chunkRead.Owner->Failed = true;
+		}
+
+		ReleaseOperation(*chunkRead.Owner);
+
+		// Notified under the lock: once the count reaches zero, the destructor may proceed.
+		lock_guard<mutex> lock(mMutex);
+		--mPendingChunkCount;
+		mCondition.notify_all();
+	}
+
+	void OverlappedFileReadBackend::ReleaseOperation(Operation& operation)
+	{
+		if (--operation.PendingChunkCount == 0)
+		{
+			operation.File.close();
+			if (operation.Failed)
+			{
+				operation.Promise.set_exception(make_exception_ptr(GameException("File read failed or ended early.")));
+			}
+			else
+			{
+				operation.Promise.set_value();
+			}
+
+			operation.DestinationOwner.reset();
+		}
+	}
+}
\ No newline at end of file
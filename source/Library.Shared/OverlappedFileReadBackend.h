@@ -0,0 +1,68 @@
+#pragma once
+
+#include <windows.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <winrt\base.h>
+#include "FileReadBackend.h"
+
+namespace Library
+{
+	// Issues reads as overlapped I/O on an I/O completion port, keeping up to QueueDepth chunk reads in flight
+	// across all files. Ranges are split into chunks so that large files also keep the queue full. A single
+	// thread drains completions in batches and fulfills the futures.
+	class OverlappedFileReadBackend final : public FileReadBackend
+	{
+	public:
+		explicit OverlappedFileReadBackend(std::uint32_t queueDepth = DefaultQueueDepth, std::uint32_t chunkSize = DefaultChunkSize);
+		OverlappedFileReadBackend(const OverlappedFileReadBackend&) = delete;
+		OverlappedFileReadBackend(OverlappedFileReadBackend&&) = delete;
+		OverlappedFileReadBackend& operator=(const OverlappedFileReadBackend&) = delete;
+		OverlappedFileReadBackend& operator=(OverlappedFileReadBackend&&) = delete;
+		~OverlappedFileReadBackend();
+
+		std::uint32_t QueueDepth() const;
+		std::uint32_t ChunkSize() const;
+
+		// Blocks while the queue is full.
+		virtual std::future<void> ReadAsync(const std::wstring& filename, const gsl::span<const FileReadRange>& ranges, std::shared_ptr<const void> destinationOwner = nullptr) override;
+
+		inline static const std::uint32_t DefaultQueueDepth{ 64 };
+		inline static const std::uint32_t DefaultChunkSize{ 1 << 20 };
+
+	private:
+		// One ReadAsync call. The pending count includes one reference held while its chunks are being issued.
+		struct Operation final
+		{
+			winrt::file_handle File;
+			std::shared_ptr<const void> DestinationOwner;
+			std::promise<void> Promise;
+			std::atomic<std::uint32_t> PendingChunkCount{ 1 };
+			std::atomic<bool> Failed{ false };
+		};
+
+		struct ChunkRead final
+		{
+			OVERLAPPED Overlapped;
+			std::shared_ptr<Operation> Owner;
+			std::uint32_t ByteCount;
+		};
+
+		void CompletionThread();
+		void CompleteChunk(ChunkRead& chunkRead, bool succeeded);
+		static void ReleaseOperation(Operation& operation);
+
+		inline static const ULONG_PTR ShutdownKey{ 1 };
+		inline static const ULONG CompletionBatchSize{ 64 };
+
+		std::uint32_t mQueueDepth;
+		std::uint32_t mChunkSize;
+		winrt::handle mCompletionPort;
+		std::mutex mMutex;
+		std::condition_variable mCondition;
+		std::uint32_t mPendingChunkCount{ 0 };
+		std::thread mCompletionThread;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,452 @@
+#include "pch.h"
+#include "PackedVectorHelper.h"
+#include "GameException.h"
+#include "CpuFeatures.h"
+#include <atomic>
+#include <execution>
+#include <immintrin.h>
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+
+namespace Library
+{
+	namespace
+	{
+		ConversionInstructionSet DetectInstructionSet()
+		{
+			if (!CpuFeatures::HasF16C())
+			{
+				return ConversionInstructionSet::Scalar;
+			}
+
+			return (CpuFeatures::HasAVX2() ? ConversionInstructionSet::AVX2 : ConversionInstructionSet::F16C);
+		}
+
+		ConversionInstructionSet DetectedInstructionSet()
+		{
+			static const ConversionInstructionSet instructionSet = DetectInstructionSet();
+			return instructionSet;
+		}
+
+		atomic<ConversionInstructionSet>& ActiveInstructionSet()
+		{
+			static atomic<ConversionInstructionSet> instructionSet{ DetectedInstructionSet() };
+			return instructionSet;
+		}
+
+		template <typename TSource, typename TDestination, typename TKernel>
+		void Convert(const span<const TSource>& source, const span<TDestination>& destination, TKernel kernel)
+		{
+			const size_t count = static_cast<size_t>(source.size());
+			if (static_cast<size_t>(destination.size()) < count)
+			{
+				throw GameException("Conversion destination is smaller than the source.");
+			}
+
+			if (count <= PackedVectorHelper::ParallelBlockSize)
+			{
+				kernel(source.data(), destination.data(), count);
+				return;
+			}
+
+			const size_t blockSize = PackedVectorHelper::ParallelBlockSize;
+			vector<size_t> blocks((count + blockSize - 1) / blockSize);
+			for (size_t i = 0; i < blocks.size(); ++i)
+			{
+				blocks[i] = i * blockSize;
+			}
+
+			for_each(execution::par, blocks.begin(), blocks.end(), [&](size_t begin)
+			{
+				kernel(source.data() + begin, destination.data() + begin, min(blockSize, count - begin));
+			});
+		}
+
+#pragma region sRGB Tables
+		// Linear values from 2^-13 to 1 are split into buckets of 64 per octave, indexed directly by the float's
+		// exponent and top mantissa bits. Each bucket spans at most two code boundaries, so the code is the bucket's
+		// base code plus two threshold comparisons. Values below 2^-13 all encode to 0.
+		const uint32_t MinBucketBits{ 0x39000000 }; // 2^-13
+		const uint32_t MaxBucketBits{ 0x3F7FFFFF }; // Largest float below 1
+		const uint32_t BucketShift{ 17 };
+		const size_t BucketCount{ ((MaxBucketBits - MinBucketBits) >> BucketShift) + 1 };
+
+		struct SRGBTables final
+		{
+			// For each bucket, the code of its lower bound and the smallest linear values that encode to one and
+			// two codes higher. The three lookups are independent of each other.
+			array<int32_t, BucketCount> BaseCodes;
+			array<float, BucketCount> FirstThresholds;
+			array<float, BucketCount> SecondThresholds;
+			array<float, 256> LinearValues;
+		};
+
+		double SRGBToLinear(double value)
+		{
+			return (value <= 0.04045 ? value / 12.92 : pow((value + 0.055) / 1.055, 2.4));
+		}
+
+		double LinearToSRGB(double value)
+		{
+			return (value <= 0.0031308 ? value * 12.92 : 1.055 * pow(value, 1.0 / 2.4) - 0.055);
+		}
+
+		float FromBits(uint32_t bits)
+		{
+			float value;
+			memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+
+		SRGBTables CreateSRGBTables()
+		{
+			SRGBTables tables;
+
+			// thresholds[c] is the smallest linear value that encodes to c + 1 or higher.
+			array<float, 257> thresholds;
+			for (int32_t code = 0; code < 255; ++code)
+			{
+				// Adjust the rounded midpoint so that it is exactly the first float on the upper side.
+				const double midpoint = (code + 0.5) / 255.0;
+				float threshold = static_cast<float>(SRGBToLinear(midpoint));
+				while (LinearToSRGB(threshold) < midpoint)
+				{
+					threshold = nextafter(threshold, 2.0f);
+				}
+
+				while (LinearToSRGB(nextafter(threshold, 0.0f)) >= midpoint)
+				{
+					threshold = nextafter(threshold, 0.0f);
+				}
+
+				thresholds[code] = threshold;
+			}
+
+			thresholds[255] = numeric_limits<float>::infinity();
+			thresholds[256] = numeric_limits<float>::infinity();
+
+			for (size_t bucket = 0; bucket < BucketCount; ++bucket)
+			{
+				const float lowerBound = FromBits(MinBucketBits + narrow_cast<uint32_t>(bucket << BucketShift));
+				const int32_t baseCode = narrow_cast<int32_t>(upper_bound(thresholds.begin(), thresholds.begin() + 255, lowerBound) - thresholds.begin());
+				tables.BaseCodes[bucket] = baseCode;
+				tables.FirstThresholds[bucket] = thresholds[baseCode];
+				tables.SecondThresholds[bucket] = thresholds[baseCode + 1];
+			}
+
+			for (size_t code = 0; code < tables.LinearValues.size(); ++code)
+			{
+				tables.LinearValues[code] = static_cast<float>(SRGBToLinear(code / 255.0));
+			}
+
+			return tables;
+		}
+
+		const SRGBTables& GetSRGBTables()
+		{
+			static const SRGBTables tables = CreateSRGBTables();
+			return tables;
+		}
+#pragma endregion
+
+#pragma region Scalar Kernels
+		// The scalar kernels are the reference: they call the DirectXPackedVector conversions directly.
+		void ScalarFloatToHalf(const float* source, HALF* destination, size_t count)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				destination[i] = XMConvertFloatToHalf(source[i]);
+			}
+		}
+
+		void ScalarHalfToFloat(const HALF* source, float* destination, size_t count)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				destination[i] = XMConvertHalfToFloat(source[i]);
+			}
+		}
+
+		void ScalarFloatToUNorm8(const float* source, uint8_t* destination, size_t count)
+		{
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				XMStoreUByteN4(reinterpret_cast<XMUBYTEN4*>(destination + i), XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(source + i)));
+			}
+
+			if (i < count)
+			{
+				XMFLOAT4 tail(0.0f, 0.0f, 0.0f, 0.0f);
+				memcpy(&tail, source + i, (count - i) * sizeof(float));
+
+				XMUBYTEN4 packed;
+				XMStoreUByteN4(&packed, XMLoadFloat4(&tail));
+				memcpy(destination + i, &packed, count - i);
+			}
+		}
+
+		void ScalarFloatToSNorm16(const float* source, int16_t* destination, size_t count)
+		{
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				XMStoreShortN4(reinterpret_cast<XMSHORTN4*>(destination + i), XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(source + i)));
+			}
+
+			if (i < count)
+			{
+				XMFLOAT4 tail(0.0f, 0.0f, 0.0f, 0.0f);
+				memcpy(&tail, source + i, (count - i) * sizeof(float));
+
+				XMSHORTN4 packed;
+				XMStoreShortN4(&packed, XMLoadFloat4(&tail));
+				memcpy(destination + i, &packed, (count - i) * sizeof(int16_t));
+			}
+		}
+
+		void ScalarLinearToSRGB8(const float* source, uint8_t* destination, size_t count)
+		{
+			const SRGBTables& tables = GetSRGBTables();
+			for (size_t i = 0; i < count; ++i)
+			{
+				// Written as in the vector kernel so that NaN clamps to 0 on both paths.
+				float value = (source[i] > 0.0f ? source[i] : 0.0f);
+				value = (value < 1.0f ? value : 1.0f);
+
+				uint32_t bits;
+				memcpy(&bits, &value, sizeof(bits));
+				bits = clamp(bits, MinBucketBits, MaxBucketBits);
+
+				const uint32_t bucket = (bits - MinBucketBits) >> BucketShift;
+				const int32_t code = tables.BaseCodes[bucket] + (value >= tables.FirstThresholds[bucket] ? 1 : 0) + (value >= tables.SecondThresholds[bucket] ? 1 : 0);
+				destination[i] = static_cast<uint8_t>(code);
+			}
+		}
+
+		void ScalarSRGB8ToLinear(const uint8_t* source, float* destination, size_t count)
+		{
+			const SRGBTables& tables = GetSRGBTables();
+			for (size_t i = 0; i < count; ++i)
+			{
+				destination[i] = tables.LinearValues[source[i]];
+			}
+		}
+#pragma endregion
+
+#pragma region F16C Kernels
+		void F16CFloatToHalf(const float* source, HALF* destination, size_t count)
+		{
+			const __m256 signMask = _mm256_set1_ps(-0.0f);
+			const __m256 zero = _mm256_setzero_ps();
+			const __m256 maxHalf = _mm256_set1_ps(65504.0f);
+			const __m256 minNormalHalf = _mm256_set1_ps(6.103515625e-05f);
+
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				const __m256 value = _mm256_loadu_ps(source + i);
+				const __m256 magnitude = _mm256_andnot_ps(signMask, value);
+				const __m256 overflow = _mm256_cmp_ps(magnitude, maxHalf, _CMP_NLE_UQ);
+				const __m256 denormal = _mm256_and_ps(_mm256_cmp_ps(magnitude, minNormalHalf, _CMP_LT_OQ), _mm256_cmp_ps(magnitude, zero, _CMP_NEQ_OQ));
+				if (_mm256_movemask_ps(_mm256_or_ps(overflow, denormal)) != 0)
+				{
+					ScalarFloatToHalf(source + i, destination + i, 8);
+					continue;
+				}
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm256_cvtps_ph(value, _MM_FROUND_TO_NEAREST_INT));
+			}
+
+			_mm256_zeroupper();
+			ScalarFloatToHalf(source + i, destination + i, count - i);
+		}
+
+		void F16CHalfToFloat(const HALF* source, float* destination, size_t count)
+		{
+			const __m128i exponentMask = _mm_set1_epi16(0x7C00);
+
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+				if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(value, exponentMask), exponentMask)) != 0)
+				{
+					ScalarHalfToFloat(source + i, destination + i, 8);
+					continue;
+				}
+
+				_mm256_storeu_ps(destination + i, _mm256_cvtph_ps(value));
+			}
+
+			_mm256_zeroupper();
+			ScalarHalfToFloat(source + i, destination + i, count - i);
+		}
+#pragma endregion
+
+#pragma region AVX2 Kernels
+		void AVX2FloatToUNorm8(const float* source, uint8_t* destination, size_t count)
+		{
+			const __m256 zero = _mm256_setzero_ps();
+			const __m256 one = _mm256_set1_ps(1.0f);
+			const __m256 scale = _mm256_set1_ps(255.0f);
+			const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+			size_t i = 0;
+			for (; i + 32 <= count; i += 32)
+			{
+				__m256 values[4];
+				int nanMask = 0;
+				for (int j = 0; j < 4; ++j)
+				{
+					values[j] = _mm256_loadu_ps(source + i + j * 8);
+					nanMask |= _mm256_movemask_ps(_mm256_cmp_ps(values[j], values[j], _CMP_UNORD_Q));
+				}
+
+				if (nanMask != 0)
+				{
+					ScalarFloatToUNorm8(source + i, destination + i, 32);
+					continue;
+				}
+
+				__m256i integers[4];
+				for (int j = 0; j < 4; ++j)
+				{
+					integers[j] = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(values[j], zero), one), scale));
+				}
+
+				// The packs interleave the 128-bit lanes; the permute restores source order.
+				const __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(integers[0], integers[1]), _mm256_packs_epi32(integers[2], integers[3]));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm256_permutevar8x32_epi32(packed, order));
+			}
+
+			_mm256_zeroupper();
+			ScalarFloatToUNorm8(source + i, destination + i, count - i);
+		}
+
+		void AVX2FloatToSNorm16(const float* source, int16_t* destination, size_t count)
+		{
+			const __m256 negativeOne = _mm256_set1_ps(-1.0f);
+			const __m256 one = _mm256_set1_ps(1.0f);
+			const __m256 scale = _mm256_set1_ps(32767.0f);
+
+			size_t i = 0;
+			for (; i + 16 <= count; i += 16)
+			{
+				const __m256 first = _mm256_loadu_ps(source + i);
+				const __m256 second = _mm256_loadu_ps(source + i + 8);
+				const __m256 nan = _mm256_or_ps(_mm256_cmp_ps(first, first, _CMP_UNORD_Q), _mm256_cmp_ps(second, second, _CMP_UNORD_Q));
+				if (_mm256_movemask_ps(nan) != 0)
+				{
+					ScalarFloatToSNorm16(source + i, destination + i, 16);
+					continue;
+				}
+
+				const __m256i firstIntegers = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(first, negativeOne), one), scale));
+				const __m256i secondIntegers = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(second, negativeOne), one), scale));
+				const __m256i packed = _mm256_packs_epi32(firstIntegers, secondIntegers);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+			}
+
+			_mm256_zeroupper();
+			ScalarFloatToSNorm16(source + i, destination + i, count - i);
+		}
+
+		void AVX2LinearToSRGB8(const float* source, uint8_t* destination, size_t count)
+		{
+			const SRGBTables& tables = GetSRGBTables();
+			const __m256 zero = _mm256_setzero_ps();
+			const __m256 one = _mm256_set1_ps(1.0f);
+			const __m256i minBucketBits = _mm256_set1_epi32(static_cast<int>(MinBucketBits));
+			const __m256i maxBucketBits = _mm256_set1_epi32(static_cast<int>(MaxBucketBits));
+
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				const __m256 value = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(source + i), zero), one);
+
+				// The clamped value is non-negative, so its bits order like signed integers.
+				const __m256i bits = _mm256_min_epi32(_mm256_max_epi32(_mm256_castps_si256(value), minBucketBits), maxBucketBits);
+				const __m256i bucket = _mm256_srli_epi32(_mm256_sub_epi32(bits, minBucketBits), BucketShift);
+				const __m256i baseCode = _mm256_i32gather_epi32(tables.BaseCodes.data(), bucket, 4);
+				const __m256 firstThreshold = _mm256_i32gather_ps(tables.FirstThresholds.data(), bucket, 4);
+				const __m256 secondThreshold = _mm256_i32gather_ps(tables.SecondThresholds.data(), bucket, 4);
+
+				// A passed comparison yields -1 in the lane.
+				const __m256i firstStep = _mm256_castps_si256(_mm256_cmp_ps(value, firstThreshold, _CMP_GE_OQ));
+				const __m256i secondStep = _mm256_castps_si256(_mm256_cmp_ps(value, secondThreshold, _CMP_GE_OQ));
+				const __m256i code = _mm256_sub_epi32(_mm256_sub_epi32(baseCode, firstStep), secondStep);
+
+				const __m128i words = _mm_packs_epi32(_mm256_castsi256_si128(code), _mm256_extracti128_si256(code, 1));
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(destination + i), _mm_packus_epi16(words, words));
+			}
+
+			_mm256_zeroupper();
+			ScalarLinearToSRGB8(source + i, destination + i, count - i);
+		}
+
+		void AVX2SRGB8ToLinear(const uint8_t* source, float* destination, size_t count)
+		{
+			const SRGBTables& tables = GetSRGBTables();
+
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				const __m256i codes = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(source + i)));
+				_mm256_storeu_ps(destination + i, _mm256_i32gather_ps(tables.LinearValues.data(), codes, 4));
+			}
+
+			_mm256_zeroupper();
+			ScalarSRGB8ToLinear(source + i, destination + i, count - i);
+		}
+#pragma endregion
+	}
+
+	ConversionInstructionSet PackedVectorHelper::SupportedInstructionSet()
+	{
+		return DetectedInstructionSet();
+	}
+
+	ConversionInstructionSet PackedVectorHelper::InstructionSet()
+	{
+		return ActiveInstructionSet().load();
+	}
+
+	void PackedVectorHelper::SetInstructionSet(ConversionInstructionSet instructionSet)
+	{
+		ActiveInstructionSet().store(min(instructionSet, DetectedInstructionSet()));
+	}
+
+	void PackedVectorHelper::FloatToHalf(const span<const float>& source, const span<HALF>& destination)
+	{
+		Convert(source, destination, (InstructionSet() != ConversionInstructionSet::Scalar ? F16CFloatToHalf : ScalarFloatToHalf));
+	}
+
+	void PackedVectorHelper::HalfToFloat(const span<const HALF>& source, const span<float>& destination)
+	{
+		Convert(source, destination, (InstructionSet() != ConversionInstructionSet::Scalar ? F16CHalfToFloat : ScalarHalfToFloat));
+	}
+
+	void PackedVectorHelper::FloatToUNorm8(const span<const float>& source, const span<uint8_t>& destination)
+	{
+		Convert(source, destination, (InstructionSet() == ConversionInstructionSet::AVX2 ? AVX2FloatToUNorm8 : ScalarFloatToUNorm8));
+	}
+
+	void PackedVectorHelper::FloatToSNorm16(const span<const float>& source, const span<int16_t>& destination)
+	{
+		Convert(source, destination, (InstructionSet() == ConversionInstructionSet::AVX2 ? AVX2FloatToSNorm16 : ScalarFloatToSNorm16));
+	}
+
+	void PackedVectorHelper::LinearToSRGB8(const span<const float>& source, const span<uint8_t>& destination)
+	{
+		Convert(source, destination, (InstructionSet() == ConversionInstructionSet::AVX2 ? AVX2LinearToSRGB8 : ScalarLinearToSRGB8));
+	}
+
+	void PackedVectorHelper::SRGB8ToLinear(const span<const uint8_t>& source, const span<float>& destination)
+	{
+		Convert(source, destination, (InstructionSet() == ConversionInstructionSet::AVX2 ? AVX2SRGB8ToLinear : ScalarSRGB8ToLinear));
+	}
+}
\ No newline at end of file
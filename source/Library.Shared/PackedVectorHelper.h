@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <DirectXPackedVector.h>
+#include <gsl\gsl>
+
+namespace Library
+{
+	enum class ConversionInstructionSet
+	{
+		Scalar,
+		F16C,
+		AVX2
+	};
+
+	// Bulk conversions between float streams and the packed formats used by compact vertex and texture data.
+	// The kernels are selected at run time from the instructions the CPU supports; F16C accelerates the half
+	// conversions and AVX2 the normalized-integer and sRGB conversions. Large streams are split across threads.
+	//
+	// FloatToHalf, HalfToFloat, FloatToUNorm8 and FloatToSNorm16 produce the same bits as the per-element
+	// DirectXPackedVector functions (XMConvertFloatToHalf, XMConvertHalfToFloat, XMStoreUByteN4, XMStoreShortN4)
+	// for every input. Lanes whose vector result could differ (half denormals, overflow, NaN, Inf) take the scalar path.
+	// The sRGB conversions are table-driven and identical on every path.
+	class PackedVectorHelper final
+	{
+	public:
+		static ConversionInstructionSet SupportedInstructionSet();
+		static ConversionInstructionSet InstructionSet();
+
+		// Restricts the kernels to the given instruction set (clamped to what the CPU supports); intended for
+		// benchmarking and for verifying the vector paths against the scalar ones.
+		static void SetInstructionSet(ConversionInstructionSet instructionSet);
+
+		static void FloatToHalf(const gsl::span<const float>& source, const gsl::span<DirectX::PackedVector::HALF>& destination);
+		static void HalfToFloat(const gsl::span<const DirectX::PackedVector::HALF>& source, const gsl::span<float>& destination);
+
+		// Clamp to [0, 1] and [-1, 1] respectively.
+		static void FloatToUNorm8(const gsl::span<const float>& source, const gsl::span<std::uint8_t>& destination);
+		static void FloatToSNorm16(const gsl::span<const float>& source, const gsl::span<std::int16_t>& destination);
+
+		// Linear [0, 1] to 8-bit sRGB, rounded to the nearest code of the exact sRGB curve.
+		static void LinearToSRGB8(const gsl::span<const float>& source, const gsl::span<std::uint8_t>& destination);
+		static void SRGB8ToLinear(const gsl::span<const std::uint8_t>& source, const gsl::span<float>& destination);
+
+		inline static const std::size_t ParallelBlockSize{ 1 << 18 };
+
+		PackedVectorHelper() = delete;
+		PackedVectorHelper(const PackedVectorHelper&) = delete;
+		PackedVectorHelper& operator=(const PackedVectorHelper&) = delete;
+		PackedVectorHelper(PackedVectorHelper&&) = delete;
+		PackedVectorHelper& operator=(PackedVectorHelper&&) = delete;
+		~PackedVectorHelper() = default;
+	};
+}
\ No newline at end of file
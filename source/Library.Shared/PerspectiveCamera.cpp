@@ -41,6 +41,8 @@ namespace Library
 		{
 			XMMATRIX projectionMatrix = XMMatrixPerspectiveFovRH(mFieldOfView, mAspectRatio, mNearPlaneDistance, mFarPlaneDistance);
 			XMStoreFloat4x4(&mProjectionMatrix, projectionMatrix);
+			mProjectionMatrixDataDirty = false;
+			mFrustumDataDirty = true;
 
 			for (auto& callback : mProjectionMatrixUpdatedCallbacks)
 			{
@@ -2,7 +2,7 @@
 #include "PixelShaderReader.h"
 #include "Game.h"
 #include "GameException.h"
-#include "Utility.h"
+#include "ShaderPack.h"
 
 using namespace std;
 using namespace DirectX;
@@ -20,9 +20,8 @@ namespace Library
 	shared_ptr<PixelShader> PixelShaderReader::_Read(const wstring& assetName)
 	{
 		com_ptr<ID3D11PixelShader> pixelShader;
-		vector<char> compiledPixelShader;
-		Utility::LoadBinaryFile(assetName, compiledPixelShader);
-		ThrowIfFailed(mGame->Direct3DDevice()->CreatePixelShader(compiledPixelShader.data(), compiledPixelShader.size(), nullptr, pixelShader.put()), "ID3D11Device::CreatedPixelShader() failed.");
+		ShaderBytecode compiledPixelShader = ShaderPack::LoadBytecode(*mGame, assetName);
+		ThrowIfFailed(mGame->Direct3DDevice()->CreatePixelShader(compiledPixelShader.Data.data(), compiledPixelShader.Data.size(), nullptr, pixelShader.put()), "ID3D11Device::CreatedPixelShader() failed.");
 		
 		return shared_ptr<PixelShader>(new PixelShader(move(pixelShader)));
 	}
@@ -37,9 +36,8 @@ namespace Library
 		assert(mClassLinkage != nullptr);
 
 		com_ptr<ID3D11PixelShader> pixelShader;
-		vector<char> compiledPixelShader;
-		Utility::LoadBinaryFile(assetName, compiledPixelShader);
-		ThrowIfFailed(mGame->Direct3DDevice()->CreatePixelShader(compiledPixelShader.data(), compiledPixelShader.size(), mClassLinkage.get(), pixelShader.put()), "ID3D11Device::CreatedPixelShader() failed.");
+		ShaderBytecode compiledPixelShader = ShaderPack::LoadBytecode(*mGame, assetName);
+		ThrowIfFailed(mGame->Direct3DDevice()->CreatePixelShader(compiledPixelShader.Data.data(), compiledPixelShader.Data.size(), mClassLinkage.get(), pixelShader.put()), "ID3D11Device::CreatedPixelShader() failed.");
 
 		return shared_ptr<PixelShader>(new PixelShader(move(pixelShader)));
 	}
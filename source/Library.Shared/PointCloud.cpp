@@ -0,0 +1,99 @@
+#include "pch.h"
+#include "PointCloud.h"
+#include "GameException.h"
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+using namespace winrt;
+
+namespace Library
+{
+	namespace
+	{
+		static_assert(sizeof(PointCloud::Header) == 64);
+		static_assert(sizeof(PointCloud::Node) == 80);
+		static_assert(sizeof(VertexPositionPackedColor) == 16);
+
+		// The file is opened for overlapped I/O so that concurrent reads from worker threads are not serialized.
+		void ReadAt(HANDLE file, uint64_t offset, void* buffer, uint32_t byteCount)
+		{
+			handle completionEvent(CreateEventW(nullptr, TRUE, FALSE, nullptr));
+			if (!completionEvent)
+			{
+				throw GameException("CreateEventW() failed.", HRESULT_FROM_WIN32(GetLastError()));
+			}
+
+			OVERLAPPED overlapped{ 0 };
+			overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
+			overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+			overlapped.hEvent = completionEvent.get();
+
+			if (ReadFile(file, buffer, byteCount, nullptr, &overlapped) == FALSE && GetLastError() != ERROR_IO_PENDING)
+			{
+				throw GameException("ReadFile() failed.", HRESULT_FROM_WIN32(GetLastError()));
+			}
+
+			DWORD bytesRead;
+			if (GetOverlappedResult(file, &overlapped, &bytesRead, TRUE) == FALSE || bytesRead != byteCount)
+			{
+				throw GameException("Unexpected end of point cloud file.");
+			}
+		}
+	}
+
+	bool PointCloud::Node::IsLeaf() const
+	{
+		return all_of(begin(Children), end(Children), [](uint32_t child) { return child == InvalidNode; });
+	}
+
+	PointCloud::PointCloud(const wstring& filename)
+	{
+		mFile.attach(CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_OVERLAPPED | FILE_FLAG_RANDOM_ACCESS, nullptr));
+		if (!mFile)
+		{
+			throw GameException("Could not open point cloud file.", HRESULT_FROM_WIN32(GetLastError()));
+		}
+
+		ReadAt(mFile.get(), 0, &mHeader, sizeof(Header));
+		if (mHeader.Magic != Magic || mHeader.Version != Version)
+		{
+			throw GameException("Unsupported point cloud version.");
+		}
+
+		mNodes.resize(mHeader.NodeCount);
+		ReadAt(mFile.get(), mHeader.NodeTableOffset, mNodes.data(), narrow<uint32_t>(sizeof(Node) * mNodes.size()));
+
+		if (mHeader.RootNode >= mNodes.size())
+		{
+			throw GameException("Invalid point cloud node table.");
+		}
+	}
+
+	const PointCloud::Header& PointCloud::GetHeader() const
+	{
+		return mHeader;
+	}
+
+	const vector<PointCloud::Node>& PointCloud::Nodes() const
+	{
+		return mNodes;
+	}
+
+	const PointCloud::Node& PointCloud::RootNode() const
+	{
+		return mNodes[mHeader.RootNode];
+	}
+
+	vector<VertexPositionPackedColor> PointCloud::ReadPoints(uint32_t nodeIndex) const
+	{
+		const Node& node = mNodes.at(nodeIndex);
+		vector<VertexPositionPackedColor> points(node.PointCount);
+		if (!points.empty())
+		{
+			ReadAt(mFile.get(), node.DataOffset, points.data(), narrow<uint32_t>(sizeof(VertexPositionPackedColor) * points.size()));
+		}
+
+		return points;
+	}
+}
\ No newline at end of file
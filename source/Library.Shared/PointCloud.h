@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <DirectXMath.h>
+#include <gsl\gsl>
+#include <winrt\base.h>
+#include "VertexDeclarations.h"
+
+namespace Library
+{
+	// Octree of point chunks written by the PointCloudPipeline tool. Interior nodes hold a grid-subsampled
+	// copy of their subtree (one point per Spacing-sized cell); leaves hold the original points. Rendering
+	// a node's children in place of the node therefore increases density without duplicating points.
+	// Only the header and node table are kept in memory; node points are read on demand.
+	class PointCloud final
+	{
+	public:
+		struct Header final
+		{
+			std::uint32_t Magic;
+			std::uint32_t Version;
+			std::uint32_t NodeCount;
+			std::uint32_t RootNode;
+			std::uint64_t PointCount;
+			std::uint64_t NodeTableOffset;
+			DirectX::XMFLOAT3 BoundsMin;
+			float Spacing;
+			DirectX::XMFLOAT3 BoundsMax;
+			std::uint32_t Reserved;
+		};
+
+		// Points of a node are stored contiguously at DataOffset. Leaves have a spacing of zero.
+		struct Node final
+		{
+			DirectX::XMFLOAT3 BoundsMin;
+			float Spacing;
+			DirectX::XMFLOAT3 BoundsMax;
+			std::uint32_t Level;
+			std::uint64_t DataOffset;
+			std::uint32_t PointCount;
+			std::uint32_t Parent;
+			std::uint32_t Children[8];
+
+			bool IsLeaf() const;
+		};
+
+		inline static const std::uint32_t Magic{ 0x444C4350 }; // "PCLD"
+		inline static const std::uint32_t Version{ 1 };
+		inline static const std::uint32_t InvalidNode{ UINT32_MAX };
+
+		explicit PointCloud(const std::wstring& filename);
+		PointCloud(const PointCloud&) = delete;
+		PointCloud(PointCloud&&) = default;
+		PointCloud& operator=(const PointCloud&) = delete;
+		PointCloud& operator=(PointCloud&&) = default;
+		~PointCloud() = default;
+
+		const Header& GetHeader() const;
+		const std::vector<Node>& Nodes() const;
+		const Node& RootNode() const;
+
+		// Thread-safe; each call performs a single positional read.
+		std::vector<VertexPositionPackedColor> ReadPoints(std::uint32_t nodeIndex) const;
+
+	private:
+		winrt::file_handle mFile;
+		Header mHeader;
+		std::vector<Node> mNodes;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,413 @@
+#include "pch.h"
+#include "PointCloudComponent.h"
+#include "Game.h"
+#include "GameException.h"
+#include "Camera.h"
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+using namespace winrt;
+
+namespace Library
+{
+	RTTI_DEFINITIONS(PointCloudComponent)
+
+	namespace
+	{
+		// Clip-space planes (Gribb-Hartmann) of a row-vector view-projection matrix, pointing inward.
+		void ExtractFrustumPlanes(CXMMATRIX viewProjectionMatrix, XMVECTOR planes[6])
+		{
+			const XMMATRIX columns = XMMatrixTranspose(viewProjectionMatrix);
+			planes[0] = columns.r[3] + columns.r[0];
+			planes[1] = columns.r[3] - columns.r[0];
+			planes[2] = columns.r[3] + columns.r[1];
+			planes[3] = columns.r[3] - columns.r[1];
+			planes[4] = columns.r[2];
+			planes[5] = columns.r[3] - columns.r[2];
+		}
+
+		bool IntersectsFrustum(const XMVECTOR planes[6], const PointCloud::Node& node)
+		{
+			const XMVECTOR boundsMin = XMLoadFloat3(&node.BoundsMin);
+			const XMVECTOR boundsMax = XMLoadFloat3(&node.BoundsMax);
+			for (size_t i = 0; i < 6; ++i)
+			{
+				// Test the corner furthest along the plane normal.
+				const XMVECTOR positiveVertex = XMVectorSelect(boundsMin, boundsMax, XMVectorGreaterOrEqual(planes[i], XMVectorZero()));
+				if (XMVectorGetX(XMPlaneDotCoord(planes[i], positiveVertex)) < 0.0f)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		float DistanceToBounds(FXMVECTOR position, const PointCloud::Node& node)
+		{
+			const XMVECTOR closestPoint = XMVectorClamp(position, XMLoadFloat3(&node.BoundsMin), XMLoadFloat3(&node.BoundsMax));
+			return XMVectorGetX(XMVector3Length(position - closestPoint));
+		}
+	}
+
+	bool PointCloudComponent::LoadRequest::operator<(const LoadRequest& rhs) const
+	{
+		return Priority < rhs.Priority;
+	}
+
+	PointCloudComponent::PointCloudComponent(Game& game, const shared_ptr<Camera>& camera, const wstring& filename, uint32_t pointBudget, uint32_t workerThreadCount) :
+		DrawableGameComponent(game, camera),
+		mFilename(filename), mMaterial(game), mPointBudget(pointBudget), mWorkerThreadCount(max(workerThreadCount, 1U))
+	{
+	}
+
+	PointCloudComponent::~PointCloudComponent()
+	{
+		StopWorkers();
+	}
+
+	const PointCloud& PointCloudComponent::GetPointCloud() const
+	{
+		return *mPointCloud;
+	}
+
+	uint32_t PointCloudComponent::PointBudget() const
+	{
+		return mPointBudget;
+	}
+
+	void PointCloudComponent::SetPointBudget(uint32_t pointBudget)
+	{
+		mPointBudget = pointBudget;
+	}
+
+	float PointCloudComponent::TargetPointSpacing() const
+	{
+		return mTargetPointSpacing;
+	}
+
+	void PointCloudComponent::SetTargetPointSpacing(float targetPointSpacing)
+	{
+		mTargetPointSpacing = max(targetPointSpacing, 0.01f);
+	}
+
+	uint64_t PointCloudComponent::SelectedPointCount() const
+	{
+		return mSelectedPointCount;
+	}
+
+	size_t PointCloudComponent::SelectedNodeCount() const
+	{
+		return mSelectedNodes.size();
+	}
+
+	size_t PointCloudComponent::ResidentNodeCount() const
+	{
+		return mResidentNodeCount;
+	}
+
+	size_t PointCloudComponent::PendingNodeCount() const
+	{
+		lock_guard<mutex> lock(mMutex);
+		return mRequests.size();
+	}
+
+	void PointCloudComponent::Initialize()
+	{
+		mPointCloud = make_unique<PointCloud>(mFilename);
+		mNodes.resize(mPointCloud->Nodes().size());
+
+		mMaterial.Initialize();
+
+		auto updateMaterialFunc = [this]() { mUpdateMaterial = true; };
+		mCamera->AddViewMatrixUpdatedCallback(updateMaterialFunc);
+		mCamera->AddProjectionMatrixUpdatedCallback(updateMaterialFunc);
+
+		StartWorkers(mWorkerThreadCount);
+	}
+
+	void PointCloudComponent::Shutdown()
+	{
+		StopWorkers();
+	}
+
+	void PointCloudComponent::Update(const GameTime&)
+	{
+		{
+			lock_guard<mutex> lock(mMutex);
+			if (mWorkerError != nullptr)
+			{
+				rethrow_exception(mWorkerError);
+			}
+		}
+
+		++mFrame;
+		UploadLoadedNodes();
+		SelectNodes();
+		EvictNodes();
+	}
+
+	void PointCloudComponent::Draw(const GameTime&)
+	{
+		if (mUpdateMaterial)
+		{
+			const XMMATRIX wvp = XMMatrixTranspose(mCamera->ViewProjectionMatrix());
+			mMaterial.UpdateTransform(wvp);
+			mUpdateMaterial = false;
+		}
+
+		const auto& nodes = mPointCloud->Nodes();
+		for (uint32_t nodeIndex : mSelectedNodes)
+		{
+			ID3D11Buffer* vertexBuffer = mNodes[nodeIndex].VertexBuffer.get();
+			if (vertexBuffer != nullptr)
+			{
+				mMaterial.Draw(not_null<ID3D11Buffer*>(vertexBuffer), nodes[nodeIndex].PointCount);
+			}
+		}
+	}
+
+	void PointCloudComponent::UploadLoadedNodes()
+	{
+		vector<LoadedNode> loadedNodes;
+		{
+			lock_guard<mutex> lock(mMutex);
+			loadedNodes.swap(mLoadedNodes);
+		}
+
+		auto direct3DDevice = mGame->Direct3DDevice();
+		for (LoadedNode& loadedNode : loadedNodes)
+		{
+			NodeResidency& node = mNodes[loadedNode.NodeIndex];
+			if (!loadedNode.Points.empty())
+			{
+				VertexPositionPackedColor::CreateVertexBuffer(direct3DDevice, loadedNode.Points, not_null<ID3D11Buffer**>(node.VertexBuffer.put()));
+			}
+
+			node.State = NodeState::Resident;
+			node.LastUsedFrame = mFrame;
+			mResidentPointCount += loadedNode.Points.size();
+			++mResidentNodeCount;
+		}
+	}
+
+	void PointCloudComponent::SelectNodes()
+	{
+		const auto& nodes = mPointCloud->Nodes();
+		const uint32_t rootIndex = mPointCloud->GetHeader().RootNode;
+
+		XMVECTOR frustumPlanes[6];
+		ExtractFrustumPlanes(mCamera->ViewProjectionMatrix(), frustumPlanes);
+
+		// Pixels covered by one world unit at unit distance.
+		XMFLOAT4X4 projectionMatrix;
+		XMStoreFloat4x4(&projectionMatrix, mCamera->ProjectionMatrix());
+		const float projectionScale = projectionMatrix._22 * mGame->Viewport().Height * 0.5f;
+		const XMVECTOR cameraPosition = mCamera->PositionVector();
+		const float nearPlaneDistance = mCamera->NearPlaneDistance();
+
+		auto projectedSize = [&](const PointCloud::Node& node, float length)
+		{
+			return length * projectionScale / max(DistanceToBounds(cameraPosition, node), nearPlaneDistance);
+		};
+
+		auto nodeSize = [](const PointCloud::Node& node)
+		{
+			return XMVectorGetX(XMVector3Length(XMLoadFloat3(&node.BoundsMax) - XMLoadFloat3(&node.BoundsMin)));
+		};
+
+		vector<LoadRequest> requests;
+		mSelectedNodes.clear();
+		mSelectedPointCount = 0;
+
+		// Nodes that are not resident are requested whether or not they already are; see the end of the method.
+		if (mNodes[rootIndex].State != NodeState::Resident)
+		{
+			requests.push_back({ rootIndex, numeric_limits<float>::max() });
+		}
+		else if (IntersectsFrustum(frustumPlanes, nodes[rootIndex]))
+		{
+			// Refine the largest nodes first. The point count covers the selection plus every node still in
+			// the queue, so a refinement is only accepted if the whole cut stays within the budget.
+			vector<pair<float, uint32_t>> queue{ { projectedSize(nodes[rootIndex], nodeSize(nodes[rootIndex])), rootIndex } };
+			uint64_t pointCount = nodes[rootIndex].PointCount;
+
+			while (!queue.empty())
+			{
+				pop_heap(queue.begin(), queue.end());
+				const uint32_t nodeIndex = queue.back().second;
+				queue.pop_back();
+
+				const PointCloud::Node& node = nodes[nodeIndex];
+				mNodes[nodeIndex].LastUsedFrame = mFrame;
+
+				if (!node.IsLeaf() && projectedSize(node, node.Spacing) > mTargetPointSpacing)
+				{
+					uint64_t childPointCount = 0;
+					bool allChildrenResident = true;
+					uint32_t visibleChildren[8];
+					size_t visibleChildCount = 0;
+					for (uint32_t childIndex : node.Children)
+					{
+						if (childIndex == PointCloud::InvalidNode || !IntersectsFrustum(frustumPlanes, nodes[childIndex]))
+						{
+							continue;
+						}
+
+						visibleChildren[visibleChildCount++] = childIndex;
+						childPointCount += nodes[childIndex].PointCount;
+
+						// Resident children are kept from eviction while their siblings load, so that the
+						// refinement can complete once the last of them arrives.
+						NodeResidency& child = mNodes[childIndex];
+						if (child.State == NodeState::Resident)
+						{
+							child.LastUsedFrame = mFrame;
+						}
+						else
+						{
+							allChildrenResident = false;
+							requests.push_back({ childIndex, projectedSize(nodes[childIndex], nodeSize(nodes[childIndex])) });
+						}
+					}
+
+					if (allChildrenResident && pointCount - node.PointCount + childPointCount <= mPointBudget)
+					{
+						pointCount = pointCount - node.PointCount + childPointCount;
+						for (size_t i = 0; i < visibleChildCount; ++i)
+						{
+							const uint32_t childIndex = visibleChildren[i];
+							queue.emplace_back(projectedSize(nodes[childIndex], nodeSize(nodes[childIndex])), childIndex);
+							push_heap(queue.begin(), queue.end());
+						}
+
+						continue;
+					}
+				}
+
+				mSelectedNodes.push_back(nodeIndex);
+				mSelectedPointCount += node.PointCount;
+			}
+		}
+
+		// Replace the pending requests. Queued requests that are still wanted are kept with their new priority, and
+		// those no longer wanted are dropped. Nodes already being read by a worker are the only ones still
+		// requested once the queue is cleared; they stay requested until they arrive and are not queued again.
+		{
+			lock_guard<mutex> lock(mMutex);
+			for (const LoadRequest& request : mRequests)
+			{
+				mNodes[request.NodeIndex].State = NodeState::Unloaded;
+			}
+
+			requests.erase(remove_if(requests.begin(), requests.end(), [this](const LoadRequest& request)
+			{
+				return mNodes[request.NodeIndex].State != NodeState::Unloaded;
+			}), requests.end());
+
+			for (const LoadRequest& request : requests)
+			{
+				mNodes[request.NodeIndex].State = NodeState::Requested;
+			}
+
+			mRequests = move(requests);
+			make_heap(mRequests.begin(), mRequests.end());
+		}
+
+		mCondition.notify_all();
+	}
+
+	void PointCloudComponent::EvictNodes()
+	{
+		const uint64_t cacheSize = static_cast<uint64_t>(mPointBudget) * CacheSizeMultiplier;
+		if (mResidentPointCount <= cacheSize)
+		{
+			return;
+		}
+
+		vector<uint32_t> candidates;
+		for (uint32_t i = 0; i < mNodes.size(); ++i)
+		{
+			if (mNodes[i].State == NodeState::Resident && mNodes[i].LastUsedFrame < mFrame)
+			{
+				candidates.push_back(i);
+			}
+		}
+
+		sort(candidates.begin(), candidates.end(), [this](uint32_t lhs, uint32_t rhs) { return mNodes[lhs].LastUsedFrame < mNodes[rhs].LastUsedFrame; });
+
+		const auto& nodes = mPointCloud->Nodes();
+		for (uint32_t nodeIndex : candidates)
+		{
+			if (mResidentPointCount <= cacheSize)
+			{
+				break;
+			}
+
+			NodeResidency& node = mNodes[nodeIndex];
+			node.VertexBuffer = nullptr;
+			node.State = NodeState::Unloaded;
+			mResidentPointCount -= nodes[nodeIndex].PointCount;
+			--mResidentNodeCount;
+		}
+	}
+
+	void PointCloudComponent::StartWorkers(uint32_t workerThreadCount)
+	{
+		mStopWorkers = false;
+		for (uint32_t i = 0; i < workerThreadCount; ++i)
+		{
+			mWorkers.emplace_back(&PointCloudComponent::WorkerThread, this);
+		}
+	}
+
+	void PointCloudComponent::StopWorkers()
+	{
+		{
+			lock_guard<mutex> lock(mMutex);
+			mStopWorkers = true;
+		}
+
+		mCondition.notify_all();
+		for (thread& worker : mWorkers)
+		{
+			worker.join();
+		}
+
+		mWorkers.clear();
+	}
+
+	void PointCloudComponent::WorkerThread()
+	{
+		while (true)
+		{
+			LoadRequest request;
+			{
+				unique_lock<mutex> lock(mMutex);
+				mCondition.wait(lock, [this]() { return mStopWorkers || !mRequests.empty(); });
+				if (mStopWorkers)
+				{
+					return;
+				}
+
+				pop_heap(mRequests.begin(), mRequests.end());
+				request = mRequests.back();
+				mRequests.pop_back();
+			}
+
+			try
+			{
+				vector<VertexPositionPackedColor> points = mPointCloud->ReadPoints(request.NodeIndex);
+
+				lock_guard<mutex> lock(mMutex);
+				mLoadedNodes.push_back({ request.NodeIndex, move(points) });
+			}
+			catch (...)
+			{
+				lock_guard<mutex> lock(mMutex);
+				mWorkerError = current_exception();
+			}
+		}
+	}
+}
\ No newline at end of file
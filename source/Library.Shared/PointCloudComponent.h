@@ -0,0 +1,116 @@
+#pragma once
+
+#include <winrt\Windows.Foundation.h>
+#include <d3d11.h>
+#include <DirectXMath.h>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include "DrawableGameComponent.h"
+#include "PointCloud.h"
+#include "PointCloudMaterial.h"
+
+namespace Library
+{
+	// Renders a PointCloud octree. Each frame, nodes are refined front-to-back by projected size while their
+	// projected point spacing exceeds the target and the selection stays under the point budget. Missing
+	// nodes are requested from worker threads, which read them from disk; the parent keeps drawing until all
+	// of its visible children are resident. Nodes unused for the longest time are evicted from the GPU once
+	// the resident point count exceeds the cache size.
+	class PointCloudComponent final : public DrawableGameComponent
+	{
+		RTTI_DECLARATIONS(PointCloudComponent, DrawableGameComponent)
+
+	public:
+		PointCloudComponent(Game& game, const std::shared_ptr<Camera>& camera, const std::wstring& filename, std::uint32_t pointBudget = DefaultPointBudget, std::uint32_t workerThreadCount = DefaultWorkerThreadCount);
+		PointCloudComponent(const PointCloudComponent&) = delete;
+		PointCloudComponent(PointCloudComponent&&) = delete;
+		PointCloudComponent& operator=(const PointCloudComponent&) = delete;
+		PointCloudComponent& operator=(PointCloudComponent&&) = delete;
+		~PointCloudComponent();
+
+		// Valid after Initialize().
+		const PointCloud& GetPointCloud() const;
+
+		std::uint32_t PointBudget() const;
+		void SetPointBudget(std::uint32_t pointBudget);
+
+		// Nodes are refined while their point spacing projects to more than this many pixels.
+		float TargetPointSpacing() const;
+		void SetTargetPointSpacing(float targetPointSpacing);
+
+		std::uint64_t SelectedPointCount() const;
+		std::size_t SelectedNodeCount() const;
+		std::size_t ResidentNodeCount() const;
+		std::size_t PendingNodeCount() const;
+
+		virtual void Initialize() override;
+		virtual void Shutdown() override;
+		virtual void Update(const GameTime& gameTime) override;
+		virtual void Draw(const GameTime& gameTime) override;
+
+		inline static const std::uint32_t DefaultPointBudget{ 5000000 };
+		inline static const std::uint32_t DefaultWorkerThreadCount{ 2 };
+		inline static const float DefaultTargetPointSpacing{ 1.5f };
+		inline static const std::uint32_t CacheSizeMultiplier{ 2 };
+
+	private:
+		enum class NodeState
+		{
+			Unloaded,
+			Requested,
+			Resident
+		};
+
+		struct NodeResidency final
+		{
+			NodeState State{ NodeState::Unloaded };
+			winrt::com_ptr<ID3D11Buffer> VertexBuffer;
+			std::uint64_t LastUsedFrame{ 0 };
+		};
+
+		struct LoadRequest final
+		{
+			std::uint32_t NodeIndex;
+			float Priority;
+
+			bool operator<(const LoadRequest& rhs) const;
+		};
+
+		struct LoadedNode final
+		{
+			std::uint32_t NodeIndex;
+			std::vector<VertexPositionPackedColor> Points;
+		};
+
+		void UploadLoadedNodes();
+		void SelectNodes();
+		void EvictNodes();
+		void StartWorkers(std::uint32_t workerThreadCount);
+		void StopWorkers();
+		void WorkerThread();
+
+		std::wstring mFilename;
+		std::unique_ptr<PointCloud> mPointCloud;
+		PointCloudMaterial mMaterial;
+		std::vector<NodeResidency> mNodes;
+		std::vector<std::uint32_t> mSelectedNodes;
+		std::uint64_t mSelectedPointCount{ 0 };
+		std::uint64_t mResidentPointCount{ 0 };
+		std::size_t mResidentNodeCount{ 0 };
+		std::uint64_t mFrame{ 0 };
+		std::uint32_t mPointBudget;
+		std::uint32_t mWorkerThreadCount;
+		float mTargetPointSpacing{ DefaultTargetPointSpacing };
+		bool mUpdateMaterial{ true };
+
+		// Shared with the worker threads; guarded by mMutex.
+		mutable std::mutex mMutex;
+		std::condition_variable mCondition;
+		std::vector<LoadRequest> mRequests;
+		std::vector<LoadedNode> mLoadedNodes;
+		std::exception_ptr mWorkerError;
+		bool mStopWorkers{ false };
+		std::vector<std::thread> mWorkers;
+	};
+}
\ No newline at end of file
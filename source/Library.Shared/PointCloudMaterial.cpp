@@ -0,0 +1,53 @@
+#include "pch.h"
+#include "PointCloudMaterial.h"
+#include "Game.h"
+#include "GameException.h"
+#include "VertexDeclarations.h"
+#include "VertexShader.h"
+#include "PixelShader.h"
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+
+namespace Library
+{
+	RTTI_DEFINITIONS(PointCloudMaterial)
+
+	PointCloudMaterial::PointCloudMaterial(Game& game) :
+		Material(game, D3D11_PRIMITIVE_TOPOLOGY_POINTLIST)
+	{
+	}
+
+	uint32_t PointCloudMaterial::VertexSize() const
+	{
+		return sizeof(VertexPositionPackedColor);
+	}
+
+	void PointCloudMaterial::Initialize()
+	{
+		Material::Initialize();
+
+		auto& content = mGame->Content();
+		auto vertexShader = content.Load<VertexShader>(L"Shaders\\PointCloudVS.cso");
+		SetShader(vertexShader);
+
+		auto pixelShader = content.Load<PixelShader>(L"Shaders\\PointCloudPS.cso");
+		SetShader(pixelShader);
+
+		auto direct3DDevice = mGame->Direct3DDevice();
+		vertexShader->CreateInputLayout<VertexPositionPackedColor>(direct3DDevice);
+		SetInputLayout(vertexShader->InputLayout());
+
+		D3D11_BUFFER_DESC constantBufferDesc{ 0 };
+		constantBufferDesc.ByteWidth = sizeof(XMFLOAT4X4);
+		constantBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+		ThrowIfFailed(direct3DDevice->CreateBuffer(&constantBufferDesc, nullptr, mVSConstantBuffer.put()), "ID3D11Device::CreateBuffer() failed.");
+		AddConstantBuffer(ShaderStages::VS, mVSConstantBuffer.get());
+	}
+
+	void PointCloudMaterial::UpdateTransform(CXMMATRIX worldViewProjectionMatrix)
+	{
+		mGame->Direct3DDeviceContext()->UpdateSubresource(mVSConstantBuffer.get(), 0, nullptr, worldViewProjectionMatrix.r, 0, 0);
+	}
+}
\ No newline at end of file
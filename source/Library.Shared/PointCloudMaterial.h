@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Material.h"
+
+namespace Library
+{
+	class PointCloudMaterial final : public Material
+	{
+		RTTI_DECLARATIONS(PointCloudMaterial, Material)
+
+	public:
+		explicit PointCloudMaterial(Game& game);
+		PointCloudMaterial(const PointCloudMaterial&) = default;
+		PointCloudMaterial& operator=(const PointCloudMaterial&) = default;
+		PointCloudMaterial(PointCloudMaterial&&) = default;
+		PointCloudMaterial& operator=(PointCloudMaterial&&) = default;
+		~PointCloudMaterial() = default;
+
+		virtual std::uint32_t VertexSize() const override;
+		virtual void Initialize() override;
+
+		void UpdateTransform(DirectX::CXMMATRIX worldViewProjectionMatrix);
+
+	private:
+		winrt::com_ptr<ID3D11Buffer> mVSConstantBuffer;
+	};
+}
\ No newline at end of file
@@ -126,6 +126,7 @@ namespace Library
 		VertexPosition::CreateVertexBuffer(mGame->Direct3DDevice(), *mesh, not_null<ID3D11Buffer**>(mVertexBuffer.put()));
 		mesh->CreateIndexBuffer(*mGame->Direct3DDevice(), not_null<ID3D11Buffer**>(mIndexBuffer.put()));
 		mIndexCount = narrow<uint32_t>(mesh->Indices().size());
+		BoundingSphere::CreateFromPoints(mLocalBounds, mesh->Vertices().size(), mesh->Vertices().data(), sizeof(XMFLOAT3));
 
 		mMaterial.Initialize();
 
@@ -171,4 +172,10 @@ namespace Library
 			mMaterial.DrawIndexed(not_null<ID3D11Buffer*>(mVertexBuffer.get()), not_null<ID3D11Buffer*>(mIndexBuffer.get()), mIndexCount);
 		}
 	}
+
+	bool ProxyModel::GetBounds(BoundingSphere& bounds) const
+	{
+		mLocalBounds.Transform(bounds, XMLoadFloat4x4(&mWorldMatrix));
+		return true;
+	}
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <winrt\Windows.Foundation.h>
 #include <d3d11.h>
 #include <DirectXMath.h>
+#include <DirectXCollision.h>
 #include <gsl\gsl>
 #include "DrawableGameComponent.h"
 #include "MatrixHelper.h"
@@ -49,6 +50,7 @@ namespace Library
 		virtual void Initialize() override;
 		virtual void Update(const GameTime& gameTime) override;		
 		virtual void Draw(const GameTime& gameTime) override;
+		virtual bool GetBounds(DirectX::BoundingSphere& bounds) const override;
 
 	private:
 		DirectX::XMFLOAT4X4 mWorldMatrix{ MatrixHelper::Identity };
@@ -56,6 +58,7 @@ namespace Library
 		DirectX::XMFLOAT3 mDirection{ Vector3Helper::Forward };
 		DirectX::XMFLOAT3 mUp{ Vector3Helper::Up };
 		DirectX::XMFLOAT3 mRight{ Vector3Helper::Right };
+		DirectX::BoundingSphere mLocalBounds;
 		BasicMaterial mMaterial;
 		std::string mModelFileName;
 		float mScale;
@@ -0,0 +1,743 @@
+#include "pch.h"
+#include "SceneBvh.h"
+#include "Frustum.h"
+#include "GameException.h"
+#include <execution>
+#include <numeric>
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+
+namespace Library
+{
+	namespace
+	{
+		struct Bounds final
+		{
+			XMFLOAT3 Min{ numeric_limits<float>::max(), numeric_limits<float>::max(), numeric_limits<float>::max() };
+			XMFLOAT3 Max{ numeric_limits<float>::lowest(), numeric_limits<float>::lowest(), numeric_limits<float>::lowest() };
+
+			void Grow(const XMFLOAT3& point)
+			{
+				Min = XMFLOAT3(min(Min.x, point.x), min(Min.y, point.y), min(Min.z, point.z));
+				Max = XMFLOAT3(max(Max.x, point.x), max(Max.y, point.y), max(Max.z, point.z));
+			}
+
+			void Grow(const XMFLOAT3& min, const XMFLOAT3& max)
+			{
+				Min = XMFLOAT3(std::min(Min.x, min.x), std::min(Min.y, min.y), std::min(Min.z, min.z));
+				Max = XMFLOAT3(std::max(Max.x, max.x), std::max(Max.y, max.y), std::max(Max.z, max.z));
+			}
+
+			void Grow(const Bounds& bounds)
+			{
+				Grow(bounds.Min, bounds.Max);
+			}
+
+			float SurfaceArea() const
+			{
+				if (Min.x > Max.x)
+				{
+					return 0.0f;
+				}
+
+				const XMFLOAT3 extent(Max.x - Min.x, Max.y - Min.y, Max.z - Min.z);
+				return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+			}
+		};
+
+		struct Bin final
+		{
+			Bounds BinBounds;
+			uint32_t Count{ 0 };
+		};
+
+		using AxisBins = array<array<Bin, SceneBvh::BinCount>, 3>;
+
+		// Items binned by one task when a node is split in parallel.
+		const uint32_t BinningChunkSize{ 4096 };
+
+		float Component(const XMFLOAT3& value, uint32_t axis)
+		{
+			return (axis == 0 ? value.x : axis == 1 ? value.y : value.z);
+		}
+
+		uint32_t BinIndex(float value, float axisMin, float binScale)
+		{
+			return min(SceneBvh::BinCount - 1, static_cast<uint32_t>((value - axisMin) * binScale));
+		}
+
+		template <typename T>
+		float SurfaceArea(const T& bounds)
+		{
+			return Bounds{ bounds.Min, bounds.Max }.SurfaceArea();
+		}
+
+		// Entry distance of the ray into the bounds, or infinity if it misses them within the maximum distance.
+		template <typename T>
+		float IntersectBounds(const T& bounds, const Ray& ray, const XMFLOAT3& inverseDirection, float maxDistance)
+		{
+			const float x1 = (bounds.Min.x - ray.Origin.x) * inverseDirection.x;
+			const float x2 = (bounds.Max.x - ray.Origin.x) * inverseDirection.x;
+			const float y1 = (bounds.Min.y - ray.Origin.y) * inverseDirection.y;
+			const float y2 = (bounds.Max.y - ray.Origin.y) * inverseDirection.y;
+			const float z1 = (bounds.Min.z - ray.Origin.z) * inverseDirection.z;
+			const float z2 = (bounds.Max.z - ray.Origin.z) * inverseDirection.z;
+			const float entry = max(max(min(x1, x2), min(y1, y2)), max(min(z1, z2), 0.0f));
+			const float exit = min(min(max(x1, x2), max(y1, y2)), min(max(z1, z2), maxDistance));
+			return (entry <= exit ? entry : numeric_limits<float>::infinity());
+		}
+
+		enum class Overlap
+		{
+			None,
+			Partial,
+			Contained
+		};
+
+		template <typename T>
+		Overlap TestSphere(const T& bounds, const XMFLOAT3& center, float radiusSquared)
+		{
+			// Squared distances from the center to the nearest and farthest points of the box.
+			float nearest = 0.0f;
+			float farthest = 0.0f;
+			for (uint32_t axis = 0; axis < 3; axis++)
+			{
+				const float value = Component(center, axis);
+				const float min = Component(bounds.Min, axis);
+				const float max = Component(bounds.Max, axis);
+				const float below = (value < min ? min - value : value > max ? value - max : 0.0f);
+				const float across = std::max(value - min, max - value);
+				nearest += below * below;
+				farthest += across * across;
+			}
+
+			return (nearest > radiusSquared ? Overlap::None : farthest <= radiusSquared ? Overlap::Contained : Overlap::Partial);
+		}
+
+		// Tests the bounds against the frustum planes set in planeMask, clearing the bits of planes the bounds
+		// lie entirely inside of; descendants then skip those planes. Returns false if the bounds are outside.
+		template <typename T>
+		bool TestFrustum(const T& bounds, const array<XMFLOAT4, 6>& planes, uint32_t& planeMask)
+		{
+			const XMFLOAT3 center(0.5f * (bounds.Min.x + bounds.Max.x), 0.5f * (bounds.Min.y + bounds.Max.y), 0.5f * (bounds.Min.z + bounds.Max.z));
+			const XMFLOAT3 extent(0.5f * (bounds.Max.x - bounds.Min.x), 0.5f * (bounds.Max.y - bounds.Min.y), 0.5f * (bounds.Max.z - bounds.Min.z));
+			for (uint32_t plane = 0; plane < Frustum::PlaneCount; plane++)
+			{
+				const uint32_t planeBit = 1U << plane;
+				if ((planeMask & planeBit) == 0)
+				{
+					continue;
+				}
+
+				const XMFLOAT4& p = planes[plane];
+				const float distance = p.x * center.x + p.y * center.y + p.z * center.z + p.w;
+				const float radius = fabs(p.x) * extent.x + fabs(p.y) * extent.y + fabs(p.z) * extent.z;
+				if (distance + radius < 0.0f)
+				{
+					return false;
+				}
+
+				if (distance - radius >= 0.0f)
+				{
+					planeMask &= ~planeBit;
+				}
+			}
+
+			return true;
+		}
+	}
+
+	struct SceneBvh::BuildContext final
+	{
+		vector<Bounds> ItemBounds;
+		vector<XMFLOAT3> Centroids;
+	};
+
+	SceneBvh::SceneBvh(const span<const BoundingBox>& itemBounds)
+	{
+		const uint32_t itemCount = narrow<uint32_t>(itemBounds.size());
+		if (itemCount == 0)
+		{
+			return;
+		}
+
+		BuildContext context;
+		context.ItemBounds.resize(itemCount);
+		context.Centroids.resize(itemCount);
+		mItems.resize(itemCount);
+		iota(mItems.begin(), mItems.end(), 0U);
+		for_each(execution::par, mItems.begin(), mItems.end(), [&](uint32_t item)
+		{
+			const BoundingBox& box = itemBounds[item];
+			Bounds& bounds = context.ItemBounds[item];
+			bounds.Min = XMFLOAT3(box.Center.x - box.Extents.x, box.Center.y - box.Extents.y, box.Center.z - box.Extents.z);
+			bounds.Max = XMFLOAT3(box.Center.x + box.Extents.x, box.Center.y + box.Extents.y, box.Center.z + box.Extents.z);
+			context.Centroids[item] = box.Center;
+		});
+
+		const Bounds rootBounds = transform_reduce(execution::par, context.ItemBounds.begin(), context.ItemBounds.end(), Bounds(), [](Bounds lhs, const Bounds& rhs)
+		{
+			lhs.Grow(rhs);
+			return lhs;
+		}, [](const Bounds& bounds) { return bounds; });
+
+		mNodes.reserve(static_cast<size_t>(itemCount) * 2);
+		mNodes.push_back({ rootBounds.Min, 0, rootBounds.Max, itemCount, 0 });
+
+		// Nodes above the threshold are split one at a time, each with parallel binning and partitioning; the
+		// nodes below it become the roots of subtrees that are built concurrently. Pending nodes carry their
+		// depth, as the depth limit bounds the traversal stacks.
+		vector<pair<uint32_t, uint32_t>> pendingNodes{ { 0, 0 } };
+		vector<pair<uint32_t, uint32_t>> subtrees;
+		while (!pendingNodes.empty())
+		{
+			const auto [nodeIndex, depth] = pendingNodes.back();
+			pendingNodes.pop_back();
+
+			if (mNodes[nodeIndex].ItemCount < ParallelBuildThreshold)
+			{
+				subtrees.emplace_back(nodeIndex, depth);
+				continue;
+			}
+
+			Node left;
+			Node right;
+			if (depth + 1 >= MaxDepth || !Split(context, mNodes[nodeIndex], true, left, right))
+			{
+				continue;
+			}
+
+			const uint32_t leftIndex = narrow<uint32_t>(mNodes.size());
+			mNodes.push_back(left);
+			mNodes.push_back(right);
+			mNodes[nodeIndex].FirstChild = leftIndex;
+			pendingNodes.emplace_back(leftIndex, depth + 1);
+			pendingNodes.emplace_back(leftIndex + 1, depth + 1);
+		}
+
+		vector<vector<Node>> subtreeNodes(subtrees.size());
+		vector<uint32_t> subtreeIndices(subtrees.size());
+		iota(subtreeIndices.begin(), subtreeIndices.end(), 0U);
+		for_each(execution::par, subtreeIndices.begin(), subtreeIndices.end(), [&](uint32_t subtree)
+		{
+			vector<Node>& nodes = subtreeNodes[subtree];
+			nodes.push_back(mNodes[subtrees[subtree].first]);
+			BuildSubtree(context, nodes, subtrees[subtree].second);
+		});
+
+		// Each subtree's root replaces its placeholder; the remaining nodes are appended, so local node i > 0
+		// moves to the current node count plus i - 1.
+		for (size_t subtree = 0; subtree < subtrees.size(); subtree++)
+		{
+			vector<Node>& nodes = subtreeNodes[subtree];
+			const uint32_t offset = narrow<uint32_t>(mNodes.size()) - 1;
+			for (Node& node : nodes)
+			{
+				if (node.FirstChild != 0)
+				{
+					node.FirstChild += offset;
+				}
+			}
+
+			mNodes[subtrees[subtree].first] = nodes.front();
+			mNodes.insert(mNodes.end(), nodes.begin() + 1, nodes.end());
+		}
+
+		mNodes.shrink_to_fit();
+
+		mItemBounds.resize(itemCount);
+		transform(execution::par, mItems.begin(), mItems.end(), mItemBounds.begin(), [&](uint32_t item)
+		{
+			const Bounds& bounds = context.ItemBounds[item];
+			return ItemBounds{ bounds.Min, bounds.Max };
+		});
+	}
+
+	uint32_t SceneBvh::ItemCount() const
+	{
+		return narrow_cast<uint32_t>(mItems.size());
+	}
+
+	uint32_t SceneBvh::NodeCount() const
+	{
+		return narrow_cast<uint32_t>(mNodes.size());
+	}
+
+	float SceneBvh::Cost() const
+	{
+		if (mNodes.empty())
+		{
+			return 0.0f;
+		}
+
+		// Visiting a node costs as much as testing one item.
+		float cost = 0.0f;
+		for (const Node& node : mNodes)
+		{
+			cost += SurfaceArea(node) * (node.FirstChild != 0 ? 1.0f : static_cast<float>(node.ItemCount));
+		}
+
+		const float rootArea = SurfaceArea(mNodes.front());
+		return (rootArea > 0.0f ? cost / rootArea : 0.0f);
+	}
+
+	void SceneBvh::Refit(const span<const BoundingBox>& itemBounds)
+	{
+		if (narrow<uint32_t>(itemBounds.size()) != ItemCount())
+		{
+			throw GameException("Refitting requires the bounds of every item.");
+		}
+
+		// Leaves are refit in parallel; interior nodes follow in reverse order, which visits children before their parents.
+		for_each(execution::par, mNodes.begin(), mNodes.end(), [&](Node& node)
+		{
+			if (node.FirstChild != 0)
+			{
+				return;
+			}
+
+			Bounds nodeBounds;
+			for (uint32_t i = node.FirstItem; i < node.FirstItem + node.ItemCount; i++)
+			{
+				const BoundingBox& box = itemBounds[mItems[i]];
+				ItemBounds& bounds = mItemBounds[i];
+				bounds.Min = XMFLOAT3(box.Center.x - box.Extents.x, box.Center.y - box.Extents.y, box.Center.z - box.Extents.z);
+				bounds.Max = XMFLOAT3(box.Center.x + box.Extents.x, box.Center.y + box.Extents.y, box.Center.z + box.Extents.z);
+				nodeBounds.Grow(bounds.Min, bounds.Max);
+			}
+
+			node.Min = nodeBounds.Min;
+			node.Max = nodeBounds.Max;
+		});
+
+		for (size_t nodeIndex = mNodes.size(); nodeIndex-- > 0;)
+		{
+			Node& node = mNodes[nodeIndex];
+			if (node.FirstChild != 0)
+			{
+				Bounds nodeBounds;
+				nodeBounds.Grow(mNodes[node.FirstChild].Min, mNodes[node.FirstChild].Max);
+				nodeBounds.Grow(mNodes[node.FirstChild + 1].Min, mNodes[node.FirstChild + 1].Max);
+				node.Min = nodeBounds.Min;
+				node.Max = nodeBounds.Max;
+			}
+		}
+	}
+
+	void SceneBvh::Query(const Frustum& frustum, vector<uint32_t>& items) const
+	{
+		if (mNodes.empty())
+		{
+			return;
+		}
+
+		const array<XMFLOAT4, 6>& planes = frustum.Planes();
+		pair<uint32_t, uint32_t> stack[MaxDepth];
+		uint32_t stackSize = 0;
+		uint32_t nodeIndex = 0;
+		uint32_t planeMask = (1U << Frustum::PlaneCount) - 1;
+		for (;;)
+		{
+			const Node& node = mNodes[nodeIndex];
+			if (TestFrustum(node, planes, planeMask))
+			{
+				if (planeMask == 0)
+				{
+					items.insert(items.end(), mItems.begin() + node.FirstItem, mItems.begin() + node.FirstItem + node.ItemCount);
+				}
+				else if (node.FirstChild == 0)
+				{
+					for (uint32_t i = node.FirstItem; i < node.FirstItem + node.ItemCount; i++)
+					{
+						uint32_t itemPlaneMask = planeMask;
+						if (TestFrustum(mItemBounds[i], planes, itemPlaneMask))
+						{
+							items.push_back(mItems[i]);
+						}
+					}
+				}
+				else
+				{
+					assert(stackSize < MaxDepth);
+					stack[stackSize++] = { node.FirstChild + 1, planeMask };
+					nodeIndex = node.FirstChild;
+					continue;
+				}
+			}
+
+			if (stackSize == 0)
+			{
+				break;
+			}
+
+			tie(nodeIndex, planeMask) = stack[--stackSize];
+		}
+	}
+
+	void SceneBvh::Query(const BoundingSphere& sphere, vector<uint32_t>& items) const
+	{
+		if (mNodes.empty())
+		{
+			return;
+		}
+
+		const float radiusSquared = sphere.Radius * sphere.Radius;
+		uint32_t stack[MaxDepth];
+		uint32_t stackSize = 0;
+		uint32_t nodeIndex = 0;
+		for (;;)
+		{
+			const Node& node = mNodes[nodeIndex];
+			const Overlap overlap = TestSphere(node, sphere.Center, radiusSquared);
+			if (overlap == Overlap::Contained)
+			{
+				items.insert(items.end(), mItems.begin() + node.FirstItem, mItems.begin() + node.FirstItem + node.ItemCount);
+			}
+			else if (overlap == Overlap::Partial)
+			{
+				if (node.FirstChild == 0)
+				{
+					for (uint32_t i = node.FirstItem; i < node.FirstItem + node.ItemCount; i++)
+					{
+						if (TestSphere(mItemBounds[i], sphere.Center, radiusSquared) != Overlap::None)
+						{
+							items.push_back(mItems[i]);
+						}
+					}
+				}
+				else
+				{
+					assert(stackSize < MaxDepth);
+					stack[stackSize++] = node.FirstChild + 1;
+					nodeIndex = node.FirstChild;
+					continue;
+				}
+			}
+
+			if (stackSize == 0)
+			{
+				break;
+			}
+
+			nodeIndex = stack[--stackSize];
+		}
+	}
+
+	void SceneBvh::Query(const Ray& ray, vector<uint32_t>& items) const
+	{
+		if (mNodes.empty())
+		{
+			return;
+		}
+
+		const XMFLOAT3 inverseDirection(1.0f / ray.Direction.x, 1.0f / ray.Direction.y, 1.0f / ray.Direction.z);
+		const float infinity = numeric_limits<float>::infinity();
+		uint32_t stack[MaxDepth];
+		uint32_t stackSize = 0;
+		uint32_t nodeIndex = 0;
+		for (;;)
+		{
+			const Node& node = mNodes[nodeIndex];
+			if (IntersectBounds(node, ray, inverseDirection, ray.MaxDistance) != infinity)
+			{
+				if (node.FirstChild == 0)
+				{
+					for (uint32_t i = node.FirstItem; i < node.FirstItem + node.ItemCount; i++)
+					{
+						if (IntersectBounds(mItemBounds[i], ray, inverseDirection, ray.MaxDistance) != infinity)
+						{
+							items.push_back(mItems[i]);
+						}
+					}
+				}
+				else
+				{
+					assert(stackSize < MaxDepth);
+					stack[stackSize++] = node.FirstChild + 1;
+					nodeIndex = node.FirstChild;
+					continue;
+				}
+			}
+
+			if (stackSize == 0)
+			{
+				break;
+			}
+
+			nodeIndex = stack[--stackSize];
+		}
+	}
+
+	bool SceneBvh::Intersect(const Ray& ray, uint32_t& item, float& distance) const
+	{
+		if (mNodes.empty())
+		{
+			return false;
+		}
+
+		const XMFLOAT3 inverseDirection(1.0f / ray.Direction.x, 1.0f / ray.Direction.y, 1.0f / ray.Direction.z);
+		const float infinity = numeric_limits<float>::infinity();
+		float closestDistance = ray.MaxDistance;
+		if (IntersectBounds(mNodes[0], ray, inverseDirection, closestDistance) == infinity)
+		{
+			return false;
+		}
+
+		// Deferred nodes keep their entry distance, so that they are skipped once a closer hit is found.
+		bool found = false;
+		pair<uint32_t, float> stack[MaxDepth];
+		uint32_t stackSize = 0;
+		uint32_t nodeIndex = 0;
+		for (;;)
+		{
+			const Node& node = mNodes[nodeIndex];
+			if (node.FirstChild == 0)
+			{
+				for (uint32_t i = node.FirstItem; i < node.FirstItem + node.ItemCount; i++)
+				{
+					const float entry = IntersectBounds(mItemBounds[i], ray, inverseDirection, closestDistance);
+					if (entry != infinity && (!found || entry < closestDistance))
+					{
+						closestDistance = entry;
+						item = mItems[i];
+						found = true;
+					}
+				}
+			}
+			else
+			{
+				// Visit the nearer child first.
+				const uint32_t left = node.FirstChild;
+				const float leftDistance = IntersectBounds(mNodes[left], ray, inverseDirection, closestDistance);
+				const float rightDistance = IntersectBounds(mNodes[left + 1], ray, inverseDirection, closestDistance);
+				const bool visitLeft = (leftDistance != infinity);
+				const bool visitRight = (rightDistance != infinity);
+				if (visitLeft && visitRight)
+				{
+					const bool leftFirst = (leftDistance <= rightDistance);
+					assert(stackSize < MaxDepth);
+					stack[stackSize++] = (leftFirst ? make_pair(left + 1, rightDistance) : make_pair(left, leftDistance));
+					nodeIndex = (leftFirst ? left : left + 1);
+					continue;
+				}
+
+				if (visitLeft || visitRight)
+				{
+					nodeIndex = (visitLeft ? left : left + 1);
+					continue;
+				}
+			}
+
+			bool resumed = false;
+			while (stackSize > 0)
+			{
+				const auto [deferredIndex, entry] = stack[--stackSize];
+				if (entry <= closestDistance)
+				{
+					nodeIndex = deferredIndex;
+					resumed = true;
+					break;
+				}
+			}
+
+			if (!resumed)
+			{
+				break;
+			}
+		}
+
+		if (found)
+		{
+			distance = closestDistance;
+		}
+
+		return found;
+	}
+
+	bool SceneBvh::Split(const BuildContext& context, const Node& node, bool parallel, Node& left, Node& right)
+	{
+		const uint32_t first = node.FirstItem;
+		const uint32_t count = node.ItemCount;
+		const uint32_t chunkSize = (parallel ? BinningChunkSize : count);
+		vector<uint32_t> chunks((count + chunkSize - 1) / chunkSize);
+		iota(chunks.begin(), chunks.end(), 0U);
+
+		const auto forEachChunk = [&](const auto& function)
+		{
+			if (parallel)
+			{
+				for_each(execution::par, chunks.begin(), chunks.end(), function);
+			}
+			else
+			{
+				for_each(chunks.begin(), chunks.end(), function);
+			}
+		};
+
+		vector<Bounds> chunkCentroidBounds(chunks.size());
+		forEachChunk([&](uint32_t chunk)
+		{
+			const uint32_t begin = first + chunk * chunkSize;
+			const uint32_t end = min(first + count, begin + chunkSize);
+			for (uint32_t i = begin; i < end; i++)
+			{
+				chunkCentroidBounds[chunk].Grow(context.Centroids[mItems[i]]);
+			}
+		});
+
+		Bounds centroidBounds;
+		for (const Bounds& bounds : chunkCentroidBounds)
+		{
+			centroidBounds.Grow(bounds);
+		}
+
+		float axisMins[3];
+		float binScales[3];
+		for (uint32_t axis = 0; axis < 3; axis++)
+		{
+			axisMins[axis] = Component(centroidBounds.Min, axis);
+			const float extent = Component(centroidBounds.Max, axis) - axisMins[axis];
+			binScales[axis] = (extent > 0.0f ? BinCount / extent : 0.0f);
+		}
+
+		vector<AxisBins> chunkBins(chunks.size());
+		forEachChunk([&](uint32_t chunk)
+		{
+			AxisBins& bins = chunkBins[chunk];
+			const uint32_t begin = first + chunk * chunkSize;
+			const uint32_t end = min(first + count, begin + chunkSize);
+			for (uint32_t i = begin; i < end; i++)
+			{
+				const uint32_t item = mItems[i];
+				for (uint32_t axis = 0; axis < 3; axis++)
+				{
+					if (binScales[axis] > 0.0f)
+					{
+						Bin& bin = bins[axis][BinIndex(Component(context.Centroids[item], axis), axisMins[axis], binScales[axis])];
+						bin.BinBounds.Grow(context.ItemBounds[item]);
+						++bin.Count;
+					}
+				}
+			}
+		});
+
+		AxisBins bins;
+		for (const AxisBins& chunk : chunkBins)
+		{
+			for (uint32_t axis = 0; axis < 3; axis++)
+			{
+				for (uint32_t bin = 0; bin < BinCount; bin++)
+				{
+					bins[axis][bin].BinBounds.Grow(chunk[axis][bin].BinBounds);
+					bins[axis][bin].Count += chunk[axis][bin].Count;
+				}
+			}
+		}
+
+		// Evaluate the split after each bin along each axis; the cost omits the constant traversal term.
+		float bestCost = numeric_limits<float>::max();
+		uint32_t bestAxis = 0;
+		uint32_t bestSplit = 0;
+		for (uint32_t axis = 0; axis < 3; axis++)
+		{
+			if (binScales[axis] <= 0.0f)
+			{
+				continue;
+			}
+
+			float rightAreas[BinCount];
+			uint32_t rightCounts[BinCount];
+			Bounds rightBounds;
+			uint32_t rightCount = 0;
+			for (uint32_t bin = BinCount - 1; bin > 0; bin--)
+			{
+				rightBounds.Grow(bins[axis][bin].BinBounds);
+				rightCount += bins[axis][bin].Count;
+				rightAreas[bin] = rightBounds.SurfaceArea();
+				rightCounts[bin] = rightCount;
+			}
+
+			Bounds leftBounds;
+			uint32_t leftCount = 0;
+			for (uint32_t split = 1; split < BinCount; split++)
+			{
+				leftBounds.Grow(bins[axis][split - 1].BinBounds);
+				leftCount += bins[axis][split - 1].Count;
+				const float cost = leftCount * leftBounds.SurfaceArea() + rightCounts[split] * rightAreas[split];
+				if (leftCount > 0 && rightCounts[split] > 0 && cost < bestCost)
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = split;
+				}
+			}
+		}
+
+		// Large nodes are always split, so that no leaf is too large for the subtree builds to share the work.
+		if (bestSplit == 0 || (count < ParallelBuildThreshold && bestCost >= count * SurfaceArea(node)))
+		{
+			return false;
+		}
+
+		Bounds leftBounds;
+		Bounds rightBounds;
+		uint32_t leftCount = 0;
+		for (uint32_t bin = 0; bin < BinCount; bin++)
+		{
+			if (bin < bestSplit)
+			{
+				leftBounds.Grow(bins[bestAxis][bin].BinBounds);
+				leftCount += bins[bestAxis][bin].Count;
+			}
+			else
+			{
+				rightBounds.Grow(bins[bestAxis][bin].BinBounds);
+			}
+		}
+
+		const auto isLeft = [&](uint32_t item)
+		{
+			return BinIndex(Component(context.Centroids[item], bestAxis), axisMins[bestAxis], binScales[bestAxis]) < bestSplit;
+		};
+
+		if (parallel)
+		{
+			partition(execution::par, mItems.begin() + first, mItems.begin() + first + count, isLeft);
+		}
+		else
+		{
+			partition(mItems.begin() + first, mItems.begin() + first + count, isLeft);
+		}
+
+		left = { leftBounds.Min, first, leftBounds.Max, leftCount, 0 };
+		right = { rightBounds.Min, first + leftCount, rightBounds.Max, count - leftCount, 0 };
+
+		return true;
+	}
+
+	void SceneBvh::BuildSubtree(const BuildContext& context, vector<Node>& nodes, uint32_t depth)
+	{
+		vector<pair<uint32_t, uint32_t>> pendingNodes{ { 0, depth } };
+		while (!pendingNodes.empty())
+		{
+			const auto [nodeIndex, nodeDepth] = pendingNodes.back();
+			pendingNodes.pop_back();
+
+			Node left;
+			Node right;
+			if (nodes[nodeIndex].ItemCount <= MaxLeafSize || nodeDepth + 1 >= MaxDepth || !Split(context, nodes[nodeIndex], false, left, right))
+			{
+				continue;
+			}
+
+			const uint32_t leftIndex = narrow<uint32_t>(nodes.size());
+			nodes.push_back(left);
+			nodes.push_back(right);
+			nodes[nodeIndex].FirstChild = leftIndex;
+			pendingNodes.emplace_back(leftIndex, nodeDepth + 1);
+			pendingNodes.emplace_back(leftIndex + 1, nodeDepth + 1);
+		}
+	}
+}
\ No newline at end of file
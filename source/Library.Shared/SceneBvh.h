@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include <gsl\gsl>
+#include "TriangleBvh.h"
+
+namespace Library
+{
+	class Frustum;
+
+	// Bounding volume hierarchy over the bounding boxes of scene objects (items), for visibility, overlap and
+	// picking queries. Large nodes are split with parallel binning and partitioning, and the subtrees below them
+	// are built concurrently, using a binned surface area heuristic. Items that move a little are handled by
+	// refitting the node bounds without changing the tree. The queries are read-only and may run concurrently.
+	class SceneBvh final
+	{
+	public:
+		SceneBvh() = default;
+		explicit SceneBvh(const gsl::span<const DirectX::BoundingBox>& itemBounds);
+		SceneBvh(const SceneBvh&) = default;
+		SceneBvh(SceneBvh&&) = default;
+		SceneBvh& operator=(const SceneBvh&) = default;
+		SceneBvh& operator=(SceneBvh&&) = default;
+		~SceneBvh() = default;
+
+		std::uint32_t ItemCount() const;
+		std::uint32_t NodeCount() const;
+
+		// Surface area heuristic cost of the tree, relative to the area of its root. Refitting raises it as
+		// items move; rebuild when it has grown well beyond the cost after construction.
+		float Cost() const;
+
+		// Recomputes the bounds of all nodes from new item bounds, indexed as in the constructor.
+		void Refit(const gsl::span<const DirectX::BoundingBox>& itemBounds);
+
+		// The queries append the indices of matching items, in no particular order. Subtrees entirely inside
+		// the frustum or sphere are appended without visiting their nodes.
+		void Query(const Frustum& frustum, std::vector<std::uint32_t>& items) const;
+		void Query(const DirectX::BoundingSphere& sphere, std::vector<std::uint32_t>& items) const;
+		void Query(const Ray& ray, std::vector<std::uint32_t>& items) const;
+
+		// Item whose bounds the ray enters first within its maximum distance; distance is zero for bounds
+		// containing the ray's origin.
+		bool Intersect(const Ray& ray, std::uint32_t& item, float& distance) const;
+
+		inline static const std::uint32_t BinCount{ 16 };
+		inline static const std::uint32_t MaxLeafSize{ 4 };
+		inline static const std::uint32_t MaxDepth{ 64 };
+		inline static const std::uint32_t ParallelBuildThreshold{ 16384 };
+
+	private:
+		// Every node covers a contiguous range of items; interior nodes also store the index of their first
+		// child (the second follows it), which is always greater than their own.
+		struct Node final
+		{
+			DirectX::XMFLOAT3 Min;
+			std::uint32_t FirstItem;
+			DirectX::XMFLOAT3 Max;
+			std::uint32_t ItemCount;
+			std::uint32_t FirstChild; // Zero for leaves
+		};
+
+		struct ItemBounds final
+		{
+			DirectX::XMFLOAT3 Min;
+			DirectX::XMFLOAT3 Max;
+		};
+
+		struct BuildContext;
+
+		bool Split(const BuildContext& context, const Node& node, bool parallel, Node& left, Node& right);
+		void BuildSubtree(const BuildContext& context, std::vector<Node>& nodes, std::uint32_t depth);
+
+		std::vector<Node> mNodes;
+		std::vector<ItemBounds> mItemBounds; // In tree order
+		std::vector<std::uint32_t> mItems; // Constructor indices, in tree order
+	};
+}
\ No newline at end of file
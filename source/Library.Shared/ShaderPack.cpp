@@ -0,0 +1,205 @@
+#include "pch.h"
+#include "ShaderPack.h"
+#include "Game.h"
+#include "GameException.h"
+#include "Utility.h"
+
+using namespace std;
+using namespace gsl;
+
+namespace Library
+{
+	RTTI_DEFINITIONS(ShaderPack)
+
+	namespace
+	{
+		const uint64_t FnvOffsetBasis{ 14695981039346656037ULL };
+		const uint64_t FnvPrime{ 1099511628211ULL };
+
+		static_assert(sizeof(ShaderPack::Header) == 16);
+		static_assert(sizeof(ShaderPack::Entry) == 16);
+		static_assert(sizeof(ShaderPack::Blob) == 16);
+	}
+
+	ShaderPack::ShaderPack(const wstring& filename)
+	{
+		auto data = make_shared<vector<char>>();
+		Utility::LoadBinaryFile(filename, *data);
+		mData = move(data);
+
+		error_code error;
+		const auto writeTime = filesystem::last_write_time(filename, error);
+		if (!error)
+		{
+			mWriteTime = writeTime;
+		}
+
+		Initialize();
+	}
+
+	ShaderPack::ShaderPack(shared_ptr<const vector<char>> data, filesystem::file_time_type writeTime) :
+		mData(move(data)), mWriteTime(writeTime)
+	{
+		Initialize();
+	}
+
+	const shared_ptr<const vector<char>>& ShaderPack::Data() const
+	{
+		return mData;
+	}
+
+	span<const ShaderPack::Entry> ShaderPack::Entries() const
+	{
+		return mEntries;
+	}
+
+	span<const ShaderPack::Blob> ShaderPack::Blobs() const
+	{
+		return mBlobs;
+	}
+
+	filesystem::file_time_type ShaderPack::WriteTime() const
+	{
+		return mWriteTime;
+	}
+
+	bool ShaderPack::Contains(const wstring& assetName) const
+	{
+		return !Find(HashName(assetName)).empty();
+	}
+
+	span<const char> ShaderPack::Find(const wstring& assetName) const
+	{
+		return Find(HashName(assetName));
+	}
+
+	span<const char> ShaderPack::Find(uint64_t nameHash) const
+	{
+		auto it = lower_bound(mEntries.begin(), mEntries.end(), nameHash, [](const Entry& entry, uint64_t hash)
+		{
+			return entry.NameHash < hash;
+		});
+
+		if (it == mEntries.end() || it->NameHash != nameHash)
+		{
+			return span<const char>();
+		}
+
+		const Blob& blob = mBlobs[it->BlobIndex];
+		return span<const char>(mData->data() + blob.Offset, blob.Size);
+	}
+
+	uint64_t ShaderPack::HashName(const wstring& assetName)
+	{
+		uint64_t hash = FnvOffsetBasis;
+		for (wchar_t c : assetName)
+		{
+			if (c == L'/')
+			{
+				c = L'\\';
+			}
+			else if (c >= L'A' && c <= L'Z')
+			{
+				c = static_cast<wchar_t>(c - L'A' + L'a');
+			}
+
+			hash = (hash ^ static_cast<uint64_t>(c)) * FnvPrime;
+		}
+
+		return hash;
+	}
+
+	uint64_t ShaderPack::HashContent(span<const char> data)
+	{
+		uint64_t hash = FnvOffsetBasis;
+		for (char c : data)
+		{
+			hash = (hash ^ static_cast<uint8_t>(c)) * FnvPrime;
+		}
+
+		return hash;
+	}
+
+	wstring ShaderPack::VariantAssetName(const wstring& assetName, uint32_t featureMask)
+	{
+		if (featureMask == 0)
+		{
+			return assetName;
+		}
+
+		const size_t extensionPosition = assetName.find_last_of(L'.');
+		const size_t separatorPosition = assetName.find_last_of(L"\\/");
+		const bool hasExtension = (extensionPosition != wstring::npos && (separatorPosition == wstring::npos || extensionPosition > separatorPosition));
+		const size_t insertPosition = (hasExtension ? extensionPosition : assetName.size());
+
+		return assetName.substr(0, insertPosition) + L"." + to_wstring(featureMask) + assetName.substr(insertPosition);
+	}
+
+	ShaderBytecode ShaderPack::LoadBytecode(Game& game, const wstring& filename)
+	{
+		auto shaderPack = reinterpret_cast<ShaderPack*>(game.Services().GetService(ShaderPack::TypeIdClass()));
+		if (shaderPack != nullptr)
+		{
+			// Content manager paths are prefixed with the root directory; pack names are not.
+			const wstring& rootDirectory = game.Content().RootDirectory();
+			const bool isRooted = (filename.size() > rootDirectory.size() && _wcsnicmp(filename.c_str(), rootDirectory.c_str(), rootDirectory.size()) == 0);
+			auto bytecode = shaderPack->Find(isRooted ? filename.substr(rootDirectory.size()) : filename);
+			if (!bytecode.empty())
+			{
+				// Packs of unknown age are trusted; otherwise a loose file written since the pack is read instead.
+				error_code error;
+				const auto looseWriteTime = filesystem::last_write_time(filename, error);
+				if (shaderPack->mWriteTime == filesystem::file_time_type::min() || error || looseWriteTime <= shaderPack->mWriteTime)
+				{
+					return ShaderBytecode{ shaderPack->mData, bytecode };
+				}
+			}
+		}
+
+		auto data = make_shared<const vector<char>>(game.Content().ReadFile(filename));
+		span<const char> bytecode(*data);
+
+		return ShaderBytecode{ move(data), bytecode };
+	}
+
+	void ShaderPack::Initialize()
+	{
+		assert(mData != nullptr);
+		const vector<char>& data = *mData;
+		if (data.size() < sizeof(Header))
+		{
+			throw GameException("Invalid shader pack.");
+		}
+
+		const Header& header = *reinterpret_cast<const Header*>(data.data());
+		if (header.Magic != Magic || header.Version != Version)
+		{
+			throw GameException("Unsupported shader pack version.");
+		}
+
+		const size_t tableSize = sizeof(Header) + sizeof(Entry) * header.EntryCount + sizeof(Blob) * header.BlobCount;
+		if (data.size() < tableSize)
+		{
+			throw GameException("Invalid shader pack.");
+		}
+
+		mEntries = span<const Entry>(reinterpret_cast<const Entry*>(data.data() + sizeof(Header)), header.EntryCount);
+		mBlobs = span<const Blob>(reinterpret_cast<const Blob*>(data.data() + sizeof(Header) + sizeof(Entry) * header.EntryCount), header.BlobCount);
+
+		for (const Blob& blob : mBlobs)
+		{
+			if (static_cast<size_t>(blob.Offset) + blob.Size > data.size())
+			{
+				throw GameException("Shader pack blob out of range.");
+			}
+		}
+
+		const uint32_t blobCount = header.BlobCount;
+		const bool hasInvalidBlobIndex = any_of(mEntries.begin(), mEntries.end(), [blobCount](const Entry& entry) { return entry.BlobIndex >= blobCount; });
+		const bool isUnsorted = (adjacent_find(mEntries.begin(), mEntries.end(), [](const Entry& lhs, const Entry& rhs) { return lhs.NameHash >= rhs.NameHash; }) != mEntries.end());
+		if (hasInvalidBlobIndex || isUnsorted)
+		{
+			throw GameException("Invalid shader pack entry table.");
+		}
+	}
+}
\ No newline at end of file
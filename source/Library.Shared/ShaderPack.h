@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <gsl\gsl>
+#include "RTTI.h"
+
+namespace Library
+{
+	class Game;
+
+	// Compiled shader bytecode and the buffer that owns it. The storage may be an entire shader pack,
+	// in which case the bytecode is a view into the pack and no copy is made.
+	struct ShaderBytecode final
+	{
+		std::shared_ptr<const std::vector<char>> Storage;
+		gsl::span<const char> Data;
+	};
+
+	class ShaderPack final : public RTTI
+	{
+		RTTI_DECLARATIONS(ShaderPack, RTTI)
+
+	public:
+		struct Header final
+		{
+			std::uint32_t Magic;
+			std::uint32_t Version;
+			std::uint32_t EntryCount;
+			std::uint32_t BlobCount;
+		};
+
+		// Entries are sorted by name hash. Several entries may reference the same blob.
+		struct Entry final
+		{
+			std::uint64_t NameHash;
+			std::uint32_t BlobIndex;
+			std::uint32_t Reserved;
+		};
+
+		// Blob offsets are relative to the start of the pack.
+		struct Blob final
+		{
+			std::uint64_t ContentHash;
+			std::uint32_t Offset;
+			std::uint32_t Size;
+		};
+
+		inline static const std::uint32_t Magic{ 0x4B415053 }; // "SPAK"
+		inline static const std::uint32_t Version{ 1 };
+		inline static const std::uint32_t BlobAlignment{ 16 };
+		inline static const std::wstring DefaultAssetName{ L"Shaders.shaderpack" };
+		inline static const std::uint32_t MaxFeatureCount{ 8 }; // Feature defines per shader; see VariantAssetName
+
+		// The write time, when known, is compared against loose shader files; see LoadBytecode.
+		ShaderPack(const std::wstring& filename);
+		explicit ShaderPack(std::shared_ptr<const std::vector<char>> data, std::filesystem::file_time_type writeTime = std::filesystem::file_time_type::min());
+		ShaderPack(const ShaderPack&) = default;
+		ShaderPack(ShaderPack&&) = default;
+		ShaderPack& operator=(const ShaderPack&) = default;
+		ShaderPack& operator=(ShaderPack&&) = default;
+		~ShaderPack() = default;
+
+		const std::shared_ptr<const std::vector<char>>& Data() const;
+		gsl::span<const Entry> Entries() const;
+		gsl::span<const Blob> Blobs() const;
+		std::filesystem::file_time_type WriteTime() const;
+
+		bool Contains(const std::wstring& assetName) const;
+		gsl::span<const char> Find(const std::wstring& assetName) const;
+		gsl::span<const char> Find(std::uint64_t nameHash) const;
+
+		// Asset names are hashed case-insensitively, relative to the content root, with '\\' separators.
+		static std::uint64_t HashName(const std::wstring& assetName);
+		static std::uint64_t HashContent(gsl::span<const char> data);
+
+		// Permutation variants are named by inserting the feature mask before the extension
+		// (e.g. Shaders\FogDemoPS.1.cso). Feature mask 0 is the unadorned asset name.
+		static std::wstring VariantAssetName(const std::wstring& assetName, std::uint32_t featureMask);
+
+		// Resolves bytecode through the ShaderPack service, if one is registered, falling back to a file read. A loose
+		// file written after the pack takes precedence over its entry, so a stale pack cannot shadow rebuilt shaders.
+		static ShaderBytecode LoadBytecode(Game& game, const std::wstring& filename);
+
+	private:
+		void Initialize();
+
+		std::shared_ptr<const std::vector<char>> mData;
+		gsl::span<const Entry> mEntries;
+		gsl::span<const Blob> mBlobs;
+		std::filesystem::file_time_type mWriteTime{ std::filesystem::file_time_type::min() };
+	};
+}
\ No newline at end of file
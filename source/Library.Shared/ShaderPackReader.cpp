@@ -0,0 +1,23 @@
+#include "pch.h"
+#include "ShaderPackReader.h"
+#include "Game.h"
+
+using namespace std;
+
+namespace Library
+{
+	RTTI_DEFINITIONS(ShaderPackReader)
+
+	ShaderPackReader::ShaderPackReader(Game& game) :
+		ContentTypeReader(game, ShaderPack::TypeIdClass())
+	{
+	}
+
+	shared_ptr<ShaderPack> ShaderPackReader::_Read(const wstring& assetName)
+	{
+		error_code error;
+		const auto writeTime = filesystem::last_write_time(assetName, error);
+
+		return make_shared<ShaderPack>(make_shared<const vector<char>>(mGame->Content().ReadFile(assetName)), (error ? filesystem::file_time_type::min() : writeTime));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "ContentTypeReader.h"
+#include "ShaderPack.h"
+
+namespace Library
+{
+	class ShaderPackReader : public ContentTypeReader<ShaderPack>
+	{
+		RTTI_DECLARATIONS(ShaderPackReader, AbstractContentTypeReader)
+
+	public:
+		ShaderPackReader(Game& game);
+		ShaderPackReader(const ShaderPackReader&) = default;
+		ShaderPackReader& operator=(const ShaderPackReader&) = default;
+		ShaderPackReader(ShaderPackReader&&) = default;
+		ShaderPackReader& operator=(ShaderPackReader&&) = default;
+		~ShaderPackReader() = default;
+
+	protected:
+		virtual std::shared_ptr<ShaderPack> _Read(const std::wstring& assetName) override;
+	};
+}
\ No newline at end of file
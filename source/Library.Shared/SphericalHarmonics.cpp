@@ -0,0 +1,126 @@
+#include "pch.h"
+#include "SphericalHarmonics.h"
+#include "StreamHelper.h"
+#include "GameException.h"
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+
+namespace Library
+{
+	RTTI_DEFINITIONS(SphericalHarmonics)
+
+	SphericalHarmonics::SphericalHarmonics(const string& filename)
+	{
+		Load(filename);
+	}
+
+	SphericalHarmonics::SphericalHarmonics(ifstream& file)
+	{
+		Load(file);
+	}
+
+	SphericalHarmonics::SphericalHarmonics(const CoefficientArray& coefficients) :
+		mCoefficients(coefficients)
+	{
+	}
+
+	const SphericalHarmonics::CoefficientArray& SphericalHarmonics::Coefficients() const
+	{
+		return mCoefficients;
+	}
+
+	array<XMFLOAT4, SphericalHarmonics::CoefficientCount> SphericalHarmonics::PackedCoefficients() const
+	{
+		array<XMFLOAT4, CoefficientCount> packedCoefficients;
+		for (uint32_t i = 0; i < CoefficientCount; i++)
+		{
+			const XMFLOAT3& coefficient = mCoefficients[i];
+			packedCoefficients[i] = XMFLOAT4(coefficient.x, coefficient.y, coefficient.z, 0.0f);
+		}
+
+		return packedCoefficients;
+	}
+
+	XMVECTOR SphericalHarmonics::EvaluateIrradiance(FXMVECTOR normal) const
+	{
+		array<float, CoefficientCount> basis;
+		EvaluateBasis(normal, basis);
+
+		XMVECTOR irradiance = XMVectorZero();
+		for (uint32_t i = 0; i < CoefficientCount; i++)
+		{
+			irradiance = XMVectorMultiplyAdd(XMLoadFloat3(&mCoefficients[i]), XMVectorReplicate(basis[i]), irradiance);
+		}
+
+		return XMVectorMax(irradiance, XMVectorZero());
+	}
+
+	void SphericalHarmonics::EvaluateBasis(FXMVECTOR direction, span<float, CoefficientCount> basis)
+	{
+		XMFLOAT3 d;
+		XMStoreFloat3(&d, XMVector3Normalize(direction));
+
+		// Real spherical harmonic basis, bands 0 through 2
+		basis[0] = 0.282095f;
+		basis[1] = 0.488603f * d.y;
+		basis[2] = 0.488603f * d.z;
+		basis[3] = 0.488603f * d.x;
+		basis[4] = 1.092548f * d.x * d.y;
+		basis[5] = 1.092548f * d.y * d.z;
+		basis[6] = 0.315392f * (3.0f * d.z * d.z - 1.0f);
+		basis[7] = 1.092548f * d.x * d.z;
+		basis[8] = 0.546274f * (d.x * d.x - d.y * d.y);
+	}
+
+	void SphericalHarmonics::Save(const string& filename) const
+	{
+		ofstream file(filename.c_str(), ios::binary);
+		if (!file.good())
+		{
+			throw GameException("Could not open file.");
+		}
+
+		Save(file);
+	}
+
+	void SphericalHarmonics::Save(ofstream& file) const
+	{
+		OutputStreamHelper streamHelper(file);
+
+		streamHelper << CoefficientCount;
+		for (const XMFLOAT3& coefficient : mCoefficients)
+		{
+			streamHelper << coefficient.x << coefficient.y << coefficient.z;
+		}
+	}
+
+	void SphericalHarmonics::Load(const string& filename)
+	{
+		ifstream file(filename.c_str(), ios::binary);
+		if (!file.good())
+		{
+			throw GameException("Could not open file.");
+		}
+
+		Load(file);
+	}
+
+	void SphericalHarmonics::Load(ifstream& file)
+	{
+		InputStreamHelper streamHelper(file);
+
+		uint32_t coefficientCount;
+		streamHelper >> coefficientCount;
+		if (coefficientCount != CoefficientCount)
+		{
+			throw GameException("Unsupported spherical harmonics coefficient count.");
+		}
+
+		for (XMFLOAT3& coefficient : mCoefficients)
+		{
+			streamHelper >> coefficient.x >> coefficient.y >> coefficient.z;
+		}
+	}
+}
\ No newline at end of file
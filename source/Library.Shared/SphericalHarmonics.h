@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <fstream>
+#include <DirectXMath.h>
+#include <gsl\gsl>
+#include "RTTI.h"
+
+namespace Library
+{
+	class SphericalHarmonics final : public RTTI
+	{
+		RTTI_DECLARATIONS(SphericalHarmonics, RTTI)
+
+	public:
+		static constexpr std::uint32_t CoefficientCount{ 9 };
+		using CoefficientArray = std::array<DirectX::XMFLOAT3, CoefficientCount>;
+
+		SphericalHarmonics() = default;
+		SphericalHarmonics(const std::string& filename);
+		SphericalHarmonics(std::ifstream& file);
+		SphericalHarmonics(const CoefficientArray& coefficients);
+		SphericalHarmonics(const SphericalHarmonics&) = default;
+		SphericalHarmonics(SphericalHarmonics&&) = default;
+		SphericalHarmonics& operator=(const SphericalHarmonics&) = default;
+		SphericalHarmonics& operator=(SphericalHarmonics&&) = default;
+		~SphericalHarmonics() = default;
+
+		// Order-2 (9 coefficient) irradiance, already convolved with the clamped cosine lobe.
+		const CoefficientArray& Coefficients() const;
+
+		// Coefficients widened to float4 for direct upload into a constant buffer.
+		std::array<DirectX::XMFLOAT4, CoefficientCount> PackedCoefficients() const;
+
+		DirectX::XMVECTOR EvaluateIrradiance(DirectX::FXMVECTOR normal) const;
+
+		static void EvaluateBasis(DirectX::FXMVECTOR direction, gsl::span<float, CoefficientCount> basis);
+
+		void Save(const std::string& filename) const;
+		void Save(std::ofstream& file) const;
+
+	private:
+		void Load(const std::string& filename);
+		void Load(std::ifstream& file);
+
+		CoefficientArray mCoefficients{ };
+	};
+}
\ No newline at end of file
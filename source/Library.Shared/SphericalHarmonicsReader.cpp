@@ -0,0 +1,20 @@
+#include "pch.h"
+#include "SphericalHarmonicsReader.h"
+#include "Utility.h"
+
+using namespace std;
+
+namespace Library
+{
+	RTTI_DEFINITIONS(SphericalHarmonicsReader)
+
+	SphericalHarmonicsReader::SphericalHarmonicsReader(Game& game) :
+		ContentTypeReader(game, SphericalHarmonics::TypeIdClass())
+	{
+	}
+
+	shared_ptr<SphericalHarmonics> SphericalHarmonicsReader::_Read(const wstring& assetName)
+	{
+		return make_shared<SphericalHarmonics>(Utility::ToString(assetName));
+	}
+}
\ No newline at end of file
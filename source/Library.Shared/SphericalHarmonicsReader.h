@@ -0,0 +1,23 @@
+#pragma once
+
+#include "ContentTypeReader.h"
+#include "SphericalHarmonics.h"
+
+namespace Library
+{
+	class SphericalHarmonicsReader : public ContentTypeReader<SphericalHarmonics>
+	{
+		RTTI_DECLARATIONS(SphericalHarmonicsReader, AbstractContentTypeReader)
+
+	public:
+		SphericalHarmonicsReader(Game& game);
+		SphericalHarmonicsReader(const SphericalHarmonicsReader&) = default;
+		SphericalHarmonicsReader& operator=(const SphericalHarmonicsReader&) = default;
+		SphericalHarmonicsReader(SphericalHarmonicsReader&&) = default;
+		SphericalHarmonicsReader& operator=(SphericalHarmonicsReader&&) = default;
+		~SphericalHarmonicsReader() = default;
+
+	protected:
+		virtual std::shared_ptr<SphericalHarmonics> _Read(const std::wstring& assetName) override;
+	};
+}
\ No newline at end of file
@@ -52,7 +52,7 @@ namespace Library
 		return XMLoadFloat3(&mRight);
 	}
 
-	float SpotLight::InnerAngle()
+	float SpotLight::InnerAngle() const
 	{
 		return mInnerAngle;
 	}
@@ -62,7 +62,7 @@ namespace Library
 		mInnerAngle = value;
 	}
 
-	float SpotLight::OuterAngle()
+	float SpotLight::OuterAngle() const
 	{
 		return mOuterAngle;
 	}
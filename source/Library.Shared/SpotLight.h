@@ -23,10 +23,10 @@ namespace Library
 		DirectX::XMVECTOR UpVector() const;
 		DirectX::XMVECTOR RightVector() const;
 
-		float InnerAngle();
+		float InnerAngle() const;
 		void SetInnerAngle(float value);
 		
-		float OuterAngle();
+		float OuterAngle() const;
 		void SetOuterAngle(float value);
 
 		void ApplyRotation(DirectX::CXMMATRIX transform);
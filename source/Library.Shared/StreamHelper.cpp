@@ -180,8 +180,60 @@ void InputStreamHelper::ReadObject(istream& stream, T& value)
 
 	for (uint32_t size = 0; size < sizeof(T); ++size)
 	{
-		value |= stream.get() << (8 * size);
+		value |= static_cast<T>(static_cast<make_unsigned_t<T>>(stream.get() & 0xFF) << (8 * size));
 	}
 }
 
-#pragma endregion InputStreamHelper
\ No newline at end of file
+#pragma endregion InputStreamHelper
+
+#pragma region MemoryStreamBuffer
+
+MemoryStreamBuffer::MemoryStreamBuffer(const gsl::span<const char>& buffer)
+{
+	// The get area is never written through; streambuf only takes non-const pointers.
+	char* begin = const_cast<char*>(buffer.data());
+	setg(begin, begin, begin + buffer.size());
+}
+
+MemoryStreamBuffer::pos_type MemoryStreamBuffer::seekoff(off_type offset, ios_base::seekdir direction, ios_base::openmode mode)
+{
+	if ((mode & ios_base::in) == 0)
+	{
+		return pos_type(off_type(-1));
+	}
+
+	off_type base;
+	switch (direction)
+	{
+	case ios_base::beg:
+		base = 0;
+		break;
+
+	case ios_base::cur:
+		base = gptr() - eback();
+		break;
+
+	case ios_base::end:
+		base = egptr() - eback();
+		break;
+
+	default:
+		return pos_type(off_type(-1));
+	}
+
+	const off_type position = base + offset;
+	if (position < 0 || position > egptr() - eback())
+	{
+		return pos_type(off_type(-1));
+	}
+
+	setg(eback(), eback() + position, egptr());
+	return pos_type(position);
+}
+
+MemoryStreamBuffer::pos_type MemoryStreamBuffer::seekpos(pos_type position, ios_base::openmode mode)
+{
+	return seekoff(off_type(position), ios_base::beg, mode);
+}
+
+#pragma endregion MemoryStreamBuffer
\ No newline at end of file
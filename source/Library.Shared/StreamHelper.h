@@ -1,6 +1,8 @@
 #pragma once
 
 #include <iostream>
+#include <streambuf>
+#include <gsl\gsl>
 
 namespace DirectX
 {
@@ -58,4 +60,18 @@ namespace Library
 
 		std::istream& mStream;
 	};
+
+	// Read-only stream buffer over memory owned by the caller. Lets an InputStreamHelper read a slice of a larger
+	// buffer without copying it; several can share one buffer across threads.
+	class MemoryStreamBuffer final : public std::streambuf
+	{
+	public:
+		explicit MemoryStreamBuffer(const gsl::span<const char>& buffer);
+		MemoryStreamBuffer(const MemoryStreamBuffer&) = delete;
+		MemoryStreamBuffer& operator=(const MemoryStreamBuffer&) = delete;
+
+	protected:
+		virtual pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode mode = std::ios_base::in) override;
+		virtual pos_type seekpos(pos_type position, std::ios_base::openmode mode = std::ios_base::in) override;
+	};
 }
\ No newline at end of file
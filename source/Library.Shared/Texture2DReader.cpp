@@ -21,15 +21,18 @@ namespace Library
 
 	shared_ptr<Texture2D> Texture2DReader::_Read(const wstring& assetName)
 	{
+		const vector<char> data = mGame->Content().ReadFile(assetName);
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data.data());
+
 		com_ptr<ID3D11Resource> resource;
 		com_ptr<ID3D11ShaderResourceView> shaderResourceView;
 		if (StringHelper::EndsWith(assetName, L".dds"))
 		{
-			ThrowIfFailed(CreateDDSTextureFromFile(mGame->Direct3DDevice(), assetName.c_str(), resource.put(), shaderResourceView.put()), "CreateDDSTextureFromFile() failed.");
+			ThrowIfFailed(CreateDDSTextureFromMemory(mGame->Direct3DDevice(), bytes, data.size(), resource.put(), shaderResourceView.put()), "CreateDDSTextureFromMemory() failed.");
 		}
 		else
 		{
-			ThrowIfFailed(CreateWICTextureFromFile(mGame->Direct3DDevice(), assetName.c_str(), resource.put(), shaderResourceView.put()), "CreateWICTextureFromFile() failed.");
+			ThrowIfFailed(CreateWICTextureFromMemory(mGame->Direct3DDevice(), bytes, data.size(), resource.put(), shaderResourceView.put()), "CreateWICTextureFromMemory() failed.");
 		}
 
 		com_ptr<ID3D11Texture2D> texture = resource.as<ID3D11Texture2D>();
@@ -18,8 +18,10 @@ namespace Library
 
 	shared_ptr<TextureCube> TextureCubeReader::_Read(const wstring& assetName)
 	{
+		const vector<char> data = mGame->Content().ReadFile(assetName);
+
 		com_ptr<ID3D11ShaderResourceView> shaderResourceView;	
-		ThrowIfFailed(CreateDDSTextureFromFile(mGame->Direct3DDevice(), assetName.c_str(), nullptr, shaderResourceView.put()), "CreateDDSTextureFromFile() failed.");
+		ThrowIfFailed(CreateDDSTextureFromMemory(mGame->Direct3DDevice(), reinterpret_cast<const uint8_t*>(data.data()), data.size(), nullptr, shaderResourceView.put()), "CreateDDSTextureFromMemory() failed.");
 
 		return shared_ptr<TextureCube>(new TextureCube(move(shaderResourceView)));
 	}
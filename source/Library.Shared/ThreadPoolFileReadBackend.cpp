@@ -0,0 +1,113 @@
+#include "pch.h"
+#include "ThreadPoolFileReadBackend.h"
+#include "GameException.h"
+
+using namespace std;
+using namespace gsl;
+
+namespace Library
+{
+	ThreadPoolFileReadBackend::ThreadPoolFileReadBackend(uint32_t threadCount)
+	{
+		threadCount = max(threadCount, 1U);
+		mWorkers.reserve(threadCount);
+		for (uint32_t i = 0; i < threadCount; ++i)
+		{
+			mWorkers.emplace_back(&ThreadPoolFileReadBackend::WorkerThread, this);
+		}
+	}
+
+	ThreadPoolFileReadBackend::~ThreadPoolFileReadBackend()
+	{
+		// Queued jobs are still executed; their destinations may be referenced by callers.
+		{
+			lock_guard<mutex> lock(mMutex);
+			mShutdown = true;
+		}
+
+		mCondition.notify_all();
+		for (auto& worker : mWorkers)
+		{
+			worker.join();
+		}
+	}
+
+	uint32_t ThreadPoolFileReadBackend::ThreadCount() const
+	{
+		return narrow_cast<uint32_t>(mWorkers.size());
+	}
+
+	uint32_t ThreadPoolFileReadBackend::DefaultThreadCount()
+	{
+		return clamp(thread::hardware_concurrency(), 2U, 8U);
+	}
+
+	future<void> ThreadPoolFileReadBackend::ReadAsync(const wstring& filename, const span<const FileReadRange>& ranges, shared_ptr<const void> destinationOwner)
+	{
+		Job job;
+		job.Filename = filename;
+		job.Ranges.assign(ranges.begin(), ranges.end());
+		job.DestinationOwner = move(destinationOwner);
+		future<void> completion = job.Promise.get_future();
+
+		{
+			lock_guard<mutex> lock(mMutex);
+			mJobs.push_back(move(job));
+		}
+
+		mCondition.notify_one();
+
+		return completion;
+	}
+
+	void ThreadPoolFileReadBackend::WorkerThread()
+	{
+		for (;;)
+		{
+			Job job;
+			{
+				unique_lock<mutex> lock(mMutex);
+				mCondition.wait(lock, [this] { return mShutdown || !mJobs.empty(); });
+				if (mJobs.empty())
+				{
+					return;
+				}
+
+				job = move(mJobs.front());
+				mJobs.pop_front();
+			}
+
+			Execute(job);
+		}
+	}
+
+	void ThreadPoolFileReadBackend::Execute(Job& job)
+	{
+		try
+		{
+			ifstream file(job.Filename.c_str(), ios::binary);
+			if (!file.good())
+			{
+				throw GameException("Could not open file.");
+			}
+
+			for (const FileReadRange& range : job.Ranges)
+			{
+				file.seekg(static_cast<streamoff>(range.Offset));
+				file.read(range.Destination.data(), static_cast<streamsize>(range.Destination.size()));
+				if (file.gcount() != static_cast<streamsize>(range.Destination.size()))
+				{
+					throw GameException("File read failed or ended early.");
+				}
+			}
+
+			job.Promise.set_value();
+		}
+		catch (...)
+		{
+			job.Promise.set_exception(current_exception());
+		}
+
+		job.DestinationOwner.reset();
+	}
+}
\ No newline at end of file
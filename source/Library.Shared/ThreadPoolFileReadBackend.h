@@ -0,0 +1,47 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "FileReadBackend.h"
+
+namespace Library
+{
+	// Portable fallback: a fixed set of worker threads, each performing blocking std::ifstream reads. Concurrency
+	// is limited to one file per worker.
+	class ThreadPoolFileReadBackend final : public FileReadBackend
+	{
+	public:
+		explicit ThreadPoolFileReadBackend(std::uint32_t threadCount = DefaultThreadCount());
+		ThreadPoolFileReadBackend(const ThreadPoolFileReadBackend&) = delete;
+		ThreadPoolFileReadBackend(ThreadPoolFileReadBackend&&) = delete;
+		ThreadPoolFileReadBackend& operator=(const ThreadPoolFileReadBackend&) = delete;
+		ThreadPoolFileReadBackend& operator=(ThreadPoolFileReadBackend&&) = delete;
+		~ThreadPoolFileReadBackend();
+
+		std::uint32_t ThreadCount() const;
+
+		virtual std::future<void> ReadAsync(const std::wstring& filename, const gsl::span<const FileReadRange>& ranges, std::shared_ptr<const void> destinationOwner = nullptr) override;
+
+		static std::uint32_t DefaultThreadCount();
+
+	private:
+		struct Job final
+		{
+			std::wstring Filename;
+			std::vector<FileReadRange> Ranges;
+			std::shared_ptr<const void> DestinationOwner;
+			std::promise<void> Promise;
+		};
+
+		void WorkerThread();
+		static void Execute(Job& job);
+
+		std::mutex mMutex;
+		std::condition_variable mCondition;
+		std::deque<Job> mJobs;
+		bool mShutdown{ false };
+		std::vector<std::thread> mWorkers;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,471 @@
+#include "pch.h"
+#include "TriangleBvh.h"
+#include <numeric>
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+
+namespace Library
+{
+	namespace
+	{
+		struct Bounds final
+		{
+			XMFLOAT3 Min{ numeric_limits<float>::max(), numeric_limits<float>::max(), numeric_limits<float>::max() };
+			XMFLOAT3 Max{ numeric_limits<float>::lowest(), numeric_limits<float>::lowest(), numeric_limits<float>::lowest() };
+
+			void Grow(const XMFLOAT3& point)
+			{
+				Min = XMFLOAT3(min(Min.x, point.x), min(Min.y, point.y), min(Min.z, point.z));
+				Max = XMFLOAT3(max(Max.x, point.x), max(Max.y, point.y), max(Max.z, point.z));
+			}
+
+			// Empty bounds (such as an unused bin) leave these unchanged.
+			void Grow(const Bounds& bounds)
+			{
+				Min = XMFLOAT3(min(Min.x, bounds.Min.x), min(Min.y, bounds.Min.y), min(Min.z, bounds.Min.z));
+				Max = XMFLOAT3(max(Max.x, bounds.Max.x), max(Max.y, bounds.Max.y), max(Max.z, bounds.Max.z));
+			}
+
+			float SurfaceArea() const
+			{
+				if (Min.x > Max.x)
+				{
+					return 0.0f;
+				}
+
+				const XMFLOAT3 extent(Max.x - Min.x, Max.y - Min.y, Max.z - Min.z);
+				return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+			}
+		};
+
+		float Component(const XMFLOAT3& value, uint32_t axis)
+		{
+			return (axis == 0 ? value.x : axis == 1 ? value.y : value.z);
+		}
+
+		XMFLOAT3 Subtract(const XMFLOAT3& lhs, const XMFLOAT3& rhs)
+		{
+			return XMFLOAT3(lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z);
+		}
+
+		XMFLOAT3 Cross(const XMFLOAT3& lhs, const XMFLOAT3& rhs)
+		{
+			return XMFLOAT3(lhs.y * rhs.z - lhs.z * rhs.y, lhs.z * rhs.x - lhs.x * rhs.z, lhs.x * rhs.y - lhs.y * rhs.x);
+		}
+
+		float Dot(const XMFLOAT3& lhs, const XMFLOAT3& rhs)
+		{
+			return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
+		}
+	}
+
+	TriangleBvh::TriangleBvh(const vector<XMFLOAT3>& triangleVertices)
+	{
+		const uint32_t triangleCount = narrow<uint32_t>(triangleVertices.size() / 3);
+		if (triangleCount == 0)
+		{
+			return;
+		}
+
+		vector<Bounds> triangleBounds(triangleCount);
+		vector<XMFLOAT3> centroids(triangleCount);
+		for (uint32_t i = 0; i < triangleCount; i++)
+		{
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				triangleBounds[i].Grow(triangleVertices[i * 3 + corner]);
+			}
+
+			const Bounds& bounds = triangleBounds[i];
+			centroids[i] = XMFLOAT3(0.5f * (bounds.Min.x + bounds.Max.x), 0.5f * (bounds.Min.y + bounds.Max.y), 0.5f * (bounds.Min.z + bounds.Max.z));
+		}
+
+		mTriangleIndices.resize(triangleCount);
+		iota(mTriangleIndices.begin(), mTriangleIndices.end(), 0U);
+
+		const auto rangeBounds = [&](uint32_t first, uint32_t count)
+		{
+			Bounds bounds;
+			for (uint32_t i = first; i < first + count; i++)
+			{
+				bounds.Grow(triangleBounds[mTriangleIndices[i]]);
+			}
+
+			return bounds;
+		};
+
+		const Bounds rootBounds = rangeBounds(0, triangleCount);
+		mNodes.reserve(static_cast<size_t>(triangleCount) * 2);
+		mNodes.push_back({ rootBounds.Min, 0, rootBounds.Max, triangleCount });
+
+		struct Bin final
+		{
+			Bounds BinBounds;
+			uint32_t Count{ 0 };
+		};
+
+		// Pending nodes with their depth; the depth limit bounds the traversal stack.
+		vector<pair<uint32_t, uint32_t>> pendingNodes{ { 0, 0 } };
+		while (!pendingNodes.empty())
+		{
+			const auto [nodeIndex, depth] = pendingNodes.back();
+			pendingNodes.pop_back();
+
+			const uint32_t first = mNodes[nodeIndex].FirstChildOrTriangle;
+			const uint32_t count = mNodes[nodeIndex].TriangleCount;
+			if (count <= MaxLeafSize || depth + 1 >= MaxDepth)
+			{
+				continue;
+			}
+
+			Bounds centroidBounds;
+			for (uint32_t i = first; i < first + count; i++)
+			{
+				centroidBounds.Grow(centroids[mTriangleIndices[i]]);
+			}
+
+			// Evaluate the split after each bin along each axis; the cost omits the constant traversal term.
+			float bestCost = numeric_limits<float>::max();
+			uint32_t bestAxis = 0;
+			uint32_t bestSplit = 0;
+			for (uint32_t axis = 0; axis < 3; axis++)
+			{
+				const float axisMin = Component(centroidBounds.Min, axis);
+				const float extent = Component(centroidBounds.Max, axis) - axisMin;
+				if (extent <= 0.0f)
+				{
+					continue;
+				}
+
+				Bin bins[BinCount];
+				const float binScale = BinCount / extent;
+				for (uint32_t i = first; i < first + count; i++)
+				{
+					const uint32_t triangle = mTriangleIndices[i];
+					const uint32_t bin = min(BinCount - 1, static_cast<uint32_t>((Component(centroids[triangle], axis) - axisMin) * binScale));
+					bins[bin].BinBounds.Grow(triangleBounds[triangle]);
+					++bins[bin].Count;
+				}
+
+				float rightAreas[BinCount];
+				uint32_t rightCounts[BinCount];
+				Bounds rightBounds;
+				uint32_t rightCount = 0;
+				for (uint32_t bin = BinCount - 1; bin > 0; bin--)
+				{
+					rightBounds.Grow(bins[bin].BinBounds);
+					rightCount += bins[bin].Count;
+					rightAreas[bin] = rightBounds.SurfaceArea();
+					rightCounts[bin] = rightCount;
+				}
+
+				Bounds leftBounds;
+				uint32_t leftCount = 0;
+				for (uint32_t split = 1; split < BinCount; split++)
+				{
+					leftBounds.Grow(bins[split - 1].BinBounds);
+					leftCount += bins[split - 1].Count;
+					const float cost = leftCount * leftBounds.SurfaceArea() + rightCounts[split] * rightAreas[split];
+					if (leftCount > 0 && rightCounts[split] > 0 && cost < bestCost)
+					{
+						bestCost = cost;
+						bestAxis = axis;
+						bestSplit = split;
+					}
+				}
+			}
+
+			const Bounds nodeBounds{ mNodes[nodeIndex].Min, mNodes[nodeIndex].Max };
+			if (bestSplit == 0 || bestCost >= count * nodeBounds.SurfaceArea())
+			{
+				continue;
+			}
+
+			const float axisMin = Component(centroidBounds.Min, bestAxis);
+			const float binScale = BinCount / (Component(centroidBounds.Max, bestAxis) - axisMin);
+			const auto middle = partition(mTriangleIndices.begin() + first, mTriangleIndices.begin() + first + count, [&](uint32_t triangle)
+			{
+				return min(BinCount - 1, static_cast<uint32_t>((Component(centroids[triangle], bestAxis) - axisMin) * binScale)) < bestSplit;
+			});
+
+			const uint32_t leftCount = narrow<uint32_t>(distance(mTriangleIndices.begin() + first, middle));
+			const uint32_t leftIndex = narrow<uint32_t>(mNodes.size());
+			const Bounds leftBounds = rangeBounds(first, leftCount);
+			const Bounds rightBounds = rangeBounds(first + leftCount, count - leftCount);
+			mNodes.push_back({ leftBounds.Min, first, leftBounds.Max, leftCount });
+			mNodes.push_back({ rightBounds.Min, first + leftCount, rightBounds.Max, count - leftCount });
+			mNodes[nodeIndex].FirstChildOrTriangle = leftIndex;
+			mNodes[nodeIndex].TriangleCount = 0;
+
+			pendingNodes.emplace_back(leftIndex, depth + 1);
+			pendingNodes.emplace_back(leftIndex + 1, depth + 1);
+		}
+
+		mTriangles.resize(triangleCount);
+		for (uint32_t i = 0; i < triangleCount; i++)
+		{
+			const XMFLOAT3* vertices = &triangleVertices[static_cast<size_t>(mTriangleIndices[i]) * 3];
+			mTriangles[i] = { vertices[0], Subtract(vertices[1], vertices[0]), Subtract(vertices[2], vertices[0]) };
+		}
+	}
+
+	uint32_t TriangleBvh::TriangleCount() const
+	{
+		return narrow<uint32_t>(mTriangles.size());
+	}
+
+	uint32_t TriangleBvh::NodeCount() const
+	{
+		return narrow<uint32_t>(mNodes.size());
+	}
+
+	bool TriangleBvh::Intersect(const Ray& ray, RayHit& hit) const
+	{
+		return Traverse<false>(ray, hit);
+	}
+
+	bool TriangleBvh::Occluded(const Ray& ray) const
+	{
+		RayHit hit;
+		return Traverse<true>(ray, hit);
+	}
+
+	uint32_t TriangleBvh::Occluded(const RayPacket& packet) const
+	{
+		if (mNodes.empty())
+		{
+			return 0;
+		}
+
+		const XMVECTOR inverseDirectionX = XMVectorReciprocal(packet.DirectionX);
+		const XMVECTOR inverseDirectionY = XMVectorReciprocal(packet.DirectionY);
+		const XMVECTOR inverseDirectionZ = XMVectorReciprocal(packet.DirectionZ);
+		const XMVECTOR zero = XMVectorZero();
+
+		// Lanes of rays that are still unoccluded; the query ends once all of them are.
+		XMVECTOR active = XMVectorGreater(packet.MaxDistance, zero);
+		XMVECTOR occluded = XMVectorFalseInt();
+
+		const auto intersectBounds = [&](const Node& node)
+		{
+			const XMVECTOR x1 = (XMVectorReplicate(node.Min.x) - packet.OriginX) * inverseDirectionX;
+			const XMVECTOR x2 = (XMVectorReplicate(node.Max.x) - packet.OriginX) * inverseDirectionX;
+			const XMVECTOR y1 = (XMVectorReplicate(node.Min.y) - packet.OriginY) * inverseDirectionY;
+			const XMVECTOR y2 = (XMVectorReplicate(node.Max.y) - packet.OriginY) * inverseDirectionY;
+			const XMVECTOR z1 = (XMVectorReplicate(node.Min.z) - packet.OriginZ) * inverseDirectionZ;
+			const XMVECTOR z2 = (XMVectorReplicate(node.Max.z) - packet.OriginZ) * inverseDirectionZ;
+			const XMVECTOR entry = XMVectorMax(XMVectorMax(XMVectorMin(x1, x2), XMVectorMin(y1, y2)), XMVectorMax(XMVectorMin(z1, z2), zero));
+			const XMVECTOR exit = XMVectorMin(XMVectorMin(XMVectorMax(x1, x2), XMVectorMax(y1, y2)), XMVectorMin(XMVectorMax(z1, z2), packet.MaxDistance));
+			return XMVector4NotEqualInt(XMVectorAndInt(XMVectorLessOrEqual(entry, exit), active), XMVectorFalseInt());
+		};
+
+		uint32_t stack[MaxDepth];
+		uint32_t stackSize = 0;
+		uint32_t nodeIndex = 0;
+		bool visit = intersectBounds(mNodes[0]);
+		while (visit)
+		{
+			const Node& node = mNodes[nodeIndex];
+			if (node.TriangleCount > 0)
+			{
+				for (uint32_t i = node.FirstChildOrTriangle; i < node.FirstChildOrTriangle + node.TriangleCount; i++)
+				{
+					// Moller-Trumbore across the four lanes.
+					const Triangle& triangle = mTriangles[i];
+					const XMVECTOR edge1X = XMVectorReplicate(triangle.Edge1.x);
+					const XMVECTOR edge1Y = XMVectorReplicate(triangle.Edge1.y);
+					const XMVECTOR edge1Z = XMVectorReplicate(triangle.Edge1.z);
+					const XMVECTOR edge2X = XMVectorReplicate(triangle.Edge2.x);
+					const XMVECTOR edge2Y = XMVectorReplicate(triangle.Edge2.y);
+					const XMVECTOR edge2Z = XMVectorReplicate(triangle.Edge2.z);
+
+					const XMVECTOR pX = packet.DirectionY * edge2Z - packet.DirectionZ * edge2Y;
+					const XMVECTOR pY = packet.DirectionZ * edge2X - packet.DirectionX * edge2Z;
+					const XMVECTOR pZ = packet.DirectionX * edge2Y - packet.DirectionY * edge2X;
+					const XMVECTOR determinant = edge1X * pX + edge1Y * pY + edge1Z * pZ;
+					const XMVECTOR inverseDeterminant = XMVectorReciprocal(determinant);
+
+					const XMVECTOR sX = packet.OriginX - XMVectorReplicate(triangle.Vertex.x);
+					const XMVECTOR sY = packet.OriginY - XMVectorReplicate(triangle.Vertex.y);
+					const XMVECTOR sZ = packet.OriginZ - XMVectorReplicate(triangle.Vertex.z);
+					const XMVECTOR u = (sX * pX + sY * pY + sZ * pZ) * inverseDeterminant;
+
+					const XMVECTOR qX = sY * edge1Z - sZ * edge1Y;
+					const XMVECTOR qY = sZ * edge1X - sX * edge1Z;
+					const XMVECTOR qZ = sX * edge1Y - sY * edge1X;
+					const XMVECTOR v = (packet.DirectionX * qX + packet.DirectionY * qY + packet.DirectionZ * qZ) * inverseDeterminant;
+					const XMVECTOR distance = (edge2X * qX + edge2Y * qY + edge2Z * qZ) * inverseDeterminant;
+
+					XMVECTOR hit = XMVectorGreaterOrEqual(XMVectorAbs(determinant), XMVectorReplicate(1e-12f));
+					hit = XMVectorAndInt(hit, XMVectorGreaterOrEqual(u, zero));
+					hit = XMVectorAndInt(hit, XMVectorGreaterOrEqual(v, zero));
+					hit = XMVectorAndInt(hit, XMVectorLessOrEqual(u + v, XMVectorSplatOne()));
+					hit = XMVectorAndInt(hit, XMVectorGreater(distance, zero));
+					hit = XMVectorAndInt(hit, XMVectorLess(distance, packet.MaxDistance));
+					hit = XMVectorAndInt(hit, active);
+
+					occluded = XMVectorOrInt(occluded, hit);
+					active = XMVectorAndCInt(active, hit);
+				}
+
+				if (XMVector4EqualInt(active, XMVectorFalseInt()))
+				{
+					break;
+				}
+			}
+			else
+			{
+				// Any hit ends a ray's query, so children are visited in order without sorting.
+				const uint32_t left = node.FirstChildOrTriangle;
+				const bool visitLeft = intersectBounds(mNodes[left]);
+				const bool visitRight = intersectBounds(mNodes[left + 1]);
+				if (visitLeft && visitRight)
+				{
+					assert(stackSize < MaxDepth);
+					stack[stackSize++] = left + 1;
+					nodeIndex = left;
+					continue;
+				}
+
+				if (visitLeft || visitRight)
+				{
+					nodeIndex = (visitLeft ? left : left + 1);
+					continue;
+				}
+			}
+
+			if (stackSize == 0)
+			{
+				break;
+			}
+
+			nodeIndex = stack[--stackSize];
+		}
+
+		uint32_t lanes[RayPacket::Size];
+		XMStoreInt4(lanes, occluded);
+		uint32_t mask = 0;
+		for (uint32_t lane = 0; lane < RayPacket::Size; lane++)
+		{
+			mask |= (lanes[lane] != 0 ? 1U << lane : 0U);
+		}
+
+		return mask;
+	}
+
+	template <bool AnyHit>
+	bool TriangleBvh::Traverse(const Ray& ray, RayHit& hit) const
+	{
+		if (mNodes.empty())
+		{
+			return false;
+		}
+
+		const XMFLOAT3 inverseDirection(1.0f / ray.Direction.x, 1.0f / ray.Direction.y, 1.0f / ray.Direction.z);
+		float closestDistance = ray.MaxDistance;
+
+		// Entry distance of the ray into the node's bounds, or infinity if it misses them (or enters beyond the closest hit).
+		const auto intersectBounds = [&](const Node& node)
+		{
+			const float x1 = (node.Min.x - ray.Origin.x) * inverseDirection.x;
+			const float x2 = (node.Max.x - ray.Origin.x) * inverseDirection.x;
+			const float y1 = (node.Min.y - ray.Origin.y) * inverseDirection.y;
+			const float y2 = (node.Max.y - ray.Origin.y) * inverseDirection.y;
+			const float z1 = (node.Min.z - ray.Origin.z) * inverseDirection.z;
+			const float z2 = (node.Max.z - ray.Origin.z) * inverseDirection.z;
+			const float entry = max(max(min(x1, x2), min(y1, y2)), max(min(z1, z2), 0.0f));
+			const float exit = min(min(max(x1, x2), max(y1, y2)), min(max(z1, z2), closestDistance));
+			return (entry <= exit ? entry : numeric_limits<float>::infinity());
+		};
+
+		if (intersectBounds(mNodes[0]) == numeric_limits<float>::infinity())
+		{
+			return false;
+		}
+
+		bool found = false;
+		uint32_t stack[MaxDepth];
+		uint32_t stackSize = 0;
+		uint32_t nodeIndex = 0;
+		for (;;)
+		{
+			const Node& node = mNodes[nodeIndex];
+			if (node.TriangleCount > 0)
+			{
+				for (uint32_t i = node.FirstChildOrTriangle; i < node.FirstChildOrTriangle + node.TriangleCount; i++)
+				{
+					// Moller-Trumbore; triangles are two-sided.
+					const Triangle& triangle = mTriangles[i];
+					const XMFLOAT3 p = Cross(ray.Direction, triangle.Edge2);
+					const float determinant = Dot(triangle.Edge1, p);
+					if (fabs(determinant) < 1e-12f)
+					{
+						continue;
+					}
+
+					const float inverseDeterminant = 1.0f / determinant;
+					const XMFLOAT3 s = Subtract(ray.Origin, triangle.Vertex);
+					const float u = Dot(s, p) * inverseDeterminant;
+					if (u < 0.0f || u > 1.0f)
+					{
+						continue;
+					}
+
+					const XMFLOAT3 q = Cross(s, triangle.Edge1);
+					const float v = Dot(ray.Direction, q) * inverseDeterminant;
+					if (v < 0.0f || u + v > 1.0f)
+					{
+						continue;
+					}
+
+					const float distance = Dot(triangle.Edge2, q) * inverseDeterminant;
+					if (distance > 0.0f && distance < closestDistance)
+					{
+						if (AnyHit)
+						{
+							return true;
+						}
+
+						closestDistance = distance;
+						hit = { distance, mTriangleIndices[i], u, v };
+						found = true;
+					}
+				}
+			}
+			else
+			{
+				// Visit the nearer child first; the other is deferred.
+				const uint32_t left = node.FirstChildOrTriangle;
+				const float leftDistance = intersectBounds(mNodes[left]);
+				const float rightDistance = intersectBounds(mNodes[left + 1]);
+				const bool visitLeft = (leftDistance != numeric_limits<float>::infinity());
+				const bool visitRight = (rightDistance != numeric_limits<float>::infinity());
+				if (visitLeft && visitRight)
+				{
+					const bool leftFirst = (leftDistance <= rightDistance);
+					assert(stackSize < MaxDepth);
+					stack[stackSize++] = (leftFirst ? left + 1 : left);
+					nodeIndex = (leftFirst ? left : left + 1);
+					continue;
+				}
+
+				if (visitLeft || visitRight)
+				{
+					nodeIndex = (visitLeft ? left : left + 1);
+					continue;
+				}
+			}
+
+			if (stackSize == 0)
+			{
+				break;
+			}
+
+			nodeIndex = stack[--stackSize];
+		}
+
+		return found;
+	}
+}
\ No newline at end of file
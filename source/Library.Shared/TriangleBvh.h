@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+
+namespace Library
+{
+	struct Ray final
+	{
+		DirectX::XMFLOAT3 Origin;
+		DirectX::XMFLOAT3 Direction;
+		float MaxDistance;
+	};
+
+	struct RayHit final
+	{
+		float Distance;
+		std::uint32_t Triangle;
+		float U; // Barycentric weight of the triangle's second vertex
+		float V; // Barycentric weight of the triangle's third vertex
+	};
+
+	// Four rays in structure-of-arrays form, one per vector lane, for the SIMD queries.
+	struct RayPacket final
+	{
+		DirectX::XMVECTOR OriginX;
+		DirectX::XMVECTOR OriginY;
+		DirectX::XMVECTOR OriginZ;
+		DirectX::XMVECTOR DirectionX;
+		DirectX::XMVECTOR DirectionY;
+		DirectX::XMVECTOR DirectionZ;
+		DirectX::XMVECTOR MaxDistance;
+
+		inline static const std::uint32_t Size{ 4 };
+	};
+
+	// Bounding volume hierarchy over world-space triangles, built with a binned surface area heuristic. The
+	// queries are read-only and may run concurrently.
+	class TriangleBvh final
+	{
+	public:
+		explicit TriangleBvh(const std::vector<DirectX::XMFLOAT3>& triangleVertices);
+		TriangleBvh(const TriangleBvh&) = default;
+		TriangleBvh(TriangleBvh&&) = default;
+		TriangleBvh& operator=(const TriangleBvh&) = default;
+		TriangleBvh& operator=(TriangleBvh&&) = default;
+		~TriangleBvh() = default;
+
+		std::uint32_t TriangleCount() const;
+		std::uint32_t NodeCount() const;
+
+		// Closest hit within the ray's maximum distance; Triangle indexes the constructor's triangle list.
+		bool Intersect(const Ray& ray, RayHit& hit) const;
+
+		// Any hit within the ray's maximum distance (for shadow rays).
+		bool Occluded(const Ray& ray) const;
+
+		// Any-hit query for four rays at once; bit i of the result is set if ray i is occluded. The packet
+		// descends into a node if any of its unoccluded rays enters it, so rays with nearby origins and similar
+		// directions (such as hemisphere samples around one point) share most of their traversal.
+		std::uint32_t Occluded(const RayPacket& packet) const;
+
+		inline static const std::uint32_t BinCount{ 16 };
+		inline static const std::uint32_t MaxLeafSize{ 4 };
+		inline static const std::uint32_t MaxDepth{ 64 };
+
+	private:
+		// Interior nodes store the index of their first child (the second follows it); leaves store their first
+		// triangle and a non-zero triangle count.
+		struct Node final
+		{
+			DirectX::XMFLOAT3 Min;
+			std::uint32_t FirstChildOrTriangle;
+			DirectX::XMFLOAT3 Max;
+			std::uint32_t TriangleCount;
+		};
+
+		// Precomputed for the Moller-Trumbore test.
+		struct Triangle final
+		{
+			DirectX::XMFLOAT3 Vertex;
+			DirectX::XMFLOAT3 Edge1;
+			DirectX::XMFLOAT3 Edge2;
+		};
+
+		template <bool AnyHit>
+		bool Traverse(const Ray& ray, RayHit& hit) const;
+
+		std::vector<Node> mNodes;
+		std::vector<Triangle> mTriangles;
+		std::vector<std::uint32_t> mTriangleIndices;
+	};
+}
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "VertexDeclarations.h"
 #include "GameException.h"
 #include "Mesh.h"
+#include <execution>
 
 using namespace std;
 using namespace gsl;
@@ -9,102 +10,203 @@ using namespace DirectX;
 
 namespace Library
 {
-	void VertexPosition::CreateVertexBuffer(not_null<ID3D11Device*> device, const Mesh& mesh, not_null<ID3D11Buffer**> vertexBuffer)
+	namespace
 	{
-		const vector<XMFLOAT3>& sourceVertices = mesh.Vertices();
+		const size_t WriteBlockSize{ 1 << 16 };
+
+		// Invokes writeBlock(begin, end) over the vertex range; meshes larger than one block are written in parallel.
+		template <typename WriteBlockFunc>
+		void ForEachVertexBlock(size_t vertexCount, WriteBlockFunc writeBlock)
+		{
+			if (vertexCount <= WriteBlockSize)
+			{
+				writeBlock(size_t(0), vertexCount);
+				return;
+			}
+
+			vector<size_t> blocks((vertexCount + WriteBlockSize - 1) / WriteBlockSize);
+			for (size_t i = 0; i < blocks.size(); ++i)
+			{
+				blocks[i] = i * WriteBlockSize;
+			}
+
+			for_each(execution::par, blocks.begin(), blocks.end(), [&](size_t begin)
+			{
+				writeBlock(begin, min(begin + WriteBlockSize, vertexCount));
+			});
+		}
 
-		vector<VertexPosition> vertices;
-		vertices.reserve(sourceVertices.size());
+		// Expands packed XMFLOAT3 positions to XMFLOAT4 (w = 1) at the given destination stride. Four positions are
+		// read with three unaligned loads and rearranged in registers.
+		void WritePositions(const XMFLOAT3* source, size_t count, XMFLOAT4* destination, size_t destinationStride)
+		{
+			auto destinationAt = [destination, destinationStride](size_t index)
+			{
+				return reinterpret_cast<XMFLOAT4*>(reinterpret_cast<uint8_t*>(destination) + index * destinationStride);
+			};
+
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				const float* packed = &source[i].x;
+				const XMVECTOR a = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(packed));     // x0 y0 z0 x1
+				const XMVECTOR b = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(packed + 4)); // y1 z1 x2 y2
+				const XMVECTOR c = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(packed + 8)); // z2 x3 y3 z3
+
+				XMStoreFloat4(destinationAt(i), XMVectorSelect(a, g_XMOne, g_XMSelect0001));
+				XMStoreFloat4(destinationAt(i + 1), XMVectorSelect(XMVectorPermute<3, 4, 5, 5>(a, b), g_XMOne, g_XMSelect0001));
+				XMStoreFloat4(destinationAt(i + 2), XMVectorSelect(XMVectorPermute<2, 3, 4, 4>(b, c), g_XMOne, g_XMSelect0001));
+				XMStoreFloat4(destinationAt(i + 3), XMVectorSelect(XMVectorSwizzle<1, 2, 3, 3>(c), g_XMOne, g_XMSelect0001));
+			}
+
+			for (; i < count; ++i)
+			{
+				*destinationAt(i) = XMFLOAT4(source[i].x, source[i].y, source[i].z, 1.0f);
+			}
+		}
 
-		for (size_t i = 0; i < sourceVertices.size(); i++)
+		template <typename T>
+		void ValidateDestination(const Mesh& mesh, const span<T>& destination)
 		{
-			const XMFLOAT3& position = sourceVertices.at(i);
-			vertices.emplace_back(XMFLOAT4(position.x, position.y, position.z, 1.0f));
+			if (static_cast<size_t>(destination.size()) < mesh.Vertices().size())
+			{
+				throw GameException("Vertex destination is smaller than the mesh.");
+			}
 		}
 
-		VertexDeclaration::CreateVertexBuffer(device, vertices, vertexBuffer);
+		// Builds the vertices in a per-thread scratch buffer that is reused across calls, so that loading many
+		// meshes does not allocate per mesh. The scratch buffer keeps the capacity of the largest mesh built on the thread.
+		template <typename T>
+		void CreateVertexBufferFromMesh(not_null<ID3D11Device*> device, const Mesh& mesh, not_null<ID3D11Buffer**> vertexBuffer)
+		{
+			thread_local vector<uint8_t> scratch;
+
+			const size_t vertexCount = mesh.Vertices().size();
+			scratch.resize(T::VertexBufferByteWidth(vertexCount));
+			const span<T> vertices(reinterpret_cast<T*>(scratch.data()), vertexCount);
+
+			T::WriteVertices(mesh, vertices);
+			T::CreateVertexBuffer(device, span<const T>(vertices), vertexBuffer);
+		}
 	}
 
-	void VertexPositionColor::CreateVertexBuffer(not_null<ID3D11Device*> device, const Mesh& mesh, not_null<ID3D11Buffer**> vertexBuffer)
+	void VertexPosition::WriteVertices(const Mesh& mesh, const span<VertexPosition>& destination)
 	{
+		ValidateDestination(mesh, destination);
 		const vector<XMFLOAT3>& sourceVertices = mesh.Vertices();
 
-		vector<VertexPositionColor> vertices;
-		vertices.reserve(sourceVertices.size());
+		VertexPosition* vertices = destination.data();
+		ForEachVertexBlock(sourceVertices.size(), [&](size_t begin, size_t end)
+		{
+			WritePositions(&sourceVertices[begin], end - begin, &vertices[begin].Position, sizeof(VertexPosition));
+		});
+	}
+
+	void VertexPosition::CreateVertexBuffer(not_null<ID3D11Device*> device, const Mesh& mesh, not_null<ID3D11Buffer**> vertexBuffer)
+	{
+		CreateVertexBufferFromMesh<VertexPosition>(device, mesh, vertexBuffer);
+	}
+
+	void VertexPositionColor::WriteVertices(const Mesh& mesh, const span<VertexPositionColor>& destination)
+	{
+		ValidateDestination(mesh, destination);
+		const vector<XMFLOAT3>& sourceVertices = mesh.Vertices();
 
 		assert(mesh.VertexColors().size() > 0);
 		const vector<XMFLOAT4>& vertexColors = mesh.VertexColors().at(0);
 		assert(vertexColors.size() == sourceVertices.size());
 
-		for (size_t i = 0; i < sourceVertices.size(); i++)
+		VertexPositionColor* vertices = destination.data();
+		ForEachVertexBlock(sourceVertices.size(), [&](size_t begin, size_t end)
 		{
-			const XMFLOAT3& position = sourceVertices.at(i);
-			const XMFLOAT4& color = vertexColors.at(i);
-			vertices.emplace_back(XMFLOAT4(position.x, position.y, position.z, 1.0f), color);
-		}
+			WritePositions(&sourceVertices[begin], end - begin, &vertices[begin].Position, sizeof(VertexPositionColor));
+			for (size_t i = begin; i < end; ++i)
+			{
+				vertices[i].Color = vertexColors[i];
+			}
+		});
+	}
 
-		VertexDeclaration::CreateVertexBuffer(device, vertices, vertexBuffer);
+	void VertexPositionColor::CreateVertexBuffer(not_null<ID3D11Device*> device, const Mesh& mesh, not_null<ID3D11Buffer**> vertexBuffer)
+	{
+		CreateVertexBufferFromMesh<VertexPositionColor>(device, mesh, vertexBuffer);
 	}
 
-	void VertexPositionTexture::CreateVertexBuffer(not_null<ID3D11Device*> device, const Mesh& mesh, not_null<ID3D11Buffer**> vertexBuffer)
+	void VertexPositionTexture::WriteVertices(const Mesh& mesh, const span<VertexPositionTexture>& destination)
 	{
+		ValidateDestination(mesh, destination);
 		const vector<XMFLOAT3>& sourceVertices = mesh.Vertices();
 		const vector<XMFLOAT3>& textureCoordinates = mesh.TextureCoordinates().at(0);
 		assert(textureCoordinates.size() == sourceVertices.size());
 
-		vector<VertexPositionTexture> vertices;
-		vertices.reserve(sourceVertices.size());
-		for (size_t i = 0; i < sourceVertices.size(); i++)
+		VertexPositionTexture* vertices = destination.data();
+		ForEachVertexBlock(sourceVertices.size(), [&](size_t begin, size_t end)
 		{
-			const XMFLOAT3& position = sourceVertices.at(i);
-			const XMFLOAT3& uv = textureCoordinates.at(i);
-			vertices.emplace_back(XMFLOAT4(position.x, position.y, position.z, 1.0f), XMFLOAT2(uv.x, uv.y));
-		}
+			WritePositions(&sourceVertices[begin], end - begin, &vertices[begin].Position, sizeof(VertexPositionTexture));
+			for (size_t i = begin; i < end; ++i)
+			{
+				vertices[i].TextureCoordinates = XMFLOAT2(textureCoordinates[i].x, textureCoordinates[i].y);
+			}
+		});
+	}
 
-		VertexDeclaration::CreateVertexBuffer(device, vertices, vertexBuffer);
+	void VertexPositionTexture::CreateVertexBuffer(not_null<ID3D11Device*> device, const Mesh& mesh, not_null<ID3D11Buffer**> vertexBuffer)
+	{
+		CreateVertexBufferFromMesh<VertexPositionTexture>(device, mesh, vertexBuffer);
 	}
 
-	void VertexPositionNormal::CreateVertexBuffer(not_null<ID3D11Device*> device, const Mesh& mesh, not_null<ID3D11Buffer**> vertexBuffer)
+	void VertexPositionNormal::WriteVertices(const Mesh& mesh, const span<VertexPositionNormal>& destination)
 	{
+		ValidateDestination(mesh, destination);
 		const vector<XMFLOAT3>& sourceVertices = mesh.Vertices();
 		const vector<XMFLOAT3>& sourceNormals = mesh.Normals();
 		assert(sourceNormals.size() == sourceVertices.size());
 
-		vector<VertexPositionNormal> vertices;
-		vertices.reserve(sourceVertices.size());
-		for (size_t i = 0; i < sourceVertices.size(); i++)
+		VertexPositionNormal* vertices = destination.data();
+		ForEachVertexBlock(sourceVertices.size(), [&](size_t begin, size_t end)
 		{
-			const XMFLOAT3& position = sourceVertices.at(i);
-			const XMFLOAT3& normal = sourceNormals.at(i);
-			vertices.emplace_back(XMFLOAT4(position.x, position.y, position.z, 1.0f), normal);
-		}
+			WritePositions(&sourceVertices[begin], end - begin, &vertices[begin].Position, sizeof(VertexPositionNormal));
+			for (size_t i = begin; i < end; ++i)
+			{
+				vertices[i].Normal = sourceNormals[i];
+			}
+		});
+	}
 
-		VertexDeclaration::CreateVertexBuffer(device, vertices, vertexBuffer);
+	void VertexPositionNormal::CreateVertexBuffer(not_null<ID3D11Device*> device, const Mesh& mesh, not_null<ID3D11Buffer**> vertexBuffer)
+	{
+		CreateVertexBufferFromMesh<VertexPositionNormal>(device, mesh, vertexBuffer);
 	}
 
-	void VertexPositionTextureNormal::CreateVertexBuffer(not_null<ID3D11Device*> device, const Mesh& mesh, not_null<ID3D11Buffer**> vertexBuffer)
+	void VertexPositionTextureNormal::WriteVertices(const Mesh& mesh, const span<VertexPositionTextureNormal>& destination)
 	{
+		ValidateDestination(mesh, destination);
 		const vector<XMFLOAT3>& sourceVertices = mesh.Vertices();
 		const auto& sourceUVs = mesh.TextureCoordinates().at(0);
 		assert(sourceUVs.size() == sourceVertices.size());
 		const auto& sourceNormals = mesh.Normals();
 		assert(sourceNormals.size() == sourceVertices.size());
 
-		vector<VertexPositionTextureNormal> vertices;
-		vertices.reserve(sourceVertices.size());
-		for (size_t i = 0; i < sourceVertices.size(); i++)
+		VertexPositionTextureNormal* vertices = destination.data();
+		ForEachVertexBlock(sourceVertices.size(), [&](size_t begin, size_t end)
 		{
-			const XMFLOAT3& position = sourceVertices.at(i);
-			const XMFLOAT3& uv = sourceUVs.at(i);
-			const XMFLOAT3& normal = sourceNormals.at(i);
-			vertices.emplace_back(XMFLOAT4(position.x, position.y, position.z, 1.0f), XMFLOAT2(uv.x, uv.y), normal);
-		}
+			WritePositions(&sourceVertices[begin], end - begin, &vertices[begin].Position, sizeof(VertexPositionTextureNormal));
+			for (size_t i = begin; i < end; ++i)
+			{
+				vertices[i].TextureCoordinates = XMFLOAT2(sourceUVs[i].x, sourceUVs[i].y);
+				vertices[i].Normal = sourceNormals[i];
+			}
+		});
+	}
 
-		VertexDeclaration::CreateVertexBuffer(device, vertices, vertexBuffer);
+	void VertexPositionTextureNormal::CreateVertexBuffer(not_null<ID3D11Device*> device, const Mesh& mesh, not_null<ID3D11Buffer**> vertexBuffer)
+	{
+		CreateVertexBufferFromMesh<VertexPositionTextureNormal>(device, mesh, vertexBuffer);
 	}
 
-	void VertexPositionTextureNormalTangent::CreateVertexBuffer(not_null<ID3D11Device*> device, const Mesh& mesh, not_null<ID3D11Buffer**> vertexBuffer)
+	void VertexPositionTextureNormalTangent::WriteVertices(const Mesh& mesh, const span<VertexPositionTextureNormalTangent>& destination)
 	{
+		ValidateDestination(mesh, destination);
 		const vector<XMFLOAT3>& sourceVertices = mesh.Vertices();
 		const auto& sourceUVs = mesh.TextureCoordinates().at(0);
 		assert(sourceUVs.size() == sourceVertices.size());
@@ -113,17 +215,21 @@ namespace Library
 		const auto& sourceTangents = mesh.Tangents();
 		assert(sourceTangents.size() == sourceVertices.size());
 
-		vector<VertexPositionTextureNormalTangent> vertices;
-		vertices.reserve(sourceVertices.size());
-		for (size_t i = 0; i < sourceVertices.size(); i++)
+		VertexPositionTextureNormalTangent* vertices = destination.data();
+		ForEachVertexBlock(sourceVertices.size(), [&](size_t begin, size_t end)
 		{
-			const XMFLOAT3& position = sourceVertices.at(i);
-			const XMFLOAT3& uv = sourceUVs.at(i);
-			const XMFLOAT3& normal = sourceNormals.at(i);
-			const XMFLOAT3& tangent = sourceTangents.at(i);
-			vertices.emplace_back(XMFLOAT4(position.x, position.y, position.z, 1.0f), XMFLOAT2(uv.x, uv.y), normal, tangent);
-		}
+			WritePositions(&sourceVertices[begin], end - begin, &vertices[begin].Position, sizeof(VertexPositionTextureNormalTangent));
+			for (size_t i = begin; i < end; ++i)
+			{
+				vertices[i].TextureCoordinates = XMFLOAT2(sourceUVs[i].x, sourceUVs[i].y);
+				vertices[i].Normal = sourceNormals[i];
+				vertices[i].Tangent = sourceTangents[i];
+			}
+		});
+	}
 
-		VertexDeclaration::CreateVertexBuffer(device, vertices, vertexBuffer);
+	void VertexPositionTextureNormalTangent::CreateVertexBuffer(not_null<ID3D11Device*> device, const Mesh& mesh, not_null<ID3D11Buffer**> vertexBuffer)
+	{
+		CreateVertexBufferFromMesh<VertexPositionTextureNormalTangent>(device, mesh, vertexBuffer);
 	}
 }
\ No newline at end of file
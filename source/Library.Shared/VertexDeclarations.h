@@ -3,11 +3,15 @@
 #include <DirectXMath.h>
 #include <d3d11.h>
 #include <gsl\gsl>
+#include "VertexLayout.h"
 
 namespace Library
 {
 	class Mesh;
 
+	// Declarations that can be built from a Mesh also provide WriteVertices(mesh, destination), which writes the
+	// interleaved vertices straight into caller-owned memory (a mapped staging buffer or a reusable scratch
+	// buffer). The destination must hold at least mesh.Vertices().size() vertices.
 	template <typename T>
 	class VertexDeclaration
 	{
@@ -35,6 +39,7 @@ namespace Library
 
 		inline static const gsl::span<const D3D11_INPUT_ELEMENT_DESC> InputElements { _InputElements };
 
+		static void WriteVertices(const Library::Mesh& mesh, const gsl::span<VertexPosition>& destination);
 		static void CreateVertexBuffer(gsl::not_null<ID3D11Device*> device, const Library::Mesh& mesh, gsl::not_null<ID3D11Buffer**> vertexBuffer);
 		static void CreateVertexBuffer(gsl::not_null<ID3D11Device*> device, const gsl::span<const VertexPosition>& vertices, gsl::not_null<ID3D11Buffer**> vertexBuffer)
 		{
@@ -62,6 +67,7 @@ namespace Library
 
 		inline static const gsl::span<const D3D11_INPUT_ELEMENT_DESC> InputElements{ _InputElements };
 
+		static void WriteVertices(const Library::Mesh& mesh, const gsl::span<VertexPositionColor>& destination);
 		static void CreateVertexBuffer(gsl::not_null<ID3D11Device*> device, const Library::Mesh& mesh, gsl::not_null<ID3D11Buffer**> vertexBuffer);
 		static void CreateVertexBuffer(gsl::not_null<ID3D11Device*> device, const gsl::span<const VertexPositionColor>& vertices, gsl::not_null<ID3D11Buffer**> vertexBuffer)
 		{
@@ -69,6 +75,33 @@ namespace Library
 		}
 	};
 
+	// Compact 16-byte layout for large point sets; the color is R8G8B8A8 with red in the low byte.
+	class VertexPositionPackedColor : public VertexDeclaration<VertexPositionPackedColor>
+	{
+	private:
+		inline static const D3D11_INPUT_ELEMENT_DESC _InputElements[]
+		{
+			{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+			{ "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		};
+
+	public:
+		VertexPositionPackedColor() = default;
+
+		VertexPositionPackedColor(const DirectX::XMFLOAT3& position, std::uint32_t color) :
+			Position(position), Color(color) { }
+
+		DirectX::XMFLOAT3 Position;
+		std::uint32_t Color;
+
+		inline static const gsl::span<const D3D11_INPUT_ELEMENT_DESC> InputElements{ _InputElements };
+
+		static void CreateVertexBuffer(gsl::not_null<ID3D11Device*> device, const gsl::span<const VertexPositionPackedColor>& vertices, gsl::not_null<ID3D11Buffer**> vertexBuffer)
+		{
+			VertexDeclaration::CreateVertexBuffer(device, vertices, vertexBuffer);
+		}
+	};
+
 	class VertexPositionTexture : public VertexDeclaration<VertexPositionTexture>
 	{
 	private:
@@ -88,6 +121,7 @@ namespace Library
 
 		inline static const gsl::span<const D3D11_INPUT_ELEMENT_DESC> InputElements{ _InputElements };
 
+		static void WriteVertices(const Library::Mesh& mesh, const gsl::span<VertexPositionTexture>& destination);
 		static void CreateVertexBuffer(gsl::not_null<ID3D11Device*> device, const Library::Mesh& mesh, gsl::not_null<ID3D11Buffer**> vertexBuffer);
 		static void CreateVertexBuffer(gsl::not_null<ID3D11Device*> device, const gsl::span<const VertexPositionTexture>& vertices, gsl::not_null<ID3D11Buffer**> vertexBuffer)
 		{
@@ -142,6 +176,7 @@ namespace Library
 
 		inline static const gsl::span<const D3D11_INPUT_ELEMENT_DESC> InputElements{ _InputElements };
 
+		static void WriteVertices(const Library::Mesh& mesh, const gsl::span<VertexPositionNormal>& destination);
 		static void CreateVertexBuffer(gsl::not_null<ID3D11Device*> device, const Library::Mesh& mesh, gsl::not_null<ID3D11Buffer**> vertexBuffer);
 		static void CreateVertexBuffer(gsl::not_null<ID3D11Device*> device, const gsl::span<const VertexPositionNormal>& vertices, gsl::not_null<ID3D11Buffer**> vertexBuffer)
 		{
@@ -171,6 +206,7 @@ namespace Library
 		
 		inline static const gsl::span<const D3D11_INPUT_ELEMENT_DESC> InputElements{ _InputElements };
 
+		static void WriteVertices(const Library::Mesh& mesh, const gsl::span<VertexPositionTextureNormal>& destination);
 		static void CreateVertexBuffer(gsl::not_null<ID3D11Device*> device, const Library::Mesh& mesh, gsl::not_null<ID3D11Buffer**> vertexBuffer);
 		static void CreateVertexBuffer(gsl::not_null<ID3D11Device*> device, const gsl::span<const VertexPositionTextureNormal>& vertices, gsl::not_null<ID3D11Buffer**> vertexBuffer)
 		{
@@ -202,6 +238,7 @@ namespace Library
 
 		inline static const gsl::span<const D3D11_INPUT_ELEMENT_DESC> InputElements{ _InputElements };
 
+		static void WriteVertices(const Library::Mesh& mesh, const gsl::span<VertexPositionTextureNormalTangent>& destination);
 		static void CreateVertexBuffer(gsl::not_null<ID3D11Device*> device, const Library::Mesh& mesh, gsl::not_null<ID3D11Buffer**> vertexBuffer);		
 		static void CreateVertexBuffer(gsl::not_null<ID3D11Device*> device, const gsl::span<const VertexPositionTextureNormalTangent>& vertices, gsl::not_null<ID3D11Buffer**> vertexBuffer)
 		{
@@ -209,6 +246,23 @@ namespace Library
 		}
 	};
 
+	// 20-byte alternative to VertexPositionTextureNormal (36 bytes): half-precision texture coordinates and a signed-normalized
+	// normal. The input assembler expands the position to w = 1, so it binds to the same shaders.
+	class VertexPositionTextureNormalCompact : public ReflectedVertexDeclaration<VertexPositionTextureNormalCompact>
+	{
+	public:
+		VertexPositionTextureNormalCompact() = default;
+
+		DirectX::XMFLOAT3 Position;
+		DirectX::PackedVector::XMHALF2 TextureCoordinates;
+		DirectX::PackedVector::XMBYTEN4 Normal;
+
+		using Layout = VertexLayout<
+			VertexElement<&VertexPositionTextureNormalCompact::Position, VertexSemantic::Position>,
+			VertexElement<&VertexPositionTextureNormalCompact::TextureCoordinates, VertexSemantic::TextureCoordinate>,
+			VertexElement<&VertexPositionTextureNormalCompact::Normal, VertexSemantic::Normal>>;
+	};
+
 	class VertexSkinnedPositionTextureNormal : public VertexDeclaration<VertexSkinnedPositionTextureNormal>
 	{
 	private:
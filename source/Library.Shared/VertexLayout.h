@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include <vector>
+#include <execution>
+#include <type_traits>
+#include <d3d11.h>
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h>
+#include <gsl\gsl>
+#include "GameException.h"
+#include "Mesh.h"
+
+namespace Library
+{
+	template <typename T>
+	class VertexDeclaration;
+
+	// The Mesh attribute stream an element is read from. TextureCoordinate and Color use the element's semantic index as the channel.
+	enum class VertexSemantic
+	{
+		Position,
+		Color,
+		TextureCoordinate,
+		Normal,
+		Tangent,
+		BiNormal
+	};
+
+	template <typename T>
+	struct VertexMemberTraits;
+
+	template <typename TVertex, typename TField>
+	struct VertexMemberTraits<TField TVertex::*>
+	{
+		using VertexType = TVertex;
+		using FieldType = TField;
+	};
+
+	template <typename T>
+	struct VertexFieldTypeNotSupported : std::false_type
+	{
+	};
+
+	template <typename T>
+	constexpr DXGI_FORMAT VertexElementFormat()
+	{
+		using namespace DirectX;
+		using namespace DirectX::PackedVector;
+
+		if constexpr (std::is_same_v<T, XMFLOAT4>) return DXGI_FORMAT_R32G32B32A32_FLOAT;
+		else if constexpr (std::is_same_v<T, XMFLOAT3>) return DXGI_FORMAT_R32G32B32_FLOAT;
+		else if constexpr (std::is_same_v<T, XMFLOAT2>) return DXGI_FORMAT_R32G32_FLOAT;
+		else if constexpr (std::is_same_v<T, float>) return DXGI_FORMAT_R32_FLOAT;
+		else if constexpr (std::is_same_v<T, XMUINT4>) return DXGI_FORMAT_R32G32B32A32_UINT;
+		else if constexpr (std::is_same_v<T, XMHALF4>) return DXGI_FORMAT_R16G16B16A16_FLOAT;
+		else if constexpr (std::is_same_v<T, XMHALF2>) return DXGI_FORMAT_R16G16_FLOAT;
+		else if constexpr (std::is_same_v<T, XMSHORTN4>) return DXGI_FORMAT_R16G16B16A16_SNORM;
+		else if constexpr (std::is_same_v<T, XMSHORTN2>) return DXGI_FORMAT_R16G16_SNORM;
+		else if constexpr (std::is_same_v<T, XMUSHORTN2>) return DXGI_FORMAT_R16G16_UNORM;
+		else if constexpr (std::is_same_v<T, XMBYTEN4>) return DXGI_FORMAT_R8G8B8A8_SNORM;
+		else if constexpr (std::is_same_v<T, XMUBYTEN4>) return DXGI_FORMAT_R8G8B8A8_UNORM;
+		else if constexpr (std::is_same_v<T, XMUDECN4>) return DXGI_FORMAT_R10G10B10A2_UNORM;
+		else if constexpr (std::is_same_v<T, XMCOLOR>) return DXGI_FORMAT_B8G8R8A8_UNORM;
+		else static_assert(VertexFieldTypeNotSupported<T>::value, "Vertex field type has no DXGI format mapping.");
+	}
+
+	// One field of a vertex struct. The DXGI format is deduced from the field type; positions are read with w = 1,
+	// other three-component attributes with w = 0.
+	template <auto _Member, VertexSemantic _Semantic, std::uint32_t _SemanticIndex = 0>
+	struct VertexElement final
+	{
+		using VertexType = typename VertexMemberTraits<decltype(_Member)>::VertexType;
+		using FieldType = typename VertexMemberTraits<decltype(_Member)>::FieldType;
+
+		static constexpr VertexSemantic Semantic{ _Semantic };
+		static constexpr std::uint32_t SemanticIndex{ _SemanticIndex };
+		static constexpr DXGI_FORMAT Format{ VertexElementFormat<FieldType>() };
+
+		VertexElement() = delete;
+
+		static const char* SemanticName();
+		static std::uint32_t Offset();
+		static D3D11_INPUT_ELEMENT_DESC InputElement();
+
+		// Throws if the mesh lacks the attribute stream this element reads.
+		static void Validate(const Mesh& mesh);
+
+		// Converts vertices [begin, end) of the mesh stream into the field.
+		static void Write(const Mesh& mesh, VertexType* vertices, std::size_t begin, std::size_t end);
+	};
+
+	// Reflects a vertex struct from its element list. Everything a vertex declaration needs is generated from the
+	// list: the input element descriptions, the stride, a Mesh converter with one tight loop per element (no
+	// per-vertex dispatch), and a hash of the layout for use in cache keys.
+	//
+	// Usage:
+	//	class VertexCompact : public ReflectedVertexDeclaration<VertexCompact>
+	//	{
+	//	public:
+	//		DirectX::XMFLOAT3 Position;
+	//		DirectX::PackedVector::XMBYTEN4 Normal;
+	//
+	//		using Layout = VertexLayout<VertexElement<&VertexCompact::Position, VertexSemantic::Position>, VertexElement<&VertexCompact::Normal, VertexSemantic::Normal>>;
+	//	};
+	template <typename TFirstElement, typename... TElements>
+	class VertexLayout final
+	{
+	public:
+		using VertexType = typename TFirstElement::VertexType;
+		static_assert((std::is_same_v<typename TElements::VertexType, VertexType> && ...), "All elements of a vertex layout must belong to the same vertex type.");
+
+		static constexpr std::uint32_t Stride{ gsl::narrow_cast<std::uint32_t>(sizeof(VertexType)) };
+		static constexpr std::size_t ElementCount{ 1 + sizeof...(TElements) };
+
+		VertexLayout() = delete;
+
+		static const std::array<D3D11_INPUT_ELEMENT_DESC, ElementCount>& InputElements();
+		static std::uint64_t Hash();
+
+		static void Validate(const Mesh& mesh);
+
+		// Meshes larger than WriteBlockSize vertices are converted in parallel blocks.
+		static void WriteVertices(const Mesh& mesh, const gsl::span<VertexType>& destination);
+
+		inline static const std::size_t WriteBlockSize{ 1 << 16 };
+	};
+
+	// Base class for vertex declarations described by a nested Layout type (see VertexLayout).
+	template <typename T>
+	class ReflectedVertexDeclaration : public VertexDeclaration<T>
+	{
+	public:
+		inline static const gsl::span<const D3D11_INPUT_ELEMENT_DESC> InputElements{ T::Layout::InputElements() };
+
+		static std::uint64_t LayoutHash();
+		static void WriteVertices(const Mesh& mesh, const gsl::span<T>& destination);
+		static void CreateVertexBuffer(gsl::not_null<ID3D11Device*> device, const Mesh& mesh, gsl::not_null<ID3D11Buffer**> vertexBuffer);
+		static void CreateVertexBuffer(gsl::not_null<ID3D11Device*> device, const gsl::span<const T>& vertices, gsl::not_null<ID3D11Buffer**> vertexBuffer);
+	};
+}
+
+#include "VertexLayout.inl"
\ No newline at end of file
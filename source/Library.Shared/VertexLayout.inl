@@ -0,0 +1,229 @@
+namespace Library
+{
+#pragma region Attribute Stores
+	inline void StoreVertexAttribute(DirectX::XMFLOAT4& field, DirectX::FXMVECTOR value) { DirectX::XMStoreFloat4(&field, value); }
+	inline void StoreVertexAttribute(DirectX::XMFLOAT3& field, DirectX::FXMVECTOR value) { DirectX::XMStoreFloat3(&field, value); }
+	inline void StoreVertexAttribute(DirectX::XMFLOAT2& field, DirectX::FXMVECTOR value) { DirectX::XMStoreFloat2(&field, value); }
+	inline void StoreVertexAttribute(float& field, DirectX::FXMVECTOR value) { field = DirectX::XMVectorGetX(value); }
+	inline void StoreVertexAttribute(DirectX::XMUINT4& field, DirectX::FXMVECTOR value) { DirectX::XMStoreUInt4(&field, DirectX::XMConvertVectorFloatToUInt(value, 0)); }
+	inline void StoreVertexAttribute(DirectX::PackedVector::XMHALF4& field, DirectX::FXMVECTOR value) { DirectX::PackedVector::XMStoreHalf4(&field, value); }
+	inline void StoreVertexAttribute(DirectX::PackedVector::XMHALF2& field, DirectX::FXMVECTOR value) { DirectX::PackedVector::XMStoreHalf2(&field, value); }
+	inline void StoreVertexAttribute(DirectX::PackedVector::XMSHORTN4& field, DirectX::FXMVECTOR value) { DirectX::PackedVector::XMStoreShortN4(&field, value); }
+	inline void StoreVertexAttribute(DirectX::PackedVector::XMSHORTN2& field, DirectX::FXMVECTOR value) { DirectX::PackedVector::XMStoreShortN2(&field, value); }
+	inline void StoreVertexAttribute(DirectX::PackedVector::XMUSHORTN2& field, DirectX::FXMVECTOR value) { DirectX::PackedVector::XMStoreUShortN2(&field, value); }
+	inline void StoreVertexAttribute(DirectX::PackedVector::XMBYTEN4& field, DirectX::FXMVECTOR value) { DirectX::PackedVector::XMStoreByteN4(&field, value); }
+	inline void StoreVertexAttribute(DirectX::PackedVector::XMUBYTEN4& field, DirectX::FXMVECTOR value) { DirectX::PackedVector::XMStoreUByteN4(&field, value); }
+	inline void StoreVertexAttribute(DirectX::PackedVector::XMUDECN4& field, DirectX::FXMVECTOR value) { DirectX::PackedVector::XMStoreUDecN4(&field, value); }
+	inline void StoreVertexAttribute(DirectX::PackedVector::XMCOLOR& field, DirectX::FXMVECTOR value) { DirectX::PackedVector::XMStoreColor(&field, value); }
+#pragma endregion
+
+#pragma region VertexElement
+	template <auto _Member, VertexSemantic _Semantic, std::uint32_t _SemanticIndex>
+	inline const char* VertexElement<_Member, _Semantic, _SemanticIndex>::SemanticName()
+	{
+		if constexpr (_Semantic == VertexSemantic::Position) return "POSITION";
+		else if constexpr (_Semantic == VertexSemantic::Color) return "COLOR";
+		else if constexpr (_Semantic == VertexSemantic::TextureCoordinate) return "TEXCOORD";
+		else if constexpr (_Semantic == VertexSemantic::Normal) return "NORMAL";
+		else if constexpr (_Semantic == VertexSemantic::Tangent) return "TANGENT";
+		else return "BINORMAL";
+	}
+
+	template <auto _Member, VertexSemantic _Semantic, std::uint32_t _SemanticIndex>
+	inline std::uint32_t VertexElement<_Member, _Semantic, _SemanticIndex>::Offset()
+	{
+		static const VertexType vertex{};
+		return gsl::narrow_cast<std::uint32_t>(reinterpret_cast<const std::uint8_t*>(&(vertex.*_Member)) - reinterpret_cast<const std::uint8_t*>(&vertex));
+	}
+
+	template <auto _Member, VertexSemantic _Semantic, std::uint32_t _SemanticIndex>
+	inline D3D11_INPUT_ELEMENT_DESC VertexElement<_Member, _Semantic, _SemanticIndex>::InputElement()
+	{
+		return { SemanticName(), SemanticIndex, Format, 0, Offset(), D3D11_INPUT_PER_VERTEX_DATA, 0 };
+	}
+
+	template <auto _Member, VertexSemantic _Semantic, std::uint32_t _SemanticIndex>
+	void VertexElement<_Member, _Semantic, _SemanticIndex>::Validate(const Mesh& mesh)
+	{
+		const std::size_t vertexCount = mesh.Vertices().size();
+		std::size_t sourceCount;
+
+		if constexpr (_Semantic == VertexSemantic::Position) sourceCount = vertexCount;
+		else if constexpr (_Semantic == VertexSemantic::Normal) sourceCount = mesh.Normals().size();
+		else if constexpr (_Semantic == VertexSemantic::Tangent) sourceCount = mesh.Tangents().size();
+		else if constexpr (_Semantic == VertexSemantic::BiNormal) sourceCount = mesh.BiNormals().size();
+		else if constexpr (_Semantic == VertexSemantic::TextureCoordinate) sourceCount = (_SemanticIndex < mesh.TextureCoordinates().size() ? mesh.TextureCoordinates()[_SemanticIndex].size() : 0);
+		else sourceCount = (_SemanticIndex < mesh.VertexColors().size() ? mesh.VertexColors()[_SemanticIndex].size() : 0);
+
+		if (sourceCount != vertexCount)
+		{
+			throw GameException("Mesh does not provide every attribute required by the vertex layout.");
+		}
+	}
+
+	template <auto _Member, VertexSemantic _Semantic, std::uint32_t _SemanticIndex>
+	void VertexElement<_Member, _Semantic, _SemanticIndex>::Write(const Mesh& mesh, VertexType* vertices, std::size_t begin, std::size_t end)
+	{
+		using namespace DirectX;
+
+		if constexpr (_Semantic == VertexSemantic::Color)
+		{
+			const std::vector<XMFLOAT4>& source = mesh.VertexColors()[_SemanticIndex];
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				if constexpr (std::is_same_v<FieldType, XMFLOAT4>)
+				{
+					vertices[i].*_Member = source[i];
+				}
+				else
+				{
+					StoreVertexAttribute(vertices[i].*_Member, XMLoadFloat4(&source[i]));
+				}
+			}
+		}
+		else
+		{
+			const std::vector<XMFLOAT3>* source;
+			if constexpr (_Semantic == VertexSemantic::Position) source = &mesh.Vertices();
+			else if constexpr (_Semantic == VertexSemantic::Normal) source = &mesh.Normals();
+			else if constexpr (_Semantic == VertexSemantic::Tangent) source = &mesh.Tangents();
+			else if constexpr (_Semantic == VertexSemantic::BiNormal) source = &mesh.BiNormals();
+			else source = &mesh.TextureCoordinates()[_SemanticIndex];
+
+			const XMFLOAT3* sourceData = source->data();
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				if constexpr (std::is_same_v<FieldType, XMFLOAT3>)
+				{
+					vertices[i].*_Member = sourceData[i];
+				}
+				else if constexpr (_Semantic == VertexSemantic::Position)
+				{
+					StoreVertexAttribute(vertices[i].*_Member, XMVectorSetW(XMLoadFloat3(&sourceData[i]), 1.0f));
+				}
+				else
+				{
+					StoreVertexAttribute(vertices[i].*_Member, XMLoadFloat3(&sourceData[i]));
+				}
+			}
+		}
+	}
+#pragma endregion
+
+#pragma region VertexLayout
+	template <typename TFirstElement, typename... TElements>
+	const std::array<D3D11_INPUT_ELEMENT_DESC, VertexLayout<TFirstElement, TElements...>::ElementCount>& VertexLayout<TFirstElement, TElements...>::InputElements()
+	{
+		static const std::array<D3D11_INPUT_ELEMENT_DESC, ElementCount> inputElements{ TFirstElement::InputElement(), TElements::InputElement()... };
+		return inputElements;
+	}
+
+	template <typename TFirstElement, typename... TElements>
+	std::uint64_t VertexLayout<TFirstElement, TElements...>::Hash()
+	{
+		// FNV-1a over the stride and every field of the input element descriptions.
+		static const std::uint64_t hash = []
+		{
+			std::uint64_t value = 14695981039346656037ULL;
+			auto combine = [&value](const void* data, std::size_t size)
+			{
+				const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(data);
+				for (std::size_t i = 0; i < size; ++i)
+				{
+					value = (value ^ bytes[i]) * 1099511628211ULL;
+				}
+			};
+
+			combine(&Stride, sizeof(Stride));
+			for (const D3D11_INPUT_ELEMENT_DESC& inputElement : InputElements())
+			{
+				combine(inputElement.SemanticName, std::strlen(inputElement.SemanticName) + 1);
+				combine(&inputElement.SemanticIndex, sizeof(inputElement.SemanticIndex));
+				combine(&inputElement.Format, sizeof(inputElement.Format));
+				combine(&inputElement.AlignedByteOffset, sizeof(inputElement.AlignedByteOffset));
+			}
+
+			return value;
+		}();
+
+		return hash;
+	}
+
+	template <typename TFirstElement, typename... TElements>
+	inline void VertexLayout<TFirstElement, TElements...>::Validate(const Mesh& mesh)
+	{
+		TFirstElement::Validate(mesh);
+		(TElements::Validate(mesh), ...);
+	}
+
+	template <typename TFirstElement, typename... TElements>
+	void VertexLayout<TFirstElement, TElements...>::WriteVertices(const Mesh& mesh, const gsl::span<VertexType>& destination)
+	{
+		const std::size_t vertexCount = mesh.Vertices().size();
+		if (static_cast<std::size_t>(destination.size()) < vertexCount)
+		{
+			throw GameException("Vertex destination is smaller than the mesh.");
+		}
+
+		Validate(mesh);
+
+		VertexType* vertices = destination.data();
+		auto writeBlock = [&mesh, vertices](std::size_t begin, std::size_t end)
+		{
+			TFirstElement::Write(mesh, vertices, begin, end);
+			(TElements::Write(mesh, vertices, begin, end), ...);
+		};
+
+		if (vertexCount <= WriteBlockSize)
+		{
+			writeBlock(0, vertexCount);
+			return;
+		}
+
+		std::vector<std::size_t> blocks((vertexCount + WriteBlockSize - 1) / WriteBlockSize);
+		for (std::size_t i = 0; i < blocks.size(); ++i)
+		{
+			blocks[i] = i * WriteBlockSize;
+		}
+
+		std::for_each(std::execution::par, blocks.begin(), blocks.end(), [&](std::size_t begin)
+		{
+			writeBlock(begin, std::min(begin + WriteBlockSize, vertexCount));
+		});
+	}
+#pragma endregion
+
+#pragma region ReflectedVertexDeclaration
+	template <typename T>
+	inline std::uint64_t ReflectedVertexDeclaration<T>::LayoutHash()
+	{
+		return T::Layout::Hash();
+	}
+
+	template <typename T>
+	inline void ReflectedVertexDeclaration<T>::WriteVertices(const Mesh& mesh, const gsl::span<T>& destination)
+	{
+		T::Layout::WriteVertices(mesh, destination);
+	}
+
+	template <typename T>
+	void ReflectedVertexDeclaration<T>::CreateVertexBuffer(gsl::not_null<ID3D11Device*> device, const Mesh& mesh, gsl::not_null<ID3D11Buffer**> vertexBuffer)
+	{
+		// Reused across calls so that loading many meshes does not allocate per mesh.
+		thread_local std::vector<T> scratch;
+
+		const std::size_t vertexCount = mesh.Vertices().size();
+		scratch.resize(vertexCount);
+		const gsl::span<T> vertices(scratch.data(), vertexCount);
+
+		WriteVertices(mesh, vertices);
+		VertexDeclaration<T>::CreateVertexBuffer(device, gsl::span<const T>(vertices), vertexBuffer);
+	}
+
+	template <typename T>
+	inline void ReflectedVertexDeclaration<T>::CreateVertexBuffer(gsl::not_null<ID3D11Device*> device, const gsl::span<const T>& vertices, gsl::not_null<ID3D11Buffer**> vertexBuffer)
+	{
+		VertexDeclaration<T>::CreateVertexBuffer(device, vertices, vertexBuffer);
+	}
+#pragma endregion
+}
\ No newline at end of file
@@ -12,16 +12,21 @@ namespace Library
 	RTTI_DEFINITIONS(VertexShader)
 
 	VertexShader::VertexShader(const vector<char>& compiledShader, const com_ptr<ID3D11VertexShader>& vertexShader) :
-		mCompiledShader(compiledShader), mShader(vertexShader)
+		mCompiledShaderStorage(make_shared<const vector<char>>(compiledShader)), mCompiledShader(*mCompiledShaderStorage), mShader(vertexShader)
 	{
 	}
 
 	VertexShader::VertexShader(vector<char>&& compiledShader, const com_ptr<ID3D11VertexShader>& vertexShader) :
-		mCompiledShader(compiledShader), mShader(vertexShader)
+		mCompiledShaderStorage(make_shared<const vector<char>>(move(compiledShader))), mCompiledShader(*mCompiledShaderStorage), mShader(vertexShader)
 	{
 	}
 
-	const vector<char>& VertexShader::CompiledShader() const
+	VertexShader::VertexShader(shared_ptr<const vector<char>> compiledShaderStorage, span<const char> compiledShader, const com_ptr<ID3D11VertexShader>& vertexShader) :
+		mCompiledShaderStorage(move(compiledShaderStorage)), mCompiledShader(compiledShader), mShader(vertexShader)
+	{
+	}
+
+	span<const char> VertexShader::CompiledShader() const
 	{
 		return mCompiledShader;
 	}
@@ -43,8 +48,8 @@ namespace Library
 
 		if (releaseCompiledShader)
 		{
-			mCompiledShader.clear();
-			mCompiledShader.shrink_to_fit();
+			mCompiledShader = span<const char>();
+			mCompiledShaderStorage = nullptr;
 		}
 	}
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <memory>
 #include "Shader.h"
 
 namespace Library
@@ -16,7 +17,7 @@ namespace Library
 		VertexShader& operator=(VertexShader&&) = default;
 		~VertexShader() = default;
 
-		const std::vector<char>& CompiledShader() const;
+		gsl::span<const char> CompiledShader() const;
 		winrt::com_ptr<ID3D11VertexShader> Shader() const;
 		winrt::com_ptr<ID3D11InputLayout> InputLayout() const;
 
@@ -32,8 +33,11 @@ namespace Library
 		friend class VertexShaderReader;
 		VertexShader(const std::vector<char>& compiledShader, const winrt::com_ptr<ID3D11VertexShader>& vertexShader);
 		VertexShader(std::vector<char>&& compiledShader, const winrt::com_ptr<ID3D11VertexShader>& vertexShader);
+		VertexShader(std::shared_ptr<const std::vector<char>> compiledShaderStorage, gsl::span<const char> compiledShader, const winrt::com_ptr<ID3D11VertexShader>& vertexShader);
 
-		std::vector<char> mCompiledShader;
+		// The storage may be shared with a shader pack; the compiled shader is a view into it.
+		std::shared_ptr<const std::vector<char>> mCompiledShaderStorage;
+		gsl::span<const char> mCompiledShader;
 		winrt::com_ptr<ID3D11VertexShader> mShader;
 		winrt::com_ptr<ID3D11InputLayout> mInputLayout;
 	};
@@ -2,7 +2,7 @@
 #include "VertexShaderReader.h"
 #include "Game.h"
 #include "GameException.h"
-#include "Utility.h"
+#include "ShaderPack.h"
 
 using namespace std;
 using namespace DirectX;
@@ -20,10 +20,9 @@ namespace Library
 	shared_ptr<VertexShader> VertexShaderReader::_Read(const wstring& assetName)
 	{
 		com_ptr<ID3D11VertexShader> vertexShader;
-		vector<char> compiledVertexShader;
-		Utility::LoadBinaryFile(assetName, compiledVertexShader);
-		ThrowIfFailed(mGame->Direct3DDevice()->CreateVertexShader(compiledVertexShader.data(), compiledVertexShader.size(), nullptr, vertexShader.put()), "ID3D11Device::CreatedVertexShader() failed.");
+		ShaderBytecode compiledVertexShader = ShaderPack::LoadBytecode(*mGame, assetName);
+		ThrowIfFailed(mGame->Direct3DDevice()->CreateVertexShader(compiledVertexShader.Data.data(), compiledVertexShader.Data.size(), nullptr, vertexShader.put()), "ID3D11Device::CreatedVertexShader() failed.");
 		
-		return shared_ptr<VertexShader>(new VertexShader(move(compiledVertexShader), move(vertexShader)));
+		return shared_ptr<VertexShader>(new VertexShader(move(compiledVertexShader.Storage), compiledVertexShader.Data, move(vertexShader)));
 	}
 }
\ No newline at end of file
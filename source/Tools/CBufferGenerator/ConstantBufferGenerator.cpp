@@ -0,0 +1,249 @@
+#include "pch.h"
+#include "ConstantBufferGenerator.h"
+#include <regex>
+#include <set>
+
+using namespace std;
+using namespace std::filesystem;
+using namespace std::string_literals;
+
+namespace CBufferGenerator
+{
+	namespace
+	{
+		struct HlslType final
+		{
+			string CppType;
+			uint32_t Size;
+			bool StartsOnRegister;
+		};
+
+		const map<string, HlslType> HlslTypes
+		{
+			{ "float", { "float", 4, false } },
+			{ "float1", { "float", 4, false } },
+			{ "float2", { "DirectX::XMFLOAT2", 8, false } },
+			{ "float3", { "DirectX::XMFLOAT3", 12, false } },
+			{ "float4", { "DirectX::XMFLOAT4", 16, false } },
+			{ "int", { "std::int32_t", 4, false } },
+			{ "int2", { "DirectX::XMINT2", 8, false } },
+			{ "int3", { "DirectX::XMINT3", 12, false } },
+			{ "int4", { "DirectX::XMINT4", 16, false } },
+			{ "uint", { "std::uint32_t", 4, false } },
+			{ "uint2", { "DirectX::XMUINT2", 8, false } },
+			{ "uint3", { "DirectX::XMUINT3", 12, false } },
+			{ "uint4", { "DirectX::XMUINT4", 16, false } },
+			{ "bool", { "std::uint32_t", 4, false } },
+			{ "float4x4", { "DirectX::XMFLOAT4X4", 64, true } },
+			{ "matrix", { "DirectX::XMFLOAT4X4", 64, true } },
+		};
+
+		const set<string> IgnoredModifiers{ "row_major", "column_major", "precise", "uniform", "static", "const" };
+
+		string StripComments(const string& source)
+		{
+			static const regex commentExpression(R"(//[^\n]*|/\*[\s\S]*?\*/)");
+			return regex_replace(source, commentExpression, " "s);
+		}
+
+		uint32_t AlignToRegister(uint32_t offset)
+		{
+			return (offset + ConstantBufferGenerator::RegisterSize - 1) & ~(ConstantBufferGenerator::RegisterSize - 1);
+		}
+
+		void AddMember(ConstantBufferDeclaration& constantBuffer, const string& typeName, const string& declarator, uint32_t& offset)
+		{
+			static const regex declaratorExpression(R"(^\s*(\w+)\s*(?:\[\s*(\d+)\s*\])?\s*(:.*)?$)");
+			smatch match;
+			if (!regex_match(declarator, match, declaratorExpression))
+			{
+				throw exception(("Unsupported cbuffer member declaration: "s + declarator).c_str());
+			}
+
+			if (match[3].matched)
+			{
+				throw exception(("packoffset is not supported: "s + constantBuffer.Name + "::"s + match[1].str()).c_str());
+			}
+
+			auto it = HlslTypes.find(typeName);
+			if (it == HlslTypes.end())
+			{
+				throw exception(("Unsupported cbuffer member type: "s + typeName).c_str());
+			}
+
+			const HlslType& type = it->second;
+			ConstantBufferMember member;
+			member.Name = match[1].str();
+			member.HlslType = typeName;
+			member.CppType = type.CppType;
+			member.ArrayLength = (match[2].matched ? static_cast<uint32_t>(stoul(match[2].str())) : 0);
+
+			if (member.ArrayLength > 0 && type.Size % ConstantBufferGenerator::RegisterSize != 0)
+			{
+				// Each array element starts on a register, which has no direct C++ equivalent for smaller types.
+				throw exception(("Arrays of types smaller than a register are not supported: "s + constantBuffer.Name + "::"s + member.Name).c_str());
+			}
+
+			// Matrices and arrays start on a register; other members may not straddle a register boundary.
+			const bool straddlesRegister = ((offset % ConstantBufferGenerator::RegisterSize) + type.Size > ConstantBufferGenerator::RegisterSize);
+			if (type.StartsOnRegister || member.ArrayLength > 0 || straddlesRegister)
+			{
+				offset = AlignToRegister(offset);
+			}
+
+			member.Offset = offset;
+			member.Size = type.Size * max(member.ArrayLength, 1U);
+			offset += member.Size;
+
+			constantBuffer.Members.push_back(move(member));
+		}
+
+		void ParseMembers(ConstantBufferDeclaration& constantBuffer, const string& body)
+		{
+			uint32_t offset = 0;
+			size_t statementStart = 0;
+			size_t statementEnd;
+			while ((statementEnd = body.find(';', statementStart)) != string::npos)
+			{
+				istringstream statement(body.substr(statementStart, statementEnd - statementStart));
+				statementStart = statementEnd + 1;
+
+				string typeName;
+				while (statement >> typeName && IgnoredModifiers.count(typeName) > 0)
+				{
+				}
+
+				if (typeName.empty())
+				{
+					continue;
+				}
+
+				string declarator;
+				while (getline(statement, declarator, ','))
+				{
+					AddMember(constantBuffer, typeName, declarator, offset);
+				}
+			}
+
+			constantBuffer.Size = AlignToRegister(offset);
+		}
+	}
+
+	vector<ConstantBufferDeclaration> ConstantBufferGenerator::Parse(const path& filename)
+	{
+		ifstream file(filename);
+		if (!file.good())
+		{
+			throw exception("Could not open file.");
+		}
+
+		stringstream sourceStream;
+		sourceStream << file.rdbuf();
+		const string source = StripComments(sourceStream.str());
+
+		static const regex cbufferExpression(R"(\bcbuffer\s+(\w+)\s*(?::\s*register\s*\(\s*\w+\s*\))?\s*\{([^}]*)\})");
+		vector<ConstantBufferDeclaration> constantBuffers;
+		for (sregex_iterator it(source.begin(), source.end(), cbufferExpression), end; it != end; ++it)
+		{
+			ConstantBufferDeclaration constantBuffer;
+			constantBuffer.Name = (*it)[1].str();
+			ParseMembers(constantBuffer, (*it)[2].str());
+			constantBuffers.push_back(move(constantBuffer));
+		}
+
+		return constantBuffers;
+	}
+
+	string ConstantBufferGenerator::GenerateHeader(const vector<ConstantBufferDeclaration>& constantBuffers, const string& sourceFilename, const string& namespaceName)
+	{
+		ostringstream header;
+		header << "// Generated by CBufferGenerator from " << sourceFilename << ". Do not edit.\n";
+		header << "#pragma once\n\n";
+		header << "#include <cstddef>\n";
+		header << "#include <cstdint>\n";
+		header << "#include <DirectXMath.h>\n";
+		header << "#include \"ConstantBufferDirtyRange.h\"\n\n";
+		header << "namespace " << namespaceName << "\n{\n";
+
+		for (const auto& constantBuffer : constantBuffers)
+		{
+			if (&constantBuffer != &constantBuffers.front())
+			{
+				header << "\n";
+			}
+
+			header << "\tstruct " << constantBuffer.Name << " final\n\t{\n";
+
+			uint32_t offset = 0;
+			uint32_t paddingIndex = 0;
+			const auto writePadding = [&](uint32_t paddedOffset)
+			{
+				if (paddedOffset > offset)
+				{
+					const uint32_t paddingCount = (paddedOffset - offset) / static_cast<uint32_t>(sizeof(float));
+					header << "\t\tfloat Padding" << paddingIndex++;
+					if (paddingCount > 1)
+					{
+						header << "[" << paddingCount << "]";
+					}
+					header << "{ };\n";
+				}
+			};
+
+			for (const auto& member : constantBuffer.Members)
+			{
+				writePadding(member.Offset);
+				header << "\t\t" << member.CppType << " " << member.Name;
+				if (member.ArrayLength > 0)
+				{
+					header << "[" << member.ArrayLength << "]";
+				}
+				header << "{ };\n";
+				offset = member.Offset + member.Size;
+			}
+			writePadding(constantBuffer.Size);
+
+			header << "\n";
+			for (const auto& member : constantBuffer.Members)
+			{
+				header << "\t\tstatic constexpr Library::ConstantBufferField " << member.Name << "Field{ " << member.Offset << ", " << member.Size << " };\n";
+			}
+
+			header << "\t};\n\n";
+
+			for (const auto& member : constantBuffer.Members)
+			{
+				header << "\tstatic_assert(offsetof(" << constantBuffer.Name << ", " << member.Name << ") == " << member.Offset << ");\n";
+			}
+			header << "\tstatic_assert(sizeof(" << constantBuffer.Name << ") == " << constantBuffer.Size << ");\n";
+		}
+
+		header << "}";
+		return header.str();
+	}
+
+	bool ConstantBufferGenerator::WriteIfChanged(const path& filename, const string& contents)
+	{
+		{
+			ifstream existingFile(filename, ios::binary);
+			if (existingFile.good())
+			{
+				stringstream existingContents;
+				existingContents << existingFile.rdbuf();
+				if (existingContents.str() == contents)
+				{
+					return false;
+				}
+			}
+		}
+
+		ofstream file(filename, ios::binary);
+		if (!file.good())
+		{
+			throw exception("Could not open file.");
+		}
+
+		file << contents;
+		return true;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <filesystem>
+
+namespace CBufferGenerator
+{
+	struct ConstantBufferMember final
+	{
+		std::string Name;
+		std::string HlslType;
+		std::string CppType;
+		std::uint32_t Offset{ 0 };
+		std::uint32_t Size{ 0 };
+		std::uint32_t ArrayLength{ 0 };
+	};
+
+	struct ConstantBufferDeclaration final
+	{
+		std::string Name;
+		std::vector<ConstantBufferMember> Members;
+		std::uint32_t Size{ 0 };
+	};
+
+	class ConstantBufferGenerator final
+	{
+	public:
+		ConstantBufferGenerator() = delete;
+
+		// Parses the cbuffer declarations of an HLSL file and lays out their members under HLSL packing rules.
+		static std::vector<ConstantBufferDeclaration> Parse(const std::filesystem::path& filename);
+
+		static std::string GenerateHeader(const std::vector<ConstantBufferDeclaration>& constantBuffers, const std::string& sourceFilename, const std::string& namespaceName);
+
+		// Returns false (and leaves the file untouched) when the contents are unchanged, to avoid needless rebuilds.
+		static bool WriteIfChanged(const std::filesystem::path& filename, const std::string& contents);
+
+		inline static const std::uint32_t RegisterSize{ 16 };
+	};
+}
\ No newline at end of file
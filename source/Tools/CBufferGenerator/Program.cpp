@@ -0,0 +1,52 @@
+#include "pch.h"
+#include "ConstantBufferGenerator.h"
+
+using namespace std;
+using namespace std::filesystem;
+using namespace std::string_literals;
+using namespace CBufferGenerator;
+
+int main(int argc, char* argv[])
+{
+	try
+	{
+		if (argc != 4)
+		{
+			throw exception("Usage: CBufferGenerator.exe shaderdirectory outputdirectory namespace");
+		}
+
+		const path shaderDirectory = absolute(path(argv[1]));
+		const path outputDirectory = absolute(path(argv[2]));
+		const string namespaceName = argv[3];
+
+		for (const auto& directoryEntry : directory_iterator(shaderDirectory))
+		{
+			const path& shaderFile = directoryEntry.path();
+			if (!directoryEntry.is_regular_file() || shaderFile.extension() != ".hlsl")
+			{
+				continue;
+			}
+
+			auto constantBuffers = ConstantBufferGenerator::Parse(shaderFile);
+			if (constantBuffers.empty())
+			{
+				continue;
+			}
+
+			const string shaderName = shaderFile.stem().string();
+			const path headerFile = outputDirectory / (shaderName + "CBuffers.h"s);
+			const string header = ConstantBufferGenerator::GenerateHeader(constantBuffers, shaderFile.filename().string(), namespaceName + "::"s + shaderName);
+			if (ConstantBufferGenerator::WriteIfChanged(headerFile, header))
+			{
+				cout << "Writing: "s << headerFile.filename() << endl;
+			}
+		}
+	}
+	catch (exception ex)
+	{
+		cout << ex.what() << endl;
+		return 1;
+	}
+
+	return 0;
+}
\ No newline at end of file
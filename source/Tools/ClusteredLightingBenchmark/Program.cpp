@@ -0,0 +1,280 @@
+#include "pch.h"
+#include "ClusteredLightBuilder.h"
+#include "PointLight.h"
+#include "SpotLight.h"
+#include <chrono>
+#include <random>
+
+using namespace std;
+using namespace std::chrono;
+using namespace std::string_literals;
+using namespace gsl;
+using namespace DirectX;
+using namespace Library;
+
+namespace
+{
+	const uint32_t DefaultLightCount{ 1024 };
+	const int FrameCount{ 100 };
+	const float SceneExtent{ 150.0f }; // Half the side of the square the lights are scattered over
+	const float FieldOfView{ XM_PIDIV4 };
+	const float AspectRatio{ 16.0f / 9.0f };
+	const float NearPlaneDistance{ 0.1f };
+	const float FarPlaneDistance{ 1000.0f };
+	const uint32_t SamplesPerLight{ 512 };
+
+	// Half point lights and half spot lights, scattered over the ground around the camera and pointing every way.
+	vector<unique_ptr<PointLight>> CreateLights(uint32_t lightCount)
+	{
+		mt19937 generator(1);
+		uniform_real_distribution<float> position(-SceneExtent, SceneExtent);
+		uniform_real_distribution<float> height(0.5f, 20.0f);
+		uniform_real_distribution<float> radius(2.0f, 25.0f);
+		uniform_real_distribution<float> color(0.2f, 1.0f);
+		uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+		uniform_real_distribution<float> outerAngle(0.1f, 0.95f);
+
+		vector<unique_ptr<PointLight>> lights;
+		lights.reserve(lightCount);
+		for (uint32_t i = 0; i < lightCount; i++)
+		{
+			const XMFLOAT3 lightPosition(position(generator), height(generator), position(generator));
+			if (i % 2 == 0)
+			{
+				lights.push_back(make_unique<PointLight>(lightPosition, radius(generator)));
+			}
+			else
+			{
+				auto spotLight = make_unique<SpotLight>(lightPosition, radius(generator));
+				spotLight->ApplyRotation(XMMatrixRotationRollPitchYaw(angle(generator), angle(generator), 0.0f));
+				const float outer = outerAngle(generator);
+				spotLight->SetOuterAngle(outer);
+				spotLight->SetInnerAngle(min(outer + 0.05f, 1.0f));
+				lights.push_back(move(spotLight));
+			}
+
+			lights.back()->SetColor(color(generator), color(generator), color(generator), 1.0f);
+		}
+
+		return lights;
+	}
+
+	// Standing among the lights, looking slightly down.
+	XMMATRIX ViewMatrix()
+	{
+		return XMMatrixLookToRH(XMVectorSet(0.0f, 10.0f, 0.5f * SceneExtent, 1.0f), XMVectorSet(0.0f, -0.2f, -1.0f, 0.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+	}
+
+	double Milliseconds(const high_resolution_clock::time_point& startTime)
+	{
+		return duration<double, milli>(high_resolution_clock::now() - startTime).count();
+	}
+
+	// The cluster containing a view-space point, if the point is in the view frustum.
+	bool FindCluster(const ClusteredLightBuilder& builder, const XMFLOAT3& viewPosition, uint32_t& cluster)
+	{
+		const float depth = -viewPosition.z;
+		if (depth < NearPlaneDistance || depth > FarPlaneDistance)
+		{
+			return false;
+		}
+
+		const float tanHalfFovY = tan(FieldOfView * 0.5f);
+		const float x = viewPosition.x / (depth * tanHalfFovY * AspectRatio);
+		const float y = viewPosition.y / (depth * tanHalfFovY);
+		if (fabs(x) > 1.0f || fabs(y) > 1.0f)
+		{
+			return false;
+		}
+
+		const auto index = [](float value, uint32_t count)
+		{
+			return min(static_cast<uint32_t>(max(value * count, 0.0f)), count - 1);
+		};
+
+		const uint32_t tileX = index((x + 1.0f) * 0.5f, builder.TileCountX());
+		const uint32_t tileY = index((1.0f - y) * 0.5f, builder.TileCountY());
+		const uint32_t slice = index((log(depth) * builder.SliceScale() + builder.SliceBias()) / builder.SliceCount(), builder.SliceCount());
+		cluster = builder.ClusterIndex(tileX, tileY, slice);
+		return true;
+	}
+
+	// Checks that points lit by each light are in clusters that list it: points are sampled within the light's
+	// radius and, for spot lights, within its outer cone and in front of it. Returns the number of points in view.
+	size_t ValidateCoverage(const ClusteredLightBuilder& builder, const vector<unique_ptr<PointLight>>& lights, CXMMATRIX viewMatrix)
+	{
+		mt19937 generator(2);
+		uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		size_t testedCount = 0;
+		for (uint32_t lightIndex = 0; lightIndex < lights.size(); lightIndex++)
+		{
+			const PointLight& light = *lights[lightIndex];
+			const SpotLight* spotLight = light.As<SpotLight>();
+			for (uint32_t sample = 0; sample < SamplesPerLight; sample++)
+			{
+				const XMVECTOR offset = XMVectorSet(unit(generator), unit(generator), unit(generator), 0.0f) * light.Radius();
+				const float distance = XMVectorGetX(XMVector3Length(offset));
+				if (distance > light.Radius() || distance == 0.0f)
+				{
+					continue;
+				}
+
+				if (spotLight != nullptr)
+				{
+					const float cosine = XMVectorGetX(XMVector3Dot(offset / distance, spotLight->DirectionVector()));
+					if (cosine <= 0.0f || cosine <= spotLight->OuterAngle())
+					{
+						continue;
+					}
+				}
+
+				XMFLOAT3 viewPosition;
+				XMStoreFloat3(&viewPosition, XMVector3Transform(light.PositionVector() + offset, viewMatrix));
+				uint32_t cluster;
+				if (!FindCluster(builder, viewPosition, cluster))
+				{
+					continue;
+				}
+
+				++testedCount;
+				const LightCluster& range = builder.Clusters()[cluster];
+				const auto first = builder.LightIndices().begin() + range.Offset;
+				if (find(first, first + range.Count, lightIndex) == first + range.Count)
+				{
+					throw exception("A lit point is in a cluster that does not list its light.");
+				}
+			}
+		}
+
+		return testedCount;
+	}
+
+	// Tests every light against every cluster, one at a time and without the builder's selection of tile and
+	// slice ranges: the light's bounding sphere against the cluster's box and, for spot lights, the cone against
+	// the cluster's bounding sphere. The builder's lists must be subsets of these.
+	vector<vector<uint32_t>> BruteForce(const ClusteredLightBuilder& builder, const vector<unique_ptr<PointLight>>& lights, CXMMATRIX viewMatrix)
+	{
+		vector<vector<uint32_t>> clusterLights(builder.ClusterCount());
+		for (uint32_t lightIndex = 0; lightIndex < lights.size(); lightIndex++)
+		{
+			const PointLight& light = *lights[lightIndex];
+			const SpotLight* spotLight = light.As<SpotLight>();
+			const XMVECTOR apex = XMVector3Transform(light.PositionVector(), viewMatrix);
+			const float range = light.Radius();
+			XMVECTOR axis = XMVectorZero();
+			float coneCosine = -1.0f;
+			float coneSine = 0.0f;
+
+			BoundingSphere bounds;
+			XMStoreFloat3(&bounds.Center, apex);
+			bounds.Radius = range;
+			if (spotLight != nullptr)
+			{
+				axis = XMVector3Normalize(XMVector3TransformNormal(spotLight->DirectionVector(), viewMatrix));
+				coneCosine = clamp(spotLight->OuterAngle(), 0.0f, 1.0f);
+				coneSine = sqrt(1.0f - coneCosine * coneCosine);
+				const float centerDistance = (coneCosine > 0.70710678f ? range / (2.0f * coneCosine) : range * coneCosine);
+				XMStoreFloat3(&bounds.Center, apex + axis * centerDistance);
+				bounds.Radius = (coneCosine > 0.70710678f ? centerDistance : range * coneSine);
+			}
+
+			for (uint32_t cluster = 0; cluster < builder.ClusterCount(); cluster++)
+			{
+				const BoundingBox& box = builder.ClusterBounds(cluster);
+				if (!box.Intersects(bounds))
+				{
+					continue;
+				}
+
+				if (spotLight != nullptr)
+				{
+					const float clusterRadius = XMVectorGetX(XMVector3Length(XMLoadFloat3(&box.Extents)));
+					const XMVECTOR toCluster = XMLoadFloat3(&box.Center) - apex;
+					const float axialDistance = XMVectorGetX(XMVector3Dot(toCluster, axis));
+					const float radialDistance = XMVectorGetX(XMVector3Length(toCluster - axis * axialDistance));
+					if (coneCosine * radialDistance - coneSine * axialDistance > clusterRadius || axialDistance > clusterRadius + range || axialDistance < -clusterRadius)
+					{
+						continue;
+					}
+				}
+
+				clusterLights[cluster].push_back(lightIndex);
+			}
+		}
+
+		return clusterLights;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+#if defined(DEBUG) | defined(_DEBUG)
+	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+#endif
+
+	try
+	{
+		const uint32_t lightCount = (argc > 1 ? static_cast<uint32_t>(stoul(argv[1])) : DefaultLightCount);
+		const vector<unique_ptr<PointLight>> lights = CreateLights(lightCount);
+		vector<const PointLight*> lightPointers;
+		for (const auto& light : lights)
+		{
+			lightPointers.push_back(light.get());
+		}
+
+		const XMMATRIX viewMatrix = ViewMatrix();
+		ClusteredLightBuilder builder;
+		double buildTime = 0.0;
+		double maxBuildTime = 0.0;
+		for (int frame = 0; frame < FrameCount; frame++)
+		{
+			const auto startTime = high_resolution_clock::now();
+			builder.Build(viewMatrix, FieldOfView, AspectRatio, NearPlaneDistance, FarPlaneDistance, lightPointers);
+			const double frameTime = Milliseconds(startTime);
+			buildTime += frameTime;
+			maxBuildTime = max(maxBuildTime, frameTime);
+		}
+
+		auto startTime = high_resolution_clock::now();
+		const vector<vector<uint32_t>> bruteForce = BruteForce(builder, lights, viewMatrix);
+		const double bruteForceTime = Milliseconds(startTime);
+
+		size_t bruteForceCount = 0;
+		uint32_t maxLightsPerCluster = 0;
+		uint32_t emptyClusterCount = 0;
+		for (uint32_t cluster = 0; cluster < builder.ClusterCount(); cluster++)
+		{
+			const LightCluster& range = builder.Clusters()[cluster];
+			const auto first = builder.LightIndices().begin() + range.Offset;
+			for (auto light = first; light != first + range.Count; ++light)
+			{
+				if (!binary_search(bruteForce[cluster].begin(), bruteForce[cluster].end(), *light))
+				{
+					throw exception("A cluster lists a light that does not reach it.");
+				}
+			}
+
+			bruteForceCount += bruteForce[cluster].size();
+			maxLightsPerCluster = max(maxLightsPerCluster, range.Count);
+			emptyClusterCount += (range.Count == 0 ? 1 : 0);
+		}
+
+		const size_t testedCount = ValidateCoverage(builder, lights, viewMatrix);
+		const size_t indexCount = builder.LightIndices().size();
+
+		cout << "Clusters "s << builder.TileCountX() << "x"s << builder.TileCountY() << "x"s << builder.SliceCount() << " ("s << builder.ClusterCount() << "), "s
+			<< lightCount << " lights ("s << (lightCount + 1) / 2 << " point, "s << lightCount / 2 << " spot)"s << endl;
+		cout << "Light indices: "s << indexCount << " ("s << bruteForceCount << " by brute force), "s
+			<< fixed << setprecision(2) << static_cast<double>(indexCount) / builder.ClusterCount() << " lights per cluster on average, "s
+			<< maxLightsPerCluster << " at most, "s << emptyClusterCount << " clusters empty"s << endl;
+		cout << "Validated with "s << testedCount << " lit points in view"s << endl;
+		cout << setprecision(3) << "Build (ms): average of "s << FrameCount << " frames "s << buildTime / FrameCount << ", slowest "s << maxBuildTime
+			<< "; brute force "s << bruteForceTime << endl;
+	}
+	catch (exception ex)
+	{
+		cout << ex.what() << endl;
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include "pch.h"
+#include "OverlappedFileReadBackend.h"
+#include "ThreadPoolFileReadBackend.h"
+#include "Utility.h"
+#include <chrono>
+#include <filesystem>
+
+using namespace std;
+using namespace std::chrono;
+using namespace std::string_literals;
+using namespace gsl;
+using namespace Library;
+
+namespace
+{
+	const string DefaultContentDirectory{ "Content"s };
+	const string ColdCacheOption{ "-cold"s };
+
+	// Best effort: opening a file without buffering flushes its cached pages on most systems. Only the first run
+	// against a truly cold cache (e.g. after a reboot) is fully representative.
+	void EvictFromCache(const vector<wstring>& filenames)
+	{
+		for (const wstring& filename : filenames)
+		{
+			winrt::file_handle file(CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_NO_BUFFERING, nullptr));
+		}
+	}
+
+	template <typename Func>
+	void Benchmark(const string& name, const vector<wstring>& filenames, bool coldCache, Func func)
+	{
+		if (coldCache)
+		{
+			EvictFromCache(filenames);
+		}
+
+		auto startTime = high_resolution_clock::now();
+		const uint64_t byteCount = func();
+		const double time = duration<double, milli>(high_resolution_clock::now() - startTime).count();
+
+		const double megabytes = static_cast<double>(byteCount) / (1024.0 * 1024.0);
+		cout << left << setw(24) << name << right << fixed << setprecision(2)
+			<< setw(10) << megabytes << " MB"s
+			<< setw(10) << time << " ms"s
+			<< setw(10) << megabytes / (time / 1000.0) << " MB/s"s << endl;
+	}
+
+	// Issues every read before waiting on any of them, the way ContentManager::Prefetch does.
+	uint64_t ReadAll(FileReadBackend& backend, const vector<wstring>& filenames)
+	{
+		vector<future<vector<char>>> reads;
+		reads.reserve(filenames.size());
+		for (const wstring& filename : filenames)
+		{
+			reads.push_back(backend.ReadFileAsync(filename));
+		}
+
+		uint64_t byteCount = 0;
+		for (auto& read : reads)
+		{
+			byteCount += read.get().size();
+		}
+
+		return byteCount;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+#if defined(DEBUG) | defined(_DEBUG)
+	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+#endif
+
+	try
+	{
+		string contentDirectory = DefaultContentDirectory;
+		bool coldCache = false;
+		for (int i = 1; i < argc; i++)
+		{
+			if (argv[i] == ColdCacheOption)
+			{
+				coldCache = true;
+			}
+			else
+			{
+				contentDirectory = argv[i];
+			}
+		}
+
+		vector<wstring> filenames;
+		for (const auto& entry : filesystem::recursive_directory_iterator(contentDirectory))
+		{
+			if (entry.is_regular_file())
+			{
+				filenames.push_back(entry.path().wstring());
+			}
+		}
+
+		if (filenames.empty())
+		{
+			throw exception("No files found in the content directory.");
+		}
+
+		cout << "Files: "s << filenames.size() << (coldCache ? " (cold cache)"s : " (warm cache)"s) << endl;
+
+		Benchmark("Sequential"s, filenames, coldCache, [&]()
+		{
+			uint64_t byteCount = 0;
+			vector<char> data;
+			for (const wstring& filename : filenames)
+			{
+				Utility::LoadBinaryFile(filename, data);
+				byteCount += data.size();
+			}
+
+			return byteCount;
+		});
+
+		ThreadPoolFileReadBackend threadPoolBackend;
+		Benchmark("ThreadPool ("s + to_string(threadPoolBackend.ThreadCount()) + " threads)"s, filenames, coldCache, [&]()
+		{
+			return ReadAll(threadPoolBackend, filenames);
+		});
+
+		OverlappedFileReadBackend overlappedBackend;
+		Benchmark("Overlapped (QD "s + to_string(overlappedBackend.QueueDepth()) + ")"s, filenames, coldCache, [&]()
+		{
+			return ReadAll(overlappedBackend, filenames);
+		});
+	}
+	catch (exception ex)
+	{
+		cout << ex.what() << endl;
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,486 @@
+#include "pch.h"
+#include "CubeMapProcessor.h"
+#include "GameException.h"
+#include "StringHelper.h"
+#include <execution>
+#include <numeric>
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+using namespace Library;
+
+namespace CubeMapPipeline
+{
+	namespace
+	{
+		struct PrefilterSample final
+		{
+			XMFLOAT3 Direction;
+			float Weight;
+			float SourceMipLevel;
+		};
+
+		struct IrradianceAccumulator final
+		{
+			SphericalHarmonics::CoefficientArray Coefficients{ };
+			float SolidAngle{ 0.0f };
+		};
+
+		inline XMFLOAT4* Row(const Image& image, size_t y)
+		{
+			return reinterpret_cast<XMFLOAT4*>(image.pixels + y * image.rowPitch);
+		}
+
+		// Maps a face and face-space coordinates in [-1, 1] to a direction, following the Direct3D cube map layout.
+		XMVECTOR FaceDirection(uint32_t face, float u, float v)
+		{
+			switch (face)
+			{
+			case 0:
+				return XMVectorSet(1.0f, -v, -u, 0.0f);
+			case 1:
+				return XMVectorSet(-1.0f, -v, u, 0.0f);
+			case 2:
+				return XMVectorSet(u, 1.0f, v, 0.0f);
+			case 3:
+				return XMVectorSet(u, -1.0f, -v, 0.0f);
+			case 4:
+				return XMVectorSet(u, -v, 1.0f, 0.0f);
+			default:
+				return XMVectorSet(-u, -v, -1.0f, 0.0f);
+			}
+		}
+
+		// Inverse of FaceDirection; s and t are returned in [0, 1].
+		void DirectionToFace(FXMVECTOR direction, uint32_t& face, float& s, float& t)
+		{
+			XMFLOAT3 d;
+			XMStoreFloat3(&d, direction);
+			const float ax = fabsf(d.x);
+			const float ay = fabsf(d.y);
+			const float az = fabsf(d.z);
+
+			float majorAxis;
+			float sc;
+			float tc;
+			if (ax >= ay && ax >= az)
+			{
+				majorAxis = ax;
+				face = (d.x >= 0.0f ? 0 : 1);
+				sc = (d.x >= 0.0f ? -d.z : d.z);
+				tc = -d.y;
+			}
+			else if (ay >= az)
+			{
+				majorAxis = ay;
+				face = (d.y >= 0.0f ? 2 : 3);
+				sc = d.x;
+				tc = (d.y >= 0.0f ? d.z : -d.z);
+			}
+			else
+			{
+				majorAxis = az;
+				face = (d.z >= 0.0f ? 4 : 5);
+				sc = (d.z >= 0.0f ? d.x : -d.x);
+				tc = -d.y;
+			}
+
+			s = 0.5f * (sc / majorAxis + 1.0f);
+			t = 0.5f * (tc / majorAxis + 1.0f);
+		}
+
+		XMVECTOR SampleBilinear(const Image& image, float s, float t)
+		{
+			const float x = std::clamp(s * static_cast<float>(image.width) - 0.5f, 0.0f, static_cast<float>(image.width - 1));
+			const float y = std::clamp(t * static_cast<float>(image.height) - 0.5f, 0.0f, static_cast<float>(image.height - 1));
+			const size_t x0 = static_cast<size_t>(x);
+			const size_t y0 = static_cast<size_t>(y);
+			const size_t x1 = std::min(x0 + 1, image.width - 1);
+			const size_t y1 = std::min(y0 + 1, image.height - 1);
+			const float fx = x - static_cast<float>(x0);
+			const float fy = y - static_cast<float>(y0);
+
+			const XMFLOAT4* row0 = Row(image, y0);
+			const XMFLOAT4* row1 = Row(image, y1);
+			XMVECTOR top = XMVectorLerp(XMLoadFloat4(&row0[x0]), XMLoadFloat4(&row0[x1]), fx);
+			XMVECTOR bottom = XMVectorLerp(XMLoadFloat4(&row1[x0]), XMLoadFloat4(&row1[x1]), fx);
+
+			return XMVectorLerp(top, bottom, fy);
+		}
+
+		XMVECTOR SampleCube(const ScratchImage& cubeMap, FXMVECTOR direction, float mipLevel)
+		{
+			uint32_t face;
+			float s;
+			float t;
+			DirectionToFace(direction, face, s, t);
+
+			const float maxMipLevel = static_cast<float>(cubeMap.GetMetadata().mipLevels - 1);
+			mipLevel = std::clamp(mipLevel, 0.0f, maxMipLevel);
+			const size_t mip0 = static_cast<size_t>(mipLevel);
+			const size_t mip1 = std::min(mip0 + 1, cubeMap.GetMetadata().mipLevels - 1);
+
+			XMVECTOR color = SampleBilinear(*cubeMap.GetImage(mip0, face, 0), s, t);
+			if (mip1 != mip0)
+			{
+				color = XMVectorLerp(color, SampleBilinear(*cubeMap.GetImage(mip1, face, 0), s, t), mipLevel - static_cast<float>(mip0));
+			}
+
+			return color;
+		}
+
+		float AreaElement(float x, float y)
+		{
+			return atan2f(x * y, sqrtf(x * x + y * y + 1.0f));
+		}
+
+		float TexelSolidAngle(size_t x, size_t y, size_t size)
+		{
+			const float inverseSize = 1.0f / static_cast<float>(size);
+			const float u = (2.0f * (static_cast<float>(x) + 0.5f) * inverseSize) - 1.0f;
+			const float v = (2.0f * (static_cast<float>(y) + 0.5f) * inverseSize) - 1.0f;
+
+			const float x0 = u - inverseSize;
+			const float y0 = v - inverseSize;
+			const float x1 = u + inverseSize;
+			const float y1 = v + inverseSize;
+
+			return AreaElement(x0, y0) - AreaElement(x0, y1) - AreaElement(x1, y0) + AreaElement(x1, y1);
+		}
+
+		XMFLOAT2 Hammersley(uint32_t i, uint32_t count)
+		{
+			uint32_t bits = i;
+			bits = (bits << 16u) | (bits >> 16u);
+			bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+			bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+			bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+			bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+
+			return XMFLOAT2(static_cast<float>(i) / static_cast<float>(count), static_cast<float>(bits) * 2.3283064365386963e-10f);
+		}
+
+		// GGX samples are identical for every output texel because N = V = R, so they are generated once per mip
+		// in tangent space together with the source mip that matches each sample's solid angle.
+		vector<PrefilterSample> GenerateSamples(float roughness, uint32_t sampleCount, size_t sourceSize)
+		{
+			const float alpha = roughness * roughness;
+			const float alphaSquared = alpha * alpha;
+			const float texelSolidAngle = 4.0f * XM_PI / (6.0f * static_cast<float>(sourceSize * sourceSize));
+
+			vector<PrefilterSample> samples;
+			samples.reserve(sampleCount);
+			float totalWeight = 0.0f;
+
+			for (uint32_t i = 0; i < sampleCount; i++)
+			{
+				XMFLOAT2 xi = Hammersley(i, sampleCount);
+				const float phi = XM_2PI * xi.x;
+				const float cosTheta = sqrtf((1.0f - xi.y) / (1.0f + (alphaSquared - 1.0f) * xi.y));
+				const float sinTheta = sqrtf(1.0f - cosTheta * cosTheta);
+
+				XMFLOAT3 halfVector(sinTheta * cosf(phi), sinTheta * sinf(phi), cosTheta);
+				XMFLOAT3 lightDirection(2.0f * cosTheta * halfVector.x, 2.0f * cosTheta * halfVector.y, 2.0f * cosTheta * halfVector.z - 1.0f);
+
+				const float nDotL = lightDirection.z;
+				if (nDotL > 0.0f)
+				{
+					const float denominator = cosTheta * cosTheta * (alphaSquared - 1.0f) + 1.0f;
+					const float distribution = alphaSquared / (XM_PI * denominator * denominator);
+					const float pdf = distribution * 0.25f;
+					const float sampleSolidAngle = 1.0f / (static_cast<float>(sampleCount) * pdf + 0.0001f);
+					const float sourceMipLevel = (roughness == 0.0f ? 0.0f : std::max(0.5f * log2f(sampleSolidAngle / texelSolidAngle) + 1.0f, 0.0f));
+
+					samples.push_back({ lightDirection, nDotL, sourceMipLevel });
+					totalWeight += nDotL;
+				}
+			}
+
+			for (auto& sample : samples)
+			{
+				sample.Weight /= totalWeight;
+			}
+
+			return samples;
+		}
+
+		ScratchImage ConvertToFloat(ScratchImage&& image)
+		{
+			const TexMetadata& metadata = image.GetMetadata();
+			if (metadata.format == DXGI_FORMAT_R32G32B32A32_FLOAT)
+			{
+				return move(image);
+			}
+
+			ScratchImage converted;
+			if (IsCompressed(metadata.format))
+			{
+				ThrowIfFailed(Decompress(image.GetImages(), image.GetImageCount(), metadata, DXGI_FORMAT_R32G32B32A32_FLOAT, converted), "Decompress() failed.");
+			}
+			else
+			{
+				ThrowIfFailed(Convert(image.GetImages(), image.GetImageCount(), metadata, DXGI_FORMAT_R32G32B32A32_FLOAT, TEX_FILTER_DEFAULT, TEX_THRESHOLD_DEFAULT, converted), "Convert() failed.");
+			}
+
+			return converted;
+		}
+
+		ScratchImage LoadFloatImage(const wstring& filename)
+		{
+			ScratchImage image;
+			if (StringHelper::EndsWith(filename, L".dds"))
+			{
+				ThrowIfFailed(LoadFromDDSFile(filename.c_str(), DDS_FLAGS_NONE, nullptr, image), "LoadFromDDSFile() failed.");
+			}
+			else
+			{
+				ThrowIfFailed(LoadFromWICFile(filename.c_str(), WIC_FLAGS_NONE, nullptr, image), "LoadFromWICFile() failed.");
+			}
+
+			return ConvertToFloat(move(image));
+		}
+
+		ScratchImage GenerateSourceMips(ScratchImage&& cubeMap)
+		{
+			if (cubeMap.GetMetadata().mipLevels > 1)
+			{
+				return move(cubeMap);
+			}
+
+			ScratchImage mipChain;
+			ThrowIfFailed(GenerateMipMaps(cubeMap.GetImages(), cubeMap.GetImageCount(), cubeMap.GetMetadata(), TEX_FILTER_BOX, 0, mipChain), "GenerateMipMaps() failed.");
+
+			return mipChain;
+		}
+	}
+
+	ScratchImage CubeMapProcessor::LoadCubeMap(const wstring& filename)
+	{
+		ScratchImage cubeMap = LoadFloatImage(filename);
+		const TexMetadata& metadata = cubeMap.GetMetadata();
+		if (!metadata.IsCubemap() || metadata.arraySize != FaceCount)
+		{
+			throw GameException("Input texture is not a single cube map.");
+		}
+
+		if (metadata.width != metadata.height)
+		{
+			throw GameException("Cube map faces must be square.");
+		}
+
+		return GenerateSourceMips(move(cubeMap));
+	}
+
+	ScratchImage CubeMapProcessor::LoadCubeMap(const vector<wstring>& faceFilenames)
+	{
+		if (faceFilenames.size() != FaceCount)
+		{
+			throw GameException("Six face images are required (+X, -X, +Y, -Y, +Z, -Z).");
+		}
+
+		vector<ScratchImage> faces(FaceCount);
+		transform(execution::par, faceFilenames.begin(), faceFilenames.end(), faces.begin(), LoadFloatImage);
+
+		const size_t size = faces[0].GetMetadata().width;
+		for (const auto& face : faces)
+		{
+			if (face.GetMetadata().width != size || face.GetMetadata().height != size)
+			{
+				throw GameException("Cube map faces must be square and equally sized.");
+			}
+		}
+
+		ScratchImage cubeMap;
+		ThrowIfFailed(cubeMap.InitializeCube(DXGI_FORMAT_R32G32B32A32_FLOAT, size, size, 1, 1), "ScratchImage::InitializeCube() failed.");
+		for (uint32_t face = 0; face < FaceCount; face++)
+		{
+			const Image& source = *faces[face].GetImage(0, 0, 0);
+			const Image& destination = *cubeMap.GetImage(0, face, 0);
+			for (size_t y = 0; y < size; y++)
+			{
+				memcpy(Row(destination, y), Row(source, y), size * sizeof(XMFLOAT4));
+			}
+		}
+
+		return GenerateSourceMips(move(cubeMap));
+	}
+
+	ScratchImage CubeMapProcessor::PrefilterSpecular(const ScratchImage& cubeMap, const PrefilterSettings& settings)
+	{
+		const size_t size = cubeMap.GetMetadata().width;
+		size_t maxMipLevels = 1;
+		while ((size >> maxMipLevels) > 0)
+		{
+			++maxMipLevels;
+		}
+
+		const size_t mipLevels = (settings.MipLevels == 0 ? maxMipLevels : std::min<size_t>(settings.MipLevels, maxMipLevels));
+
+		ScratchImage prefiltered;
+		ThrowIfFailed(prefiltered.InitializeCube(DXGI_FORMAT_R32G32B32A32_FLOAT, size, size, 1, mipLevels), "ScratchImage::InitializeCube() failed.");
+
+		vector<vector<PrefilterSample>> samplesPerMip(mipLevels);
+		for (size_t mip = 1; mip < mipLevels; mip++)
+		{
+			const float roughness = (mipLevels > 1 ? static_cast<float>(mip) / static_cast<float>(mipLevels - 1) : 0.0f);
+			samplesPerMip[mip] = GenerateSamples(roughness, settings.SampleCount, size);
+		}
+
+		// One work item per output row, across every face and mip, keeps all cores busy even on the tiny mips.
+		struct RowWorkItem
+		{
+			uint32_t Mip;
+			uint32_t Face;
+			uint32_t Y;
+		};
+
+		vector<RowWorkItem> workItems;
+		for (uint32_t mip = 0; mip < mipLevels; mip++)
+		{
+			const uint32_t mipSize = narrow_cast<uint32_t>(std::max<size_t>(size >> mip, 1));
+			for (uint32_t face = 0; face < FaceCount; face++)
+			{
+				for (uint32_t y = 0; y < mipSize; y++)
+				{
+					workItems.push_back({ mip, face, y });
+				}
+			}
+		}
+
+		for_each(execution::par, workItems.begin(), workItems.end(), [&](const RowWorkItem& workItem)
+		{
+			const Image& destination = *prefiltered.GetImage(workItem.Mip, workItem.Face, 0);
+			XMFLOAT4* destinationRow = Row(destination, workItem.Y);
+
+			if (workItem.Mip == 0)
+			{
+				// Roughness zero is a perfect mirror; the source is copied as is.
+				memcpy(destinationRow, Row(*cubeMap.GetImage(0, workItem.Face, 0), workItem.Y), destination.width * sizeof(XMFLOAT4));
+				return;
+			}
+
+			const auto& samples = samplesPerMip[workItem.Mip];
+			const float inverseSize = 1.0f / static_cast<float>(destination.width);
+			const float v = 2.0f * (static_cast<float>(workItem.Y) + 0.5f) * inverseSize - 1.0f;
+
+			for (size_t x = 0; x < destination.width; x++)
+			{
+				const float u = 2.0f * (static_cast<float>(x) + 0.5f) * inverseSize - 1.0f;
+				XMVECTOR normal = XMVector3Normalize(FaceDirection(workItem.Face, u, v));
+				XMVECTOR up = (fabsf(XMVectorGetZ(normal)) < 0.999f ? g_XMIdentityR2 : g_XMIdentityR0);
+				XMVECTOR tangentX = XMVector3Normalize(XMVector3Cross(up, normal));
+				XMVECTOR tangentY = XMVector3Cross(normal, tangentX);
+
+				XMVECTOR color = XMVectorZero();
+				for (const auto& sample : samples)
+				{
+					XMVECTOR lightDirection = XMVectorScale(tangentX, sample.Direction.x);
+					lightDirection = XMVectorMultiplyAdd(tangentY, XMVectorReplicate(sample.Direction.y), lightDirection);
+					lightDirection = XMVectorMultiplyAdd(normal, XMVectorReplicate(sample.Direction.z), lightDirection);
+
+					color = XMVectorMultiplyAdd(SampleCube(cubeMap, lightDirection, sample.SourceMipLevel), XMVectorReplicate(sample.Weight), color);
+				}
+
+				XMStoreFloat4(&destinationRow[x], XMVectorSetW(color, 1.0f));
+			}
+		});
+
+		if (settings.OutputFormat == DXGI_FORMAT_R32G32B32A32_FLOAT)
+		{
+			return prefiltered;
+		}
+
+		ScratchImage converted;
+		ThrowIfFailed(Convert(prefiltered.GetImages(), prefiltered.GetImageCount(), prefiltered.GetMetadata(), settings.OutputFormat, TEX_FILTER_DEFAULT, TEX_THRESHOLD_DEFAULT, converted), "Convert() failed.");
+
+		return converted;
+	}
+
+	SphericalHarmonics CubeMapProcessor::ProjectIrradiance(const ScratchImage& cubeMap)
+	{
+		// Irradiance is band-limited, so projecting a mip no larger than 128x128 loses nothing visible.
+		static const size_t MaxProjectionSize = 128;
+		const TexMetadata& metadata = cubeMap.GetMetadata();
+		size_t mip = 0;
+		while ((metadata.width >> mip) > MaxProjectionSize && mip + 1 < metadata.mipLevels)
+		{
+			++mip;
+		}
+
+		array<uint32_t, FaceCount> faces;
+		iota(faces.begin(), faces.end(), 0);
+		array<IrradianceAccumulator, FaceCount> accumulators;
+
+		transform(execution::par, faces.begin(), faces.end(), accumulators.begin(), [&](uint32_t face)
+		{
+			IrradianceAccumulator accumulator;
+			const Image& image = *cubeMap.GetImage(mip, face, 0);
+			const float inverseSize = 1.0f / static_cast<float>(image.width);
+			array<float, SphericalHarmonics::CoefficientCount> basis;
+
+			for (size_t y = 0; y < image.height; y++)
+			{
+				const XMFLOAT4* row = Row(image, y);
+				const float v = 2.0f * (static_cast<float>(y) + 0.5f) * inverseSize - 1.0f;
+				for (size_t x = 0; x < image.width; x++)
+				{
+					const float u = 2.0f * (static_cast<float>(x) + 0.5f) * inverseSize - 1.0f;
+					const float solidAngle = TexelSolidAngle(x, y, image.width);
+					SphericalHarmonics::EvaluateBasis(FaceDirection(face, u, v), basis);
+
+					for (uint32_t i = 0; i < SphericalHarmonics::CoefficientCount; i++)
+					{
+						XMFLOAT3& coefficient = accumulator.Coefficients[i];
+						const float weight = basis[i] * solidAngle;
+						coefficient.x += row[x].x * weight;
+						coefficient.y += row[x].y * weight;
+						coefficient.z += row[x].z * weight;
+					}
+
+					accumulator.SolidAngle += solidAngle;
+				}
+			}
+
+			return accumulator;
+		});
+
+		SphericalHarmonics::CoefficientArray coefficients{ };
+		float totalSolidAngle = 0.0f;
+		for (const auto& accumulator : accumulators)
+		{
+			for (uint32_t i = 0; i < SphericalHarmonics::CoefficientCount; i++)
+			{
+				coefficients[i].x += accumulator.Coefficients[i].x;
+				coefficients[i].y += accumulator.Coefficients[i].y;
+				coefficients[i].z += accumulator.Coefficients[i].z;
+			}
+
+			totalSolidAngle += accumulator.SolidAngle;
+		}
+
+		// Renormalize to exactly 4*pi, then convolve with the clamped cosine lobe (Ramamoorthi & Hanrahan)
+		static const array<float, SphericalHarmonics::CoefficientCount> BandScales
+		{
+			XM_PI,
+			XM_2PI / 3.0f, XM_2PI / 3.0f, XM_2PI / 3.0f,
+			XM_PIDIV4, XM_PIDIV4, XM_PIDIV4, XM_PIDIV4, XM_PIDIV4
+		};
+
+		const float normalization = 4.0f * XM_PI / totalSolidAngle;
+		for (uint32_t i = 0; i < SphericalHarmonics::CoefficientCount; i++)
+		{
+			const float scale = normalization * BandScales[i];
+			coefficients[i].x *= scale;
+			coefficients[i].y *= scale;
+			coefficients[i].z *= scale;
+		}
+
+		return SphericalHarmonics(coefficients);
+	}
+
+	void CubeMapProcessor::SaveCubeMap(const ScratchImage& cubeMap, const wstring& filename)
+	{
+		ThrowIfFailed(SaveToDDSFile(cubeMap.GetImages(), cubeMap.GetImageCount(), cubeMap.GetMetadata(), DDS_FLAGS_NONE, filename.c_str()), "SaveToDDSFile() failed.");
+	}
+}
\ No newline at end of file
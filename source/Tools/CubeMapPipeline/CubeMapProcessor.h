@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <DirectXTex.h>
+#include "SphericalHarmonics.h"
+
+namespace CubeMapPipeline
+{
+	struct PrefilterSettings final
+	{
+		std::uint32_t SampleCount{ 512 };
+		std::uint32_t MipLevels{ 0 };
+		DXGI_FORMAT OutputFormat{ DXGI_FORMAT_R16G16B16A16_FLOAT };
+	};
+
+	class CubeMapProcessor final
+	{
+	public:
+		CubeMapProcessor() = delete;
+
+		static DirectX::ScratchImage LoadCubeMap(const std::wstring& filename);
+		static DirectX::ScratchImage LoadCubeMap(const std::vector<std::wstring>& faceFilenames);
+
+		static DirectX::ScratchImage PrefilterSpecular(const DirectX::ScratchImage& cubeMap, const PrefilterSettings& settings);
+		static Library::SphericalHarmonics ProjectIrradiance(const DirectX::ScratchImage& cubeMap);
+
+		static void SaveCubeMap(const DirectX::ScratchImage& cubeMap, const std::wstring& filename);
+
+		static constexpr std::uint32_t FaceCount{ 6 };
+	};
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include "pch.h"
+#include "CubeMapProcessor.h"
+#include "GameException.h"
+#include "Utility.h"
+#include <chrono>
+
+using namespace std;
+using namespace std::chrono;
+using namespace std::filesystem;
+using namespace std::string_literals;
+using namespace CubeMapPipeline;
+using namespace DirectX;
+using namespace Library;
+
+int main(int argc, char* argv[])
+{
+#if defined(DEBUG) | defined(_DEBUG)
+	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+#endif
+
+	try
+	{
+		if (argc != 2 && argc != 3 && argc != 7 && argc != 8)
+		{
+			throw exception("Usage: CubeMapPipeline.exe cubemap.dds [samplecount]\n       CubeMapPipeline.exe +x -x +y -y +z -z [samplecount]");
+		}
+
+		ThrowIfFailed(CoInitializeEx(nullptr, COINITBASE_MULTITHREADED), "Error initializing COM.");
+
+		const bool separateFaces = (argc >= 7);
+		const int inputCount = (separateFaces ? 6 : 1);
+		path inputFile = absolute(path(argv[1]));
+
+		PrefilterSettings settings;
+		if (argc == inputCount + 2)
+		{
+			settings.SampleCount = static_cast<uint32_t>(stoul(argv[inputCount + 1]));
+		}
+
+		auto startTime = high_resolution_clock::now();
+		ScratchImage cubeMap;
+		if (separateFaces)
+		{
+			vector<wstring> faceFilenames;
+			for (int i = 1; i <= inputCount; i++)
+			{
+				faceFilenames.push_back(absolute(path(argv[i])).wstring());
+				cout << "Reading: "s << path(argv[i]).filename() << endl;
+			}
+
+			cubeMap = CubeMapProcessor::LoadCubeMap(faceFilenames);
+		}
+		else
+		{
+			cout << "Reading: "s << inputFile.filename() << endl;
+			cubeMap = CubeMapProcessor::LoadCubeMap(inputFile.wstring());
+		}
+
+		current_path(inputFile.parent_path());
+		
+		auto prefilterStartTime = high_resolution_clock::now();
+		ScratchImage prefiltered = CubeMapProcessor::PrefilterSpecular(cubeMap, settings);
+		auto prefilterEndTime = high_resolution_clock::now();
+		cout << "Prefiltered "s << prefiltered.GetMetadata().mipLevels << " mip levels ("s << settings.SampleCount << " samples) in "s << duration_cast<milliseconds>(prefilterEndTime - prefilterStartTime).count() << " ms"s << endl;
+
+		SphericalHarmonics irradiance = CubeMapProcessor::ProjectIrradiance(cubeMap);
+		auto irradianceEndTime = high_resolution_clock::now();
+		cout << "Projected irradiance in "s << duration_cast<milliseconds>(irradianceEndTime - prefilterEndTime).count() << " ms"s << endl;
+
+		wstring prefilteredFilename = inputFile.stem().wstring() + L"Prefiltered.dds"s;
+		cout << "Writing: "s << Utility::ToString(prefilteredFilename) << endl;
+		CubeMapProcessor::SaveCubeMap(prefiltered, prefilteredFilename);
+
+		string irradianceFilename = inputFile.stem().string() + "Irradiance.sh"s;
+		cout << "Writing: "s << irradianceFilename << endl;
+		irradiance.Save(irradianceFilename);
+
+		cout << "Finished in "s << duration_cast<milliseconds>(high_resolution_clock::now() - startTime).count() << " ms"s << endl;
+	}
+	catch (exception ex)
+	{
+		cout << ex.what() << endl;
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "pch.h"
+#include "BakeScene.h"
+
+using namespace std;
+using namespace std::filesystem;
+using namespace std::string_literals;
+using namespace DirectX;
+
+namespace LightmapBaker
+{
+	namespace
+	{
+		XMFLOAT3 Normalize(const XMFLOAT3& value)
+		{
+			const float length = sqrt(value.x * value.x + value.y * value.y + value.z * value.z);
+			if (length == 0.0f)
+			{
+				throw exception("Light direction cannot be zero.");
+			}
+
+			return XMFLOAT3(value.x / length, value.y / length, value.z / length);
+		}
+	}
+
+	BakeScene BakeScene::Load(const path& filename)
+	{
+		ifstream file(filename);
+		if (!file.good())
+		{
+			throw exception("Could not open file.");
+		}
+
+		BakeScene scene;
+		string line;
+		while (getline(file, line))
+		{
+			istringstream lineStream(line);
+			string keyword;
+			if (!(lineStream >> keyword) || keyword[0] == '#')
+			{
+				continue;
+			}
+
+			bool valid = true;
+			if (keyword == "model"s)
+			{
+				BakeModel model;
+				string modelFile;
+				valid = static_cast<bool>(lineStream >> modelFile);
+				if (lineStream >> model.Width)
+				{
+					model.Height = model.Width;
+					lineStream >> model.Height;
+					valid = valid && model.Width > 0 && model.Height > 0;
+				}
+
+				model.Filename = filename.parent_path() / modelFile;
+				scene.Models.push_back(move(model));
+			}
+			else if (keyword == "directional"s)
+			{
+				BakeLight light;
+				light.Type = BakeLightType::Directional;
+				valid = static_cast<bool>(lineStream >> light.Direction.x >> light.Direction.y >> light.Direction.z >> light.Color.x >> light.Color.y >> light.Color.z);
+				light.Direction = Normalize(light.Direction);
+				scene.Lights.push_back(light);
+			}
+			else if (keyword == "point"s)
+			{
+				BakeLight light;
+				light.Type = BakeLightType::Point;
+				valid = static_cast<bool>(lineStream >> light.Position.x >> light.Position.y >> light.Position.z >> light.Radius >> light.Color.x >> light.Color.y >> light.Color.z);
+				scene.Lights.push_back(light);
+			}
+			else if (keyword == "spot"s)
+			{
+				BakeLight light;
+				light.Type = BakeLightType::Spot;
+				valid = static_cast<bool>(lineStream >> light.Position.x >> light.Position.y >> light.Position.z >> light.Direction.x >> light.Direction.y >> light.Direction.z
+					>> light.Radius >> light.InnerAngle >> light.OuterAngle >> light.Color.x >> light.Color.y >> light.Color.z);
+				light.Direction = Normalize(light.Direction);
+				scene.Lights.push_back(light);
+			}
+			else if (keyword == "sky"s)
+			{
+				valid = static_cast<bool>(lineStream >> scene.SkyColor.x >> scene.SkyColor.y >> scene.SkyColor.z);
+			}
+			else
+			{
+				valid = false;
+			}
+
+			if (!valid)
+			{
+				throw exception(("Malformed scene line: "s + line).c_str());
+			}
+		}
+
+		if (scene.Models.empty())
+		{
+			throw exception("Scene has no models.");
+		}
+
+		return scene;
+	}
+}
\ No newline at end of file
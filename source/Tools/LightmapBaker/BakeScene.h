@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <filesystem>
+#include <DirectXMath.h>
+
+namespace LightmapBaker
+{
+	enum class BakeLightType
+	{
+		Directional,
+		Point,
+		Spot
+	};
+
+	// Mirrors the runtime lights: point and spot lights attenuate linearly to zero at their radius, and spot light
+	// angles are cosines, blended with smoothstep from the outer to the inner angle.
+	struct BakeLight final
+	{
+		BakeLightType Type{ BakeLightType::Point };
+		DirectX::XMFLOAT3 Position{ 0.0f, 0.0f, 0.0f };
+		DirectX::XMFLOAT3 Direction{ 0.0f, 0.0f, -1.0f };
+		DirectX::XMFLOAT3 Color{ 1.0f, 1.0f, 1.0f };
+		float Radius{ 50.0f };
+		float InnerAngle{ 0.75f };
+		float OuterAngle{ 0.25f };
+	};
+
+	// A zero size selects the size of the atlas the model's lightmap coordinates were packed for, or
+	// DefaultLightmapSize for models that do not record one.
+	struct BakeModel final
+	{
+		std::filesystem::path Filename;
+		std::uint32_t Width{ 0 };
+		std::uint32_t Height{ 0 };
+
+		inline static const std::uint32_t DefaultLightmapSize{ 512 };
+	};
+
+	// One scene file line per model or light ('#' starts a comment line):
+	//   model <file.model> [width [height]]
+	//   directional <direction xyz> <color rgb>
+	//   point <position xyz> <radius> <color rgb>
+	//   spot <position xyz> <direction xyz> <radius> <inner angle> <outer angle> <color rgb>
+	//   sky <color rgb>
+	// Model files are relative to the scene file. Lightmaps are best baked at the model's atlas size (the default),
+	// since the padding between charts is in texels of that atlas.
+	struct BakeScene final
+	{
+		std::vector<BakeModel> Models;
+		std::vector<BakeLight> Lights;
+		DirectX::XMFLOAT3 SkyColor{ 0.0f, 0.0f, 0.0f };
+
+		static BakeScene Load(const std::filesystem::path& filename);
+	};
+}
\ No newline at end of file
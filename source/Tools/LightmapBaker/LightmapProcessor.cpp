@@ -0,0 +1,558 @@
+#include "pch.h"
+#include "LightmapProcessor.h"
+#include "Model.h"
+#include "Mesh.h"
+#include "PackedVectorHelper.h"
+#include "GameException.h"
+#include <DirectXTex.h>
+#include <execution>
+#include <numeric>
+#include <atomic>
+
+using namespace std;
+using namespace std::filesystem;
+using namespace std::string_literals;
+using namespace gsl;
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+using namespace Library;
+
+namespace LightmapBaker
+{
+	namespace
+	{
+		const uint32_t LightmapChannel{ 1 };
+		const float Pi{ 3.14159265358979f };
+
+		// PCG32 (O'Neill); one stream per texel keeps the bake deterministic regardless of thread scheduling.
+		class Random final
+		{
+		public:
+			Random(uint64_t seed, uint64_t stream) :
+				mIncrement((stream << 1) | 1)
+			{
+				Next();
+				mState += seed;
+				Next();
+			}
+
+			uint32_t Next()
+			{
+				const uint64_t state = mState;
+				mState = state * 6364136223846793005ULL + mIncrement;
+				const uint32_t shifted = static_cast<uint32_t>(((state >> 18) ^ state) >> 27);
+				const uint32_t rotation = static_cast<uint32_t>(state >> 59);
+				return (shifted >> rotation) | (shifted << ((0U - rotation) & 31));
+			}
+
+			float NextFloat()
+			{
+				return (Next() >> 8) * (1.0f / 16777216.0f);
+			}
+
+		private:
+			uint64_t mState{ 0 };
+			uint64_t mIncrement;
+		};
+
+		// Texels covered by the bake target; unused texels have a zero normal.
+		struct SurfaceTexel final
+		{
+			XMFLOAT3 Position{ 0.0f, 0.0f, 0.0f };
+			XMFLOAT3 Normal{ 0.0f, 0.0f, 0.0f };
+			XMFLOAT3 GeometricNormal{ 0.0f, 0.0f, 0.0f };
+			float WorldSize{ 0.0f };
+		};
+
+		XMVECTOR CosineSampleHemisphere(FXMVECTOR normal, float u1, float u2)
+		{
+			// Orthonormal basis from Duff et al., "Building an Orthonormal Basis, Revisited".
+			XMFLOAT3 n;
+			XMStoreFloat3(&n, normal);
+			const float sign = copysign(1.0f, n.z);
+			const float a = -1.0f / (sign + n.z);
+			const float b = n.x * n.y * a;
+			const XMVECTOR tangent = XMVectorSet(1.0f + sign * n.x * n.x * a, sign * b, -sign * n.x, 0.0f);
+			const XMVECTOR bitangent = XMVectorSet(b, sign + n.y * n.y * a, -n.y, 0.0f);
+
+			const float radius = sqrt(u1);
+			const float phi = 2.0f * Pi * u2;
+			const XMVECTOR direction = XMVectorScale(tangent, radius * cos(phi)) + XMVectorScale(bitangent, radius * sin(phi)) + XMVectorScale(normal, sqrt(max(0.0f, 1.0f - u1)));
+
+			return XMVector3Normalize(direction);
+		}
+
+		float SmoothStep(float minimum, float maximum, float value)
+		{
+			const float t = clamp((value - minimum) / (maximum - minimum), 0.0f, 1.0f);
+			return t * t * (3.0f - 2.0f * t);
+		}
+	}
+
+	LightmapProcessor::LightmapProcessor(const BakeScene& scene, const path& contentDirectory) :
+		mLights(scene.Lights), mSkyColor(scene.SkyColor)
+	{
+		for (const BakeModel& bakeModel : scene.Models)
+		{
+			AddModel(bakeModel, contentDirectory);
+		}
+
+		if (mTriangleVertices.empty())
+		{
+			throw exception("Scene has no triangles.");
+		}
+
+		XMVECTOR minimum = XMLoadFloat3(&mTriangleVertices[0]);
+		XMVECTOR maximum = minimum;
+		for (const XMFLOAT3& vertex : mTriangleVertices)
+		{
+			minimum = XMVectorMin(minimum, XMLoadFloat3(&vertex));
+			maximum = XMVectorMax(maximum, XMLoadFloat3(&vertex));
+		}
+
+		mSceneExtent = max(XMVectorGetX(XMVector3Length(maximum - minimum)), 1e-3f);
+		mRayEpsilon = mSceneExtent * 1e-4f;
+		mBvh = make_unique<TriangleBvh>(mTriangleVertices);
+	}
+
+	const TriangleBvh& LightmapProcessor::Bvh() const
+	{
+		return *mBvh;
+	}
+
+	size_t LightmapProcessor::ModelCount() const
+	{
+		return mTargets.size();
+	}
+
+	uint32_t LightmapProcessor::SkippedInstanceCount() const
+	{
+		return mSkippedInstanceCount;
+	}
+
+	const BakeModel& LightmapProcessor::BakedModel(size_t modelIndex) const
+	{
+		return mTargets.at(modelIndex).Model;
+	}
+
+	const ModelLightmap& LightmapProcessor::LightmapAtlas(size_t modelIndex) const
+	{
+		return mTargets.at(modelIndex).Atlas;
+	}
+
+	void LightmapProcessor::AddModel(const BakeModel& bakeModel, const path& contentDirectory)
+	{
+		Model::SharedModelResolver sharedModelResolver;
+		sharedModelResolver = [&contentDirectory, &sharedModelResolver](const string& sharedAssetName)
+		{
+			return make_shared<Model>((contentDirectory / sharedAssetName).string(), sharedModelResolver);
+		};
+
+		Model model(bakeModel.Filename.string(), sharedModelResolver);
+		BakeTarget target;
+		target.Model = bakeModel;
+		target.Atlas = model.Lightmap();
+		if (target.Model.Width == 0)
+		{
+			const bool hasAtlas = (target.Atlas.Width > 0 && target.Atlas.Height > 0);
+			target.Model.Width = (hasAtlas ? target.Atlas.Width : BakeModel::DefaultLightmapSize);
+			target.Model.Height = (hasAtlas ? target.Atlas.Height : BakeModel::DefaultLightmapSize);
+		}
+
+		for (uint32_t meshIndex = 0; meshIndex < model.Meshes().size(); ++meshIndex)
+		{
+			const Mesh& mesh = *model.Meshes()[meshIndex];
+			if (mesh.TextureCoordinates().size() <= LightmapChannel)
+			{
+				throw exception(("Model has no lightmap texture coordinates (run ModelPipeline.exe with -lightmapuvs): "s + bakeModel.Filename.filename().string()).c_str());
+			}
+
+			const auto& vertices = mesh.Vertices();
+			const auto& normals = mesh.Normals();
+			const auto& textureCoordinates = mesh.TextureCoordinates()[LightmapChannel];
+			const auto& indices = mesh.Indices();
+			const span<const XMFLOAT4X4> instanceTransforms = model.MeshInstanceTransforms(meshIndex);
+			bool isBaked = true;
+			for (const XMFLOAT4X4& instanceTransform : instanceTransforms)
+			{
+				const XMMATRIX worldMatrix = XMLoadFloat4x4(&instanceTransform);
+				const XMMATRIX normalMatrix = XMMatrixTranspose(XMMatrixInverse(nullptr, worldMatrix));
+
+				for (size_t i = 0; i + 2 < indices.size(); i += 3)
+				{
+					BakeTriangle triangle;
+					for (size_t corner = 0; corner < 3; ++corner)
+					{
+						const uint32_t vertexIndex = indices[i + corner];
+						XMStoreFloat3(&triangle.Positions[corner], XMVector3TransformCoord(XMLoadFloat3(&vertices[vertexIndex]), worldMatrix));
+						mTriangleVertices.push_back(triangle.Positions[corner]);
+
+						if (isBaked)
+						{
+							const XMVECTOR normal = (normals.empty() ? XMVectorZero() : XMVector3TransformNormal(XMLoadFloat3(&normals[vertexIndex]), normalMatrix));
+							XMStoreFloat3(&triangle.Normals[corner], XMVector3Normalize(normal));
+							triangle.TextureCoordinates[corner] = XMFLOAT2(textureCoordinates[vertexIndex].x, textureCoordinates[vertexIndex].y);
+						}
+					}
+
+					const XMVECTOR p0 = XMLoadFloat3(&triangle.Positions[0]);
+					const XMVECTOR geometricNormal = XMVector3Normalize(XMVector3Cross(XMLoadFloat3(&triangle.Positions[1]) - p0, XMLoadFloat3(&triangle.Positions[2]) - p0));
+					XMFLOAT3 storedNormal;
+					XMStoreFloat3(&storedNormal, geometricNormal);
+					mTriangleNormals.push_back(storedNormal);
+
+					if (isBaked)
+					{
+						if (normals.empty())
+						{
+							fill(begin(triangle.Normals), end(triangle.Normals), storedNormal);
+						}
+
+						target.Triangles.push_back(triangle);
+					}
+				}
+
+				if (!isBaked)
+				{
+					++mSkippedInstanceCount;
+				}
+
+				isBaked = false;
+			}
+		}
+
+		mTargets.push_back(move(target));
+	}
+
+	Lightmap LightmapProcessor::Bake(size_t modelIndex, const BakeSettings& settings, BakeStatistics& statistics) const
+	{
+		const BakeTarget& target = mTargets.at(modelIndex);
+		const uint32_t width = target.Model.Width;
+		const uint32_t height = target.Model.Height;
+		const size_t texelCount = static_cast<size_t>(width) * height;
+
+		// Rasterize the triangles in lightmap space, sampling at texel centres.
+		vector<SurfaceTexel> surface(texelCount);
+		for (const BakeTriangle& triangle : target.Triangles)
+		{
+			XMFLOAT2 uv[3];
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				uv[corner] = XMFLOAT2(triangle.TextureCoordinates[corner].x * width, triangle.TextureCoordinates[corner].y * height);
+			}
+
+			const float area = (uv[1].x - uv[0].x) * (uv[2].y - uv[0].y) - (uv[2].x - uv[0].x) * (uv[1].y - uv[0].y);
+			if (abs(area) < 1e-12f)
+			{
+				continue;
+			}
+
+			const XMVECTOR p0 = XMLoadFloat3(&triangle.Positions[0]);
+			const XMVECTOR p1 = XMLoadFloat3(&triangle.Positions[1]);
+			const XMVECTOR p2 = XMLoadFloat3(&triangle.Positions[2]);
+			XMVECTOR geometricNormal = XMVector3Normalize(XMVector3Cross(p1 - p0, p2 - p0));
+			const float worldArea = 0.5f * XMVectorGetX(XMVector3Length(XMVector3Cross(p1 - p0, p2 - p0)));
+			const float worldSize = sqrt(worldArea / (0.5f * abs(area)));
+
+			const int32_t minX = max(static_cast<int32_t>(floor(min({ uv[0].x, uv[1].x, uv[2].x }))), 0);
+			const int32_t maxX = min(static_cast<int32_t>(ceil(max({ uv[0].x, uv[1].x, uv[2].x }))), static_cast<int32_t>(width) - 1);
+			const int32_t minY = max(static_cast<int32_t>(floor(min({ uv[0].y, uv[1].y, uv[2].y }))), 0);
+			const int32_t maxY = min(static_cast<int32_t>(ceil(max({ uv[0].y, uv[1].y, uv[2].y }))), static_cast<int32_t>(height) - 1);
+			for (int32_t y = minY; y <= maxY; ++y)
+			{
+				for (int32_t x = minX; x <= maxX; ++x)
+				{
+					const float px = x + 0.5f;
+					const float py = y + 0.5f;
+					const float w1 = ((px - uv[0].x) * (uv[2].y - uv[0].y) - (uv[2].x - uv[0].x) * (py - uv[0].y)) / area;
+					const float w2 = ((uv[1].x - uv[0].x) * (py - uv[0].y) - (px - uv[0].x) * (uv[1].y - uv[0].y)) / area;
+					const float w0 = 1.0f - w1 - w2;
+					const float tolerance = -1e-4f;
+					if (w0 < tolerance || w1 < tolerance || w2 < tolerance)
+					{
+						continue;
+					}
+
+					SurfaceTexel& texel = surface[static_cast<size_t>(y) * width + x];
+					XMStoreFloat3(&texel.Position, XMVectorScale(p0, w0) + XMVectorScale(p1, w1) + XMVectorScale(p2, w2));
+
+					XMVECTOR normal = XMVectorScale(XMLoadFloat3(&triangle.Normals[0]), w0) + XMVectorScale(XMLoadFloat3(&triangle.Normals[1]), w1) + XMVectorScale(XMLoadFloat3(&triangle.Normals[2]), w2);
+					normal = XMVector3Normalize(normal);
+					XMStoreFloat3(&texel.Normal, normal);
+
+					// Offset rays to the side the shading normal faces.
+					XMStoreFloat3(&texel.GeometricNormal, (XMVectorGetX(XMVector3Dot(normal, geometricNormal)) < 0.0f ? -geometricNormal : geometricNormal));
+					texel.WorldSize = worldSize;
+				}
+			}
+		}
+
+		// Irradiance from the scene lights, with the attenuation and spot falloff of the runtime shaders.
+		auto directLighting = [this](FXMVECTOR position, FXMVECTOR normal, FXMVECTOR offsetNormal, uint64_t& rayCount)
+		{
+			const XMVECTOR origin = position + XMVectorScale(offsetNormal, mRayEpsilon);
+			XMVECTOR irradiance = XMVectorZero();
+			for (const BakeLight& light : mLights)
+			{
+				XMVECTOR lightDirection;
+				float distance;
+				float attenuation = 1.0f;
+				if (light.Type == BakeLightType::Directional)
+				{
+					lightDirection = -XMLoadFloat3(&light.Direction);
+					distance = mSceneExtent * 2.0f;
+				}
+				else
+				{
+					const XMVECTOR toLight = XMLoadFloat3(&light.Position) - position;
+					distance = XMVectorGetX(XMVector3Length(toLight));
+					if (distance <= 0.0f || distance >= light.Radius)
+					{
+						continue;
+					}
+
+					lightDirection = XMVectorScale(toLight, 1.0f / distance);
+					attenuation = clamp(1.0f - distance / light.Radius, 0.0f, 1.0f);
+					if (light.Type == BakeLightType::Spot)
+					{
+						const float lightAngle = XMVectorGetX(XMVector3Dot(-XMLoadFloat3(&light.Direction), lightDirection));
+						attenuation *= (lightAngle > 0.0f ? SmoothStep(light.OuterAngle, light.InnerAngle, lightAngle) : 0.0f);
+					}
+				}
+
+				const float nDotL = XMVectorGetX(XMVector3Dot(normal, lightDirection));
+				if (nDotL <= 0.0f || attenuation <= 0.0f)
+				{
+					continue;
+				}
+
+				++rayCount;
+				const Ray shadowRay{ XMFLOAT3(XMVectorGetX(origin), XMVectorGetY(origin), XMVectorGetZ(origin)), XMFLOAT3(XMVectorGetX(lightDirection), XMVectorGetY(lightDirection), XMVectorGetZ(lightDirection)), distance - mRayEpsilon };
+				if (!mBvh->Occluded(shadowRay))
+				{
+					irradiance += XMVectorScale(XMLoadFloat3(&light.Color), nDotL * attenuation);
+				}
+			}
+
+			return irradiance;
+		};
+
+		vector<XMFLOAT3> direct(texelCount);
+		vector<XMFLOAT3> indirect(texelCount);
+		atomic<uint64_t> rayCount{ 0 };
+		vector<uint32_t> rows(height);
+		iota(rows.begin(), rows.end(), 0U);
+		const uint32_t sampleCount = max(settings.SampleCount, 1U);
+		for_each(execution::par, rows.begin(), rows.end(), [&](uint32_t y)
+		{
+			uint64_t rowRayCount = 0;
+			for (uint32_t x = 0; x < width; ++x)
+			{
+				const size_t texelIndex = static_cast<size_t>(y) * width + x;
+				const SurfaceTexel& texel = surface[texelIndex];
+				const XMVECTOR normal = XMLoadFloat3(&texel.Normal);
+				if (XMVector3Equal(normal, XMVectorZero()))
+				{
+					continue;
+				}
+
+				const XMVECTOR position = XMLoadFloat3(&texel.Position);
+				const XMVECTOR geometricNormal = XMLoadFloat3(&texel.GeometricNormal);
+				XMStoreFloat3(&direct[texelIndex], directLighting(position, normal, geometricNormal, rowRayCount));
+
+				// Cosine-weighted paths: each sample's contribution is already divided by its probability density.
+				Random random(static_cast<uint64_t>(modelIndex) << 32 | texelIndex, texelIndex);
+				XMVECTOR indirectSum = XMVectorZero();
+				for (uint32_t sample = 0; sample < sampleCount; ++sample)
+				{
+					XMVECTOR pathPosition = position;
+					XMVECTOR pathNormal = normal;
+					XMVECTOR pathOffsetNormal = geometricNormal;
+					float throughput = 1.0f;
+					for (uint32_t bounce = 0; bounce < settings.MaxBounces; ++bounce)
+					{
+						const XMVECTOR direction = CosineSampleHemisphere(pathNormal, random.NextFloat(), random.NextFloat());
+						const XMVECTOR origin = pathPosition + XMVectorScale(pathOffsetNormal, mRayEpsilon);
+
+						Ray ray;
+						XMStoreFloat3(&ray.Origin, origin);
+						XMStoreFloat3(&ray.Direction, direction);
+						ray.MaxDistance = numeric_limits<float>::max();
+						RayHit hit;
+						++rowRayCount;
+						if (!mBvh->Intersect(ray, hit))
+						{
+							indirectSum += XMVectorScale(XMLoadFloat3(&mSkyColor), throughput);
+							break;
+						}
+
+						pathPosition = origin + XMVectorScale(direction, hit.Distance);
+						pathNormal = XMLoadFloat3(&mTriangleNormals[hit.Triangle]);
+						if (XMVectorGetX(XMVector3Dot(pathNormal, direction)) > 0.0f)
+						{
+							pathNormal = -pathNormal;
+						}
+
+						pathOffsetNormal = pathNormal;
+						throughput *= settings.Albedo;
+						indirectSum += XMVectorScale(directLighting(pathPosition, pathNormal, pathOffsetNormal, rowRayCount), throughput);
+
+						// Russian roulette after the first bounces keeps long paths unbiased but rare.
+						if (bounce >= 1)
+						{
+							const float survival = min(throughput, 1.0f);
+							if (random.NextFloat() >= survival)
+							{
+								break;
+							}
+
+							throughput /= survival;
+						}
+					}
+				}
+
+				XMStoreFloat3(&indirect[texelIndex], XMVectorScale(indirectSum, 1.0f / sampleCount));
+			}
+
+			rayCount += rowRayCount;
+		});
+
+		// Edge-avoiding a-trous wavelet filter (Dammertz et al.) over the noisy indirect term only; weights fall off
+		// with the normal and world-space distance, scaled by the texel footprint of each pass.
+		const float kernel[3] = { 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f };
+		vector<XMFLOAT3> filtered(texelCount);
+		for (uint32_t iteration = 0; iteration < settings.DenoiseIterations; ++iteration)
+		{
+			const int32_t step = 1 << iteration;
+			for_each(execution::par, rows.begin(), rows.end(), [&](uint32_t y)
+			{
+				for (uint32_t x = 0; x < width; ++x)
+				{
+					const size_t texelIndex = static_cast<size_t>(y) * width + x;
+					const SurfaceTexel& texel = surface[texelIndex];
+					const XMVECTOR normal = XMLoadFloat3(&texel.Normal);
+					if (XMVector3Equal(normal, XMVectorZero()))
+					{
+						continue;
+					}
+
+					const XMVECTOR position = XMLoadFloat3(&texel.Position);
+					const float positionSigma = max(texel.WorldSize * step * 2.0f, mRayEpsilon);
+					XMVECTOR sum = XMVectorZero();
+					float weightSum = 0.0f;
+					for (int32_t dy = -2; dy <= 2; ++dy)
+					{
+						const int32_t sy = static_cast<int32_t>(y) + dy * step;
+						if (sy < 0 || sy >= static_cast<int32_t>(height))
+						{
+							continue;
+						}
+
+						for (int32_t dx = -2; dx <= 2; ++dx)
+						{
+							const int32_t sx = static_cast<int32_t>(x) + dx * step;
+							if (sx < 0 || sx >= static_cast<int32_t>(width))
+							{
+								continue;
+							}
+
+							const size_t sampleIndex = static_cast<size_t>(sy) * width + sx;
+							const SurfaceTexel& sampleTexel = surface[sampleIndex];
+							const float normalWeight = XMVectorGetX(XMVector3Dot(normal, XMLoadFloat3(&sampleTexel.Normal)));
+							if (normalWeight <= 0.0f)
+							{
+								continue;
+							}
+
+							const float distanceSquared = XMVectorGetX(XMVector3LengthSq(position - XMLoadFloat3(&sampleTexel.Position)));
+							const float weight = kernel[abs(dx)] * kernel[abs(dy)] * pow(normalWeight, 32.0f) * exp(-distanceSquared / (positionSigma * positionSigma));
+							sum += XMVectorScale(XMLoadFloat3(&indirect[sampleIndex]), weight);
+							weightSum += weight;
+						}
+					}
+
+					XMStoreFloat3(&filtered[texelIndex], XMVectorScale(sum, 1.0f / weightSum));
+				}
+			});
+
+			swap(indirect, filtered);
+		}
+
+		Lightmap lightmap;
+		lightmap.Width = width;
+		lightmap.Height = height;
+		lightmap.Texels.resize(texelCount, XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f));
+		for (size_t i = 0; i < texelCount; ++i)
+		{
+			if (surface[i].WorldSize > 0.0f)
+			{
+				lightmap.Texels[i] = XMFLOAT4(direct[i].x + indirect[i].x, direct[i].y + indirect[i].y, direct[i].z + indirect[i].z, 1.0f);
+				++statistics.TexelCount;
+			}
+		}
+
+		// Fill the gutter around each chart from its covered neighbours so that bilinear filtering and mipmaps do
+		// not blend in unlit texels.
+		vector<XMFLOAT4> dilated;
+		for (uint32_t iteration = 0; iteration < settings.DilationTexels; ++iteration)
+		{
+			dilated = lightmap.Texels;
+			for_each(execution::par, rows.begin(), rows.end(), [&](uint32_t y)
+			{
+				for (uint32_t x = 0; x < width; ++x)
+				{
+					const size_t texelIndex = static_cast<size_t>(y) * width + x;
+					if (lightmap.Texels[texelIndex].w > 0.0f)
+					{
+						continue;
+					}
+
+					XMVECTOR sum = XMVectorZero();
+					uint32_t count = 0;
+					for (int32_t dy = -1; dy <= 1; ++dy)
+					{
+						for (int32_t dx = -1; dx <= 1; ++dx)
+						{
+							const int32_t sx = static_cast<int32_t>(x) + dx;
+							const int32_t sy = static_cast<int32_t>(y) + dy;
+							if (sx < 0 || sy < 0 || sx >= static_cast<int32_t>(width) || sy >= static_cast<int32_t>(height))
+							{
+								continue;
+							}
+
+							const XMFLOAT4& neighbour = lightmap.Texels[static_cast<size_t>(sy) * width + sx];
+							if (neighbour.w > 0.0f)
+							{
+								sum += XMLoadFloat4(&neighbour);
+								++count;
+							}
+						}
+					}
+
+					if (count > 0)
+					{
+						XMStoreFloat4(&dilated[texelIndex], XMVectorScale(sum, 1.0f / count));
+					}
+				}
+			});
+
+			swap(lightmap.Texels, dilated);
+		}
+
+		statistics.RayCount += rayCount;
+
+		return lightmap;
+	}
+
+	void LightmapProcessor::SaveLightmap(const Lightmap& lightmap, const wstring& filename)
+	{
+		ScratchImage image;
+		ThrowIfFailed(image.Initialize2D(DXGI_FORMAT_R16G16B16A16_FLOAT, lightmap.Width, lightmap.Height, 1, 1), "ScratchImage::Initialize2D() failed.");
+
+		const span<const float> source(reinterpret_cast<const float*>(lightmap.Texels.data()), lightmap.Texels.size() * 4);
+		const span<HALF> destination(reinterpret_cast<HALF*>(image.GetPixels()), image.GetPixelsSize() / sizeof(HALF));
+		PackedVectorHelper::FloatToHalf(source, destination);
+
+		ThrowIfFailed(SaveToDDSFile(image.GetImages(), image.GetImageCount(), image.GetMetadata(), DDS_FLAGS_NONE, filename.c_str()), "SaveToDDSFile() failed.");
+	}
+}
\ No newline at end of file
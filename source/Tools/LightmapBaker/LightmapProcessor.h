@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <filesystem>
+#include <DirectXMath.h>
+#include "BakeScene.h"
+#include "TriangleBvh.h"
+#include "Model.h"
+
+namespace LightmapBaker
+{
+	struct BakeSettings final
+	{
+		std::uint32_t SampleCount{ 128 }; // Indirect lighting paths per texel.
+		std::uint32_t MaxBounces{ 3 };
+		float Albedo{ 0.5f }; // Diffuse reflectance of every surface for indirect bounces.
+		std::uint32_t DenoiseIterations{ 4 }; // A-trous filter passes over the indirect lighting.
+		std::uint32_t DilationTexels{ 4 }; // Gutter texels filled around each chart.
+	};
+
+	struct BakeStatistics final
+	{
+		std::uint64_t RayCount{ 0 };
+		std::uint64_t TexelCount{ 0 };
+	};
+
+	// Irradiance per texel (shader units: surface color multiplies it directly); alpha is 1 for texels that
+	// belong to a chart or its dilated gutter and 0 elsewhere.
+	struct Lightmap final
+	{
+		std::uint32_t Width{ 0 };
+		std::uint32_t Height{ 0 };
+		std::vector<DirectX::XMFLOAT4> Texels;
+	};
+
+	// Bakes direct and indirect diffuse lighting into texture coordinate channel 1 of each scene model. All mesh
+	// instances occlude and bounce light, but only the first instance of each mesh receives lightmap texels.
+	class LightmapProcessor final
+	{
+	public:
+		// Models that reference a shared model resolve it relative to the content directory.
+		LightmapProcessor(const BakeScene& scene, const std::filesystem::path& contentDirectory);
+		LightmapProcessor(const LightmapProcessor&) = delete;
+		LightmapProcessor(LightmapProcessor&&) = default;
+		LightmapProcessor& operator=(const LightmapProcessor&) = delete;
+		LightmapProcessor& operator=(LightmapProcessor&&) = default;
+		~LightmapProcessor() = default;
+
+		const Library::TriangleBvh& Bvh() const;
+		std::size_t ModelCount() const;
+		std::uint32_t SkippedInstanceCount() const;
+
+		// The model as baked, with its lightmap size resolved, and the atlas size its lightmap coordinates were
+		// packed for (zero if the model does not record one).
+		const BakeModel& BakedModel(std::size_t modelIndex) const;
+		const Library::ModelLightmap& LightmapAtlas(std::size_t modelIndex) const;
+
+		// Texel rows are baked in parallel.
+		Lightmap Bake(std::size_t modelIndex, const BakeSettings& settings, BakeStatistics& statistics) const;
+
+		static void SaveLightmap(const Lightmap& lightmap, const std::wstring& filename);
+
+	private:
+		struct BakeTriangle final
+		{
+			DirectX::XMFLOAT3 Positions[3];
+			DirectX::XMFLOAT3 Normals[3];
+			DirectX::XMFLOAT2 TextureCoordinates[3];
+		};
+
+		struct BakeTarget final
+		{
+			BakeModel Model;
+			Library::ModelLightmap Atlas;
+			std::vector<BakeTriangle> Triangles;
+		};
+
+		void AddModel(const BakeModel& bakeModel, const std::filesystem::path& contentDirectory);
+
+		std::vector<BakeLight> mLights;
+		DirectX::XMFLOAT3 mSkyColor;
+		std::vector<BakeTarget> mTargets;
+		std::vector<DirectX::XMFLOAT3> mTriangleVertices;
+		std::vector<DirectX::XMFLOAT3> mTriangleNormals;
+		std::unique_ptr<Library::TriangleBvh> mBvh;
+		float mRayEpsilon{ 0.0f };
+		float mSceneExtent{ 0.0f };
+		std::uint32_t mSkippedInstanceCount{ 0 };
+	};
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "pch.h"
+#include "BakeScene.h"
+#include "LightmapProcessor.h"
+#include "GameException.h"
+#include <chrono>
+#include <thread>
+
+using namespace std;
+using namespace std::chrono;
+using namespace std::filesystem;
+using namespace std::string_literals;
+using namespace LightmapBaker;
+using namespace Library;
+
+int main(int argc, char* argv[])
+{
+#if defined(DEBUG) | defined(_DEBUG)
+	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+#endif
+
+	try
+	{
+		if (argc < 2)
+		{
+			throw exception("Usage: LightmapBaker.exe scenefile [-samples count] [-bounces count] [-albedo reflectance] [-denoise iterations] [-content directory]");
+		}
+
+		ThrowIfFailed(CoInitializeEx(nullptr, COINITBASE_MULTITHREADED), "Error initializing COM.");
+
+		const path sceneFile = absolute(path(argv[1]));
+		path contentDirectory = sceneFile.parent_path();
+		BakeSettings settings;
+		for (int i = 2; i < argc; i++)
+		{
+			const string option(argv[i]);
+			if (option == "-samples"s && i + 1 < argc)
+			{
+				settings.SampleCount = static_cast<uint32_t>(stoul(argv[++i]));
+			}
+			else if (option == "-bounces"s && i + 1 < argc)
+			{
+				settings.MaxBounces = static_cast<uint32_t>(stoul(argv[++i]));
+			}
+			else if (option == "-albedo"s && i + 1 < argc)
+			{
+				settings.Albedo = stof(argv[++i]);
+			}
+			else if (option == "-denoise"s && i + 1 < argc)
+			{
+				settings.DenoiseIterations = static_cast<uint32_t>(stoul(argv[++i]));
+			}
+			else if (option == "-content"s && i + 1 < argc)
+			{
+				contentDirectory = absolute(path(argv[++i]));
+			}
+			else
+			{
+				throw exception(("Unknown option: "s + option).c_str());
+			}
+		}
+
+		cout << "Reading: "s << sceneFile.filename() << endl;
+		auto startTime = high_resolution_clock::now();
+		const BakeScene scene = BakeScene::Load(sceneFile);
+		const LightmapProcessor processor(scene, contentDirectory);
+		cout << "Scene: "s << scene.Models.size() << " models, "s << scene.Lights.size() << " lights, "s << processor.Bvh().TriangleCount() << " triangles, "s << processor.Bvh().NodeCount() << " BVH nodes ("s
+			<< duration_cast<milliseconds>(high_resolution_clock::now() - startTime).count() << " ms)"s << endl;
+
+		if (processor.SkippedInstanceCount() > 0)
+		{
+			cout << "Warning: "s << processor.SkippedInstanceCount() << " additional mesh instances share their mesh's lightmap texels and are baked only as occluders."s << endl;
+		}
+
+		for (size_t i = 0; i < processor.ModelCount(); ++i)
+		{
+			const BakeModel& bakedModel = processor.BakedModel(i);
+			const ModelLightmap& atlas = processor.LightmapAtlas(i);
+			if (atlas.Width > 0 && (bakedModel.Width != atlas.Width || bakedModel.Height != atlas.Height))
+			{
+				cout << "Warning: "s << bakedModel.Filename.filename() << " is baked at "s << bakedModel.Width << "x"s << bakedModel.Height << ", but its lightmap coordinates were packed for a "s
+					<< atlas.Width << "x"s << atlas.Height << " atlas; the gutters between charts change size, and filtering may bleed across them."s << endl;
+			}
+		}
+
+		BakeStatistics statistics;
+		auto bakeStartTime = high_resolution_clock::now();
+		for (size_t i = 0; i < processor.ModelCount(); ++i)
+		{
+			const BakeModel& bakeModel = scene.Models[i];
+			const Lightmap lightmap = processor.Bake(i, settings, statistics);
+
+			const path outputFile = bakeModel.Filename.parent_path() / (bakeModel.Filename.stem().string() + ".lightmap.dds"s);
+			cout << "Writing: "s << outputFile.filename() << " ("s << lightmap.Width << "x"s << lightmap.Height << ")"s << endl;
+			LightmapProcessor::SaveLightmap(lightmap, outputFile.wstring());
+		}
+
+		const double bakeSeconds = max(duration_cast<milliseconds>(high_resolution_clock::now() - bakeStartTime).count() / 1000.0, 0.001);
+		cout << "Baked "s << statistics.TexelCount << " texels ("s << settings.SampleCount << " samples, "s << settings.MaxBounces << " bounces) in "s << fixed << setprecision(1) << bakeSeconds << " s: "s
+			<< statistics.RayCount / bakeSeconds / 1000000.0 << " Mrays/s on "s << thread::hardware_concurrency() << " hardware threads"s << endl;
+		cout << "Finished in "s << duration_cast<milliseconds>(high_resolution_clock::now() - startTime).count() << " ms"s << endl;
+	}
+	catch (exception ex)
+	{
+		cout << ex.what() << endl;
+	}
+
+	return 0;
+}
\ No newline at end of file
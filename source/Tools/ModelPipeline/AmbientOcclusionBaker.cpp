@@ -0,0 +1,233 @@
+#include "pch.h"
+#include "AmbientOcclusionBaker.h"
+#include "Model.h"
+#include "Mesh.h"
+#include "TriangleBvh.h"
+#include <execution>
+#include <numeric>
+#include <atomic>
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+using namespace Library;
+
+namespace ModelPipeline
+{
+	namespace
+	{
+		const float Pi{ 3.14159265358979f };
+
+		// Hammersley points mapped to a cosine-weighted hemisphere around +z; each vertex rotates the set about its
+		// normal by a different angle, which hides the pattern that a fixed set would leave across a surface.
+		vector<XMFLOAT3> HemisphereSamples(uint32_t sampleCount)
+		{
+			vector<XMFLOAT3> samples(sampleCount);
+			for (uint32_t i = 0; i < sampleCount; i++)
+			{
+				uint32_t bits = i;
+				bits = (bits << 16) | (bits >> 16);
+				bits = ((bits & 0x55555555U) << 1) | ((bits & 0xAAAAAAAAU) >> 1);
+				bits = ((bits & 0x33333333U) << 2) | ((bits & 0xCCCCCCCCU) >> 2);
+				bits = ((bits & 0x0F0F0F0FU) << 4) | ((bits & 0xF0F0F0F0U) >> 4);
+				bits = ((bits & 0x00FF00FFU) << 8) | ((bits & 0xFF00FF00U) >> 8);
+
+				const float u1 = (i + 0.5f) / sampleCount;
+				const float u2 = bits * 2.3283064365386963e-10f;
+				const float radius = sqrt(u1);
+				const float phi = 2.0f * Pi * u2;
+				samples[i] = XMFLOAT3(radius * cos(phi), radius * sin(phi), sqrt(max(0.0f, 1.0f - u1)));
+			}
+
+			return samples;
+		}
+
+		float VertexRotation(uint32_t vertex)
+		{
+			// Integer hash (Wang) of the vertex index, as a fraction of a turn.
+			vertex = (vertex ^ 61U) ^ (vertex >> 16);
+			vertex *= 9U;
+			vertex ^= vertex >> 4;
+			vertex *= 0x27D4EB2DU;
+			vertex ^= vertex >> 15;
+			return (vertex >> 8) * (2.0f * Pi / 16777216.0f);
+		}
+
+		// Area-weighted face normals, for meshes imported without normals.
+		vector<XMFLOAT3> ComputeNormals(const MeshData& meshData)
+		{
+			vector<XMVECTOR> sums(meshData.Vertices.size(), XMVectorZero());
+			for (size_t i = 0; i + 2 < meshData.Indices.size(); i += 3)
+			{
+				const uint32_t i0 = meshData.Indices[i];
+				const uint32_t i1 = meshData.Indices[i + 1];
+				const uint32_t i2 = meshData.Indices[i + 2];
+				const XMVECTOR p0 = XMLoadFloat3(&meshData.Vertices[i0]);
+				const XMVECTOR faceNormal = XMVector3Cross(XMLoadFloat3(&meshData.Vertices[i1]) - p0, XMLoadFloat3(&meshData.Vertices[i2]) - p0);
+				sums[i0] += faceNormal;
+				sums[i1] += faceNormal;
+				sums[i2] += faceNormal;
+			}
+
+			vector<XMFLOAT3> normals(sums.size());
+			for (size_t i = 0; i < sums.size(); i++)
+			{
+				XMStoreFloat3(&normals[i], XMVector3Normalize(sums[i]));
+			}
+
+			return normals;
+		}
+	}
+
+	AmbientOcclusionStatistics AmbientOcclusionBaker::Bake(Model& model, const AmbientOcclusionSettings& settings)
+	{
+		// Gather every mesh instance into one triangle list in model space.
+		vector<XMFLOAT3> triangleVertices;
+		for (uint32_t meshIndex = 0; meshIndex < model.Meshes().size(); meshIndex++)
+		{
+			const MeshData& meshData = model.Meshes()[meshIndex]->Data();
+			if (meshData.Indices.size() % 3 != 0)
+			{
+				throw exception("Ambient occlusion requires triangle lists.");
+			}
+
+			for (const XMFLOAT4X4& instanceTransform : model.MeshInstanceTransforms(meshIndex))
+			{
+				const XMMATRIX worldMatrix = XMLoadFloat4x4(&instanceTransform);
+				for (const uint32_t index : meshData.Indices)
+				{
+					XMFLOAT3 vertex;
+					XMStoreFloat3(&vertex, XMVector3TransformCoord(XMLoadFloat3(&meshData.Vertices[index]), worldMatrix));
+					triangleVertices.push_back(vertex);
+				}
+			}
+		}
+
+		AmbientOcclusionStatistics statistics;
+		if (triangleVertices.empty())
+		{
+			return statistics;
+		}
+
+		XMVECTOR minimum = XMLoadFloat3(&triangleVertices[0]);
+		XMVECTOR maximum = minimum;
+		for (const XMFLOAT3& vertex : triangleVertices)
+		{
+			minimum = XMVectorMin(minimum, XMLoadFloat3(&vertex));
+			maximum = XMVectorMax(maximum, XMLoadFloat3(&vertex));
+		}
+
+		const float diagonal = max(XMVectorGetX(XMVector3Length(maximum - minimum)), 1e-6f);
+		const float maxDistance = (settings.MaxDistance > 0.0f ? settings.MaxDistance : diagonal * 0.1f);
+		const float rayEpsilon = diagonal * 1e-4f;
+
+		const TriangleBvh bvh(triangleVertices);
+		statistics.TriangleCount = bvh.TriangleCount();
+
+		const uint32_t packetCount = max((settings.SampleCount + RayPacket::Size - 1) / RayPacket::Size, 1U);
+		const vector<XMFLOAT3> samples = HemisphereSamples(packetCount * RayPacket::Size);
+		atomic<uint64_t> rayCount{ 0 };
+		double occlusionSum = 0.0;
+
+		for (uint32_t meshIndex = 0; meshIndex < model.Meshes().size(); meshIndex++)
+		{
+			MeshData& meshData = model.Meshes()[meshIndex]->Data();
+			const span<const XMFLOAT4X4> instanceTransforms = model.MeshInstanceTransforms(meshIndex);
+			if (instanceTransforms.empty() || meshData.Vertices.empty())
+			{
+				continue;
+			}
+
+			const vector<XMFLOAT3> computedNormals = (meshData.Normals.size() == meshData.Vertices.size() ? vector<XMFLOAT3>() : ComputeNormals(meshData));
+			const vector<XMFLOAT3>& normals = (computedNormals.empty() ? meshData.Normals : computedNormals);
+			const XMMATRIX worldMatrix = XMLoadFloat4x4(&instanceTransforms[0]);
+			const XMMATRIX normalMatrix = XMMatrixTranspose(XMMatrixInverse(nullptr, worldMatrix));
+
+			vector<float> visibility(meshData.Vertices.size());
+			vector<uint32_t> vertexIndices(meshData.Vertices.size());
+			iota(vertexIndices.begin(), vertexIndices.end(), 0U);
+			for_each(execution::par, vertexIndices.begin(), vertexIndices.end(), [&](uint32_t vertex)
+			{
+				const XMVECTOR position = XMVector3TransformCoord(XMLoadFloat3(&meshData.Vertices[vertex]), worldMatrix);
+				const XMVECTOR normal = XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&normals[vertex]), normalMatrix));
+				if (XMVector3Equal(normal, XMVectorZero()))
+				{
+					visibility[vertex] = 1.0f;
+					return;
+				}
+
+				// Tangent frame around the normal (Duff et al.), rotated per vertex.
+				XMFLOAT3 n;
+				XMStoreFloat3(&n, normal);
+				const float sign = copysign(1.0f, n.z);
+				const float a = -1.0f / (sign + n.z);
+				const float b = n.x * n.y * a;
+				const XMVECTOR baseTangent = XMVectorSet(1.0f + sign * n.x * n.x * a, sign * b, -sign * n.x, 0.0f);
+				const XMVECTOR baseBitangent = XMVectorSet(b, sign + n.y * n.y * a, -n.y, 0.0f);
+				const float rotation = VertexRotation(vertex);
+				const XMVECTOR tangent = XMVectorScale(baseTangent, cos(rotation)) + XMVectorScale(baseBitangent, sin(rotation));
+				const XMVECTOR bitangent = XMVector3Cross(normal, tangent);
+
+				XMFLOAT3 origin;
+				XMStoreFloat3(&origin, position + XMVectorScale(normal, rayEpsilon));
+				RayPacket packet;
+				packet.OriginX = XMVectorReplicate(origin.x);
+				packet.OriginY = XMVectorReplicate(origin.y);
+				packet.OriginZ = XMVectorReplicate(origin.z);
+				packet.MaxDistance = XMVectorReplicate(maxDistance);
+
+				uint32_t occludedCount = 0;
+				for (uint32_t packetIndex = 0; packetIndex < packetCount; packetIndex++)
+				{
+					XMFLOAT3 directions[RayPacket::Size];
+					for (uint32_t lane = 0; lane < RayPacket::Size; lane++)
+					{
+						const XMFLOAT3& sample = samples[packetIndex * RayPacket::Size + lane];
+						XMStoreFloat3(&directions[lane], XMVectorScale(tangent, sample.x) + XMVectorScale(bitangent, sample.y) + XMVectorScale(normal, sample.z));
+					}
+
+					packet.DirectionX = XMVectorSet(directions[0].x, directions[1].x, directions[2].x, directions[3].x);
+					packet.DirectionY = XMVectorSet(directions[0].y, directions[1].y, directions[2].y, directions[3].y);
+					packet.DirectionZ = XMVectorSet(directions[0].z, directions[1].z, directions[2].z, directions[3].z);
+					const uint32_t occludedMask = bvh.Occluded(packet);
+					for (uint32_t lane = 0; lane < RayPacket::Size; lane++)
+					{
+						occludedCount += (occludedMask >> lane) & 1U;
+					}
+				}
+
+				const uint32_t rays = packetCount * RayPacket::Size;
+				visibility[vertex] = 1.0f - static_cast<float>(occludedCount) / rays;
+				rayCount += rays;
+			});
+
+			if (meshData.VertexColors.size() <= settings.Channel)
+			{
+				meshData.VertexColors.resize(settings.Channel + 1);
+			}
+
+			// Lower channels that did not exist are filled with white so that every channel stays per-vertex.
+			for (auto& colors : meshData.VertexColors)
+			{
+				if (colors.size() != meshData.Vertices.size())
+				{
+					colors.assign(meshData.Vertices.size(), XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f));
+				}
+			}
+
+			auto& colors = meshData.VertexColors[settings.Channel];
+			for (size_t i = 0; i < visibility.size(); i++)
+			{
+				colors[i] = XMFLOAT4(visibility[i], visibility[i], visibility[i], 1.0f);
+				occlusionSum += 1.0 - visibility[i];
+			}
+
+			statistics.VertexCount += visibility.size();
+		}
+
+		statistics.RayCount = rayCount;
+		statistics.AverageOcclusion = (statistics.VertexCount > 0 ? static_cast<float>(occlusionSum / statistics.VertexCount) : 0.0f);
+
+		return statistics;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Library
+{
+	class Model;
+}
+
+namespace ModelPipeline
+{
+	struct AmbientOcclusionSettings final
+	{
+		std::uint32_t SampleCount{ 64 }; // Hemisphere rays per vertex, rounded up to whole ray packets.
+		float MaxDistance{ 0.0f }; // Occluders farther away are ignored; zero uses a tenth of the model's bounding box diagonal.
+		std::uint32_t Channel{ 0 }; // Vertex color channel that receives the ambient occlusion; its previous contents are replaced.
+	};
+
+	struct AmbientOcclusionStatistics final
+	{
+		std::size_t VertexCount{ 0 };
+		std::size_t TriangleCount{ 0 };
+		std::uint64_t RayCount{ 0 };
+		float AverageOcclusion{ 0.0f };
+	};
+
+	// Bakes per-vertex ambient occlusion by casting cosine-distributed hemisphere rays against a bounding volume
+	// hierarchy of the model's own triangles. The result is stored as a grey vertex color (ambient visibility in
+	// RGB, 1 in alpha). Instanced meshes occlude with every instance, and their vertices are baked in the space
+	// of the first instance.
+	class AmbientOcclusionBaker final
+	{
+	public:
+		AmbientOcclusionBaker() = delete;
+
+		// Vertices are baked in parallel, four rays at a time.
+		static AmbientOcclusionStatistics Bake(Library::Model& model, const AmbientOcclusionSettings& settings = AmbientOcclusionSettings());
+	};
+}
\ No newline at end of file
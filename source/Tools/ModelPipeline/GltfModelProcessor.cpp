@@ -0,0 +1,1047 @@
+#include "pch.h"
+#include "GltfModelProcessor.h"
+#include "MemoryMappedFile.h"
+#include "Mesh.h"
+#include "ModelMaterial.h"
+#include <execution>
+#include <numeric>
+#include <optional>
+#include <winrt\Windows.Data.Json.h>
+
+using namespace std;
+using namespace std::filesystem;
+using namespace std::string_literals;
+using namespace gsl;
+using namespace DirectX;
+using namespace Library;
+using namespace winrt;
+using namespace winrt::Windows::Data::Json;
+
+namespace ModelPipeline
+{
+	namespace
+	{
+		const uint32_t GlbMagic{ 0x46546C67 }; // "glTF"
+		const uint32_t GlbVersion{ 2 };
+		const uint32_t GlbJsonChunkType{ 0x4E4F534A }; // "JSON"
+		const uint32_t GlbBinaryChunkType{ 0x004E4942 }; // "BIN\0"
+		const string DefaultMaterialName{ "DefaultMaterial" };
+		const uint32_t MissingIndex{ numeric_limits<uint32_t>::max() };
+
+		enum class GltfComponentType : uint32_t
+		{
+			Byte = 5120,
+			UnsignedByte = 5121,
+			Short = 5122,
+			UnsignedShort = 5123,
+			UnsignedInt = 5125,
+			Float = 5126
+		};
+
+		enum class GltfPrimitiveMode : uint32_t
+		{
+			Points = 0,
+			Lines = 1,
+			LineLoop = 2,
+			LineStrip = 3,
+			Triangles = 4,
+			TriangleStrip = 5,
+			TriangleFan = 6
+		};
+
+		struct GlbHeader final
+		{
+			uint32_t Magic;
+			uint32_t Version;
+			uint32_t Length;
+		};
+
+		struct GlbChunkHeader final
+		{
+			uint32_t Length;
+			uint32_t Type;
+		};
+
+		struct GltfBufferView final
+		{
+			uint32_t Buffer;
+			size_t ByteOffset;
+			size_t ByteLength;
+			size_t ByteStride;
+		};
+
+		struct GltfSparse final
+		{
+			size_t Count;
+			uint32_t IndicesBufferView;
+			size_t IndicesByteOffset;
+			GltfComponentType IndicesComponentType;
+			uint32_t ValuesBufferView;
+			size_t ValuesByteOffset;
+		};
+
+		struct GltfAccessor final
+		{
+			optional<uint32_t> BufferView;
+			size_t ByteOffset;
+			GltfComponentType ComponentType;
+			bool Normalized;
+			size_t Count;
+			size_t ComponentCount;
+			optional<GltfSparse> Sparse;
+		};
+
+		struct GltfPrimitive final
+		{
+			map<string, uint32_t> Attributes;
+			optional<uint32_t> Indices;
+			optional<uint32_t> Material;
+			GltfPrimitiveMode Mode;
+		};
+
+		struct GltfMesh final
+		{
+			string Name;
+			vector<GltfPrimitive> Primitives;
+		};
+
+		struct GltfNode final
+		{
+			string Name;
+			optional<uint32_t> Mesh;
+			vector<uint32_t> Children;
+			XMFLOAT4X4 LocalTransform;
+		};
+
+		struct GltfDocument final
+		{
+			unique_ptr<MemoryMappedFile> File;
+			vector<unique_ptr<MemoryMappedFile>> MappedBuffers;
+			vector<vector<char>> DecodedBuffers;
+			vector<span<const char>> Buffers;
+			vector<GltfBufferView> BufferViews;
+			vector<GltfAccessor> Accessors;
+			vector<GltfMesh> Meshes;
+			vector<GltfNode> Nodes;
+			vector<uint32_t> SceneNodes;
+		};
+
+		// One primitive of a glTF mesh, which becomes one model mesh.
+		struct GltfMeshPrimitive final
+		{
+			uint32_t Mesh;
+			uint32_t Primitive;
+			string Name;
+		};
+
+		// A node of the default scene and the index of its parent in the flattened scene.
+		struct GltfSceneNode final
+		{
+			uint32_t Node;
+			int32_t Parent;
+		};
+
+		inline uint32_t NamedUInt(const JsonObject& object, const wchar_t* name, uint32_t defaultValue = 0)
+		{
+			return static_cast<uint32_t>(object.GetNamedNumber(name, defaultValue));
+		}
+
+		inline size_t NamedSize(const JsonObject& object, const wchar_t* name, size_t defaultValue = 0)
+		{
+			return static_cast<size_t>(object.GetNamedNumber(name, static_cast<double>(defaultValue)));
+		}
+
+		inline optional<uint32_t> OptionalUInt(const JsonObject& object, const wchar_t* name)
+		{
+			return (object.HasKey(name) ? optional<uint32_t>(static_cast<uint32_t>(object.GetNamedNumber(name))) : nullopt);
+		}
+
+		inline string NamedString(const JsonObject& object, const wchar_t* name)
+		{
+			return to_string(object.GetNamedString(name, L""));
+		}
+
+		inline JsonArray NamedArray(const JsonObject& object, const wchar_t* name)
+		{
+			return (object.HasKey(name) ? object.GetNamedArray(name) : JsonArray());
+		}
+
+		inline JsonObject NamedObject(const JsonObject& object, const wchar_t* name)
+		{
+			return (object.HasKey(name) ? object.GetNamedObject(name) : nullptr);
+		}
+
+		size_t ComponentCount(const string& type)
+		{
+			static const map<string, size_t> componentCounts
+			{
+				{ "SCALAR", 1 },
+				{ "VEC2", 2 },
+				{ "VEC3", 3 },
+				{ "VEC4", 4 },
+				{ "MAT2", 4 },
+				{ "MAT3", 9 },
+				{ "MAT4", 16 }
+			};
+
+			auto it = componentCounts.find(type);
+			if (it == componentCounts.end())
+			{
+				throw exception(("Unsupported accessor type: "s + type).c_str());
+			}
+
+			return it->second;
+		}
+
+		size_t ComponentSize(GltfComponentType componentType)
+		{
+			switch (componentType)
+			{
+			case GltfComponentType::Byte:
+			case GltfComponentType::UnsignedByte:
+				return 1;
+
+			case GltfComponentType::Short:
+			case GltfComponentType::UnsignedShort:
+				return 2;
+
+			case GltfComponentType::UnsignedInt:
+			case GltfComponentType::Float:
+				return 4;
+
+			default:
+				throw exception("Unsupported accessor component type.");
+			}
+		}
+
+		template <typename T>
+		inline T ReadUnaligned(const char* source)
+		{
+			T value;
+			memcpy(&value, source, sizeof(T));
+			return value;
+		}
+
+		inline float ReadComponent(const char* source, GltfComponentType componentType, bool normalized)
+		{
+			switch (componentType)
+			{
+			case GltfComponentType::Byte:
+			{
+				const float value = ReadUnaligned<int8_t>(source);
+				return (normalized ? max(value / 127.0f, -1.0f) : value);
+			}
+
+			case GltfComponentType::UnsignedByte:
+			{
+				const float value = ReadUnaligned<uint8_t>(source);
+				return (normalized ? value / 255.0f : value);
+			}
+
+			case GltfComponentType::Short:
+			{
+				const float value = ReadUnaligned<int16_t>(source);
+				return (normalized ? max(value / 32767.0f, -1.0f) : value);
+			}
+
+			case GltfComponentType::UnsignedShort:
+			{
+				const float value = ReadUnaligned<uint16_t>(source);
+				return (normalized ? value / 65535.0f : value);
+			}
+
+			case GltfComponentType::UnsignedInt:
+				return static_cast<float>(ReadUnaligned<uint32_t>(source));
+
+			default:
+				return ReadUnaligned<float>(source);
+			}
+		}
+
+		inline uint32_t ReadIndex(const char* source, GltfComponentType componentType)
+		{
+			switch (componentType)
+			{
+			case GltfComponentType::UnsignedByte:
+				return ReadUnaligned<uint8_t>(source);
+
+			case GltfComponentType::UnsignedShort:
+				return ReadUnaligned<uint16_t>(source);
+
+			case GltfComponentType::UnsignedInt:
+				return ReadUnaligned<uint32_t>(source);
+
+			default:
+				throw exception("Unsupported index component type.");
+			}
+		}
+
+		// Returns a pointer to byteCount bytes at byteOffset within a buffer view, validating the range.
+		const char* BufferViewData(const GltfDocument& document, uint32_t bufferViewIndex, size_t byteOffset, size_t byteCount)
+		{
+			const GltfBufferView& bufferView = document.BufferViews.at(bufferViewIndex);
+			const span<const char>& buffer = document.Buffers.at(bufferView.Buffer);
+			if (bufferView.ByteOffset + bufferView.ByteLength > static_cast<size_t>(buffer.size()) || byteOffset + byteCount > bufferView.ByteLength)
+			{
+				throw exception("Accessor exceeds the bounds of its buffer view.");
+			}
+
+			return buffer.data() + bufferView.ByteOffset + byteOffset;
+		}
+
+		// Converts an accessor into destination, which holds accessor.Count elements of destinationComponents floats.
+		// Components beyond the accessor's component count are left untouched.
+		void ReadAccessor(const GltfDocument& document, uint32_t accessorIndex, size_t expectedCount, float* destination, size_t destinationComponents)
+		{
+			const GltfAccessor& accessor = document.Accessors.at(accessorIndex);
+			if (accessor.Count != expectedCount || accessor.ComponentCount > destinationComponents)
+			{
+				throw exception("Accessor does not match the vertex layout.");
+			}
+
+			const size_t componentSize = ComponentSize(accessor.ComponentType);
+			const size_t elementSize = componentSize * accessor.ComponentCount;
+
+			if (accessor.BufferView.has_value())
+			{
+				const size_t byteStride = document.BufferViews.at(*accessor.BufferView).ByteStride;
+				const size_t stride = (byteStride != 0 ? byteStride : elementSize);
+				const size_t byteCount = (accessor.Count > 0 ? (accessor.Count - 1) * stride + elementSize : 0);
+				const char* source = BufferViewData(document, *accessor.BufferView, accessor.ByteOffset, byteCount);
+
+				if (accessor.ComponentType == GltfComponentType::Float && stride == elementSize && accessor.ComponentCount == destinationComponents)
+				{
+					memcpy(destination, source, byteCount);
+				}
+				else
+				{
+					for (size_t i = 0; i < accessor.Count; ++i)
+					{
+						const char* element = source + i * stride;
+						for (size_t component = 0; component < accessor.ComponentCount; ++component)
+						{
+							destination[i * destinationComponents + component] = ReadComponent(element + component * componentSize, accessor.ComponentType, accessor.Normalized);
+						}
+					}
+				}
+			}
+			else
+			{
+				// Accessors without a buffer view are zero-initialized (and typically sparse).
+				for (size_t i = 0; i < accessor.Count; ++i)
+				{
+					fill_n(destination + i * destinationComponents, accessor.ComponentCount, 0.0f);
+				}
+			}
+
+			if (accessor.Sparse.has_value())
+			{
+				const GltfSparse& sparse = *accessor.Sparse;
+				const size_t indexSize = ComponentSize(sparse.IndicesComponentType);
+				const char* indices = BufferViewData(document, sparse.IndicesBufferView, sparse.IndicesByteOffset, sparse.Count * indexSize);
+				const char* values = BufferViewData(document, sparse.ValuesBufferView, sparse.ValuesByteOffset, sparse.Count * elementSize);
+
+				for (size_t i = 0; i < sparse.Count; ++i)
+				{
+					const uint32_t index = ReadIndex(indices + i * indexSize, sparse.IndicesComponentType);
+					if (index >= accessor.Count)
+					{
+						throw exception("Sparse accessor index out of range.");
+					}
+
+					const char* element = values + i * elementSize;
+					for (size_t component = 0; component < accessor.ComponentCount; ++component)
+					{
+						destination[index * destinationComponents + component] = ReadComponent(element + component * componentSize, accessor.ComponentType, accessor.Normalized);
+					}
+				}
+			}
+		}
+
+		vector<uint32_t> ReadIndices(const GltfDocument& document, uint32_t accessorIndex)
+		{
+			const GltfAccessor& accessor = document.Accessors.at(accessorIndex);
+			if (accessor.ComponentCount != 1 || !accessor.BufferView.has_value() || accessor.Sparse.has_value())
+			{
+				throw exception("Unsupported index accessor.");
+			}
+
+			const size_t indexSize = ComponentSize(accessor.ComponentType);
+			const size_t byteStride = document.BufferViews.at(*accessor.BufferView).ByteStride;
+			const size_t stride = (byteStride != 0 ? byteStride : indexSize);
+			const size_t byteCount = (accessor.Count > 0 ? (accessor.Count - 1) * stride + indexSize : 0);
+			const char* source = BufferViewData(document, *accessor.BufferView, accessor.ByteOffset, byteCount);
+
+			vector<uint32_t> indices(accessor.Count);
+			if (accessor.ComponentType == GltfComponentType::UnsignedInt && stride == indexSize)
+			{
+				memcpy(indices.data(), source, byteCount);
+			}
+			else
+			{
+				for (size_t i = 0; i < accessor.Count; ++i)
+				{
+					indices[i] = ReadIndex(source + i * stride, accessor.ComponentType);
+				}
+			}
+
+			return indices;
+		}
+
+		vector<char> DecodeBase64(const string& text)
+		{
+			auto decode = [](char c)
+			{
+				if (c >= 'A' && c <= 'Z') return c - 'A';
+				if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+				if (c >= '0' && c <= '9') return c - '0' + 52;
+				if (c == '+') return 62;
+				if (c == '/') return 63;
+				return -1;
+			};
+
+			vector<char> data;
+			data.reserve(text.size() * 3 / 4);
+
+			uint32_t accumulator = 0;
+			int bitCount = 0;
+			for (char c : text)
+			{
+				const int value = decode(c);
+				if (value < 0)
+				{
+					if (c == '=')
+					{
+						break;
+					}
+
+					continue;
+				}
+
+				accumulator = (accumulator << 6) | static_cast<uint32_t>(value);
+				bitCount += 6;
+				if (bitCount >= 8)
+				{
+					bitCount -= 8;
+					data.push_back(static_cast<char>((accumulator >> bitCount) & 0xFF));
+				}
+			}
+
+			return data;
+		}
+
+		string DecodeUri(const string& uri)
+		{
+			string decoded;
+			decoded.reserve(uri.size());
+			for (size_t i = 0; i < uri.size(); ++i)
+			{
+				if (uri[i] == '%' && i + 2 < uri.size() && isxdigit(static_cast<unsigned char>(uri[i + 1])) && isxdigit(static_cast<unsigned char>(uri[i + 2])))
+				{
+					decoded.push_back(static_cast<char>(stoi(uri.substr(i + 1, 2), nullptr, 16)));
+					i += 2;
+				}
+				else
+				{
+					decoded.push_back(uri[i]);
+				}
+			}
+
+			return decoded;
+		}
+
+		void LoadBuffers(GltfDocument& document, const JsonObject& root, const path& directory, span<const char> glbBinaryChunk)
+		{
+			JsonArray buffers = NamedArray(root, L"buffers");
+			document.Buffers.reserve(buffers.Size());
+			for (uint32_t i = 0; i < buffers.Size(); ++i)
+			{
+				JsonObject buffer = buffers.GetObjectAt(i);
+				const size_t byteLength = NamedSize(buffer, L"byteLength");
+				const string uri = NamedString(buffer, L"uri");
+
+				span<const char> data;
+				if (uri.empty())
+				{
+					// The first buffer of a GLB without a uri refers to the binary chunk.
+					data = glbBinaryChunk;
+				}
+				else if (uri.compare(0, 5, "data:") == 0)
+				{
+					const size_t dataPosition = uri.find(";base64,");
+					if (dataPosition == string::npos)
+					{
+						throw exception("Unsupported data uri encoding.");
+					}
+
+					const vector<char>& decodedBuffer = document.DecodedBuffers.emplace_back(DecodeBase64(uri.substr(dataPosition + 8)));
+					data = span<const char>(decodedBuffer.data(), decodedBuffer.size());
+				}
+				else
+				{
+					const auto& mappedBuffer = document.MappedBuffers.emplace_back(make_unique<MemoryMappedFile>((directory / DecodeUri(uri)).string()));
+					data = mappedBuffer->Data();
+				}
+
+				if (static_cast<size_t>(data.size()) < byteLength)
+				{
+					throw exception("Buffer is smaller than its declared length.");
+				}
+
+				document.Buffers.push_back(data);
+			}
+		}
+
+		void LoadAccessors(GltfDocument& document, const JsonObject& root)
+		{
+			JsonArray bufferViews = NamedArray(root, L"bufferViews");
+			document.BufferViews.reserve(bufferViews.Size());
+			for (uint32_t i = 0; i < bufferViews.Size(); ++i)
+			{
+				JsonObject bufferView = bufferViews.GetObjectAt(i);
+				document.BufferViews.push_back({ NamedUInt(bufferView, L"buffer"), NamedSize(bufferView, L"byteOffset"), NamedSize(bufferView, L"byteLength"), NamedSize(bufferView, L"byteStride") });
+			}
+
+			JsonArray accessors = NamedArray(root, L"accessors");
+			document.Accessors.reserve(accessors.Size());
+			for (uint32_t i = 0; i < accessors.Size(); ++i)
+			{
+				JsonObject accessor = accessors.GetObjectAt(i);
+
+				GltfAccessor& gltfAccessor = document.Accessors.emplace_back();
+				gltfAccessor.BufferView = OptionalUInt(accessor, L"bufferView");
+				gltfAccessor.ByteOffset = NamedSize(accessor, L"byteOffset");
+				gltfAccessor.ComponentType = static_cast<GltfComponentType>(NamedUInt(accessor, L"componentType"));
+				gltfAccessor.Normalized = accessor.GetNamedBoolean(L"normalized", false);
+				gltfAccessor.Count = NamedSize(accessor, L"count");
+				gltfAccessor.ComponentCount = ComponentCount(NamedString(accessor, L"type"));
+
+				JsonObject sparse = NamedObject(accessor, L"sparse");
+				if (sparse != nullptr)
+				{
+					JsonObject indices = sparse.GetNamedObject(L"indices");
+					JsonObject values = sparse.GetNamedObject(L"values");
+					gltfAccessor.Sparse = GltfSparse{ NamedSize(sparse, L"count"), NamedUInt(indices, L"bufferView"), NamedSize(indices, L"byteOffset"), static_cast<GltfComponentType>(NamedUInt(indices, L"componentType")), NamedUInt(values, L"bufferView"), NamedSize(values, L"byteOffset") };
+				}
+			}
+		}
+
+		void LoadMeshes(GltfDocument& document, const JsonObject& root)
+		{
+			JsonArray meshes = NamedArray(root, L"meshes");
+			document.Meshes.reserve(meshes.Size());
+			for (uint32_t i = 0; i < meshes.Size(); ++i)
+			{
+				JsonObject mesh = meshes.GetObjectAt(i);
+
+				GltfMesh& gltfMesh = document.Meshes.emplace_back();
+				gltfMesh.Name = NamedString(mesh, L"name");
+
+				JsonArray primitives = NamedArray(mesh, L"primitives");
+				for (uint32_t j = 0; j < primitives.Size(); ++j)
+				{
+					JsonObject primitive = primitives.GetObjectAt(j);
+
+					GltfPrimitive& gltfPrimitive = gltfMesh.Primitives.emplace_back();
+					gltfPrimitive.Indices = OptionalUInt(primitive, L"indices");
+					gltfPrimitive.Material = OptionalUInt(primitive, L"material");
+					gltfPrimitive.Mode = static_cast<GltfPrimitiveMode>(NamedUInt(primitive, L"mode", static_cast<uint32_t>(GltfPrimitiveMode::Triangles)));
+
+					for (const auto& attribute : primitive.GetNamedObject(L"attributes"))
+					{
+						gltfPrimitive.Attributes.emplace(to_string(attribute.Key()), static_cast<uint32_t>(attribute.Value().GetNumber()));
+					}
+				}
+			}
+		}
+
+		void LoadNodes(GltfDocument& document, const JsonObject& root)
+		{
+			JsonArray nodes = NamedArray(root, L"nodes");
+			document.Nodes.reserve(nodes.Size());
+			for (uint32_t i = 0; i < nodes.Size(); ++i)
+			{
+				JsonObject node = nodes.GetObjectAt(i);
+
+				GltfNode& gltfNode = document.Nodes.emplace_back();
+				gltfNode.Name = NamedString(node, L"name");
+				gltfNode.Mesh = OptionalUInt(node, L"mesh");
+
+				JsonArray children = NamedArray(node, L"children");
+				for (uint32_t j = 0; j < children.Size(); ++j)
+				{
+					gltfNode.Children.push_back(static_cast<uint32_t>(children.GetNumberAt(j)));
+				}
+
+				// glTF matrices are column-major column-vector transforms, which is the same memory layout as
+				// a row-major row-vector XMFLOAT4X4.
+				JsonArray matrix = NamedArray(node, L"matrix");
+				if (matrix.Size() == 16)
+				{
+					float values[16];
+					for (uint32_t j = 0; j < 16; ++j)
+					{
+						values[j] = static_cast<float>(matrix.GetNumberAt(j));
+					}
+
+					gltfNode.LocalTransform = XMFLOAT4X4(values);
+				}
+				else
+				{
+					auto readVector = [&node](const wchar_t* name, XMFLOAT4 defaultValue)
+					{
+						float values[4]{ defaultValue.x, defaultValue.y, defaultValue.z, defaultValue.w };
+						JsonArray components = NamedArray(node, name);
+						for (uint32_t j = 0; j < min<uint32_t>(components.Size(), 4); ++j)
+						{
+							values[j] = static_cast<float>(components.GetNumberAt(j));
+						}
+
+						return XMFLOAT4(values);
+					};
+
+					const XMFLOAT4 translation = readVector(L"translation", XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f));
+					const XMFLOAT4 rotation = readVector(L"rotation", XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+					const XMFLOAT4 scale = readVector(L"scale", XMFLOAT4(1.0f, 1.0f, 1.0f, 0.0f));
+
+					XMMATRIX localTransform = XMMatrixScaling(scale.x, scale.y, scale.z) * XMMatrixRotationQuaternion(XMLoadFloat4(&rotation)) * XMMatrixTranslation(translation.x, translation.y, translation.z);
+					XMStoreFloat4x4(&gltfNode.LocalTransform, localTransform);
+				}
+			}
+
+			JsonArray scenes = NamedArray(root, L"scenes");
+			if (scenes.Size() > 0)
+			{
+				JsonArray sceneNodes = NamedArray(scenes.GetObjectAt(NamedUInt(root, L"scene")), L"nodes");
+				for (uint32_t i = 0; i < sceneNodes.Size(); ++i)
+				{
+					document.SceneNodes.push_back(static_cast<uint32_t>(sceneNodes.GetNumberAt(i)));
+				}
+			}
+			else
+			{
+				// Without scenes, every node that is not a child of another node is a root.
+				vector<bool> isChild(document.Nodes.size(), false);
+				for (const GltfNode& node : document.Nodes)
+				{
+					for (uint32_t child : node.Children)
+					{
+						isChild.at(child) = true;
+					}
+				}
+
+				for (uint32_t i = 0; i < document.Nodes.size(); ++i)
+				{
+					if (!isChild[i])
+					{
+						document.SceneNodes.push_back(i);
+					}
+				}
+			}
+		}
+
+		// Visits the default scene depth first, so that each node is listed after its parent.
+		vector<GltfSceneNode> FlattenScene(const GltfDocument& document)
+		{
+			vector<GltfSceneNode> sceneNodes;
+			vector<bool> visited(document.Nodes.size(), false);
+			stack<pair<uint32_t, int32_t>> pendingNodes;
+			for (auto it = document.SceneNodes.rbegin(); it != document.SceneNodes.rend(); ++it)
+			{
+				pendingNodes.emplace(*it, -1);
+			}
+
+			while (!pendingNodes.empty())
+			{
+				auto [nodeIndex, parent] = pendingNodes.top();
+				pendingNodes.pop();
+
+				const GltfNode& node = document.Nodes.at(nodeIndex);
+				if (visited[nodeIndex])
+				{
+					throw exception("Node hierarchy contains a cycle.");
+				}
+				visited[nodeIndex] = true;
+
+				const int32_t index = narrow<int32_t>(sceneNodes.size());
+				sceneNodes.push_back({ nodeIndex, parent });
+
+				for (auto it = node.Children.rbegin(); it != node.Children.rend(); ++it)
+				{
+					pendingNodes.emplace(*it, index);
+				}
+			}
+
+			return sceneNodes;
+		}
+
+		string TexturePath(const JsonObject& root, uint32_t textureIndex)
+		{
+			JsonObject texture = NamedArray(root, L"textures").GetObjectAt(textureIndex);
+			const optional<uint32_t> imageIndex = OptionalUInt(texture, L"source");
+			if (!imageIndex.has_value())
+			{
+				return string();
+			}
+
+			// Images embedded in a buffer view are referenced by index, as Assimp does for embedded textures.
+			JsonObject image = NamedArray(root, L"images").GetObjectAt(*imageIndex);
+			const string uri = NamedString(image, L"uri");
+			return (uri.empty() || uri.compare(0, 5, "data:") == 0 ? "*"s + to_string(*imageIndex) : DecodeUri(uri));
+		}
+
+		ModelMaterialData LoadMaterial(const JsonObject& root, const JsonObject& material)
+		{
+			ModelMaterialData modelMaterialData;
+			modelMaterialData.Name = NamedString(material, L"name");
+
+			auto addTexture = [&](const JsonObject& parent, const wchar_t* name, TextureType textureType)
+			{
+				JsonObject textureInfo = (parent != nullptr ? NamedObject(parent, name) : nullptr);
+				if (textureInfo != nullptr)
+				{
+					string texturePath = TexturePath(root, NamedUInt(textureInfo, L"index"));
+					if (!texturePath.empty())
+					{
+						modelMaterialData.Textures[textureType].push_back(move(texturePath));
+					}
+				}
+			};
+
+			// Metallic-roughness has no direct counterpart; it is exposed as the specular map.
+			JsonObject pbrMetallicRoughness = NamedObject(material, L"pbrMetallicRoughness");
+			addTexture(pbrMetallicRoughness, L"baseColorTexture", TextureType::Diffuse);
+			addTexture(pbrMetallicRoughness, L"metallicRoughnessTexture", TextureType::SpecularMap);
+			addTexture(material, L"normalTexture", TextureType::NormalMap);
+			addTexture(material, L"occlusionTexture", TextureType::LightMap);
+			addTexture(material, L"emissiveTexture", TextureType::Emissive);
+
+			return modelMaterialData;
+		}
+
+		vector<uint32_t> BuildTriangleList(const GltfPrimitive& primitive, vector<uint32_t>&& indices)
+		{
+			switch (primitive.Mode)
+			{
+			case GltfPrimitiveMode::Triangles:
+				indices.resize(indices.size() - indices.size() % 3);
+				return move(indices);
+
+			case GltfPrimitiveMode::TriangleStrip:
+			{
+				vector<uint32_t> triangles;
+				for (size_t i = 2; i < indices.size(); ++i)
+				{
+					const bool isOdd = (i % 2) != 0;
+					triangles.insert(triangles.end(), { indices[isOdd ? i - 1 : i - 2], indices[isOdd ? i - 2 : i - 1], indices[i] });
+				}
+
+				return triangles;
+			}
+
+			case GltfPrimitiveMode::TriangleFan:
+			{
+				vector<uint32_t> triangles;
+				for (size_t i = 2; i < indices.size(); ++i)
+				{
+					triangles.insert(triangles.end(), { indices[0], indices[i - 1], indices[i] });
+				}
+
+				return triangles;
+			}
+
+			default:
+				return vector<uint32_t>();
+			}
+		}
+
+		shared_ptr<Mesh> CreateMesh(Model& model, const GltfDocument& document, const GltfMeshPrimitive& meshPrimitive, shared_ptr<ModelMaterial> material, bool flipUVs, const VertexWeldSettings& weldSettings, VertexWeldStatistics& weldStatistics)
+		{
+			const GltfPrimitive& primitive = document.Meshes[meshPrimitive.Mesh].Primitives[meshPrimitive.Primitive];
+			auto positionAttribute = primitive.Attributes.find("POSITION");
+			if (positionAttribute == primitive.Attributes.end())
+			{
+				throw exception("Primitive has no positions.");
+			}
+
+			// Vertices stay in the mesh's space; the node table places each instance.
+			const size_t vertexCount = document.Accessors.at(positionAttribute->second).Count;
+
+			MeshData meshData;
+			meshData.Material = move(material);
+			meshData.Name = meshPrimitive.Name;
+
+			meshData.Vertices.resize(vertexCount);
+			ReadAccessor(document, positionAttribute->second, vertexCount, reinterpret_cast<float*>(meshData.Vertices.data()), 3);
+
+			auto normalAttribute = primitive.Attributes.find("NORMAL");
+			if (normalAttribute != primitive.Attributes.end())
+			{
+				meshData.Normals.resize(vertexCount);
+				ReadAccessor(document, normalAttribute->second, vertexCount, reinterpret_cast<float*>(meshData.Normals.data()), 3);
+
+				auto tangentAttribute = primitive.Attributes.find("TANGENT");
+				if (tangentAttribute != primitive.Attributes.end())
+				{
+					vector<XMFLOAT4> tangents(vertexCount);
+					ReadAccessor(document, tangentAttribute->second, vertexCount, reinterpret_cast<float*>(tangents.data()), 4);
+
+					// The tangent's w component selects the handedness of the bitangent.
+					meshData.Tangents.resize(vertexCount);
+					meshData.BiNormals.resize(vertexCount);
+					for (size_t i = 0; i < vertexCount; ++i)
+					{
+						const XMVECTOR tangent = XMLoadFloat4(&tangents[i]);
+						XMVECTOR biNormal = XMVector3Cross(XMLoadFloat3(&meshData.Normals[i]), tangent) * tangents[i].w;
+						XMStoreFloat3(&meshData.Tangents[i], tangent);
+						XMStoreFloat3(&meshData.BiNormals[i], biNormal);
+					}
+				}
+			}
+
+			// glTF texture coordinates already have a top-left origin. Assimp flips them on import, so they are
+			// only flipped here when the caller has not asked for the Assimp flip to be undone.
+			for (uint32_t channel = 0;; ++channel)
+			{
+				auto textureCoordinateAttribute = primitive.Attributes.find("TEXCOORD_"s + to_string(channel));
+				if (textureCoordinateAttribute == primitive.Attributes.end())
+				{
+					break;
+				}
+
+				vector<XMFLOAT3>& textureCoordinates = meshData.TextureCoordinates.emplace_back(vertexCount, XMFLOAT3(0.0f, 0.0f, 0.0f));
+				ReadAccessor(document, textureCoordinateAttribute->second, vertexCount, reinterpret_cast<float*>(textureCoordinates.data()), 3);
+				if (!flipUVs)
+				{
+					for (XMFLOAT3& textureCoordinate : textureCoordinates)
+					{
+						textureCoordinate.y = 1.0f - textureCoordinate.y;
+					}
+				}
+			}
+
+			for (uint32_t channel = 0;; ++channel)
+			{
+				auto colorAttribute = primitive.Attributes.find("COLOR_"s + to_string(channel));
+				if (colorAttribute == primitive.Attributes.end())
+				{
+					break;
+				}
+
+				vector<XMFLOAT4>& vertexColors = meshData.VertexColors.emplace_back(vertexCount, XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+				ReadAccessor(document, colorAttribute->second, vertexCount, reinterpret_cast<float*>(vertexColors.data()), 4);
+			}
+
+			vector<uint32_t> indices;
+			if (primitive.Indices.has_value())
+			{
+				indices = ReadIndices(document, *primitive.Indices);
+				if (any_of(indices.begin(), indices.end(), [vertexCount](uint32_t index) { return index >= vertexCount; }))
+				{
+					throw exception("Index out of range.");
+				}
+			}
+			else
+			{
+				indices.resize(vertexCount);
+				iota(indices.begin(), indices.end(), 0U);
+			}
+
+			meshData.Indices = BuildTriangleList(primitive, move(indices));
+			meshData.FaceCount = narrow<uint32_t>(meshData.Indices.size() / 3);
+
+			// Reverse the winding, as with aiProcess_FlipWindingOrder.
+			for (size_t i = 0; i < meshData.Indices.size(); i += 3)
+			{
+				swap(meshData.Indices[i], meshData.Indices[i + 2]);
+			}
+
+			if (weldSettings.Enabled)
+			{
+				weldStatistics = MeshProcessor::WeldVertices(meshData, weldSettings);
+			}
+
+			return make_shared<Mesh>(model, move(meshData));
+		}
+	}
+
+	bool GltfModelProcessor::CanLoad(const string& filename)
+	{
+		string extension = path(filename).extension().string();
+		transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return static_cast<char>(tolower(static_cast<unsigned char>(c))); });
+
+		return extension == ".gltf" || extension == ".glb";
+	}
+
+	Model GltfModelProcessor::LoadModel(const string& filename, bool flipUVs, const VertexWeldSettings& weldSettings, VertexWeldStatistics* weldStatistics)
+	{
+		GltfDocument document;
+		document.File = make_unique<MemoryMappedFile>(filename);
+		span<const char> data = document.File->Data();
+
+		span<const char> json = data;
+		span<const char> glbBinaryChunk;
+		if (static_cast<size_t>(data.size()) >= sizeof(GlbHeader) && ReadUnaligned<uint32_t>(data.data()) == GlbMagic)
+		{
+			const GlbHeader header = ReadUnaligned<GlbHeader>(data.data());
+			if (header.Version != GlbVersion || header.Length > static_cast<size_t>(data.size()))
+			{
+				throw exception("Unsupported GLB container.");
+			}
+
+			json = span<const char>();
+			for (size_t offset = sizeof(GlbHeader); offset + sizeof(GlbChunkHeader) <= header.Length;)
+			{
+				const GlbChunkHeader chunkHeader = ReadUnaligned<GlbChunkHeader>(data.data() + offset);
+				offset += sizeof(GlbChunkHeader);
+				if (offset + chunkHeader.Length > header.Length)
+				{
+					throw exception("GLB chunk exceeds the container length.");
+				}
+
+				span<const char> chunk(data.data() + offset, chunkHeader.Length);
+				if (chunkHeader.Type == GlbJsonChunkType && json.empty())
+				{
+					json = chunk;
+				}
+				else if (chunkHeader.Type == GlbBinaryChunkType && glbBinaryChunk.empty())
+				{
+					glbBinaryChunk = chunk;
+				}
+
+				offset += chunkHeader.Length;
+			}
+		}
+
+		Model model;
+		ModelData& modelData = model.Data();
+
+		// Malformed documents surface as WinRT errors from Windows.Data.Json.
+		try
+		{
+			JsonObject root = JsonObject::Parse(to_hstring(string_view(json.data(), static_cast<size_t>(json.size()))));
+
+			LoadBuffers(document, root, path(filename).parent_path(), glbBinaryChunk);
+			LoadAccessors(document, root);
+			LoadMeshes(document, root);
+			LoadNodes(document, root);
+
+			JsonArray materials = NamedArray(root, L"materials");
+			for (uint32_t i = 0; i < materials.Size(); ++i)
+			{
+				modelData.Materials.push_back(make_shared<ModelMaterial>(model, LoadMaterial(root, materials.GetObjectAt(i))));
+			}
+		}
+		catch (const hresult_error& error)
+		{
+			throw exception(("Invalid glTF document: "s + to_string(error.message())).c_str());
+		}
+
+		// Each primitive of a mesh in the scene becomes one model mesh, stored once however many nodes use it.
+		const vector<GltfSceneNode> sceneNodes = FlattenScene(document);
+		vector<GltfMeshPrimitive> meshPrimitives;
+		vector<uint32_t> firstMeshPrimitives(document.Meshes.size(), MissingIndex);
+		for (const GltfSceneNode& sceneNode : sceneNodes)
+		{
+			const GltfNode& node = document.Nodes[sceneNode.Node];
+			if (node.Mesh.has_value() && firstMeshPrimitives.at(*node.Mesh) == MissingIndex)
+			{
+				const GltfMesh& mesh = document.Meshes[*node.Mesh];
+				const string& meshName = (mesh.Name.empty() ? node.Name : mesh.Name);
+				firstMeshPrimitives[*node.Mesh] = narrow<uint32_t>(meshPrimitives.size());
+				for (uint32_t i = 0; i < mesh.Primitives.size(); ++i)
+				{
+					const string name = (mesh.Primitives.size() > 1 ? meshName + "-"s + to_string(i) : meshName);
+					meshPrimitives.push_back({ *node.Mesh, i, name });
+				}
+			}
+		}
+
+		const bool needsDefaultMaterial = any_of(meshPrimitives.begin(), meshPrimitives.end(), [&](const GltfMeshPrimitive& meshPrimitive)
+		{
+			return !document.Meshes[meshPrimitive.Mesh].Primitives[meshPrimitive.Primitive].Material.has_value();
+		});
+
+		if (needsDefaultMaterial)
+		{
+			ModelMaterialData defaultMaterial;
+			defaultMaterial.Name = DefaultMaterialName;
+			modelData.Materials.push_back(make_shared<ModelMaterial>(model, move(defaultMaterial)));
+		}
+
+		// Primitives convert independently; exceptions are collected so they do not escape the parallel algorithm.
+		vector<shared_ptr<Mesh>> meshes(meshPrimitives.size());
+		vector<VertexWeldStatistics> meshWeldStatistics(meshPrimitives.size());
+		vector<exception_ptr> errors(meshPrimitives.size());
+		vector<size_t> meshIndices(meshPrimitives.size());
+		iota(meshIndices.begin(), meshIndices.end(), size_t(0));
+		for_each(execution::par, meshIndices.begin(), meshIndices.end(), [&](size_t i)
+		{
+			try
+			{
+				const GltfMeshPrimitive& meshPrimitive = meshPrimitives[i];
+				const optional<uint32_t>& materialIndex = document.Meshes[meshPrimitive.Mesh].Primitives[meshPrimitive.Primitive].Material;
+				shared_ptr<ModelMaterial> material = (materialIndex.has_value() ? modelData.Materials.at(*materialIndex) : modelData.Materials.back());
+				meshes[i] = CreateMesh(model, document, meshPrimitive, move(material), flipUVs, weldSettings, meshWeldStatistics[i]);
+			}
+			catch (...)
+			{
+				errors[i] = current_exception();
+			}
+		});
+
+		for (const exception_ptr& error : errors)
+		{
+			if (error != nullptr)
+			{
+				rethrow_exception(error);
+			}
+		}
+
+		if (weldStatistics != nullptr)
+		{
+			*weldStatistics = VertexWeldStatistics();
+			for (const auto& statistics : meshWeldStatistics)
+			{
+				*weldStatistics += statistics;
+			}
+		}
+
+		// Points and lines produce no triangles and are dropped, as with aiProcess_SortByPType.
+		vector<uint32_t> modelMeshIndices(meshes.size(), MissingIndex);
+		for (size_t i = 0; i < meshes.size(); ++i)
+		{
+			if (meshes[i]->FaceCount() > 0)
+			{
+				modelMeshIndices[i] = narrow<uint32_t>(modelData.Meshes.size());
+				modelData.Meshes.push_back(move(meshes[i]));
+			}
+		}
+
+		// The scene's nodes become the node table, each referencing the meshes of its glTF mesh's primitives.
+		modelData.Nodes.reserve(sceneNodes.size());
+		for (const GltfSceneNode& sceneNode : sceneNodes)
+		{
+			const GltfNode& node = document.Nodes[sceneNode.Node];
+			ModelNode& modelNode = modelData.Nodes.emplace_back();
+			modelNode.Name = node.Name;
+			modelNode.Parent = sceneNode.Parent;
+			modelNode.Transform = node.LocalTransform;
+			if (node.Mesh.has_value())
+			{
+				const uint32_t firstMeshPrimitive = firstMeshPrimitives[*node.Mesh];
+				for (uint32_t i = 0; i < document.Meshes[*node.Mesh].Primitives.size(); ++i)
+				{
+					if (modelMeshIndices[firstMeshPrimitive + i] != MissingIndex)
+					{
+						modelNode.MeshIndices.push_back(modelMeshIndices[firstMeshPrimitive + i]);
+					}
+				}
+			}
+		}
+
+		model.UpdateTransforms();
+
+		return model;
+	}
+}
\ No newline at end of file
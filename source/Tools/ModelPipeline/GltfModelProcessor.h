@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Model.h"
+#include "MeshProcessor.h"
+#include <string>
+
+namespace ModelPipeline
+{
+	// Native glTF 2.0 importer for .gltf and .glb sources. Binary buffers are memory mapped and accessors
+	// are converted directly into MeshData, including sparse accessors. Each primitive becomes one mesh, and
+	// the default scene's node hierarchy becomes the model's node table, so a mesh used by several nodes is
+	// stored once. Output follows the Assimp path conventions (flipped winding, optional flipped UVs).
+	class GltfModelProcessor final
+	{
+	public:
+		GltfModelProcessor() = delete;
+
+		static bool CanLoad(const std::string& filename);
+
+		// Vertices are welded by MeshProcessor::WeldVertices after conversion, unless welding is disabled.
+		static Library::Model LoadModel(const std::string& filename, bool flipUVs = false, const VertexWeldSettings& weldSettings = VertexWeldSettings(), VertexWeldStatistics* weldStatistics = nullptr);
+	};
+}
\ No newline at end of file
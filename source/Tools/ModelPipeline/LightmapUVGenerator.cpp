@@ -0,0 +1,747 @@
+#include "pch.h"
+#include "LightmapUVGenerator.h"
+#include "Model.h"
+#include "Mesh.h"
+#include <execution>
+#include <numeric>
+#include <unordered_map>
+#include <array>
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+using namespace Library;
+
+namespace ModelPipeline
+{
+	namespace
+	{
+		const uint32_t Unassigned{ numeric_limits<uint32_t>::max() };
+		const uint32_t AtlasAlignment{ 4 };
+		const int MaxPackingAttempts{ 16 };
+		const uint32_t MaxFootprintCells{ 64 }; // Projected triangles covering more grid cells are tested against every triangle
+		const float OverlapTolerance{ 1e-4f }; // Relative to the footprint cell size; triangles touching within it do not overlap
+
+		struct Chart final
+		{
+			uint32_t Mesh{ 0 };
+			XMFLOAT3 Normal{ 0.0f, 0.0f, 1.0f };
+			vector<uint32_t> Triangles;
+			vector<uint32_t> Vertices; // Sorted source vertex indices
+			vector<XMFLOAT2> Positions; // Parameterized positions of Vertices, in world units
+			XMFLOAT2 Size{ 0.0f, 0.0f };
+			float Area{ 0.0f }; // Parameterized area, in world units squared
+			uint32_t X{ 0 };
+			uint32_t Y{ 0 };
+		};
+
+		struct MeshCharts final
+		{
+			vector<Chart> Charts;
+			vector<uint32_t> TriangleCharts;
+		};
+
+		XMFLOAT3 Subtract(const XMFLOAT3& lhs, const XMFLOAT3& rhs)
+		{
+			return XMFLOAT3(lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z);
+		}
+
+		XMFLOAT3 Cross(const XMFLOAT3& lhs, const XMFLOAT3& rhs)
+		{
+			return XMFLOAT3(lhs.y * rhs.z - lhs.z * rhs.y, lhs.z * rhs.x - lhs.x * rhs.z, lhs.x * rhs.y - lhs.y * rhs.x);
+		}
+
+		float Dot(const XMFLOAT3& lhs, const XMFLOAT3& rhs)
+		{
+			return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
+		}
+
+		XMFLOAT3 Normalize(const XMFLOAT3& value)
+		{
+			const float length = sqrt(Dot(value, value));
+			return (length > 0.0f ? XMFLOAT3(value.x / length, value.y / length, value.z / length) : XMFLOAT3(0.0f, 0.0f, 0.0f));
+		}
+
+		float Cross(const XMFLOAT2& origin, const XMFLOAT2& a, const XMFLOAT2& b)
+		{
+			return (a.x - origin.x) * (b.y - origin.y) - (a.y - origin.y) * (b.x - origin.x);
+		}
+
+		// Axes of the plane a chart is projected onto.
+		void ProjectionAxes(const XMFLOAT3& normal, XMFLOAT3& tangent, XMFLOAT3& bitangent)
+		{
+			tangent = Normalize(Cross(normal, (fabs(normal.x) < 0.9f ? XMFLOAT3(1.0f, 0.0f, 0.0f) : XMFLOAT3(0.0f, 1.0f, 0.0f))));
+			bitangent = Cross(normal, tangent);
+		}
+
+		using ProjectedTriangle = array<XMFLOAT2, 3>;
+
+		// The projected triangles of the chart being grown, bucketed in a uniform grid, so that triangles whose
+		// projection would fold over the chart (on helical or wrapping surfaces) can be left for another chart.
+		class ChartFootprint final
+		{
+		public:
+			ChartFootprint(const XMFLOAT3& normal, float cellSize) :
+				mCellSize(cellSize), mTolerance(cellSize * OverlapTolerance)
+			{
+				ProjectionAxes(normal, mTangent, mBitangent);
+			}
+
+			ProjectedTriangle Project(const MeshData& meshData, uint32_t triangle) const
+			{
+				ProjectedTriangle corners;
+				for (uint32_t corner = 0; corner < 3; corner++)
+				{
+					const XMFLOAT3& position = meshData.Vertices[meshData.Indices[triangle * 3 + corner]];
+					corners[corner] = XMFLOAT2(Dot(position, mTangent), Dot(position, mBitangent));
+				}
+
+				return corners;
+			}
+
+			// Triangles that project to (nearly) no area cover nothing and never overlap.
+			bool Overlaps(const ProjectedTriangle& corners) const
+			{
+				if (IsDegenerate(corners))
+				{
+					return false;
+				}
+
+				const auto overlaps = [this, &corners](uint32_t other) { return Overlap(mTriangles[other], corners); };
+				if (any_of(mOversizedTriangles.begin(), mOversizedTriangles.end(), overlaps))
+				{
+					return true;
+				}
+
+				// Oversized triangles are tested against every triangle of the chart.
+				bool overlapFound = false;
+				if (!ForEachCell(corners, [&](uint64_t cell)
+				{
+					const auto it = mCells.find(cell);
+					overlapFound = overlapFound || (it != mCells.end() && any_of(it->second.begin(), it->second.end(), overlaps));
+				}))
+				{
+					for (uint32_t other = 0; other < mTriangles.size() && !overlapFound; other++)
+					{
+						overlapFound = overlaps(other);
+					}
+				}
+
+				return overlapFound;
+			}
+
+			void Add(const ProjectedTriangle& corners)
+			{
+				if (IsDegenerate(corners))
+				{
+					return;
+				}
+
+				const uint32_t triangle = narrow<uint32_t>(mTriangles.size());
+				mTriangles.push_back(corners);
+				if (!ForEachCell(corners, [&](uint64_t cell) { mCells[cell].push_back(triangle); }))
+				{
+					mOversizedTriangles.push_back(triangle);
+				}
+			}
+
+		private:
+			bool IsDegenerate(const ProjectedTriangle& corners) const
+			{
+				return fabs(Cross(corners[0], corners[1], corners[2])) <= mTolerance * mCellSize;
+			}
+
+			// Visits the grid cells under the triangle's bounds; returns false, visiting none, if there are too many.
+			template <typename Visitor>
+			bool ForEachCell(const ProjectedTriangle& corners, Visitor visitor) const
+			{
+				const float minimumX = min({ corners[0].x, corners[1].x, corners[2].x });
+				const float minimumY = min({ corners[0].y, corners[1].y, corners[2].y });
+				const float maximumX = max({ corners[0].x, corners[1].x, corners[2].x });
+				const float maximumY = max({ corners[0].y, corners[1].y, corners[2].y });
+				const int64_t firstX = static_cast<int64_t>(floor(minimumX / mCellSize));
+				const int64_t firstY = static_cast<int64_t>(floor(minimumY / mCellSize));
+				const int64_t lastX = static_cast<int64_t>(floor(maximumX / mCellSize));
+				const int64_t lastY = static_cast<int64_t>(floor(maximumY / mCellSize));
+				if ((lastX - firstX + 1) * (lastY - firstY + 1) > MaxFootprintCells)
+				{
+					return false;
+				}
+
+				for (int64_t y = firstY; y <= lastY; y++)
+				{
+					for (int64_t x = firstX; x <= lastX; x++)
+					{
+						visitor((static_cast<uint64_t>(static_cast<uint32_t>(y)) << 32) | static_cast<uint32_t>(x));
+					}
+				}
+
+				return true;
+			}
+
+			// Separating axis test; triangles that only touch (such as neighbors sharing an edge) do not overlap.
+			bool Overlap(const ProjectedTriangle& lhs, const ProjectedTriangle& rhs) const
+			{
+				for (const ProjectedTriangle* triangle : { &lhs, &rhs })
+				{
+					for (uint32_t edge = 0; edge < 3; edge++)
+					{
+						const XMFLOAT2& a = (*triangle)[edge];
+						const XMFLOAT2& b = (*triangle)[(edge + 1) % 3];
+						const float length = sqrt((b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y));
+						if (length == 0.0f)
+						{
+							continue;
+						}
+
+						const XMFLOAT2 axis((a.y - b.y) / length, (b.x - a.x) / length);
+						float lhsMinimum = numeric_limits<float>::max();
+						float lhsMaximum = numeric_limits<float>::lowest();
+						float rhsMinimum = numeric_limits<float>::max();
+						float rhsMaximum = numeric_limits<float>::lowest();
+						for (uint32_t corner = 0; corner < 3; corner++)
+						{
+							const float lhsDistance = lhs[corner].x * axis.x + lhs[corner].y * axis.y;
+							const float rhsDistance = rhs[corner].x * axis.x + rhs[corner].y * axis.y;
+							lhsMinimum = min(lhsMinimum, lhsDistance);
+							lhsMaximum = max(lhsMaximum, lhsDistance);
+							rhsMinimum = min(rhsMinimum, rhsDistance);
+							rhsMaximum = max(rhsMaximum, rhsDistance);
+						}
+
+						if (lhsMaximum <= rhsMinimum + mTolerance || rhsMaximum <= lhsMinimum + mTolerance)
+						{
+							return false;
+						}
+					}
+				}
+
+				return true;
+			}
+
+			float mCellSize;
+			float mTolerance;
+			XMFLOAT3 mTangent;
+			XMFLOAT3 mBitangent;
+			vector<ProjectedTriangle> mTriangles;
+			unordered_map<uint64_t, vector<uint32_t>> mCells;
+			vector<uint32_t> mOversizedTriangles;
+		};
+
+		// Triangles are connected when they share an edge between the same two positions, so that vertices split
+		// for normal or texture seams do not split charts.
+		vector<uint32_t> PositionIds(const vector<XMFLOAT3>& vertices)
+		{
+			vector<uint32_t> sortedVertices(vertices.size());
+			iota(sortedVertices.begin(), sortedVertices.end(), 0U);
+			auto less = [&vertices](uint32_t lhs, uint32_t rhs)
+			{
+				const XMFLOAT3& a = vertices[lhs];
+				const XMFLOAT3& b = vertices[rhs];
+				return (a.x != b.x ? a.x < b.x : a.y != b.y ? a.y < b.y : a.z < b.z);
+			};
+
+			sort(sortedVertices.begin(), sortedVertices.end(), less);
+
+			vector<uint32_t> positionIds(vertices.size());
+			uint32_t positionId = 0;
+			for (size_t i = 0; i < sortedVertices.size(); i++)
+			{
+				if (i > 0 && less(sortedVertices[i - 1], sortedVertices[i]))
+				{
+					++positionId;
+				}
+
+				positionIds[sortedVertices[i]] = positionId;
+			}
+
+			return positionIds;
+		}
+
+		// Grows charts from the largest unassigned triangle across shared edges, accepting triangles that face
+		// within the tolerance of the seed and whose projection does not overlap the chart. Every triangle of a
+		// chart therefore faces the projection plane, and charts never fold onto themselves.
+		MeshCharts SegmentMesh(const MeshData& meshData, uint32_t meshIndex, float cosineTolerance)
+		{
+			const auto& indices = meshData.Indices;
+			const uint32_t triangleCount = narrow<uint32_t>(indices.size() / 3);
+
+			vector<XMFLOAT3> faceNormals(triangleCount);
+			vector<float> faceAreas(triangleCount);
+			double totalArea = 0.0;
+			for (uint32_t i = 0; i < triangleCount; i++)
+			{
+				const XMFLOAT3& a = meshData.Vertices[indices[i * 3]];
+				const XMFLOAT3& b = meshData.Vertices[indices[i * 3 + 1]];
+				const XMFLOAT3& c = meshData.Vertices[indices[i * 3 + 2]];
+				const XMFLOAT3 normal = Cross(Subtract(b, a), Subtract(c, a));
+				faceAreas[i] = 0.5f * sqrt(Dot(normal, normal));
+				faceNormals[i] = Normalize(normal);
+				totalArea += faceAreas[i];
+			}
+
+			// Footprint cells about twice the size of an average triangle.
+			const float footprintCellSize = (triangleCount > 0 ? 2.0f * static_cast<float>(sqrt(totalArea / triangleCount)) : 0.0f);
+
+			// Edges sorted by their position pair; runs of equal keys are the triangles sharing an edge.
+			const vector<uint32_t> positionIds = PositionIds(meshData.Vertices);
+			vector<pair<uint64_t, uint32_t>> edges;
+			edges.reserve(indices.size());
+			for (uint32_t i = 0; i < triangleCount; i++)
+			{
+				for (uint32_t corner = 0; corner < 3; corner++)
+				{
+					const uint32_t a = positionIds[indices[i * 3 + corner]];
+					const uint32_t b = positionIds[indices[i * 3 + (corner + 1) % 3]];
+					if (a != b)
+					{
+						edges.emplace_back((static_cast<uint64_t>(min(a, b)) << 32) | max(a, b), i);
+					}
+				}
+			}
+
+			sort(edges.begin(), edges.end());
+
+			vector<pair<uint32_t, uint32_t>> links;
+			for (size_t i = 1; i < edges.size(); i++)
+			{
+				if (edges[i - 1].first == edges[i].first && edges[i - 1].second != edges[i].second)
+				{
+					links.emplace_back(edges[i - 1].second, edges[i].second);
+					links.emplace_back(edges[i].second, edges[i - 1].second);
+				}
+			}
+
+			sort(links.begin(), links.end());
+			vector<uint32_t> linkOffsets(static_cast<size_t>(triangleCount) + 1, 0);
+			for (const auto& link : links)
+			{
+				++linkOffsets[link.first + 1];
+			}
+
+			partial_sum(linkOffsets.begin(), linkOffsets.end(), linkOffsets.begin());
+
+			vector<uint32_t> seeds(triangleCount);
+			iota(seeds.begin(), seeds.end(), 0U);
+			stable_sort(seeds.begin(), seeds.end(), [&faceAreas](uint32_t lhs, uint32_t rhs) { return faceAreas[lhs] > faceAreas[rhs]; });
+
+			MeshCharts meshCharts;
+			meshCharts.TriangleCharts.assign(triangleCount, Unassigned);
+			vector<uint32_t> pending;
+			for (uint32_t seed : seeds)
+			{
+				if (meshCharts.TriangleCharts[seed] != Unassigned)
+				{
+					continue;
+				}
+
+				const uint32_t chartIndex = narrow<uint32_t>(meshCharts.Charts.size());
+				Chart& chart = meshCharts.Charts.emplace_back();
+				chart.Mesh = meshIndex;
+				if (faceAreas[seed] > 0.0f)
+				{
+					chart.Normal = faceNormals[seed];
+				}
+
+				ChartFootprint footprint(chart.Normal, max(footprintCellSize, numeric_limits<float>::min()));
+				footprint.Add(footprint.Project(meshData, seed));
+				meshCharts.TriangleCharts[seed] = chartIndex;
+				chart.Triangles.push_back(seed);
+				pending.push_back(seed);
+				while (!pending.empty())
+				{
+					const uint32_t triangle = pending.back();
+					pending.pop_back();
+					for (uint32_t link = linkOffsets[triangle]; link < linkOffsets[triangle + 1]; link++)
+					{
+						// Degenerate triangles join any chart; they cover no area.
+						const uint32_t neighbor = links[link].second;
+						if (meshCharts.TriangleCharts[neighbor] != Unassigned || (faceAreas[neighbor] > 0.0f && Dot(faceNormals[neighbor], chart.Normal) < cosineTolerance))
+						{
+							continue;
+						}
+
+						const ProjectedTriangle corners = footprint.Project(meshData, neighbor);
+						if (!footprint.Overlaps(corners))
+						{
+							footprint.Add(corners);
+							meshCharts.TriangleCharts[neighbor] = chartIndex;
+							chart.Triangles.push_back(neighbor);
+							pending.push_back(neighbor);
+						}
+					}
+				}
+			}
+
+			return meshCharts;
+		}
+
+		vector<XMFLOAT2> ConvexHull(vector<XMFLOAT2> points)
+		{
+			sort(points.begin(), points.end(), [](const XMFLOAT2& lhs, const XMFLOAT2& rhs) { return (lhs.x != rhs.x ? lhs.x < rhs.x : lhs.y < rhs.y); });
+			if (points.size() < 3)
+			{
+				return points;
+			}
+
+			// Monotone chain
+			vector<XMFLOAT2> hull(points.size() * 2);
+			size_t count = 0;
+			for (size_t i = 0; i < points.size(); i++)
+			{
+				while (count >= 2 && Cross(hull[count - 2], hull[count - 1], points[i]) <= 0.0f)
+				{
+					--count;
+				}
+
+				hull[count++] = points[i];
+			}
+
+			for (size_t i = points.size() - 1, lowerCount = count + 1; i > 0; i--)
+			{
+				while (count >= lowerCount && Cross(hull[count - 2], hull[count - 1], points[i - 1]) <= 0.0f)
+				{
+					--count;
+				}
+
+				hull[count++] = points[i - 1];
+			}
+
+			hull.resize(count - 1);
+			return hull;
+		}
+
+		// Projects the chart onto the plane of its normal and rotates it to the smallest bounding rectangle, lying
+		// flat (wider than tall), with its minimum at the origin.
+		void ParameterizeChart(Chart& chart, const MeshData& meshData)
+		{
+			const auto& indices = meshData.Indices;
+			for (uint32_t triangle : chart.Triangles)
+			{
+				chart.Vertices.insert(chart.Vertices.end(), &indices[triangle * 3], &indices[triangle * 3] + 3);
+			}
+
+			sort(chart.Vertices.begin(), chart.Vertices.end());
+			chart.Vertices.erase(unique(chart.Vertices.begin(), chart.Vertices.end()), chart.Vertices.end());
+
+			XMFLOAT3 tangent;
+			XMFLOAT3 bitangent;
+			ProjectionAxes(chart.Normal, tangent, bitangent);
+			chart.Positions.resize(chart.Vertices.size());
+			for (size_t i = 0; i < chart.Vertices.size(); i++)
+			{
+				const XMFLOAT3& position = meshData.Vertices[chart.Vertices[i]];
+				chart.Positions[i] = XMFLOAT2(Dot(position, tangent), Dot(position, bitangent));
+			}
+
+			// The minimum-area bounding rectangle has a side collinear with an edge of the convex hull.
+			const vector<XMFLOAT2> hull = ConvexHull(chart.Positions);
+			XMFLOAT2 axis(1.0f, 0.0f);
+			float bestArea = numeric_limits<float>::max();
+			for (size_t i = 0; i < hull.size(); i++)
+			{
+				const XMFLOAT2& a = hull[i];
+				const XMFLOAT2& b = hull[(i + 1) % hull.size()];
+				const float length = sqrt((b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y));
+				if (length == 0.0f)
+				{
+					continue;
+				}
+
+				const XMFLOAT2 edgeAxis((b.x - a.x) / length, (b.y - a.y) / length);
+				XMFLOAT2 minimum(numeric_limits<float>::max(), numeric_limits<float>::max());
+				XMFLOAT2 maximum(numeric_limits<float>::lowest(), numeric_limits<float>::lowest());
+				for (const XMFLOAT2& point : hull)
+				{
+					const float u = point.x * edgeAxis.x + point.y * edgeAxis.y;
+					const float v = point.y * edgeAxis.x - point.x * edgeAxis.y;
+					minimum = XMFLOAT2(min(minimum.x, u), min(minimum.y, v));
+					maximum = XMFLOAT2(max(maximum.x, u), max(maximum.y, v));
+				}
+
+				const float area = (maximum.x - minimum.x) * (maximum.y - minimum.y);
+				if (area < bestArea)
+				{
+					bestArea = area;
+					axis = edgeAxis;
+				}
+			}
+
+			XMFLOAT2 minimum(numeric_limits<float>::max(), numeric_limits<float>::max());
+			XMFLOAT2 maximum(numeric_limits<float>::lowest(), numeric_limits<float>::lowest());
+			for (XMFLOAT2& position : chart.Positions)
+			{
+				position = XMFLOAT2(position.x * axis.x + position.y * axis.y, position.y * axis.x - position.x * axis.y);
+				minimum = XMFLOAT2(min(minimum.x, position.x), min(minimum.y, position.y));
+				maximum = XMFLOAT2(max(maximum.x, position.x), max(maximum.y, position.y));
+			}
+
+			// A quarter turn (rather than swapping the axes) keeps the chart from being mirrored.
+			const bool rotate = (maximum.y - minimum.y > maximum.x - minimum.x);
+			for (XMFLOAT2& position : chart.Positions)
+			{
+				position = (rotate ? XMFLOAT2(maximum.y - position.y, position.x - minimum.x) : XMFLOAT2(position.x - minimum.x, position.y - minimum.y));
+			}
+
+			chart.Size = (rotate ? XMFLOAT2(maximum.y - minimum.y, maximum.x - minimum.x) : XMFLOAT2(maximum.x - minimum.x, maximum.y - minimum.y));
+
+			chart.Area = 0.0f;
+			for (uint32_t triangle : chart.Triangles)
+			{
+				XMFLOAT2 corners[3];
+				for (uint32_t corner = 0; corner < 3; corner++)
+				{
+					const auto it = lower_bound(chart.Vertices.begin(), chart.Vertices.end(), indices[triangle * 3 + corner]);
+					corners[corner] = chart.Positions[distance(chart.Vertices.begin(), it)];
+				}
+
+				chart.Area += 0.5f * fabs(Cross(corners[0], corners[1], corners[2]));
+			}
+		}
+
+		// Each chart occupies its parameterized extent plus one texel (half a texel of filtering margin on each side)
+		// plus the padding.
+		uint32_t ChartExtent(float size, float texelsPerUnit, uint32_t padding)
+		{
+			return static_cast<uint32_t>(ceil(size * texelsPerUnit)) + 1 + padding;
+		}
+
+		uint32_t AlignUp(uint32_t value)
+		{
+			return (value + AtlasAlignment - 1) / AtlasAlignment * AtlasAlignment;
+		}
+
+		// Shelf packing of the charts, tallest first, into an atlas about as wide as it is tall. Returns the atlas size.
+		pair<uint32_t, uint32_t> PackCharts(vector<Chart*>& charts, float texelsPerUnit, uint32_t padding)
+		{
+			vector<pair<uint32_t, uint32_t>> extents(charts.size());
+			uint64_t totalArea = 0;
+			uint32_t maxWidth = 0;
+			for (size_t i = 0; i < charts.size(); i++)
+			{
+				extents[i] = { ChartExtent(charts[i]->Size.x, texelsPerUnit, padding), ChartExtent(charts[i]->Size.y, texelsPerUnit, padding) };
+				totalArea += static_cast<uint64_t>(extents[i].first) * extents[i].second;
+				maxWidth = max(maxWidth, extents[i].first);
+			}
+
+			vector<uint32_t> order(charts.size());
+			iota(order.begin(), order.end(), 0U);
+			sort(order.begin(), order.end(), [&extents](uint32_t lhs, uint32_t rhs)
+			{
+				return (extents[lhs].second != extents[rhs].second ? extents[lhs].second > extents[rhs].second : extents[lhs].first > extents[rhs].first);
+			});
+
+			const uint32_t atlasWidth = max(maxWidth, static_cast<uint32_t>(ceil(sqrt(static_cast<double>(totalArea)))));
+			uint32_t x = 0;
+			uint32_t y = 0;
+			uint32_t shelfHeight = 0;
+			for (uint32_t i : order)
+			{
+				if (x + extents[i].first > atlasWidth)
+				{
+					x = 0;
+					y += shelfHeight;
+					shelfHeight = 0;
+				}
+
+				charts[i]->X = x;
+				charts[i]->Y = y;
+				x += extents[i].first;
+				shelfHeight = max(shelfHeight, extents[i].second);
+			}
+
+			return { AlignUp(atlasWidth), AlignUp(y + shelfHeight) };
+		}
+
+		template <typename T>
+		void GatherVertices(vector<T>& attribute, const vector<uint32_t>& sourceVertices)
+		{
+			if (attribute.empty())
+			{
+				return;
+			}
+
+			vector<T> gathered(sourceVertices.size());
+			transform(sourceVertices.begin(), sourceVertices.end(), gathered.begin(), [&attribute](uint32_t vertex) { return attribute[vertex]; });
+			attribute = move(gathered);
+		}
+
+		// Gives every chart its own copy of its vertices, and stores the atlas positions in the lightmap channel.
+		void RebuildMesh(MeshData& meshData, const MeshCharts& meshCharts, float texelsPerUnit, uint32_t padding, uint32_t atlasWidth, uint32_t atlasHeight)
+		{
+			vector<uint32_t> chartOffsets(meshCharts.Charts.size() + 1, 0);
+			for (size_t i = 0; i < meshCharts.Charts.size(); i++)
+			{
+				chartOffsets[i + 1] = chartOffsets[i] + narrow<uint32_t>(meshCharts.Charts[i].Vertices.size());
+			}
+
+			const float margin = 0.5f * padding + 0.5f;
+			vector<uint32_t> sourceVertices;
+			vector<XMFLOAT3> lightmapCoordinates;
+			sourceVertices.reserve(chartOffsets.back());
+			lightmapCoordinates.reserve(chartOffsets.back());
+			for (const Chart& chart : meshCharts.Charts)
+			{
+				sourceVertices.insert(sourceVertices.end(), chart.Vertices.begin(), chart.Vertices.end());
+				for (const XMFLOAT2& position : chart.Positions)
+				{
+					lightmapCoordinates.emplace_back((chart.X + margin + position.x * texelsPerUnit) / atlasWidth, (chart.Y + margin + position.y * texelsPerUnit) / atlasHeight, 0.0f);
+				}
+			}
+
+			auto& indices = meshData.Indices;
+			for (size_t i = 0; i < indices.size(); i++)
+			{
+				const uint32_t chartIndex = meshCharts.TriangleCharts[i / 3];
+				const auto& chartVertices = meshCharts.Charts[chartIndex].Vertices;
+				const auto it = lower_bound(chartVertices.begin(), chartVertices.end(), indices[i]);
+				indices[i] = chartOffsets[chartIndex] + narrow<uint32_t>(distance(chartVertices.begin(), it));
+			}
+
+			GatherVertices(meshData.Vertices, sourceVertices);
+			GatherVertices(meshData.Normals, sourceVertices);
+			GatherVertices(meshData.Tangents, sourceVertices);
+			GatherVertices(meshData.BiNormals, sourceVertices);
+			for (auto& textureCoordinates : meshData.TextureCoordinates)
+			{
+				GatherVertices(textureCoordinates, sourceVertices);
+			}
+
+			for (auto& vertexColors : meshData.VertexColors)
+			{
+				GatherVertices(vertexColors, sourceVertices);
+			}
+
+			// Channel 0 holds the material's texture coordinates; meshes without them get a copy of the lightmap's.
+			auto& textureCoordinates = meshData.TextureCoordinates;
+			if (textureCoordinates.empty())
+			{
+				textureCoordinates.push_back(lightmapCoordinates);
+			}
+
+			textureCoordinates.resize(max<size_t>(textureCoordinates.size(), LightmapUVGenerator::LightmapChannel + 1));
+			textureCoordinates[LightmapUVGenerator::LightmapChannel] = move(lightmapCoordinates);
+		}
+	}
+
+	LightmapUVStatistics LightmapUVGenerator::Generate(Model& model, const LightmapUVSettings& settings)
+	{
+		vector<MeshData*> meshes;
+		for (const auto& mesh : model.Meshes())
+		{
+			MeshData& meshData = mesh->Data();
+			if (meshData.Indices.size() % 3 != 0)
+			{
+				throw exception("Lightmap texture coordinates require triangle lists.");
+			}
+
+			meshes.push_back(&meshData);
+		}
+
+		LightmapUVStatistics statistics;
+		for (const MeshData* meshData : meshes)
+		{
+			statistics.SourceVertexCount += meshData->Vertices.size();
+		}
+
+		// Exceptions must not escape the parallel algorithm; the first one is rethrown afterwards.
+		const float cosineTolerance = cos(settings.ChartAngleTolerance);
+		vector<uint32_t> meshIndices(meshes.size());
+		iota(meshIndices.begin(), meshIndices.end(), 0U);
+		vector<MeshCharts> meshCharts(meshes.size());
+		vector<exception_ptr> errors(meshes.size());
+		for_each(execution::par, meshIndices.begin(), meshIndices.end(), [&](uint32_t i)
+		{
+			try
+			{
+				meshCharts[i] = SegmentMesh(*meshes[i], i, cosineTolerance);
+			}
+			catch (...)
+			{
+				errors[i] = current_exception();
+			}
+		});
+
+		for (const auto& error : errors)
+		{
+			if (error != nullptr)
+			{
+				rethrow_exception(error);
+			}
+		}
+
+		vector<Chart*> charts;
+		for (auto& meshChart : meshCharts)
+		{
+			for (auto& chart : meshChart.Charts)
+			{
+				charts.push_back(&chart);
+			}
+		}
+
+		for_each(execution::par, charts.begin(), charts.end(), [&meshes](Chart* chart)
+		{
+			ParameterizeChart(*chart, *meshes[chart->Mesh]);
+		});
+
+		// The padding does not scale with the density, so the atlas may need several attempts to fit.
+		float texelsPerUnit = settings.TexelsPerUnit;
+		pair<uint32_t, uint32_t> atlasSize = PackCharts(charts, texelsPerUnit, settings.Padding);
+		for (int attempt = 1; max(atlasSize.first, atlasSize.second) > settings.MaxAtlasSize; attempt++)
+		{
+			if (attempt == MaxPackingAttempts)
+			{
+				throw exception("Lightmap charts do not fit in the maximum atlas size.");
+			}
+
+			texelsPerUnit *= 0.99f * settings.MaxAtlasSize / max(atlasSize.first, atlasSize.second);
+			atlasSize = PackCharts(charts, texelsPerUnit, settings.Padding);
+		}
+
+		for_each(execution::par, meshIndices.begin(), meshIndices.end(), [&](uint32_t i)
+		{
+			try
+			{
+				if (meshCharts[i].Charts.empty())
+				{
+					return;
+				}
+
+				RebuildMesh(*meshes[i], meshCharts[i], texelsPerUnit, settings.Padding, atlasSize.first, atlasSize.second);
+			}
+			catch (...)
+			{
+				errors[i] = current_exception();
+			}
+		});
+
+		for (const auto& error : errors)
+		{
+			if (error != nullptr)
+			{
+				rethrow_exception(error);
+			}
+		}
+
+		double coveredArea = 0.0;
+		for (const Chart* chart : charts)
+		{
+			coveredArea += static_cast<double>(chart->Area) * texelsPerUnit * texelsPerUnit;
+		}
+
+		for (const MeshData* meshData : meshes)
+		{
+			statistics.VertexCount += meshData->Vertices.size();
+		}
+
+		model.Data().Lightmap = { atlasSize.first, atlasSize.second };
+
+		statistics.ChartCount = charts.size();
+		statistics.AtlasWidth = atlasSize.first;
+		statistics.AtlasHeight = atlasSize.second;
+		statistics.TexelsPerUnit = texelsPerUnit;
+		statistics.Utilization = (charts.empty() ? 0.0f : static_cast<float>(coveredArea / (static_cast<double>(atlasSize.first) * atlasSize.second)));
+
+		return statistics;
+	}
+}
\ No newline at end of file
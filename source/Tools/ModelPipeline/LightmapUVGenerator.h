@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Library
+{
+	class Model;
+}
+
+namespace ModelPipeline
+{
+	struct LightmapUVSettings final
+	{
+		float TexelsPerUnit{ 16.0f }; // Target texel density; lowered if the atlas would exceed MaxAtlasSize.
+		float ChartAngleTolerance{ 0.7854f }; // Radians (45 degrees) between a triangle and the first triangle of its chart.
+		std::uint32_t Padding{ 2 }; // Texels between charts, so that filtering and dilation do not bleed across them.
+		std::uint32_t MaxAtlasSize{ 2048 };
+	};
+
+	struct LightmapUVStatistics final
+	{
+		std::size_t ChartCount{ 0 };
+		std::size_t SourceVertexCount{ 0 };
+		std::size_t VertexCount{ 0 };
+		std::uint32_t AtlasWidth{ 0 };
+		std::uint32_t AtlasHeight{ 0 };
+		float TexelsPerUnit{ 0.0f };
+		float Utilization{ 0.0f }; // Fraction of the atlas covered by triangles.
+	};
+
+	// Generates non-overlapping lightmap texture coordinates for all meshes of a model, sharing one atlas, and
+	// stores them in texture coordinate channel 1; the atlas size is stored as the model's lightmap size.
+	// Triangles are grouped into charts of similar orientation whose projections do not overlap, each chart is
+	// projected onto the plane of its first triangle and rotated to its minimum-area bounding rectangle, and the
+	// charts are packed into shelves. Vertices on chart boundaries are duplicated.
+	class LightmapUVGenerator final
+	{
+	public:
+		LightmapUVGenerator() = delete;
+
+		// Meshes are segmented in parallel, and charts are parameterized in parallel.
+		static LightmapUVStatistics Generate(Library::Model& model, const LightmapUVSettings& settings = LightmapUVSettings());
+
+		inline static const std::uint32_t LightmapChannel{ 1 };
+	};
+}
\ No newline at end of file
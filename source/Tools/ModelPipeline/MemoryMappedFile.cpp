@@ -0,0 +1,56 @@
+#include "pch.h"
+#include "MemoryMappedFile.h"
+
+using namespace std;
+using namespace gsl;
+using namespace winrt;
+
+namespace ModelPipeline
+{
+	MemoryMappedFile::MemoryMappedFile(const string& filename)
+	{
+		mFile.attach(CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+		if (!mFile)
+		{
+			throw exception(("Could not open file: "s + filename).c_str());
+		}
+
+		LARGE_INTEGER fileSize;
+		if (GetFileSizeEx(mFile.get(), &fileSize) == FALSE)
+		{
+			throw exception(("Could not read file size: "s + filename).c_str());
+		}
+
+		mSize = narrow<size_t>(fileSize.QuadPart);
+		if (mSize == 0)
+		{
+			// Zero-length files cannot be mapped.
+			return;
+		}
+
+		mMapping.attach(CreateFileMappingA(mFile.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+		if (!mMapping)
+		{
+			throw exception(("Could not map file: "s + filename).c_str());
+		}
+
+		mView = static_cast<const char*>(MapViewOfFile(mMapping.get(), FILE_MAP_READ, 0, 0, 0));
+		if (mView == nullptr)
+		{
+			throw exception(("Could not map view of file: "s + filename).c_str());
+		}
+	}
+
+	MemoryMappedFile::~MemoryMappedFile()
+	{
+		if (mView != nullptr)
+		{
+			UnmapViewOfFile(mView);
+		}
+	}
+
+	span<const char> MemoryMappedFile::Data() const
+	{
+		return span<const char>(mView, mSize);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <gsl\gsl>
+#include <winrt\base.h>
+
+namespace ModelPipeline
+{
+	// Read-only view of an entire file. The view remains valid for the lifetime of the object.
+	class MemoryMappedFile final
+	{
+	public:
+		explicit MemoryMappedFile(const std::string& filename);
+		MemoryMappedFile(const MemoryMappedFile&) = delete;
+		MemoryMappedFile(MemoryMappedFile&&) = delete;
+		MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+		MemoryMappedFile& operator=(MemoryMappedFile&&) = delete;
+		~MemoryMappedFile();
+
+		gsl::span<const char> Data() const;
+
+	private:
+		winrt::file_handle mFile;
+		winrt::handle mMapping;
+		const char* mView{ nullptr };
+		std::size_t mSize{ 0 };
+	};
+}
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include "Mesh.h"
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
+#include <execution>
+#include <numeric>
 
 using namespace std;
 using namespace gsl;
@@ -12,7 +14,159 @@ using namespace Library;
 
 namespace ModelPipeline
 {
-	shared_ptr<Library::Mesh> MeshProcessor::LoadMesh(Library::Model& model, aiMesh& mesh)
+	namespace
+	{
+		const size_t WeldChunkSize{ 4096 };
+		const float CellSizeInTolerances{ 4.0f };
+		const uint32_t EmptyRun{ numeric_limits<uint32_t>::max() };
+
+		struct WeldCell final
+		{
+			int64_t X;
+			int64_t Y;
+			int64_t Z;
+		};
+
+		struct CellRun final
+		{
+			uint64_t Hash;
+			uint32_t Begin;
+			uint32_t End;
+		};
+
+		size_t RoundUpToPowerOfTwo(size_t value)
+		{
+			size_t result = 1;
+			while (result < value)
+			{
+				result <<= 1;
+			}
+
+			return result;
+		}
+
+		// A zero inverse cell size requests exact matching: the cell is the position's bit pattern (with -0 folded into +0).
+		WeldCell CellOf(const XMFLOAT3& position, float inverseCellSize)
+		{
+			if (inverseCellSize == 0.0f)
+			{
+				auto bits = [](float value)
+				{
+					value += 0.0f;
+					uint32_t result;
+					memcpy(&result, &value, sizeof(result));
+					return static_cast<int64_t>(result);
+				};
+
+				return { bits(position.x), bits(position.y), bits(position.z) };
+			}
+
+			return { static_cast<int64_t>(floor(position.x * inverseCellSize)), static_cast<int64_t>(floor(position.y * inverseCellSize)), static_cast<int64_t>(floor(position.z * inverseCellSize)) };
+		}
+
+		uint64_t HashCell(int64_t x, int64_t y, int64_t z)
+		{
+			return (static_cast<uint64_t>(x) * 0x9E3779B97F4A7C15ULL) ^ (static_cast<uint64_t>(y) * 0xC2B2AE3D27D4EB4FULL) ^ (static_cast<uint64_t>(z) * 0x165667B19E3779F9ULL);
+		}
+
+		float Dot(const XMFLOAT3& lhs, const XMFLOAT3& rhs)
+		{
+			return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
+		}
+
+		bool DirectionsMatch(const vector<XMFLOAT3>& directions, uint32_t lhs, uint32_t rhs, float cosineTolerance)
+		{
+			if (directions.empty())
+			{
+				return true;
+			}
+
+			const XMFLOAT3& a = directions[lhs];
+			const XMFLOAT3& b = directions[rhs];
+			const float lengthProduct = sqrt(Dot(a, a) * Dot(b, b));
+			return (lengthProduct == 0.0f ? Dot(a, a) == Dot(b, b) : Dot(a, b) >= cosineTolerance * lengthProduct);
+		}
+
+		class WeldComparer final
+		{
+		public:
+			WeldComparer(const MeshData& meshData, const VertexWeldSettings& settings) :
+				mMeshData(meshData), mPositionToleranceSquared(settings.PositionTolerance * settings.PositionTolerance),
+				mCosineTolerance(cos(settings.NormalAngleTolerance)), mTextureCoordinateTolerance(settings.TextureCoordinateTolerance),
+				mColorTolerance(settings.ColorTolerance)
+			{
+			}
+
+			bool operator()(uint32_t lhs, uint32_t rhs) const
+			{
+				const XMFLOAT3& a = mMeshData.Vertices[lhs];
+				const XMFLOAT3& b = mMeshData.Vertices[rhs];
+				const XMFLOAT3 delta(a.x - b.x, a.y - b.y, a.z - b.z);
+				if (Dot(delta, delta) > mPositionToleranceSquared)
+				{
+					return false;
+				}
+
+				if (!DirectionsMatch(mMeshData.Normals, lhs, rhs, mCosineTolerance) || !DirectionsMatch(mMeshData.Tangents, lhs, rhs, mCosineTolerance) || !DirectionsMatch(mMeshData.BiNormals, lhs, rhs, mCosineTolerance))
+				{
+					return false;
+				}
+
+				for (const auto& textureCoordinates : mMeshData.TextureCoordinates)
+				{
+					const XMFLOAT3& uvA = textureCoordinates[lhs];
+					const XMFLOAT3& uvB = textureCoordinates[rhs];
+					if (fabs(uvA.x - uvB.x) > mTextureCoordinateTolerance || fabs(uvA.y - uvB.y) > mTextureCoordinateTolerance || fabs(uvA.z - uvB.z) > mTextureCoordinateTolerance)
+					{
+						return false;
+					}
+				}
+
+				for (const auto& vertexColors : mMeshData.VertexColors)
+				{
+					const XMFLOAT4& colorA = vertexColors[lhs];
+					const XMFLOAT4& colorB = vertexColors[rhs];
+					if (fabs(colorA.x - colorB.x) > mColorTolerance || fabs(colorA.y - colorB.y) > mColorTolerance || fabs(colorA.z - colorB.z) > mColorTolerance || fabs(colorA.w - colorB.w) > mColorTolerance)
+					{
+						return false;
+					}
+				}
+
+				return true;
+			}
+
+		private:
+			const MeshData& mMeshData;
+			float mPositionToleranceSquared;
+			float mCosineTolerance;
+			float mTextureCoordinateTolerance;
+			float mColorTolerance;
+		};
+
+		template <typename T>
+		void GatherVertices(vector<T>& attribute, const vector<uint32_t>& keptVertices)
+		{
+			if (attribute.empty())
+			{
+				return;
+			}
+
+			vector<T> gathered(keptVertices.size());
+			transform(keptVertices.begin(), keptVertices.end(), gathered.begin(), [&attribute](uint32_t vertex) { return attribute[vertex]; });
+			attribute = move(gathered);
+		}
+	}
+
+	VertexWeldStatistics& VertexWeldStatistics::operator+=(const VertexWeldStatistics& rhs)
+	{
+		SourceVertexCount += rhs.SourceVertexCount;
+		WeldedVertexCount += rhs.WeldedVertexCount;
+		RemovedFaceCount += rhs.RemovedFaceCount;
+
+		return *this;
+	}
+
+	shared_ptr<Library::Mesh> MeshProcessor::LoadMesh(Library::Model& model, aiMesh& mesh, const VertexWeldSettings& weldSettings, VertexWeldStatistics* weldStatistics)
 	{
 		MeshData meshData;
 
@@ -99,6 +253,215 @@ namespace ModelPipeline
 			}
 		}
 
+		if (weldSettings.Enabled)
+		{
+			VertexWeldStatistics statistics = WeldVertices(meshData, weldSettings);
+			if (weldStatistics != nullptr)
+			{
+				*weldStatistics = statistics;
+			}
+		}
+
 		return make_shared<Library::Mesh>(model, move(meshData));
 	}
+
+	VertexWeldStatistics MeshProcessor::WeldVertices(MeshData& meshData, const VertexWeldSettings& settings)
+	{
+		const uint32_t vertexCount = narrow<uint32_t>(meshData.Vertices.size());
+
+		VertexWeldStatistics statistics;
+		statistics.SourceVertexCount = vertexCount;
+		statistics.WeldedVertexCount = vertexCount;
+		if (vertexCount < 2)
+		{
+			return statistics;
+		}
+
+		// Bucket the vertices by position cell. Cells are several tolerances wide, so the tolerance box around
+		// a vertex usually overlaps only its own cell. A zero tolerance buckets by exact position.
+		const float tolerance = max(settings.PositionTolerance, 0.0f);
+		const float inverseCellSize = (tolerance > 0.0f ? 1.0f / (tolerance * CellSizeInTolerances) : 0.0f);
+
+		vector<uint64_t> cellHashes(vertexCount);
+		transform(execution::par, meshData.Vertices.begin(), meshData.Vertices.end(), cellHashes.begin(), [inverseCellSize](const XMFLOAT3& position)
+		{
+			const WeldCell cell = CellOf(position, inverseCellSize);
+			return HashCell(cell.X, cell.Y, cell.Z);
+		});
+
+		// Vertices sorted by (cell hash, index), so that each cell is a contiguous run in index order.
+		vector<uint32_t> sortedVertices(vertexCount);
+		iota(sortedVertices.begin(), sortedVertices.end(), 0U);
+		sort(execution::par, sortedVertices.begin(), sortedVertices.end(), [&cellHashes](uint32_t lhs, uint32_t rhs)
+		{
+			return (cellHashes[lhs] != cellHashes[rhs] ? cellHashes[lhs] < cellHashes[rhs] : lhs < rhs);
+		});
+
+		// Open-addressed table from cell hash to run.
+		vector<CellRun> runs;
+		for (uint32_t begin = 0; begin < vertexCount;)
+		{
+			const uint64_t hash = cellHashes[sortedVertices[begin]];
+			uint32_t end = begin + 1;
+			while (end < vertexCount && cellHashes[sortedVertices[end]] == hash)
+			{
+				++end;
+			}
+
+			runs.push_back({ hash, begin, end });
+			begin = end;
+		}
+
+		const size_t tableMask = RoundUpToPowerOfTwo(runs.size() * 2) - 1;
+		vector<uint32_t> runTable(tableMask + 1, EmptyRun);
+		for (uint32_t run = 0; run < runs.size(); ++run)
+		{
+			size_t slot = static_cast<size_t>(runs[run].Hash >> 32) & tableMask;
+			while (runTable[slot] != EmptyRun)
+			{
+				slot = (slot + 1) & tableMask;
+			}
+
+			runTable[slot] = run;
+		}
+
+		auto findRun = [&](uint64_t hash) -> const CellRun*
+		{
+			for (size_t slot = static_cast<size_t>(hash >> 32) & tableMask; runTable[slot] != EmptyRun; slot = (slot + 1) & tableMask)
+			{
+				if (runs[runTable[slot]].Hash == hash)
+				{
+					return &runs[runTable[slot]];
+				}
+			}
+
+			return nullptr;
+		};
+
+		// Pass 1 (parallel): link each vertex to the lowest-indexed earlier vertex it can be welded to.
+		const WeldComparer canWeld(meshData, settings);
+		vector<uint32_t> links(vertexCount);
+		vector<uint32_t> chunks((vertexCount + WeldChunkSize - 1) / WeldChunkSize);
+		iota(chunks.begin(), chunks.end(), 0U);
+		for_each(execution::par, chunks.begin(), chunks.end(), [&](uint32_t chunk)
+		{
+			const uint32_t chunkEnd = static_cast<uint32_t>(min<size_t>((chunk + 1) * WeldChunkSize, vertexCount));
+			for (uint32_t vertex = static_cast<uint32_t>(chunk * WeldChunkSize); vertex < chunkEnd; ++vertex)
+			{
+				const XMFLOAT3& position = meshData.Vertices[vertex];
+				const WeldCell minCell = CellOf(XMFLOAT3(position.x - tolerance, position.y - tolerance, position.z - tolerance), inverseCellSize);
+				const WeldCell maxCell = CellOf(XMFLOAT3(position.x + tolerance, position.y + tolerance, position.z + tolerance), inverseCellSize);
+
+				uint32_t link = vertex;
+				for (int64_t z = minCell.Z; z <= maxCell.Z; ++z)
+				{
+					for (int64_t y = minCell.Y; y <= maxCell.Y; ++y)
+					{
+						for (int64_t x = minCell.X; x <= maxCell.X; ++x)
+						{
+							const CellRun* run = findRun(HashCell(x, y, z));
+							if (run == nullptr)
+							{
+								continue;
+							}
+
+							for (uint32_t candidate = run->Begin; candidate < run->End; ++candidate)
+							{
+								const uint32_t other = sortedVertices[candidate];
+								if (other >= link)
+								{
+									break;
+								}
+
+								if (canWeld(other, vertex))
+								{
+									link = other;
+									break;
+								}
+							}
+						}
+					}
+				}
+
+				links[vertex] = link;
+			}
+		});
+
+		// Pass 2 (sequential, linear): resolve links to kept vertices in index order. A vertex only joins its
+		// link's representative if it is within tolerance of that representative, so welds cannot drift.
+		vector<uint32_t> representatives(vertexCount);
+		vector<uint32_t> remap(vertexCount);
+		vector<uint32_t> keptVertices;
+		keptVertices.reserve(vertexCount);
+		for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+		{
+			uint32_t representative = vertex;
+			if (links[vertex] != vertex)
+			{
+				const uint32_t candidate = representatives[links[vertex]];
+				if (candidate == links[vertex] || canWeld(candidate, vertex))
+				{
+					representative = candidate;
+				}
+			}
+
+			representatives[vertex] = representative;
+			if (representative == vertex)
+			{
+				remap[vertex] = static_cast<uint32_t>(keptVertices.size());
+				keptVertices.push_back(vertex);
+			}
+			else
+			{
+				remap[vertex] = remap[representative];
+			}
+		}
+
+		statistics.WeldedVertexCount = keptVertices.size();
+		if (keptVertices.size() == vertexCount)
+		{
+			return statistics;
+		}
+
+		GatherVertices(meshData.Vertices, keptVertices);
+		GatherVertices(meshData.Normals, keptVertices);
+		GatherVertices(meshData.Tangents, keptVertices);
+		GatherVertices(meshData.BiNormals, keptVertices);
+		for (auto& textureCoordinates : meshData.TextureCoordinates)
+		{
+			GatherVertices(textureCoordinates, keptVertices);
+		}
+
+		for (auto& vertexColors : meshData.VertexColors)
+		{
+			GatherVertices(vertexColors, keptVertices);
+		}
+
+		transform(execution::par, meshData.Indices.begin(), meshData.Indices.end(), meshData.Indices.begin(), [&remap](uint32_t index) { return remap[index]; });
+
+		// Triangles whose corners were welded together are removed.
+		if (meshData.Indices.size() == static_cast<size_t>(meshData.FaceCount) * 3)
+		{
+			size_t writeIndex = 0;
+			for (size_t readIndex = 0; readIndex < meshData.Indices.size(); readIndex += 3)
+			{
+				const uint32_t i0 = meshData.Indices[readIndex];
+				const uint32_t i1 = meshData.Indices[readIndex + 1];
+				const uint32_t i2 = meshData.Indices[readIndex + 2];
+				if (i0 != i1 && i1 != i2 && i0 != i2)
+				{
+					meshData.Indices[writeIndex++] = i0;
+					meshData.Indices[writeIndex++] = i1;
+					meshData.Indices[writeIndex++] = i2;
+				}
+			}
+
+			meshData.Indices.resize(writeIndex);
+			const uint32_t faceCount = narrow<uint32_t>(writeIndex / 3);
+			statistics.RemovedFaceCount = meshData.FaceCount - faceCount;
+			meshData.FaceCount = faceCount;
+		}
+
+		return statistics;
+	}
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <cstdint>
 
 struct aiMesh;
 
@@ -8,15 +9,41 @@ namespace Library
 {
 	class Model;
 	class Mesh;
+	struct MeshData;
 }
 
 namespace ModelPipeline
 {
+	// Vertices are welded when every attribute is within tolerance of an earlier kept vertex. Texture
+	// coordinates and colors use a near-exact tolerance by default so that UV seams and color borders survive.
+	struct VertexWeldSettings final
+	{
+		bool Enabled{ true };
+		float PositionTolerance{ 1e-5f };
+		float NormalAngleTolerance{ 0.0175f }; // Radians (about one degree); also applied to tangents and binormals.
+		float TextureCoordinateTolerance{ 1e-6f };
+		float ColorTolerance{ 1.0f / 512.0f };
+	};
+
+	struct VertexWeldStatistics final
+	{
+		std::size_t SourceVertexCount{ 0 };
+		std::size_t WeldedVertexCount{ 0 };
+		std::size_t RemovedFaceCount{ 0 };
+
+		VertexWeldStatistics& operator+=(const VertexWeldStatistics& rhs);
+	};
+
     class MeshProcessor final
     {
     public:
 		MeshProcessor() = delete;
 
-		static std::shared_ptr<Library::Mesh> LoadMesh(Library::Model& model, aiMesh& mesh);
+		static std::shared_ptr<Library::Mesh> LoadMesh(Library::Model& model, aiMesh& mesh, const VertexWeldSettings& weldSettings = VertexWeldSettings(), VertexWeldStatistics* weldStatistics = nullptr);
+
+		// Welds near-duplicate vertices using a spatial hash, remapping the indices and removing triangles that
+		// collapse as a result. The neighbour search runs in parallel over chunks of the mesh; the result does
+		// not depend on the number of threads.
+		static VertexWeldStatistics WeldVertices(Library::MeshData& meshData, const VertexWeldSettings& settings);
     };
 }
\ No newline at end of file
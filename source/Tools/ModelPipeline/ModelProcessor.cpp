@@ -2,28 +2,78 @@
 #include "ModelProcessor.h"
 #include "ModelMaterialProcessor.h"
 #include "MeshProcessor.h"
+#include "Mesh.h"
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
+#include <execution>
+#include <numeric>
+#include <chrono>
 
 using namespace std;
+using namespace std::chrono;
+using namespace gsl;
 using namespace Library;
 using namespace DirectX;
 
 namespace ModelPipeline
 {
-	Library::Model ModelProcessor::LoadModel(const std::string& filename, bool flipUVs)
+	namespace
+	{
+		// Visits the hierarchy depth first, so that each node is added after its parent.
+		void LoadNodes(ModelData& modelData, const aiNode& node, int32_t parent)
+		{
+			const int32_t index = narrow<int32_t>(modelData.Nodes.size());
+			ModelNode& modelNode = modelData.Nodes.emplace_back();
+			modelNode.Name = node.mName.C_Str();
+			modelNode.Parent = parent;
+			modelNode.MeshIndices.assign(node.mMeshes, node.mMeshes + node.mNumMeshes);
+
+			// Assimp matrices transform column vectors; DirectXMath matrices transform row vectors.
+			const aiMatrix4x4& transform = node.mTransformation;
+			modelNode.Transform = XMFLOAT4X4(
+				transform.a1, transform.b1, transform.c1, transform.d1,
+				transform.a2, transform.b2, transform.c2, transform.d2,
+				transform.a3, transform.b3, transform.c3, transform.d3,
+				transform.a4, transform.b4, transform.c4, transform.d4);
+
+			for (unsigned int i = 0; i < node.mNumChildren; i++)
+			{
+				LoadNodes(modelData, *(node.mChildren[i]), index);
+			}
+		}
+
+		// CalcTangentSpace leaves meshes that already have tangents alone.
+		void RemoveTangents(const aiScene& scene)
+		{
+			for (unsigned int i = 0; i < scene.mNumMeshes; i++)
+			{
+				aiMesh& mesh = *(scene.mMeshes[i]);
+				delete[] mesh.mTangents;
+				delete[] mesh.mBitangents;
+				mesh.mTangents = nullptr;
+				mesh.mBitangents = nullptr;
+			}
+		}
+	}
+
+	Library::Model ModelProcessor::LoadModel(const std::string& filename, bool flipUVs, const VertexWeldSettings& weldSettings, VertexWeldStatistics* weldStatistics)
 	{
 		Library::Model model;
 		ModelData& modelData = model.Data();
 		Assimp::Importer importer;
 
-		uint32_t flags = aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_SortByPType | aiProcess_FlipWindingOrder;
+		uint32_t flags = aiProcess_Triangulate | aiProcess_SortByPType | aiProcess_FlipWindingOrder;
 		if (flipUVs)
 		{
 			flags |= aiProcess_FlipUVs;
 		}
 
+		if (!weldSettings.Enabled)
+		{
+			flags |= aiProcess_JoinIdenticalVertices;
+		}
+
 		const aiScene* scene = importer.ReadFile(filename, flags);
 		if (scene == nullptr)
 		{
@@ -41,13 +91,109 @@ namespace ModelPipeline
 
 		if (scene->HasMeshes())
 		{
-			for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+			// Exceptions must not escape the parallel algorithm; the first one is rethrown afterwards.
+			vector<uint32_t> meshIndices(scene->mNumMeshes);
+			iota(meshIndices.begin(), meshIndices.end(), 0U);
+			vector<shared_ptr<Mesh>> meshes(scene->mNumMeshes);
+			vector<VertexWeldStatistics> meshWeldStatistics(scene->mNumMeshes);
+			vector<exception_ptr> errors(scene->mNumMeshes);
+			for_each(execution::par, meshIndices.begin(), meshIndices.end(), [&](uint32_t i)
+			{
+				try
+				{
+					meshes[i] = MeshProcessor::LoadMesh(model, *(scene->mMeshes[i]), weldSettings, &meshWeldStatistics[i]);
+				}
+				catch (...)
+				{
+					errors[i] = current_exception();
+				}
+			});
+
+			for (const auto& error : errors)
+			{
+				if (error != nullptr)
+				{
+					rethrow_exception(error);
+				}
+			}
+
+			modelData.Meshes = move(meshes);
+
+			if (weldStatistics != nullptr)
 			{
-				shared_ptr<Mesh> mesh = MeshProcessor::LoadMesh(model, *(scene->mMeshes[i]));
-				modelData.Meshes.push_back(move(mesh));
+				*weldStatistics = VertexWeldStatistics();
+				for (const auto& statistics : meshWeldStatistics)
+				{
+					*weldStatistics += statistics;
+				}
 			}
 		}
 
+		// Meshes referenced by several nodes are stored once and instanced through the node table.
+		if (scene->mRootNode != nullptr)
+		{
+			LoadNodes(modelData, *(scene->mRootNode), -1);
+		}
+
+		model.UpdateTransforms();
+
 		return model;
 	}
+
+	TangentBenchmark ModelProcessor::BenchmarkTangentSpace(const string& filename, uint32_t iterationCount, bool flipUVs)
+	{
+		Assimp::Importer importer;
+		uint32_t flags = aiProcess_Triangulate | aiProcess_SortByPType | aiProcess_FlipWindingOrder | aiProcess_JoinIdenticalVertices | aiProcess_GenSmoothNormals;
+		if (flipUVs)
+		{
+			flags |= aiProcess_FlipUVs;
+		}
+
+		const aiScene* scene = importer.ReadFile(filename, flags);
+		if (scene == nullptr)
+		{
+			throw exception(importer.GetErrorString());
+		}
+
+		Library::Model model;
+		for (unsigned int i = 0; i < scene->mNumMaterials; i++)
+		{
+			model.Data().Materials.push_back(ModelMaterialProcessor::LoadModelMaterial(model, *(scene->mMaterials[i])));
+		}
+
+		// TangentGenerator gets the imported vertices unwelded, and only the meshes CalcTangentSpace can process.
+		VertexWeldSettings weldSettings;
+		weldSettings.Enabled = false;
+		vector<MeshData> meshes;
+		for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+		{
+			aiMesh& mesh = *(scene->mMeshes[i]);
+			if (mesh.mPrimitiveTypes == aiPrimitiveType_TRIANGLE && mesh.HasNormals() && mesh.HasTextureCoords(0))
+			{
+				meshes.push_back(MeshProcessor::LoadMesh(model, mesh, weldSettings)->Data());
+			}
+		}
+
+		TangentBenchmark benchmark;
+		for (uint32_t i = 0; i < iterationCount; i++)
+		{
+			// Each iteration starts from the imported meshes, since generation may split vertices.
+			vector<MeshData> iterationMeshes = meshes;
+			auto startTime = high_resolution_clock::now();
+			benchmark.Statistics = TangentStatistics();
+			for (MeshData& meshData : iterationMeshes)
+			{
+				TangentGenerator::Generate(meshData, &benchmark.Statistics);
+			}
+
+			benchmark.GeneratorTime += duration_cast<nanoseconds>(high_resolution_clock::now() - startTime);
+
+			RemoveTangents(*scene);
+			startTime = high_resolution_clock::now();
+			importer.ApplyPostProcessing(aiProcess_CalcTangentSpace);
+			benchmark.AssimpTime += duration_cast<nanoseconds>(high_resolution_clock::now() - startTime);
+		}
+
+		return benchmark;
+	}
 }
\ No newline at end of file
@@ -1,7 +1,10 @@
 #pragma once
 
 #include "Model.h"
+#include "MeshProcessor.h"
+#include "TangentGenerator.h"
 #include <memory>
+#include <chrono>
 
 struct aiNode;
 
@@ -13,10 +16,24 @@ namespace Library
 
 namespace ModelPipeline
 {
+	struct TangentBenchmark final
+	{
+		TangentStatistics Statistics; // From the last iteration
+		std::chrono::nanoseconds GeneratorTime{ 0 };
+		std::chrono::nanoseconds AssimpTime{ 0 };
+	};
+
     struct ModelProcessor final
     {
 		ModelProcessor() = delete;
 
-		static Library::Model LoadModel(const std::string& filename, bool flipUVs = false);		
+		// Vertices are welded by MeshProcessor::WeldVertices rather than Assimp's exact-match join, unless
+		// welding is disabled. Meshes are converted in parallel.
+		static Library::Model LoadModel(const std::string& filename, bool flipUVs = false, const VertexWeldSettings& weldSettings = VertexWeldSettings(), VertexWeldStatistics* weldStatistics = nullptr);
+
+		// Imports the file once with Assimp (exact-match join and smooth normals), then times TangentGenerator and
+		// Assimp's aiProcess_CalcTangentSpace step, each on the same triangle meshes with texture coordinates.
+		// Times are summed over the iterations.
+		static TangentBenchmark BenchmarkTangentSpace(const std::string& filename, std::uint32_t iterationCount, bool flipUVs = false);
     };
-}
+}
\ No newline at end of file
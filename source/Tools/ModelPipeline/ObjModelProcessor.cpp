@@ -0,0 +1,840 @@
+#include "pch.h"
+#include "ObjModelProcessor.h"
+#include "MemoryMappedFile.h"
+#include "Mesh.h"
+#include "ModelMaterial.h"
+#include <charconv>
+#include <execution>
+#include <numeric>
+#include <thread>
+
+using namespace std;
+using namespace std::filesystem;
+using namespace std::string_literals;
+using namespace gsl;
+using namespace DirectX;
+using namespace Library;
+
+namespace ModelPipeline
+{
+	namespace
+	{
+		const uint32_t MissingIndex{ numeric_limits<uint32_t>::max() };
+		const size_t MinimumChunkSize{ 1 << 20 };
+		const size_t ChunksPerThread{ 4 };
+		const size_t MinimumParallelWeldSize{ 1 << 16 };
+		const string DefaultGroupName{ "defaultobject" };
+		const string DefaultMaterialName{ "DefaultMaterial" };
+
+		const map<string, TextureType> TextureKeywords
+		{
+			{ "map_kd", TextureType::Diffuse },
+			{ "map_ks", TextureType::SpecularMap },
+			{ "map_ka", TextureType::Ambient },
+			{ "map_ke", TextureType::Emissive },
+			{ "map_bump", TextureType::Heightmap },
+			{ "bump", TextureType::Heightmap },
+			{ "map_kn", TextureType::NormalMap },
+			{ "norm", TextureType::NormalMap },
+			{ "map_ns", TextureType::SpecularPowerMap },
+			{ "disp", TextureType::DisplacementMap }
+		};
+
+		struct ObjCorner final
+		{
+			uint32_t Position;
+			uint32_t TextureCoordinate;
+			uint32_t Normal;
+		};
+
+		inline bool operator==(const ObjCorner& lhs, const ObjCorner& rhs)
+		{
+			return lhs.Position == rhs.Position && lhs.TextureCoordinate == rhs.TextureCoordinate && lhs.Normal == rhs.Normal;
+		}
+
+		// Group and material changes are recorded against the chunk-local triangle count and resolved once all chunks are parsed.
+		struct ObjStateChange final
+		{
+			enum class StateType
+			{
+				Group,
+				Material
+			};
+
+			StateType Type;
+			size_t TriangleIndex;
+			string Name;
+		};
+
+		struct ObjChunk final
+		{
+			const char* Begin{ nullptr };
+			const char* End{ nullptr };
+			size_t PositionCount{ 0 };
+			size_t TextureCoordinateCount{ 0 };
+			size_t NormalCount{ 0 };
+			size_t PositionBase{ 0 };
+			size_t TextureCoordinateBase{ 0 };
+			size_t NormalBase{ 0 };
+			vector<ObjCorner> Corners;
+			vector<ObjStateChange> StateChanges;
+			vector<string> MaterialLibraries;
+			string Error;
+		};
+
+		struct ObjAttributes final
+		{
+			vector<XMFLOAT3> Positions;
+			vector<XMFLOAT4> Colors;
+			vector<XMFLOAT3> TextureCoordinates;
+			vector<XMFLOAT3> Normals;
+		};
+
+		// A contiguous run of triangles from one chunk, destined for one mesh.
+		struct ObjTriangleRun final
+		{
+			size_t ChunkIndex;
+			size_t FirstTriangle;
+			size_t TriangleCount;
+			size_t MeshIndex;
+			size_t DestinationTriangle;
+		};
+
+		struct ObjMeshGroup final
+		{
+			string Name;
+			string MaterialName;
+			size_t TriangleCount{ 0 };
+			vector<ObjCorner> Corners;
+		};
+
+		struct WeldSlot final
+		{
+			ObjCorner Key;
+			uint32_t VertexIndex;
+		};
+
+		inline bool IsSpace(char c)
+		{
+			return c == ' ' || c == '\t' || c == '\r';
+		}
+
+		inline const char* SkipSpaces(const char* current, const char* end)
+		{
+			while (current < end && IsSpace(*current))
+			{
+				++current;
+			}
+
+			return current;
+		}
+
+		inline const char* FindLineEnd(const char* current, const char* end)
+		{
+			auto lineEnd = static_cast<const char*>(memchr(current, '\n', static_cast<size_t>(end - current)));
+			return (lineEnd != nullptr ? lineEnd : end);
+		}
+
+		inline const char* NextLine(const char* lineEnd, const char* end)
+		{
+			return (lineEnd < end ? lineEnd + 1 : end);
+		}
+
+		inline bool IsKeyword(const char* current, const char* end, const char* keyword, size_t keywordLength)
+		{
+			return static_cast<size_t>(end - current) > keywordLength && memcmp(current, keyword, keywordLength) == 0 && IsSpace(current[keywordLength]);
+		}
+
+		string TrimmedString(const char* begin, const char* end)
+		{
+			begin = SkipSpaces(begin, end);
+			while (end > begin && IsSpace(*(end - 1)))
+			{
+				--end;
+			}
+
+			return string(begin, end);
+		}
+
+		size_t ParseFloats(const char* current, const char* end, float* values, size_t maxCount)
+		{
+			size_t count = 0;
+			while (count < maxCount)
+			{
+				current = SkipSpaces(current, end);
+				if (current < end && *current == '+')
+				{
+					++current;
+				}
+
+				auto [next, error] = from_chars(current, end, values[count]);
+				if (error != errc())
+				{
+					break;
+				}
+
+				current = next;
+				++count;
+			}
+
+			return count;
+		}
+
+		// OBJ indices are one-based; negative indices are relative to the attributes read so far.
+		inline const char* ParseIndex(const char* current, const char* end, size_t readCount, size_t totalCount, uint32_t& index)
+		{
+			int64_t value;
+			auto [next, error] = from_chars(current, end, value);
+			if (error != errc() || value == 0)
+			{
+				return nullptr;
+			}
+
+			const int64_t resolvedIndex = (value > 0 ? value - 1 : static_cast<int64_t>(readCount) + value);
+			if (resolvedIndex < 0 || resolvedIndex >= static_cast<int64_t>(totalCount))
+			{
+				return nullptr;
+			}
+
+			index = static_cast<uint32_t>(resolvedIndex);
+			return next;
+		}
+
+		bool ParseFace(const char* current, const char* end, const ObjChunk& chunk, const ObjAttributes& attributes, vector<ObjCorner>& polygon)
+		{
+			const size_t positionsRead = chunk.PositionBase + chunk.PositionCount;
+			const size_t textureCoordinatesRead = chunk.TextureCoordinateBase + chunk.TextureCoordinateCount;
+			const size_t normalsRead = chunk.NormalBase + chunk.NormalCount;
+
+			polygon.clear();
+			for (current = SkipSpaces(current, end); current < end; current = SkipSpaces(current, end))
+			{
+				ObjCorner corner{ MissingIndex, MissingIndex, MissingIndex };
+				current = ParseIndex(current, end, positionsRead, attributes.Positions.size(), corner.Position);
+				if (current == nullptr)
+				{
+					return false;
+				}
+
+				if (current < end && *current == '/')
+				{
+					++current;
+					if (current < end && *current != '/')
+					{
+						current = ParseIndex(current, end, textureCoordinatesRead, attributes.TextureCoordinates.size(), corner.TextureCoordinate);
+						if (current == nullptr)
+						{
+							return false;
+						}
+					}
+
+					if (current < end && *current == '/')
+					{
+						++current;
+						current = ParseIndex(current, end, normalsRead, attributes.Normals.size(), corner.Normal);
+						if (current == nullptr)
+						{
+							return false;
+						}
+					}
+				}
+
+				polygon.push_back(corner);
+			}
+
+			return true;
+		}
+
+		vector<ObjChunk> SplitChunks(span<const char> data)
+		{
+			const size_t dataSize = static_cast<size_t>(data.size());
+			const size_t threadCount = max(thread::hardware_concurrency(), 1U);
+			const size_t chunkSize = max(MinimumChunkSize, dataSize / (threadCount * ChunksPerThread) + 1);
+
+			vector<ObjChunk> chunks;
+			const char* begin = data.data();
+			const char* end = begin + dataSize;
+			while (begin < end)
+			{
+				const char* chunkEnd = (static_cast<size_t>(end - begin) > chunkSize ? NextLine(FindLineEnd(begin + chunkSize, end), end) : end);
+
+				ObjChunk& chunk = chunks.emplace_back();
+				chunk.Begin = begin;
+				chunk.End = chunkEnd;
+				begin = chunkEnd;
+			}
+
+			return chunks;
+		}
+
+		void CountAttributes(ObjChunk& chunk)
+		{
+			for (const char* line = chunk.Begin; line < chunk.End;)
+			{
+				const char* lineEnd = FindLineEnd(line, chunk.End);
+				const char* current = SkipSpaces(line, lineEnd);
+				if (IsKeyword(current, lineEnd, "v", 1))
+				{
+					++chunk.PositionCount;
+				}
+				else if (IsKeyword(current, lineEnd, "vt", 2))
+				{
+					++chunk.TextureCoordinateCount;
+				}
+				else if (IsKeyword(current, lineEnd, "vn", 2))
+				{
+					++chunk.NormalCount;
+				}
+
+				line = NextLine(lineEnd, chunk.End);
+			}
+		}
+
+		// Scanners commonly append an RGB triple to each position; the first position decides for the whole file.
+		bool HasVertexColors(span<const char> data)
+		{
+			const char* end = data.data() + data.size();
+			for (const char* line = data.data(); line < end;)
+			{
+				const char* lineEnd = FindLineEnd(line, end);
+				const char* current = SkipSpaces(line, lineEnd);
+				if (IsKeyword(current, lineEnd, "v", 1))
+				{
+					float values[7];
+					return ParseFloats(current + 1, lineEnd, values, size(values)) >= 6;
+				}
+
+				line = NextLine(lineEnd, end);
+			}
+
+			return false;
+		}
+
+		void ParseChunk(ObjChunk& chunk, ObjAttributes& attributes, bool flipUVs)
+		{
+			// Counts are rebuilt while parsing so that relative indices resolve against the attributes read so far.
+			chunk.PositionCount = 0;
+			chunk.TextureCoordinateCount = 0;
+			chunk.NormalCount = 0;
+
+			const bool hasVertexColors = !attributes.Colors.empty();
+			vector<ObjCorner> polygon;
+			size_t triangleCount = 0;
+
+			for (const char* line = chunk.Begin; line < chunk.End;)
+			{
+				const char* lineEnd = FindLineEnd(line, chunk.End);
+				const char* current = SkipSpaces(line, lineEnd);
+
+				if (IsKeyword(current, lineEnd, "v", 1))
+				{
+					float values[7]{ 0.0f };
+					const size_t valueCount = ParseFloats(current + 1, lineEnd, values, size(values));
+					const size_t positionIndex = chunk.PositionBase + chunk.PositionCount++;
+					attributes.Positions[positionIndex] = XMFLOAT3(values[0], values[1], values[2]);
+					if (hasVertexColors)
+					{
+						attributes.Colors[positionIndex] = (valueCount >= 6 ? XMFLOAT4(values[valueCount - 3], values[valueCount - 2], values[valueCount - 1], 1.0f) : XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f));
+					}
+				}
+				else if (IsKeyword(current, lineEnd, "vt", 2))
+				{
+					float values[3]{ 0.0f };
+					ParseFloats(current + 2, lineEnd, values, size(values));
+					attributes.TextureCoordinates[chunk.TextureCoordinateBase + chunk.TextureCoordinateCount++] = XMFLOAT3(values[0], (flipUVs ? 1.0f - values[1] : values[1]), values[2]);
+				}
+				else if (IsKeyword(current, lineEnd, "vn", 2))
+				{
+					float values[3]{ 0.0f };
+					ParseFloats(current + 2, lineEnd, values, size(values));
+					attributes.Normals[chunk.NormalBase + chunk.NormalCount++] = XMFLOAT3(values);
+				}
+				else if (IsKeyword(current, lineEnd, "f", 1))
+				{
+					if (!ParseFace(current + 1, lineEnd, chunk, attributes, polygon))
+					{
+						chunk.Error = "Invalid face: "s + TrimmedString(current, lineEnd);
+						return;
+					}
+
+					// Triangulate as a fan; points and lines are dropped, as with aiProcess_SortByPType.
+					for (size_t i = 2; i < polygon.size(); ++i)
+					{
+						chunk.Corners.push_back(polygon[0]);
+						chunk.Corners.push_back(polygon[i - 1]);
+						chunk.Corners.push_back(polygon[i]);
+						++triangleCount;
+					}
+				}
+				else if (IsKeyword(current, lineEnd, "usemtl", 6))
+				{
+					chunk.StateChanges.push_back({ ObjStateChange::StateType::Material, triangleCount, TrimmedString(current + 6, lineEnd) });
+				}
+				else if (IsKeyword(current, lineEnd, "o", 1) || IsKeyword(current, lineEnd, "g", 1))
+				{
+					chunk.StateChanges.push_back({ ObjStateChange::StateType::Group, triangleCount, TrimmedString(current + 1, lineEnd) });
+				}
+				else if (IsKeyword(current, lineEnd, "mtllib", 6))
+				{
+					chunk.MaterialLibraries.push_back(TrimmedString(current + 6, lineEnd));
+				}
+
+				line = NextLine(lineEnd, chunk.End);
+			}
+		}
+
+		void LoadMaterialLibrary(const path& filename, vector<ModelMaterialData>& materials)
+		{
+			ifstream file(filename);
+			if (!file.good())
+			{
+				cout << "Warning: could not open material library: "s << filename << endl;
+				return;
+			}
+
+			ModelMaterialData* material = nullptr;
+			string line;
+			while (getline(file, line))
+			{
+				const char* end = line.data() + line.size();
+				const char* keywordBegin = SkipSpaces(line.data(), end);
+				const char* keywordEnd = find_if(keywordBegin, end, IsSpace);
+
+				string keyword(keywordBegin, keywordEnd);
+				transform(keyword.begin(), keyword.end(), keyword.begin(), [](char c) { return static_cast<char>(tolower(static_cast<unsigned char>(c))); });
+
+				string value = TrimmedString(keywordEnd, end);
+				if (keyword == "newmtl")
+				{
+					material = &materials.emplace_back();
+					material->Name = move(value);
+				}
+				else if (material != nullptr && !value.empty())
+				{
+					auto it = TextureKeywords.find(keyword);
+					if (it != TextureKeywords.end())
+					{
+						// Texture options (-bm, -o, ...) precede the filename.
+						const size_t filenamePosition = (value[0] == '-' ? value.find_last_of(" \t") + 1 : 0);
+						material->Textures[it->second].push_back(value.substr(filenamePosition));
+					}
+				}
+			}
+		}
+
+		// Groups triangles by (group, material) in order of first appearance and gathers each group's corners into one array.
+		vector<ObjMeshGroup> BuildMeshGroups(vector<ObjChunk>& chunks)
+		{
+			vector<ObjMeshGroup> meshGroups;
+			vector<ObjTriangleRun> runs;
+			map<pair<string, string>, size_t> meshIndices;
+			string groupName = DefaultGroupName;
+			string materialName;
+
+			auto addRun = [&](size_t chunkIndex, size_t firstTriangle, size_t lastTriangle)
+			{
+				if (lastTriangle == firstTriangle)
+				{
+					return;
+				}
+
+				auto [it, inserted] = meshIndices.try_emplace(make_pair(groupName, materialName), meshGroups.size());
+				if (inserted)
+				{
+					ObjMeshGroup& meshGroup = meshGroups.emplace_back();
+					meshGroup.Name = groupName;
+					meshGroup.MaterialName = materialName;
+				}
+
+				ObjMeshGroup& meshGroup = meshGroups[it->second];
+				runs.push_back({ chunkIndex, firstTriangle, lastTriangle - firstTriangle, it->second, meshGroup.TriangleCount });
+				meshGroup.TriangleCount += lastTriangle - firstTriangle;
+			};
+
+			for (size_t chunkIndex = 0; chunkIndex < chunks.size(); ++chunkIndex)
+			{
+				const ObjChunk& chunk = chunks[chunkIndex];
+				size_t firstTriangle = 0;
+				for (const ObjStateChange& stateChange : chunk.StateChanges)
+				{
+					addRun(chunkIndex, firstTriangle, stateChange.TriangleIndex);
+					firstTriangle = stateChange.TriangleIndex;
+
+					if (stateChange.Type == ObjStateChange::StateType::Group)
+					{
+						groupName = (stateChange.Name.empty() ? DefaultGroupName : stateChange.Name);
+					}
+					else
+					{
+						materialName = stateChange.Name;
+					}
+				}
+
+				addRun(chunkIndex, firstTriangle, chunk.Corners.size() / 3);
+			}
+
+			for (ObjMeshGroup& meshGroup : meshGroups)
+			{
+				meshGroup.Corners.resize(meshGroup.TriangleCount * 3);
+			}
+
+			for_each(execution::par, runs.begin(), runs.end(), [&](const ObjTriangleRun& run)
+			{
+				auto source = chunks[run.ChunkIndex].Corners.begin() + run.FirstTriangle * 3;
+				copy(source, source + run.TriangleCount * 3, meshGroups[run.MeshIndex].Corners.begin() + run.DestinationTriangle * 3);
+			});
+
+			for (ObjChunk& chunk : chunks)
+			{
+				chunk.Corners = vector<ObjCorner>();
+			}
+
+			return meshGroups;
+		}
+
+		inline uint64_t MixBits(uint64_t value)
+		{
+			value ^= value >> 30;
+			value *= 0xBF58476D1CE4E5B9ULL;
+			value ^= value >> 27;
+			value *= 0x94D049BB133111EBULL;
+			value ^= value >> 31;
+			return value;
+		}
+
+		inline uint64_t HashCorner(const ObjCorner& corner)
+		{
+			return MixBits(((static_cast<uint64_t>(corner.Position) << 32) | corner.TextureCoordinate) ^ MixBits(corner.Normal + 0x9E3779B97F4A7C15ULL));
+		}
+
+		size_t RoundUpToPowerOfTwo(size_t value)
+		{
+			size_t result = 1;
+			while (result < value)
+			{
+				result <<= 1;
+			}
+
+			return result;
+		}
+
+		template <typename TFunction>
+		void ParallelForBlocks(size_t count, size_t blockCount, TFunction function)
+		{
+			vector<size_t> blocks(blockCount);
+			iota(blocks.begin(), blocks.end(), size_t(0));
+
+			const size_t blockSize = (count + blockCount - 1) / blockCount;
+			for_each(execution::par, blocks.begin(), blocks.end(), [&](size_t block)
+			{
+				const size_t begin = min(count, block * blockSize);
+				const size_t end = min(count, begin + blockSize);
+				function(block, begin, end);
+			});
+		}
+
+		// Welds identical corners. Corners are partitioned into shards by hash, each shard is welded with its own
+		// open-addressed table, and unique vertices are then numbered by first occurrence so the result is
+		// identical to a serial weld regardless of thread count.
+		void WeldCorners(const vector<ObjCorner>& corners, vector<ObjCorner>& vertices, vector<uint32_t>& cornerVertexIndices)
+		{
+			const size_t cornerCount = corners.size();
+			if (cornerCount >= MissingIndex)
+			{
+				throw exception("Mesh exceeds the maximum number of indices.");
+			}
+
+			const size_t threadCount = max(thread::hardware_concurrency(), 1U);
+			const size_t shardCount = (cornerCount < MinimumParallelWeldSize ? 1 : RoundUpToPowerOfTwo(threadCount * 2));
+			const size_t shardMask = shardCount - 1;
+			auto shardOf = [shardMask](uint64_t hash) { return static_cast<size_t>(hash >> 48) & shardMask; };
+
+			vector<uint64_t> hashes(cornerCount);
+			transform(execution::par, corners.begin(), corners.end(), hashes.begin(), HashCorner);
+
+			// Partition corner indices by shard, preserving corner order within each shard.
+			const size_t blockCount = shardCount;
+			vector<size_t> blockShardCounts(blockCount * shardCount, 0);
+			ParallelForBlocks(cornerCount, blockCount, [&](size_t block, size_t begin, size_t end)
+			{
+				size_t* shardCounts = &blockShardCounts[block * shardCount];
+				for (size_t i = begin; i < end; ++i)
+				{
+					++shardCounts[shardOf(hashes[i])];
+				}
+			});
+
+			vector<size_t> shardOffsets(shardCount + 1);
+			vector<size_t> blockShardOffsets(blockCount * shardCount);
+			size_t offset = 0;
+			for (size_t shard = 0; shard < shardCount; ++shard)
+			{
+				shardOffsets[shard] = offset;
+				for (size_t block = 0; block < blockCount; ++block)
+				{
+					blockShardOffsets[block * shardCount + shard] = offset;
+					offset += blockShardCounts[block * shardCount + shard];
+				}
+			}
+			shardOffsets[shardCount] = offset;
+
+			vector<uint32_t> partitionedCorners(cornerCount);
+			ParallelForBlocks(cornerCount, blockCount, [&](size_t block, size_t begin, size_t end)
+			{
+				size_t* cursors = &blockShardOffsets[block * shardCount];
+				for (size_t i = begin; i < end; ++i)
+				{
+					partitionedCorners[cursors[shardOf(hashes[i])]++] = static_cast<uint32_t>(i);
+				}
+			});
+
+			// Weld each shard; localIndices maps each corner to its unique vertex within the shard.
+			vector<uint32_t> localIndices(cornerCount);
+			vector<vector<uint32_t>> shardFirstCorners(shardCount);
+			ParallelForBlocks(shardCount, shardCount, [&](size_t shard, size_t, size_t)
+			{
+				const size_t begin = shardOffsets[shard];
+				const size_t end = shardOffsets[shard + 1];
+				const size_t tableSize = RoundUpToPowerOfTwo(max<size_t>((end - begin) * 2, 16));
+				const size_t tableMask = tableSize - 1;
+				vector<WeldSlot> table(tableSize, WeldSlot{ { MissingIndex, MissingIndex, MissingIndex }, MissingIndex });
+
+				vector<uint32_t>& firstCorners = shardFirstCorners[shard];
+				for (size_t i = begin; i < end; ++i)
+				{
+					const uint32_t cornerIndex = partitionedCorners[i];
+					const ObjCorner& corner = corners[cornerIndex];
+					for (size_t slotIndex = hashes[cornerIndex] & tableMask;; slotIndex = (slotIndex + 1) & tableMask)
+					{
+						WeldSlot& slot = table[slotIndex];
+						if (slot.VertexIndex == MissingIndex)
+						{
+							slot.Key = corner;
+							slot.VertexIndex = static_cast<uint32_t>(firstCorners.size());
+							firstCorners.push_back(cornerIndex);
+						}
+						else if (!(slot.Key == corner))
+						{
+							continue;
+						}
+
+						localIndices[cornerIndex] = slot.VertexIndex;
+						break;
+					}
+				}
+			});
+
+			// Number unique vertices by their first corner.
+			vector<size_t> shardVertexOffsets(shardCount + 1, 0);
+			for (size_t shard = 0; shard < shardCount; ++shard)
+			{
+				shardVertexOffsets[shard + 1] = shardVertexOffsets[shard] + shardFirstCorners[shard].size();
+			}
+
+			vector<uint32_t> firstCorners;
+			firstCorners.reserve(shardVertexOffsets[shardCount]);
+			for (const auto& shardCorners : shardFirstCorners)
+			{
+				firstCorners.insert(firstCorners.end(), shardCorners.begin(), shardCorners.end());
+			}
+			sort(execution::par, firstCorners.begin(), firstCorners.end());
+
+			const size_t vertexCount = firstCorners.size();
+			vector<uint32_t> shardVertexIndices(vertexCount);
+			vertices.resize(vertexCount);
+			ParallelForBlocks(vertexCount, threadCount, [&](size_t, size_t begin, size_t end)
+			{
+				for (size_t vertexIndex = begin; vertexIndex < end; ++vertexIndex)
+				{
+					const uint32_t cornerIndex = firstCorners[vertexIndex];
+					shardVertexIndices[shardVertexOffsets[shardOf(hashes[cornerIndex])] + localIndices[cornerIndex]] = static_cast<uint32_t>(vertexIndex);
+					vertices[vertexIndex] = corners[cornerIndex];
+				}
+			});
+
+			cornerVertexIndices.resize(cornerCount);
+			ParallelForBlocks(cornerCount, threadCount, [&](size_t, size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; ++i)
+				{
+					cornerVertexIndices[i] = shardVertexIndices[shardVertexOffsets[shardOf(hashes[i])] + localIndices[i]];
+				}
+			});
+		}
+
+		shared_ptr<Mesh> CreateMesh(Model& model, const ObjMeshGroup& meshGroup, const ObjAttributes& attributes, shared_ptr<ModelMaterial> material, const VertexWeldSettings& weldSettings, VertexWeldStatistics& weldStatistics)
+		{
+			vector<ObjCorner> vertices;
+			vector<uint32_t> cornerVertexIndices;
+			WeldCorners(meshGroup.Corners, vertices, cornerVertexIndices);
+
+			MeshData meshData;
+			meshData.Material = move(material);
+			meshData.Name = meshGroup.Name;
+
+			meshData.Vertices.resize(vertices.size());
+			transform(execution::par, vertices.begin(), vertices.end(), meshData.Vertices.begin(), [&](const ObjCorner& vertex)
+			{
+				return attributes.Positions[vertex.Position];
+			});
+
+			// Corners without a normal or texture coordinate in a mesh that has them elsewhere receive zero.
+			if (any_of(execution::par, vertices.begin(), vertices.end(), [](const ObjCorner& vertex) { return vertex.Normal != MissingIndex; }))
+			{
+				meshData.Normals.resize(vertices.size());
+				transform(execution::par, vertices.begin(), vertices.end(), meshData.Normals.begin(), [&](const ObjCorner& vertex)
+				{
+					return (vertex.Normal != MissingIndex ? attributes.Normals[vertex.Normal] : XMFLOAT3(0.0f, 0.0f, 0.0f));
+				});
+			}
+
+			if (any_of(execution::par, vertices.begin(), vertices.end(), [](const ObjCorner& vertex) { return vertex.TextureCoordinate != MissingIndex; }))
+			{
+				vector<XMFLOAT3>& textureCoordinates = meshData.TextureCoordinates.emplace_back(vertices.size());
+				transform(execution::par, vertices.begin(), vertices.end(), textureCoordinates.begin(), [&](const ObjCorner& vertex)
+				{
+					return (vertex.TextureCoordinate != MissingIndex ? attributes.TextureCoordinates[vertex.TextureCoordinate] : XMFLOAT3(0.0f, 0.0f, 0.0f));
+				});
+			}
+
+			if (!attributes.Colors.empty())
+			{
+				vector<XMFLOAT4>& vertexColors = meshData.VertexColors.emplace_back(vertices.size());
+				transform(execution::par, vertices.begin(), vertices.end(), vertexColors.begin(), [&](const ObjCorner& vertex)
+				{
+					return attributes.Colors[vertex.Position];
+				});
+			}
+
+			// Reverse each triangle's winding, as with aiProcess_FlipWindingOrder.
+			const size_t triangleCount = cornerVertexIndices.size() / 3;
+			meshData.FaceCount = narrow<uint32_t>(triangleCount);
+			meshData.Indices.resize(cornerVertexIndices.size());
+			ParallelForBlocks(triangleCount, max(thread::hardware_concurrency(), 1U), [&](size_t, size_t begin, size_t end)
+			{
+				for (size_t triangle = begin; triangle < end; ++triangle)
+				{
+					meshData.Indices[triangle * 3] = cornerVertexIndices[triangle * 3 + 2];
+					meshData.Indices[triangle * 3 + 1] = cornerVertexIndices[triangle * 3 + 1];
+					meshData.Indices[triangle * 3 + 2] = cornerVertexIndices[triangle * 3];
+				}
+			});
+
+			// Corners are the source vertices, as they are for the Assimp path without its exact-match join.
+			if (weldSettings.Enabled)
+			{
+				weldStatistics = MeshProcessor::WeldVertices(meshData, weldSettings);
+				weldStatistics.SourceVertexCount = meshGroup.Corners.size();
+			}
+
+			return make_shared<Mesh>(model, move(meshData));
+		}
+	}
+
+	bool ObjModelProcessor::CanLoad(const string& filename)
+	{
+		string extension = path(filename).extension().string();
+		transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return static_cast<char>(tolower(static_cast<unsigned char>(c))); });
+
+		return extension == ".obj";
+	}
+
+	Model ObjModelProcessor::LoadModel(const string& filename, bool flipUVs, const VertexWeldSettings& weldSettings, VertexWeldStatistics* weldStatistics)
+	{
+		MemoryMappedFile file(filename);
+		span<const char> data = file.Data();
+
+		// Pass 1: count attributes per chunk so every chunk knows where its attributes land in the shared arrays.
+		vector<ObjChunk> chunks = SplitChunks(data);
+		for_each(execution::par, chunks.begin(), chunks.end(), CountAttributes);
+
+		ObjAttributes attributes;
+		size_t positionCount = 0;
+		size_t textureCoordinateCount = 0;
+		size_t normalCount = 0;
+		for (ObjChunk& chunk : chunks)
+		{
+			chunk.PositionBase = positionCount;
+			chunk.TextureCoordinateBase = textureCoordinateCount;
+			chunk.NormalBase = normalCount;
+			positionCount += chunk.PositionCount;
+			textureCoordinateCount += chunk.TextureCoordinateCount;
+			normalCount += chunk.NormalCount;
+		}
+
+		attributes.Positions.resize(positionCount);
+		attributes.TextureCoordinates.resize(textureCoordinateCount);
+		attributes.Normals.resize(normalCount);
+		if (HasVertexColors(data))
+		{
+			attributes.Colors.resize(positionCount);
+		}
+
+		// Pass 2: parse attributes in place and triangulate faces into per-chunk corner lists.
+		for_each(execution::par, chunks.begin(), chunks.end(), [&](ObjChunk& chunk)
+		{
+			ParseChunk(chunk, attributes, flipUVs);
+		});
+
+		auto failedChunk = find_if(chunks.begin(), chunks.end(), [](const ObjChunk& chunk) { return !chunk.Error.empty(); });
+		if (failedChunk != chunks.end())
+		{
+			throw exception(failedChunk->Error.c_str());
+		}
+
+		Model model;
+		ModelData& modelData = model.Data();
+
+		vector<ModelMaterialData> materials;
+		const path directory = path(filename).parent_path();
+		for (const ObjChunk& chunk : chunks)
+		{
+			for (const string& materialLibrary : chunk.MaterialLibraries)
+			{
+				LoadMaterialLibrary(directory / materialLibrary, materials);
+			}
+		}
+
+		map<string, size_t> materialIndices;
+		for (ModelMaterialData& material : materials)
+		{
+			if (materialIndices.try_emplace(material.Name, modelData.Materials.size()).second)
+			{
+				modelData.Materials.push_back(make_shared<ModelMaterial>(model, move(material)));
+			}
+		}
+
+		if (weldStatistics != nullptr)
+		{
+			*weldStatistics = VertexWeldStatistics();
+		}
+
+		vector<ObjMeshGroup> meshGroups = BuildMeshGroups(chunks);
+		for (const ObjMeshGroup& meshGroup : meshGroups)
+		{
+			auto materialIndex = materialIndices.find(meshGroup.MaterialName);
+			if (materialIndex == materialIndices.end())
+			{
+				materialIndex = materialIndices.find(DefaultMaterialName);
+				if (materialIndex == materialIndices.end())
+				{
+					ModelMaterialData defaultMaterial;
+					defaultMaterial.Name = DefaultMaterialName;
+					materialIndex = materialIndices.emplace(DefaultMaterialName, modelData.Materials.size()).first;
+					modelData.Materials.push_back(make_shared<ModelMaterial>(model, move(defaultMaterial)));
+				}
+			}
+
+			VertexWeldStatistics meshWeldStatistics;
+			modelData.Meshes.push_back(CreateMesh(model, meshGroup, attributes, modelData.Materials[materialIndex->second], weldSettings, meshWeldStatistics));
+			if (weldStatistics != nullptr)
+			{
+				*weldStatistics += meshWeldStatistics;
+			}
+		}
+
+		model.UpdateTransforms();
+
+		return model;
+	}
+}
\ No newline at end of file
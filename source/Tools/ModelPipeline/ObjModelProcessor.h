@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Model.h"
+#include "MeshProcessor.h"
+#include <string>
+
+namespace ModelPipeline
+{
+	// Native Wavefront OBJ/MTL importer for large sources. The file is memory mapped and parsed in
+	// line-aligned chunks on all cores; identical position/uv/normal triples are welded in parallel.
+	// Output matches the Assimp path (triangulated, welded, flipped winding, optional flipped UVs)
+	// with one mesh per group and material.
+	class ObjModelProcessor final
+	{
+	public:
+		ObjModelProcessor() = delete;
+
+		static bool CanLoad(const std::string& filename);
+
+		// Unless welding is disabled, the exactly welded meshes are then welded by MeshProcessor::WeldVertices,
+		// whose statistics count each face corner as a source vertex.
+		static Library::Model LoadModel(const std::string& filename, bool flipUVs = false, const VertexWeldSettings& weldSettings = VertexWeldSettings(), VertexWeldStatistics* weldStatistics = nullptr);
+	};
+}
\ No newline at end of file
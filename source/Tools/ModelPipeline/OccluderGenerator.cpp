@@ -0,0 +1,517 @@
+#include "pch.h"
+#include "OccluderGenerator.h"
+#include "Model.h"
+#include "Mesh.h"
+#include <execution>
+#include <numeric>
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+using namespace Library;
+
+namespace ModelPipeline
+{
+	namespace
+	{
+		const uint32_t TrianglesPerBox{ 12 };
+		const float OverlapTolerance{ 1e-3f }; // Of a voxel; voxels this close to a triangle count as touching it.
+
+		// Corners are numbered by their bits: 1 for maximum x, 2 for maximum y, 4 for maximum z.
+		const array<uint32_t, TrianglesPerBox * 3> BoxIndices
+		{
+			0, 4, 6, 0, 6, 2,
+			1, 3, 7, 1, 7, 5,
+			0, 1, 5, 0, 5, 4,
+			2, 6, 7, 2, 7, 3,
+			0, 2, 3, 0, 3, 1,
+			4, 5, 7, 4, 7, 6
+		};
+
+		using Triangle = array<XMFLOAT3, 3>;
+		using VoxelCoordinates = array<uint32_t, 3>;
+
+		// The grid has a border of one voxel around the model's bounds, so its outermost voxels are never interior
+		// and the neighbours of an interior voxel always exist.
+		struct VoxelGrid final
+		{
+			array<float, 3> Origin;
+			float VoxelSize;
+			VoxelCoordinates Size;
+		};
+
+		float Component(const XMFLOAT3& vector, uint32_t axis)
+		{
+			return (&vector.x)[axis];
+		}
+
+		size_t VoxelIndex(const VoxelGrid& grid, const VoxelCoordinates& voxel)
+		{
+			return (static_cast<size_t>(voxel[2]) * grid.Size[1] + voxel[1]) * grid.Size[0] + voxel[0];
+		}
+
+		// Separating axis test of a triangle against a cube (Akenine-Moller, "Fast 3D Triangle-Box Overlap Testing").
+		bool TriangleOverlapsCube(const Triangle& triangle, const array<float, 3>& center, float halfSize)
+		{
+			array<array<float, 3>, 3> vertices;
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				for (uint32_t axis = 0; axis < 3; axis++)
+				{
+					vertices[i][axis] = Component(triangle[i], axis) - center[axis];
+				}
+			}
+
+			for (uint32_t axis = 0; axis < 3; axis++)
+			{
+				if (min({ vertices[0][axis], vertices[1][axis], vertices[2][axis] }) > halfSize || max({ vertices[0][axis], vertices[1][axis], vertices[2][axis] }) < -halfSize)
+				{
+					return false;
+				}
+			}
+
+			array<array<float, 3>, 3> edges;
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				for (uint32_t axis = 0; axis < 3; axis++)
+				{
+					edges[i][axis] = vertices[(i + 1) % 3][axis] - vertices[i][axis];
+				}
+			}
+
+			// Cross products of the box's axes with the triangle's edges.
+			for (const auto& edge : edges)
+			{
+				for (uint32_t axis = 0; axis < 3; axis++)
+				{
+					array<float, 3> separatingAxis{ 0.0f, 0.0f, 0.0f };
+					separatingAxis[(axis + 1) % 3] = -edge[(axis + 2) % 3];
+					separatingAxis[(axis + 2) % 3] = edge[(axis + 1) % 3];
+
+					float minimum = numeric_limits<float>::max();
+					float maximum = numeric_limits<float>::lowest();
+					for (const auto& vertex : vertices)
+					{
+						const float projection = separatingAxis[0] * vertex[0] + separatingAxis[1] * vertex[1] + separatingAxis[2] * vertex[2];
+						minimum = min(minimum, projection);
+						maximum = max(maximum, projection);
+					}
+
+					const float radius = halfSize * (fabs(separatingAxis[0]) + fabs(separatingAxis[1]) + fabs(separatingAxis[2]));
+					if (minimum > radius || maximum < -radius)
+					{
+						return false;
+					}
+				}
+			}
+
+			const array<float, 3> normal
+			{
+				edges[0][1] * edges[1][2] - edges[0][2] * edges[1][1],
+				edges[0][2] * edges[1][0] - edges[0][0] * edges[1][2],
+				edges[0][0] * edges[1][1] - edges[0][1] * edges[1][0]
+			};
+
+			const float distance = normal[0] * vertices[0][0] + normal[1] * vertices[0][1] + normal[2] * vertices[0][2];
+			return fabs(distance) <= halfSize * (fabs(normal[0]) + fabs(normal[1]) + fabs(normal[2]));
+		}
+
+		// Marks the voxels that any triangle touches.
+		vector<uint8_t> MarkSurface(const VoxelGrid& grid, const vector<Triangle>& triangles)
+		{
+			vector<uint8_t> surface(static_cast<size_t>(grid.Size[0]) * grid.Size[1] * grid.Size[2], 0);
+			const float halfSize = grid.VoxelSize * (0.5f + OverlapTolerance);
+			for (const Triangle& triangle : triangles)
+			{
+				VoxelCoordinates first;
+				VoxelCoordinates last;
+				for (uint32_t axis = 0; axis < 3; axis++)
+				{
+					const float minimum = (min({ Component(triangle[0], axis), Component(triangle[1], axis), Component(triangle[2], axis) }) - grid.Origin[axis]) / grid.VoxelSize;
+					const float maximum = (max({ Component(triangle[0], axis), Component(triangle[1], axis), Component(triangle[2], axis) }) - grid.Origin[axis]) / grid.VoxelSize;
+					first[axis] = static_cast<uint32_t>(clamp(floor(minimum - OverlapTolerance), 0.0f, static_cast<float>(grid.Size[axis] - 1)));
+					last[axis] = static_cast<uint32_t>(clamp(floor(maximum + OverlapTolerance), 0.0f, static_cast<float>(grid.Size[axis] - 1)));
+				}
+
+				VoxelCoordinates voxel;
+				for (voxel[2] = first[2]; voxel[2] <= last[2]; voxel[2]++)
+				{
+					for (voxel[1] = first[1]; voxel[1] <= last[1]; voxel[1]++)
+					{
+						for (voxel[0] = first[0]; voxel[0] <= last[0]; voxel[0]++)
+						{
+							uint8_t& marked = surface[VoxelIndex(grid, voxel)];
+							if (marked == 0)
+							{
+								const array<float, 3> center
+								{
+									grid.Origin[0] + (voxel[0] + 0.5f) * grid.VoxelSize,
+									grid.Origin[1] + (voxel[1] + 0.5f) * grid.VoxelSize,
+									grid.Origin[2] + (voxel[2] + 0.5f) * grid.VoxelSize
+								};
+
+								marked = (TriangleOverlapsCube(triangle, center, halfSize) ? 1 : 0);
+							}
+						}
+					}
+				}
+			}
+
+			return surface;
+		}
+
+		// Edge function of a point against the directed edge from one projected vertex to another, evaluated with
+		// the endpoints in a fixed order, so that two triangles sharing the edge get exactly opposite values.
+		double EdgeFunction(const array<double, 2>& from, const array<double, 2>& to, double x, double y)
+		{
+			const bool swapped = (to[0] < from[0] || (to[0] == from[0] && to[1] < from[1]));
+			const array<double, 2>& a = (swapped ? to : from);
+			const array<double, 2>& b = (swapped ? from : to);
+			const double value = (b[0] - a[0]) * (y - a[1]) - (b[1] - a[1]) * (x - a[0]);
+			return (swapped ? -value : value);
+		}
+
+		// Counts, for every voxel, the axes along which a line through its center crosses the surface an odd number of
+		// times before reaching it. Points on an edge shared by two projected triangles are counted for only one of
+		// them (a top-left rule), so that closed meshes give consistent parity.
+		void CountParity(const VoxelGrid& grid, const vector<Triangle>& triangles, uint32_t axis, vector<uint8_t>& votes)
+		{
+			const uint32_t u = (axis + 1) % 3;
+			const uint32_t v = (axis + 2) % 3;
+			const double voxelSize = grid.VoxelSize;
+			vector<vector<float>> columnHits(static_cast<size_t>(grid.Size[u]) * grid.Size[v]);
+
+			for (const Triangle& triangle : triangles)
+			{
+				array<array<double, 2>, 3> projected;
+				for (uint32_t i = 0; i < 3; i++)
+				{
+					projected[i] = { Component(triangle[i], u), Component(triangle[i], v) };
+				}
+
+				const double area = EdgeFunction(projected[0], projected[1], projected[2][0], projected[2][1]);
+				if (area == 0.0)
+				{
+					continue;
+				}
+
+				const double orientation = (area > 0.0 ? 1.0 : -1.0);
+				const double minU = (min({ projected[0][0], projected[1][0], projected[2][0] }) - grid.Origin[u]) / voxelSize - 0.5;
+				const double maxU = (max({ projected[0][0], projected[1][0], projected[2][0] }) - grid.Origin[u]) / voxelSize - 0.5;
+				const double minV = (min({ projected[0][1], projected[1][1], projected[2][1] }) - grid.Origin[v]) / voxelSize - 0.5;
+				const double maxV = (max({ projected[0][1], projected[1][1], projected[2][1] }) - grid.Origin[v]) / voxelSize - 0.5;
+				const int64_t firstI = max(static_cast<int64_t>(ceil(minU)), int64_t(0));
+				const int64_t lastI = min(static_cast<int64_t>(floor(maxU)), static_cast<int64_t>(grid.Size[u]) - 1);
+				const int64_t firstJ = max(static_cast<int64_t>(ceil(minV)), int64_t(0));
+				const int64_t lastJ = min(static_cast<int64_t>(floor(maxV)), static_cast<int64_t>(grid.Size[v]) - 1);
+
+				for (int64_t j = firstJ; j <= lastJ; j++)
+				{
+					const double y = grid.Origin[v] + (j + 0.5) * voxelSize;
+					for (int64_t i = firstI; i <= lastI; i++)
+					{
+						const double x = grid.Origin[u] + (i + 0.5) * voxelSize;
+						array<double, 3> weights;
+						bool inside = true;
+						for (uint32_t edge = 0; edge < 3 && inside; edge++)
+						{
+							const array<double, 2>& from = projected[edge];
+							const array<double, 2>& to = projected[(edge + 1) % 3];
+							weights[edge] = EdgeFunction(from, to, x, y);
+
+							// Ties go to the triangle for which the edge, in counterclockwise order, points up or left.
+							const double oriented = weights[edge] * orientation;
+							const double directionX = (to[0] - from[0]) * orientation;
+							const double directionY = (to[1] - from[1]) * orientation;
+							const bool topLeft = (directionY > 0.0 || (directionY == 0.0 && directionX < 0.0));
+							inside = (oriented > 0.0 || (oriented == 0.0 && topLeft));
+						}
+
+						if (inside)
+						{
+							// The weight of each edge belongs to the vertex opposite it.
+							const double depth = (weights[1] * Component(triangle[0], axis) + weights[2] * Component(triangle[1], axis) + weights[0] * Component(triangle[2], axis)) / area;
+							columnHits[static_cast<size_t>(j) * grid.Size[u] + static_cast<size_t>(i)].push_back(static_cast<float>(depth));
+						}
+					}
+				}
+			}
+
+			vector<uint32_t> columns(columnHits.size());
+			iota(columns.begin(), columns.end(), 0U);
+			for_each(execution::par, columns.begin(), columns.end(), [&](uint32_t column)
+			{
+				vector<float>& hits = columnHits[column];
+				sort(hits.begin(), hits.end());
+
+				VoxelCoordinates voxel;
+				voxel[u] = column % grid.Size[u];
+				voxel[v] = column / grid.Size[u];
+				size_t crossings = 0;
+				for (voxel[axis] = 0; voxel[axis] < grid.Size[axis]; voxel[axis]++)
+				{
+					const float center = grid.Origin[axis] + (voxel[axis] + 0.5f) * grid.VoxelSize;
+					while (crossings < hits.size() && hits[crossings] < center)
+					{
+						++crossings;
+					}
+
+					votes[VoxelIndex(grid, voxel)] += static_cast<uint8_t>(crossings % 2);
+				}
+			});
+		}
+
+		// City block distance, in voxels, from each interior voxel to the nearest voxel that is not interior.
+		vector<uint32_t> InteriorDepth(const VoxelGrid& grid, const vector<uint8_t>& interior)
+		{
+			vector<uint32_t> depth(interior.size());
+			for (size_t i = 0; i < interior.size(); i++)
+			{
+				depth[i] = (interior[i] != 0 ? numeric_limits<uint32_t>::max() - 1 : 0);
+			}
+
+			const size_t strides[3] = { 1, grid.Size[0], static_cast<size_t>(grid.Size[0]) * grid.Size[1] };
+			for (size_t i = 0; i < depth.size(); i++)
+			{
+				if (depth[i] != 0)
+				{
+					depth[i] = min({ depth[i], depth[i - strides[0]] + 1, depth[i - strides[1]] + 1, depth[i - strides[2]] + 1 });
+				}
+			}
+
+			for (size_t i = depth.size(); i-- > 0;)
+			{
+				if (depth[i] != 0)
+				{
+					depth[i] = min({ depth[i], depth[i + strides[0]] + 1, depth[i + strides[1]] + 1, depth[i + strides[2]] + 1 });
+				}
+			}
+
+			return depth;
+		}
+
+		bool IsInterior(const VoxelGrid& grid, const vector<uint8_t>& interior, const VoxelCoordinates& first, const VoxelCoordinates& last)
+		{
+			VoxelCoordinates voxel;
+			for (voxel[2] = first[2]; voxel[2] <= last[2]; voxel[2]++)
+			{
+				for (voxel[1] = first[1]; voxel[1] <= last[1]; voxel[1]++)
+				{
+					for (voxel[0] = first[0]; voxel[0] <= last[0]; voxel[0]++)
+					{
+						if (interior[VoxelIndex(grid, voxel)] == 0)
+						{
+							return false;
+						}
+					}
+				}
+			}
+
+			return true;
+		}
+
+		// Grows a box of interior voxels from a seed, pushing each of its six faces outward in turn until none can move.
+		pair<VoxelCoordinates, VoxelCoordinates> GrowBox(const VoxelGrid& grid, const vector<uint8_t>& interior, const VoxelCoordinates& seed)
+		{
+			VoxelCoordinates first = seed;
+			VoxelCoordinates last = seed;
+			array<bool, 6> blocked{ false, false, false, false, false, false };
+			while (find(blocked.begin(), blocked.end(), false) != blocked.end())
+			{
+				for (uint32_t face = 0; face < 6; face++)
+				{
+					if (blocked[face])
+					{
+						continue;
+					}
+
+					const uint32_t axis = face / 2;
+					VoxelCoordinates layerFirst = first;
+					VoxelCoordinates layerLast = last;
+					const uint32_t layer = (face % 2 == 0 ? first[axis] - 1 : last[axis] + 1);
+					layerFirst[axis] = layer;
+					layerLast[axis] = layer;
+					if (IsInterior(grid, interior, layerFirst, layerLast))
+					{
+						(face % 2 == 0 ? first : last)[axis] = layer;
+					}
+					else
+					{
+						blocked[face] = true;
+					}
+				}
+			}
+
+			return { first, last };
+		}
+	}
+
+	OccluderStatistics OccluderGenerator::Generate(Model& model, const OccluderSettings& settings)
+	{
+		// Gather every mesh instance into one triangle list in model space.
+		vector<Triangle> triangles;
+		for (uint32_t meshIndex = 0; meshIndex < model.Meshes().size(); meshIndex++)
+		{
+			const MeshData& meshData = model.Meshes()[meshIndex]->Data();
+			if (meshData.Indices.size() % 3 != 0)
+			{
+				throw exception("Occluder generation requires triangle lists.");
+			}
+
+			for (const XMFLOAT4X4& instanceTransform : model.MeshInstanceTransforms(meshIndex))
+			{
+				const XMMATRIX worldMatrix = XMLoadFloat4x4(&instanceTransform);
+				for (size_t i = 0; i < meshData.Indices.size(); i += 3)
+				{
+					Triangle triangle;
+					for (uint32_t corner = 0; corner < 3; corner++)
+					{
+						XMStoreFloat3(&triangle[corner], XMVector3TransformCoord(XMLoadFloat3(&meshData.Vertices[meshData.Indices[i + corner]]), worldMatrix));
+					}
+
+					triangles.push_back(triangle);
+				}
+			}
+		}
+
+		ModelOccluder& occluder = model.Data().Occluder;
+		occluder = ModelOccluder();
+
+		OccluderStatistics statistics;
+		statistics.SourceTriangleCount = triangles.size();
+		if (triangles.empty())
+		{
+			return statistics;
+		}
+
+		XMVECTOR minimum = XMLoadFloat3(&triangles[0][0]);
+		XMVECTOR maximum = minimum;
+		double enclosedVolume = 0.0;
+		for (const Triangle& triangle : triangles)
+		{
+			const XMVECTOR p0 = XMLoadFloat3(&triangle[0]);
+			const XMVECTOR p1 = XMLoadFloat3(&triangle[1]);
+			const XMVECTOR p2 = XMLoadFloat3(&triangle[2]);
+			minimum = XMVectorMin(minimum, XMVectorMin(p0, XMVectorMin(p1, p2)));
+			maximum = XMVectorMax(maximum, XMVectorMax(p0, XMVectorMax(p1, p2)));
+			enclosedVolume += XMVectorGetX(XMVector3Dot(p0, XMVector3Cross(p1, p2))) / 6.0;
+		}
+
+		statistics.EnclosedVolume = static_cast<float>(fabs(enclosedVolume));
+
+		XMFLOAT3 boundsMin;
+		XMFLOAT3 boundsSize;
+		XMStoreFloat3(&boundsMin, minimum);
+		XMStoreFloat3(&boundsSize, maximum - minimum);
+		const float longestSide = max({ boundsSize.x, boundsSize.y, boundsSize.z });
+		if (longestSide <= 0.0f)
+		{
+			return statistics;
+		}
+
+		VoxelGrid grid;
+		grid.VoxelSize = longestSide / max(settings.Resolution, 1U);
+		for (uint32_t axis = 0; axis < 3; axis++)
+		{
+			grid.Origin[axis] = Component(boundsMin, axis) - grid.VoxelSize;
+			grid.Size[axis] = static_cast<uint32_t>(ceil(Component(boundsSize, axis) / grid.VoxelSize)) + 2;
+		}
+
+		// Voxels are interior when no triangle touches them and their centers are inside along every axis, which
+		// tolerates small holes and inconsistencies in the mesh.
+		vector<uint8_t> interior = MarkSurface(grid, triangles);
+		vector<uint8_t> votes(interior.size(), 0);
+		for (uint32_t axis = 0; axis < 3; axis++)
+		{
+			CountParity(grid, triangles, axis, votes);
+		}
+
+		vector<size_t> seeds;
+		for (size_t i = 0; i < interior.size(); i++)
+		{
+			interior[i] = (interior[i] == 0 && votes[i] == 3 ? 1 : 0);
+			if (interior[i] != 0)
+			{
+				seeds.push_back(i);
+			}
+		}
+
+		statistics.InteriorVoxelCount = seeds.size();
+		const uint32_t maxBoxCount = settings.TriangleBudget / TrianglesPerBox;
+		if (seeds.empty() || maxBoxCount == 0)
+		{
+			return statistics;
+		}
+
+		// The deepest voxels seed the largest boxes, so they are tried first.
+		const vector<uint32_t> depth = InteriorDepth(grid, interior);
+		stable_sort(seeds.begin(), seeds.end(), [&](size_t lhs, size_t rhs)
+		{
+			return depth[lhs] > depth[rhs];
+		});
+
+		const double voxelVolume = static_cast<double>(grid.VoxelSize) * grid.VoxelSize * grid.VoxelSize;
+		const double coverageVolume = (statistics.EnclosedVolume > 0.0f ? statistics.EnclosedVolume : seeds.size() * voxelVolume);
+		vector<uint8_t> covered(interior.size(), 0);
+		size_t coveredCount = 0;
+		for (size_t seed : seeds)
+		{
+			if (covered[seed] != 0)
+			{
+				continue;
+			}
+
+			const VoxelCoordinates seedVoxel
+			{
+				static_cast<uint32_t>(seed % grid.Size[0]),
+				static_cast<uint32_t>(seed / grid.Size[0] % grid.Size[1]),
+				static_cast<uint32_t>(seed / (static_cast<size_t>(grid.Size[0]) * grid.Size[1]))
+			};
+
+			const auto [first, last] = GrowBox(grid, interior, seedVoxel);
+			VoxelCoordinates voxel;
+			for (voxel[2] = first[2]; voxel[2] <= last[2]; voxel[2]++)
+			{
+				for (voxel[1] = first[1]; voxel[1] <= last[1]; voxel[1]++)
+				{
+					for (voxel[0] = first[0]; voxel[0] <= last[0]; voxel[0]++)
+					{
+						uint8_t& voxelCovered = covered[VoxelIndex(grid, voxel)];
+						coveredCount += (voxelCovered == 0 ? 1 : 0);
+						voxelCovered = 1;
+					}
+				}
+			}
+
+			const uint32_t firstVertex = narrow_cast<uint32_t>(occluder.Vertices.size());
+			for (uint32_t corner = 0; corner < 8; corner++)
+			{
+				XMFLOAT3 vertex;
+				float* components = &vertex.x;
+				for (uint32_t axis = 0; axis < 3; axis++)
+				{
+					const uint32_t boundary = ((corner >> axis) & 1U) != 0 ? last[axis] + 1 : first[axis];
+					components[axis] = grid.Origin[axis] + boundary * grid.VoxelSize;
+				}
+
+				occluder.Vertices.push_back(vertex);
+			}
+
+			for (uint32_t index : BoxIndices)
+			{
+				occluder.Indices.push_back(firstVertex + index);
+			}
+
+			statistics.Coverage.push_back(static_cast<float>(coveredCount * voxelVolume / coverageVolume));
+			if (++statistics.BoxCount == maxBoxCount)
+			{
+				break;
+			}
+		}
+
+		statistics.TriangleCount = statistics.BoxCount * TrianglesPerBox;
+		statistics.OccluderVolume = static_cast<float>(coveredCount * voxelVolume);
+
+		return statistics;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace Library
+{
+	class Model;
+}
+
+namespace ModelPipeline
+{
+	struct OccluderSettings final
+	{
+		std::uint32_t TriangleBudget{ 120 }; // Each box takes twelve triangles; budgets below twelve generate no occluder.
+		std::uint32_t Resolution{ 64 }; // Voxels along the longest side of the model's bounding box.
+	};
+
+	struct OccluderStatistics final
+	{
+		std::size_t SourceTriangleCount{ 0 };
+		std::size_t InteriorVoxelCount{ 0 };
+		std::uint32_t BoxCount{ 0 };
+		std::uint32_t TriangleCount{ 0 };
+		float EnclosedVolume{ 0.0f }; // Of the source triangles, in model units; only meaningful for closed meshes.
+		float OccluderVolume{ 0.0f };
+		std::vector<float> Coverage; // Fraction of the enclosed volume covered by the first 1, 2, ... boxes.
+	};
+
+	// Generates a conservative occluder for a model: a few boxes that lie strictly inside its surface, so that
+	// occlusion culling with them never hides what the full model would not. The model is voxelized; a voxel is
+	// interior if no triangle touches it and its center is inside the surface by ray parity along all three axes.
+	// Boxes are then grown greedily from the deepest uncovered interior voxels until the triangle budget is
+	// spent. Models that do not enclose a volume (open or very thin meshes) get no occluder.
+	class OccluderGenerator final
+	{
+	public:
+		OccluderGenerator() = delete;
+
+		// Replaces the model's occluder, in model space.
+		static OccluderStatistics Generate(Library::Model& model, const OccluderSettings& settings = OccluderSettings());
+	};
+}
\ No newline at end of file
@@ -1,12 +1,58 @@
 #include "pch.h"
 #include "ModelProcessor.h"
+#include "ObjModelProcessor.h"
+#include "GltfModelProcessor.h"
+#include "SharedModelWriter.h"
+#include "LightmapUVGenerator.h"
+#include "AmbientOcclusionBaker.h"
+#include "TangentGenerator.h"
+#include "OccluderGenerator.h"
+#include "Mesh.h"
+#include <chrono>
 
 using namespace std;
 using namespace std::filesystem;
 using namespace std::string_literals;
+using namespace std::chrono;
 using namespace ModelPipeline;
 using namespace Library;
 
+namespace
+{
+	// Deduplicates the meshes and materials of every model in a content directory into a shared model.
+	void DeduplicateModels(const path& contentDirectory, const string& sharedAssetName)
+	{
+		auto startTime = high_resolution_clock::now();
+		SharedModelWriter writer(sharedAssetName);
+
+		cout << "Reading: "s << contentDirectory.string() << endl;
+		writer.AddDirectory(contentDirectory);
+
+		cout << "Writing: "s << sharedAssetName << endl;
+		SharedModelStatistics statistics = writer.Save(contentDirectory);
+
+		const int64_t bytesSaved = static_cast<int64_t>(statistics.InputBytes) - static_cast<int64_t>(statistics.OutputBytes);
+		cout << statistics.ModelCount << " models, "s << statistics.MeshCount << " meshes ("s << statistics.UniqueMeshCount << " unique), "s << statistics.MaterialCount << " materials ("s << statistics.UniqueMaterialCount << " unique)"s << endl;
+		cout << statistics.InputBytes << " bytes in, "s << statistics.OutputBytes << " bytes out, "s << bytesSaved << " bytes saved"s << endl;
+		cout << "Finished in "s << duration_cast<milliseconds>(high_resolution_clock::now() - startTime).count() << " ms"s << endl;
+	}
+
+	// Times tangent generation with TangentGenerator and with Assimp's CalcTangentSpace step on the same imported meshes.
+	void BenchmarkTangents(const path& inputFile, uint32_t iterationCount)
+	{
+		const string inputFilename = inputFile.filename().string();
+		cout << "Reading: "s << inputFilename << endl;
+		const TangentBenchmark benchmark = ModelProcessor::BenchmarkTangentSpace(inputFilename, iterationCount, true);
+
+		const TangentStatistics& statistics = benchmark.Statistics;
+		const double generatorMilliseconds = benchmark.GeneratorTime.count() / 1000000.0 / iterationCount;
+		const double assimpMilliseconds = benchmark.AssimpTime.count() / 1000000.0 / iterationCount;
+		cout << statistics.MeshCount << " meshes, "s << statistics.SourceVertexCount << " -> "s << statistics.VertexCount << " vertices, "s << statistics.DegenerateTriangleCount << " degenerate triangles"s << endl;
+		cout << fixed << setprecision(3) << "TangentGenerator: "s << generatorMilliseconds << " ms"s << endl;
+		cout << "Assimp CalcTangentSpace: "s << assimpMilliseconds << " ms ("s << setprecision(1) << assimpMilliseconds / max(generatorMilliseconds, 0.001) << "x)"s << endl;
+	}
+}
+
 int main(int argc, char* argv[])
 {
 #if defined(DEBUG) | defined(_DEBUG)
@@ -15,16 +61,141 @@ int main(int argc, char* argv[])
 
 	try
 	{
+		winrt::init_apartment();
+
 		if (argc < 2)
 		{
-			throw exception("Usage: ModelPipeline.exe inputfilename");
+			throw exception("Usage: ModelPipeline.exe inputfilename [-assimp] [-noweld] [-weldtolerance distance] [-lightmapuvs] [-lightmapdensity texelsperunit] [-ao] [-aosamples count] [-aodistance distance] [-aochannel index] [-tangents] [-notangents] [-occluder] [-occluderbudget triangles] [-occluderresolution voxels]\n       ModelPipeline.exe -dedupe contentdirectory [sharedassetname]\n       ModelPipeline.exe -benchmarktangents inputfilename [iterations]");
+		}
+
+		if (argv[1] == "-dedupe"s)
+		{
+			if (argc < 3)
+			{
+				throw exception("Usage: ModelPipeline.exe -dedupe contentdirectory [sharedassetname]");
+			}
+
+			DeduplicateModels(absolute(path(argv[2])), (argc > 3 ? string(argv[3]) : SharedModelWriter::DefaultAssetName));
+			return 0;
+		}
+
+		if (argv[1] == "-benchmarktangents"s)
+		{
+			if (argc < 3)
+			{
+				throw exception("Usage: ModelPipeline.exe -benchmarktangents inputfilename [iterations]");
+			}
+
+			const path benchmarkFile(argv[2]);
+			current_path(benchmarkFile.parent_path().c_str());
+			BenchmarkTangents(benchmarkFile, (argc > 3 ? max(static_cast<uint32_t>(stoul(argv[3])), 1U) : 10U));
+			return 0;
 		}
 
 		path inputFile(argv[1]);
 		current_path(inputFile.parent_path().c_str());
 
-		cout << "Reading: "s << inputFile.filename() << endl;
-		Model model = ModelProcessor::LoadModel(inputFile.filename().string(), true);
+		// OBJ and glTF sources use the native importers unless -assimp is given.
+		const string inputFilename = inputFile.filename().string();
+		bool forceAssimp = false;
+		VertexWeldSettings weldSettings;
+		bool generateLightmapUVs = false;
+		LightmapUVSettings lightmapUVSettings;
+		bool generateTangents = true;
+		bool replaceTangents = false;
+		bool bakeAmbientOcclusion = false;
+		AmbientOcclusionSettings ambientOcclusionSettings;
+		bool generateOccluder = false;
+		OccluderSettings occluderSettings;
+		for (int i = 2; i < argc; i++)
+		{
+			const string option(argv[i]);
+			if (option == "-assimp"s)
+			{
+				forceAssimp = true;
+			}
+			else if (option == "-noweld"s)
+			{
+				weldSettings.Enabled = false;
+			}
+			else if (option == "-weldtolerance"s && i + 1 < argc)
+			{
+				weldSettings.PositionTolerance = stof(argv[++i]);
+			}
+			else if (option == "-lightmapuvs"s)
+			{
+				generateLightmapUVs = true;
+			}
+			else if (option == "-lightmapdensity"s && i + 1 < argc)
+			{
+				generateLightmapUVs = true;
+				lightmapUVSettings.TexelsPerUnit = stof(argv[++i]);
+			}
+			else if (option == "-tangents"s)
+			{
+				replaceTangents = true;
+			}
+			else if (option == "-notangents"s)
+			{
+				generateTangents = false;
+			}
+			else if (option == "-ao"s)
+			{
+				bakeAmbientOcclusion = true;
+			}
+			else if (option == "-aosamples"s && i + 1 < argc)
+			{
+				bakeAmbientOcclusion = true;
+				ambientOcclusionSettings.SampleCount = static_cast<uint32_t>(stoul(argv[++i]));
+			}
+			else if (option == "-aodistance"s && i + 1 < argc)
+			{
+				bakeAmbientOcclusion = true;
+				ambientOcclusionSettings.MaxDistance = stof(argv[++i]);
+			}
+			else if (option == "-aochannel"s && i + 1 < argc)
+			{
+				bakeAmbientOcclusion = true;
+				ambientOcclusionSettings.Channel = static_cast<uint32_t>(stoul(argv[++i]));
+			}
+			else if (option == "-occluder"s)
+			{
+				generateOccluder = true;
+			}
+			else if (option == "-occluderbudget"s && i + 1 < argc)
+			{
+				generateOccluder = true;
+				occluderSettings.TriangleBudget = static_cast<uint32_t>(stoul(argv[++i]));
+			}
+			else if (option == "-occluderresolution"s && i + 1 < argc)
+			{
+				generateOccluder = true;
+				occluderSettings.Resolution = static_cast<uint32_t>(stoul(argv[++i]));
+			}
+			else
+			{
+				throw exception(("Unknown option: "s + option).c_str());
+			}
+		}
+
+		const bool useObjImporter = (!forceAssimp && ObjModelProcessor::CanLoad(inputFilename));
+		const bool useGltfImporter = (!forceAssimp && GltfModelProcessor::CanLoad(inputFilename));
+
+		cout << "Reading: "s << inputFile.filename() << (useObjImporter ? " (native OBJ importer)"s : useGltfImporter ? " (native glTF importer)"s : " (Assimp)"s) << endl;
+		auto startTime = high_resolution_clock::now();
+		VertexWeldStatistics weldStatistics;
+		Model model = (useObjImporter ? ObjModelProcessor::LoadModel(inputFilename, true, weldSettings, &weldStatistics) : useGltfImporter ? GltfModelProcessor::LoadModel(inputFilename, true, weldSettings, &weldStatistics) : ModelProcessor::LoadModel(inputFilename, true, weldSettings, &weldStatistics));
+		auto elapsedTime = duration_cast<milliseconds>(high_resolution_clock::now() - startTime);
+
+		// Throughput is measured against the source file only; external glTF buffers are not included.
+		const double megabytes = static_cast<double>(file_size(inputFile.filename())) / (1024.0 * 1024.0);
+		cout << "Import time: "s << elapsedTime.count() << " ms ("s << fixed << setprecision(1) << megabytes / max(elapsedTime.count() / 1000.0, 0.001) << " MB/s)"s << endl;
+
+		if (weldStatistics.SourceVertexCount > 0)
+		{
+			const double reduction = 100.0 * (weldStatistics.SourceVertexCount - weldStatistics.WeldedVertexCount) / weldStatistics.SourceVertexCount;
+			cout << "Welded vertices: "s << weldStatistics.SourceVertexCount << " -> "s << weldStatistics.WeldedVertexCount << " ("s << reduction << "% reduction, "s << weldStatistics.RemovedFaceCount << " degenerate faces removed)"s << endl;
+		}
 
 		string outputFilename = inputFile.stem().string() + ".model"s;
 		if (!model.HasMeshes())
@@ -32,8 +203,87 @@ int main(int argc, char* argv[])
 			throw exception("Model has no meshes.");
 		}
 		
+		// Meshes imported without tangents get generated ones; -tangents replaces imported tangents too.
+		if (generateTangents)
+		{
+			startTime = high_resolution_clock::now();
+			const TangentStatistics statistics = TangentGenerator::Generate(model, replaceTangents);
+			elapsedTime = duration_cast<milliseconds>(high_resolution_clock::now() - startTime);
+			if (statistics.MeshCount > 0)
+			{
+				cout << "Tangents: "s << statistics.MeshCount << " meshes, "s << statistics.SourceVertexCount << " -> "s << statistics.VertexCount << " vertices ("s << elapsedTime.count() << " ms)"s << endl;
+			}
+
+			if (statistics.SkippedMeshCount > 0)
+			{
+				cout << "Warning: "s << statistics.SkippedMeshCount << " meshes have no normals or texture coordinates and were given no tangents."s << endl;
+			}
+		}
+
+		if (generateLightmapUVs)
+		{
+			startTime = high_resolution_clock::now();
+			const LightmapUVStatistics statistics = LightmapUVGenerator::Generate(model, lightmapUVSettings);
+			elapsedTime = duration_cast<milliseconds>(high_resolution_clock::now() - startTime);
+
+			cout << "Lightmap UVs: "s << statistics.ChartCount << " charts, "s << statistics.AtlasWidth << "x"s << statistics.AtlasHeight << " atlas at "s << statistics.TexelsPerUnit << " texels/unit, "s
+				<< 100.0f * statistics.Utilization << "% utilization, "s << statistics.SourceVertexCount << " -> "s << statistics.VertexCount << " vertices ("s << elapsedTime.count() << " ms)"s << endl;
+		}
+
+		// Baked after the lightmap UVs, which split vertices along chart boundaries.
+		if (bakeAmbientOcclusion)
+		{
+			startTime = high_resolution_clock::now();
+			const AmbientOcclusionStatistics statistics = AmbientOcclusionBaker::Bake(model, ambientOcclusionSettings);
+			elapsedTime = duration_cast<milliseconds>(high_resolution_clock::now() - startTime);
+
+			const double raysPerSecond = statistics.RayCount / max(elapsedTime.count() / 1000.0, 0.001);
+			cout << "Ambient occlusion: "s << statistics.VertexCount << " vertices, "s << statistics.TriangleCount << " triangles, "s << 100.0f * statistics.AverageOcclusion << "% average occlusion in vertex color channel "s
+				<< ambientOcclusionSettings.Channel << " ("s << elapsedTime.count() << " ms, "s << raysPerSecond / 1000000.0 << " Mrays/s)"s << endl;
+		}
+
+		if (generateOccluder)
+		{
+			startTime = high_resolution_clock::now();
+			const OccluderStatistics statistics = OccluderGenerator::Generate(model, occluderSettings);
+			elapsedTime = duration_cast<milliseconds>(high_resolution_clock::now() - startTime);
+
+			if (statistics.BoxCount == 0)
+			{
+				cout << "Warning: no occluder was generated; the model encloses no volume at this resolution, or the triangle budget is below one box."s << endl;
+			}
+			else
+			{
+				cout << "Occluder: "s << statistics.BoxCount << " boxes, "s << statistics.TriangleCount << " triangles (from "s << statistics.SourceTriangleCount << "), "s << statistics.InteriorVoxelCount << " interior voxels, "s
+					<< 100.0f * statistics.Coverage.back() << "% of the enclosed volume ("s << elapsedTime.count() << " ms)"s << endl;
+
+				// Coverage against triangle count, at doubling box counts and for the whole occluder.
+				const size_t boxCount = statistics.Coverage.size();
+				const uint32_t trianglesPerBox = statistics.TriangleCount / statistics.BoxCount;
+				cout << "Occluder coverage:"s;
+				for (size_t boxes = 1; boxes < boxCount; boxes *= 2)
+				{
+					cout << " "s << boxes * trianglesPerBox << " triangles "s << 100.0f * statistics.Coverage[boxes - 1] << "%,"s;
+				}
+
+				cout << " "s << statistics.TriangleCount << " triangles "s << 100.0f * statistics.Coverage.back() << "%"s << endl;
+			}
+		}
+
+		if (!model.Nodes().empty())
+		{
+			size_t meshInstanceCount = 0;
+			for (const auto& node : model.Nodes())
+			{
+				meshInstanceCount += node.MeshIndices.size();
+			}
+
+			cout << "Nodes: "s << model.Nodes().size() << " ("s << model.Meshes().size() << " meshes, "s << meshInstanceCount << " mesh instances)"s << endl;
+		}
+
 		cout << "Writing: "s << outputFilename << endl;
 		model.Save(outputFilename);
+
 		cout << "Finished."s << endl;
 	}
 	catch (exception ex)
@@ -0,0 +1,253 @@
+#include "pch.h"
+#include "SharedModelWriter.h"
+#include "Mesh.h"
+#include "ModelMaterial.h"
+#include "ShaderPack.h"
+#include "StreamHelper.h"
+
+using namespace std;
+using namespace std::filesystem;
+using namespace std::string_literals;
+using namespace gsl;
+using namespace Library;
+
+namespace ModelPipeline
+{
+	namespace
+	{
+		// Content keys leave out names, so that identical meshes and materials imported under different names are
+		// stored once. Attribute arrays are copied bitwise, each preceded by its size.
+		template <typename T>
+		void AppendArray(string& blob, const vector<T>& values)
+		{
+			const uint32_t size = narrow<uint32_t>(values.size());
+			blob.append(reinterpret_cast<const char*>(&size), sizeof(size));
+			blob.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+		}
+
+		template <typename T>
+		void AppendArrays(string& blob, const vector<vector<T>>& arrays)
+		{
+			const uint32_t size = narrow<uint32_t>(arrays.size());
+			blob.append(reinterpret_cast<const char*>(&size), sizeof(size));
+			for (const auto& values : arrays)
+			{
+				AppendArray(blob, values);
+			}
+		}
+
+		string MaterialContent(const ModelMaterial& material)
+		{
+			ostringstream blobStream(ios::binary);
+			OutputStreamHelper blobStreamHelper(blobStream);
+			blobStreamHelper << narrow_cast<uint32_t>(material.Textures().size());
+			for (const auto& texturePair : material.Textures())
+			{
+				blobStreamHelper << narrow_cast<int32_t>(texturePair.first);
+				blobStreamHelper << narrow_cast<uint32_t>(texturePair.second.size());
+				for (const auto& texture : texturePair.second)
+				{
+					blobStreamHelper << texture;
+				}
+			}
+
+			return blobStream.str();
+		}
+
+		// Meshes are only identical if their (deduplicated) materials are too.
+		string MeshContent(const Mesh& mesh, uint32_t materialIndex)
+		{
+			string blob(reinterpret_cast<const char*>(&materialIndex), sizeof(materialIndex));
+			AppendArray(blob, mesh.Vertices());
+			AppendArray(blob, mesh.Normals());
+			AppendArray(blob, mesh.Tangents());
+			AppendArray(blob, mesh.BiNormals());
+			AppendArrays(blob, mesh.TextureCoordinates());
+			AppendArrays(blob, mesh.VertexColors());
+			const uint32_t faceCount = mesh.FaceCount();
+			blob.append(reinterpret_cast<const char*>(&faceCount), sizeof(faceCount));
+			AppendArray(blob, mesh.Indices());
+
+			return blob;
+		}
+	}
+
+	SharedModelWriter::SharedModelWriter(const string& sharedAssetName) :
+		mSharedAssetName(sharedAssetName), mSharedModel(make_shared<Model>())
+	{
+	}
+
+	void SharedModelWriter::Add(const path& filename, const Model& model)
+	{
+		ModelEntry entry;
+		entry.Filename = filename;
+		entry.Nodes = model.Nodes();
+		entry.Occluder = model.Occluder();
+		entry.Lightmap = model.Lightmap();
+		entry.SharedModel.AssetName = mSharedAssetName;
+
+		const auto& materials = model.Materials();
+		for (const auto& material : materials)
+		{
+			entry.SharedModel.MaterialIndices.push_back(FindOrAddMaterial(*material));
+		}
+
+		for (const auto& mesh : model.Meshes())
+		{
+			auto it = find(materials.begin(), materials.end(), mesh->GetMaterial());
+			const uint32_t materialIndex = (it != materials.end() ? entry.SharedModel.MaterialIndices[distance(materials.begin(), it)] : NoMaterial);
+			entry.SharedModel.MeshIndices.push_back(FindOrAddMesh(*mesh, materialIndex));
+		}
+
+		mMaterialCount += narrow<uint32_t>(materials.size());
+		mMeshCount += narrow<uint32_t>(model.Meshes().size());
+		error_code error;
+		const uintmax_t fileSize = file_size(filename, error);
+		mInputBytes += (error ? 0 : fileSize);
+		mModels.push_back(move(entry));
+	}
+
+	void SharedModelWriter::AddDirectory(const path& contentDirectory)
+	{
+		// Models from a previous build reference its shared model; it is loaded once, and replaced by Save.
+		const path sharedModelFile = contentDirectory / mSharedAssetName;
+		map<string, shared_ptr<Model>> sharedModels;
+		const Model::SharedModelResolver sharedModelResolver = [&](const string& assetName)
+		{
+			auto& sharedModel = sharedModels[assetName];
+			if (sharedModel == nullptr)
+			{
+				sharedModel = make_shared<Model>((contentDirectory / assetName).string());
+			}
+
+			return sharedModel;
+		};
+
+		error_code error;
+		const uintmax_t sharedModelSize = file_size(sharedModelFile, error);
+		mInputBytes += (error ? 0 : sharedModelSize);
+
+		for (const auto& directoryEntry : recursive_directory_iterator(contentDirectory))
+		{
+			if (directoryEntry.is_regular_file() && directoryEntry.path().extension() == L".model" && !equivalent(directoryEntry.path(), sharedModelFile, error))
+			{
+				Model model(directoryEntry.path().string(), sharedModelResolver);
+				Add(directoryEntry.path(), model);
+			}
+		}
+	}
+
+	SharedModelStatistics SharedModelWriter::Save(const path& contentDirectory) const
+	{
+		const path sharedModelFile = contentDirectory / mSharedAssetName;
+		create_directories(sharedModelFile.parent_path());
+		mSharedModel->Save(sharedModelFile.string());
+
+		SharedModelStatistics statistics;
+		statistics.OutputBytes = file_size(sharedModelFile);
+
+		const ModelData& sharedData = mSharedModel->Data();
+		for (const auto& entry : mModels)
+		{
+			ModelData modelData;
+			modelData.Nodes = entry.Nodes;
+			modelData.SharedModel = entry.SharedModel;
+			modelData.Occluder = entry.Occluder;
+			modelData.Lightmap = entry.Lightmap;
+			for (uint32_t materialIndex : entry.SharedModel.MaterialIndices)
+			{
+				modelData.Materials.push_back(sharedData.Materials[materialIndex]);
+			}
+
+			for (uint32_t meshIndex : entry.SharedModel.MeshIndices)
+			{
+				modelData.Meshes.push_back(sharedData.Meshes[meshIndex]);
+			}
+
+			Model model(move(modelData));
+			model.Save(entry.Filename.string());
+			statistics.OutputBytes += file_size(entry.Filename);
+		}
+
+		statistics.ModelCount = narrow<uint32_t>(mModels.size());
+		statistics.MeshCount = mMeshCount;
+		statistics.UniqueMeshCount = narrow<uint32_t>(sharedData.Meshes.size());
+		statistics.MaterialCount = mMaterialCount;
+		statistics.UniqueMaterialCount = narrow<uint32_t>(sharedData.Materials.size());
+		statistics.InputBytes = mInputBytes;
+
+		return statistics;
+	}
+
+	uint32_t SharedModelWriter::FindOrAddMaterial(const ModelMaterial& material)
+	{
+		string blob = MaterialContent(material);
+
+		const uint64_t contentHash = ShaderPack::HashContent(blob);
+		auto range = mMaterialIndicesByHash.equal_range(contentHash);
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			if (mMaterialBlobs[it->second] == blob)
+			{
+				return it->second;
+			}
+		}
+
+		// Identical materials keep the first name they were added under. Meshes bind to materials by name, so
+		// distinct materials that share a name are renamed in the shared model.
+		string name = material.Name();
+		for (uint32_t suffix = 1; mMaterialNames.find(name) != mMaterialNames.end(); suffix++)
+		{
+			name = material.Name() + "#"s + to_string(suffix);
+		}
+
+		mMaterialNames.insert(name);
+
+		ModelMaterialData materialData;
+		materialData.Name = move(name);
+		materialData.Textures = material.Textures();
+
+		ModelData& sharedData = mSharedModel->Data();
+		const uint32_t materialIndex = narrow<uint32_t>(sharedData.Materials.size());
+		sharedData.Materials.push_back(make_shared<ModelMaterial>(*mSharedModel, move(materialData)));
+		mMaterialBlobs.push_back(move(blob));
+		mMaterialIndicesByHash.emplace(contentHash, materialIndex);
+
+		return materialIndex;
+	}
+
+	uint32_t SharedModelWriter::FindOrAddMesh(const Mesh& mesh, uint32_t materialIndex)
+	{
+		string blob = MeshContent(mesh, materialIndex);
+
+		const uint64_t contentHash = ShaderPack::HashContent(blob);
+		auto range = mMeshIndicesByHash.equal_range(contentHash);
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			if (mMeshBlobs[it->second] == blob)
+			{
+				return it->second;
+			}
+		}
+
+		ModelData& sharedData = mSharedModel->Data();
+		MeshData meshData;
+		meshData.Material = (materialIndex != NoMaterial ? sharedData.Materials[materialIndex] : nullptr);
+		meshData.Name = mesh.Name();
+		meshData.Vertices = mesh.Vertices();
+		meshData.Normals = mesh.Normals();
+		meshData.Tangents = mesh.Tangents();
+		meshData.BiNormals = mesh.BiNormals();
+		meshData.TextureCoordinates = mesh.TextureCoordinates();
+		meshData.VertexColors = mesh.VertexColors();
+		meshData.FaceCount = mesh.FaceCount();
+		meshData.Indices = mesh.Indices();
+
+		const uint32_t meshIndex = narrow<uint32_t>(sharedData.Meshes.size());
+		sharedData.Meshes.push_back(make_shared<Mesh>(*mSharedModel, move(meshData)));
+		mMeshBlobs.push_back(move(blob));
+		mMeshIndicesByHash.emplace(contentHash, meshIndex);
+
+		return meshIndex;
+	}
+}
\ No newline at end of file
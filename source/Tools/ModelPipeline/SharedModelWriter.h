@@ -0,0 +1,74 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <filesystem>
+#include "Model.h"
+
+namespace Library
+{
+	class Mesh;
+	class ModelMaterial;
+}
+
+namespace ModelPipeline
+{
+	struct SharedModelStatistics final
+	{
+		std::uint32_t ModelCount{ 0 };
+		std::uint32_t MeshCount{ 0 };
+		std::uint32_t UniqueMeshCount{ 0 };
+		std::uint32_t MaterialCount{ 0 };
+		std::uint32_t UniqueMaterialCount{ 0 };
+		std::uint64_t InputBytes{ 0 };
+		std::uint64_t OutputBytes{ 0 };
+	};
+
+	// Deduplicates meshes and materials across the models of a content build, comparing their content but not their
+	// names. Each unique mesh and material is stored once in a shared model, and the added models are rewritten
+	// to reference it.
+	class SharedModelWriter final
+	{
+	public:
+		explicit SharedModelWriter(const std::string& sharedAssetName = DefaultAssetName);
+
+		// The file is overwritten by Save; its current size counts towards the input bytes.
+		void Add(const std::filesystem::path& filename, const Library::Model& model);
+
+		// Adds every model in the directory, except a shared model left by a previous build (which is replaced).
+		void AddDirectory(const std::filesystem::path& contentDirectory);
+
+		SharedModelStatistics Save(const std::filesystem::path& contentDirectory) const;
+
+		inline static const std::string DefaultAssetName{ "Models\\Shared.model" };
+
+	private:
+		struct ModelEntry final
+		{
+			std::filesystem::path Filename;
+			std::vector<Library::ModelNode> Nodes;
+			Library::ModelOccluder Occluder; // Per model, since it is in the model's space
+			Library::ModelLightmap Lightmap;
+			Library::SharedModelReference SharedModel;
+		};
+
+		std::uint32_t FindOrAddMaterial(const Library::ModelMaterial& material);
+		std::uint32_t FindOrAddMesh(const Library::Mesh& mesh, std::uint32_t materialIndex);
+
+		inline static const std::uint32_t NoMaterial{ UINT32_MAX };
+
+		std::string mSharedAssetName;
+		std::shared_ptr<Library::Model> mSharedModel;
+		std::vector<ModelEntry> mModels;
+		std::vector<std::string> mMaterialBlobs;
+		std::unordered_multimap<std::uint64_t, std::uint32_t> mMaterialIndicesByHash;
+		std::unordered_set<std::string> mMaterialNames;
+		std::vector<std::string> mMeshBlobs;
+		std::unordered_multimap<std::uint64_t, std::uint32_t> mMeshIndicesByHash;
+		std::uint32_t mMeshCount{ 0 };
+		std::uint32_t mMaterialCount{ 0 };
+		std::uint64_t mInputBytes{ 0 };
+	};
+}
\ No newline at end of file
@@ -0,0 +1,281 @@
+#include "pch.h"
+#include "TangentGenerator.h"
+#include "Model.h"
+#include "Mesh.h"
+#include <execution>
+#include <numeric>
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+using namespace Library;
+
+namespace ModelPipeline
+{
+	namespace
+	{
+		enum class Orientation : uint8_t
+		{
+			Any, // No texture coordinate area; joins whichever group its corner's vertex has.
+			Preserving,
+			Reversing
+		};
+
+		// Texture-space directions of a triangle, normalized and multiplied by the orientation sign, so that both
+		// point along increasing u and v whatever the winding.
+		struct TriangleFrame final
+		{
+			XMFLOAT3 Tangent{ 0.0f, 0.0f, 0.0f };
+			XMFLOAT3 Bitangent{ 0.0f, 0.0f, 0.0f };
+			Orientation TriangleOrientation{ Orientation::Any };
+		};
+
+		TriangleFrame ComputeTriangleFrame(const MeshData& meshData, const vector<XMFLOAT3>& textureCoordinates, size_t triangle)
+		{
+			const uint32_t i0 = meshData.Indices[triangle * 3];
+			const uint32_t i1 = meshData.Indices[triangle * 3 + 1];
+			const uint32_t i2 = meshData.Indices[triangle * 3 + 2];
+			const XMVECTOR p0 = XMLoadFloat3(&meshData.Vertices[i0]);
+			const XMVECTOR d21 = XMLoadFloat3(&meshData.Vertices[i1]) - p0;
+			const XMVECTOR d31 = XMLoadFloat3(&meshData.Vertices[i2]) - p0;
+			const float t21x = textureCoordinates[i1].x - textureCoordinates[i0].x;
+			const float t21y = textureCoordinates[i1].y - textureCoordinates[i0].y;
+			const float t31x = textureCoordinates[i2].x - textureCoordinates[i0].x;
+			const float t31y = textureCoordinates[i2].y - textureCoordinates[i0].y;
+
+			TriangleFrame frame;
+			const float signedArea = t21x * t31y - t21y * t31x;
+			if (fabs(signedArea) <= numeric_limits<float>::min())
+			{
+				return frame;
+			}
+
+			frame.TriangleOrientation = (signedArea > 0.0f ? Orientation::Preserving : Orientation::Reversing);
+			const float sign = (signedArea > 0.0f ? 1.0f : -1.0f);
+			const XMVECTOR tangent = XMVectorScale(d21, t31y) - XMVectorScale(d31, t21y);
+			const XMVECTOR bitangent = XMVectorScale(d31, t21x) - XMVectorScale(d21, t31x);
+			XMStoreFloat3(&frame.Tangent, XMVectorScale(XMVector3Normalize(tangent), sign));
+			XMStoreFloat3(&frame.Bitangent, XMVectorScale(XMVector3Normalize(bitangent), sign));
+
+			return frame;
+		}
+
+		// Angle of a triangle's corner, measured between its edges projected into the plane of the vertex normal.
+		float CornerAngle(FXMVECTOR normal, FXMVECTOR position, FXMVECTOR previous, GXMVECTOR next)
+		{
+			XMVECTOR edge1 = next - position;
+			XMVECTOR edge2 = previous - position;
+			edge1 = XMVector3Normalize(edge1 - XMVectorScale(normal, XMVectorGetX(XMVector3Dot(normal, edge1))));
+			edge2 = XMVector3Normalize(edge2 - XMVectorScale(normal, XMVectorGetX(XMVector3Dot(normal, edge2))));
+			return acos(clamp(XMVectorGetX(XMVector3Dot(edge1, edge2)), -1.0f, 1.0f));
+		}
+
+		// Any vector perpendicular to the normal, for vertices whose triangles have no texture coordinate area.
+		XMVECTOR PerpendicularTangent(FXMVECTOR normal)
+		{
+			const XMVECTOR axis = (fabs(XMVectorGetX(normal)) < 0.9f ? g_XMIdentityR0 : g_XMIdentityR1);
+			return XMVector3Normalize(axis - XMVectorScale(normal, XMVectorGetX(XMVector3Dot(normal, axis))));
+		}
+
+		template <typename T>
+		void AppendVertices(vector<T>& attribute, const vector<uint32_t>& sourceVertices)
+		{
+			if (attribute.empty())
+			{
+				return;
+			}
+
+			attribute.reserve(attribute.size() + sourceVertices.size());
+			for (const uint32_t vertex : sourceVertices)
+			{
+				attribute.push_back(attribute[vertex]);
+			}
+		}
+	}
+
+	TangentStatistics& TangentStatistics::operator+=(const TangentStatistics& rhs)
+	{
+		MeshCount += rhs.MeshCount;
+		SkippedMeshCount += rhs.SkippedMeshCount;
+		SourceVertexCount += rhs.SourceVertexCount;
+		VertexCount += rhs.VertexCount;
+		DegenerateTriangleCount += rhs.DegenerateTriangleCount;
+
+		return *this;
+	}
+
+	vector<XMFLOAT4> TangentGenerator::Generate(MeshData& meshData, TangentStatistics* statistics)
+	{
+		const size_t vertexCount = meshData.Vertices.size();
+		if (meshData.Normals.size() != vertexCount || meshData.TextureCoordinates.empty() || meshData.TextureCoordinates[0].size() != vertexCount)
+		{
+			throw exception("Tangent generation requires normals and texture coordinates.");
+		}
+
+		if (meshData.Indices.size() % 3 != 0)
+		{
+			throw exception("Tangent generation requires triangle lists.");
+		}
+
+		const size_t triangleCount = meshData.Indices.size() / 3;
+		const vector<XMFLOAT3>& textureCoordinates = meshData.TextureCoordinates[0];
+		vector<uint32_t> triangles(triangleCount);
+		iota(triangles.begin(), triangles.end(), 0U);
+		vector<TriangleFrame> frames(triangleCount);
+		for_each(execution::par, triangles.begin(), triangles.end(), [&](uint32_t triangle)
+		{
+			frames[triangle] = ComputeTriangleFrame(meshData, textureCoordinates, triangle);
+		});
+
+		// Corners grouped by vertex (compressed rows), so that each vertex gathers its own sums without contention.
+		vector<uint32_t> cornerOffsets(vertexCount + 1, 0);
+		for (const uint32_t index : meshData.Indices)
+		{
+			++cornerOffsets[index + 1];
+		}
+
+		partial_sum(cornerOffsets.begin(), cornerOffsets.end(), cornerOffsets.begin());
+		vector<uint32_t> vertexCorners(meshData.Indices.size());
+		{
+			vector<uint32_t> cursors(cornerOffsets.begin(), cornerOffsets.end() - 1);
+			for (uint32_t corner = 0; corner < meshData.Indices.size(); corner++)
+			{
+				vertexCorners[cursors[meshData.Indices[corner]]++] = corner;
+			}
+		}
+
+		// Each vertex produces one tangent per orientation present among its corners; the reversing one is given to
+		// a new vertex if the preserving one is also used.
+		vector<XMFLOAT4> preservingTangents(vertexCount);
+		vector<XMFLOAT4> reversingTangents(vertexCount);
+		vector<uint8_t> vertexOrientations(vertexCount, 0); // Bit 0: preserving corners, bit 1: reversing corners
+		vector<uint32_t> vertices(vertexCount);
+		iota(vertices.begin(), vertices.end(), 0U);
+		for_each(execution::par, vertices.begin(), vertices.end(), [&](uint32_t vertex)
+		{
+			const XMVECTOR normal = XMVector3Normalize(XMLoadFloat3(&meshData.Normals[vertex]));
+			const XMVECTOR position = XMLoadFloat3(&meshData.Vertices[vertex]);
+			XMVECTOR tangentSums[2] = { XMVectorZero(), XMVectorZero() };
+			XMVECTOR bitangentSums[2] = { XMVectorZero(), XMVectorZero() };
+			uint8_t orientations = 0;
+			for (uint32_t i = cornerOffsets[vertex]; i < cornerOffsets[vertex + 1]; i++)
+			{
+				const uint32_t corner = vertexCorners[i];
+				const uint32_t triangle = corner / 3;
+				const TriangleFrame& frame = frames[triangle];
+				if (frame.TriangleOrientation == Orientation::Any)
+				{
+					continue;
+				}
+
+				const uint32_t group = (frame.TriangleOrientation == Orientation::Preserving ? 0 : 1);
+				orientations |= static_cast<uint8_t>(1 << group);
+
+				const uint32_t first = triangle * 3;
+				const XMVECTOR previous = XMLoadFloat3(&meshData.Vertices[meshData.Indices[first + (corner - first + 2) % 3]]);
+				const XMVECTOR next = XMLoadFloat3(&meshData.Vertices[meshData.Indices[first + (corner - first + 1) % 3]]);
+				const float angle = CornerAngle(normal, position, previous, next);
+
+				const XMVECTOR tangent = XMLoadFloat3(&frame.Tangent);
+				const XMVECTOR bitangent = XMLoadFloat3(&frame.Bitangent);
+				tangentSums[group] += XMVectorScale(XMVector3Normalize(tangent - XMVectorScale(normal, XMVectorGetX(XMVector3Dot(normal, tangent)))), angle);
+				bitangentSums[group] += XMVectorScale(XMVector3Normalize(bitangent - XMVectorScale(normal, XMVectorGetX(XMVector3Dot(normal, bitangent)))), angle);
+			}
+
+			vertexOrientations[vertex] = orientations;
+			for (uint32_t group = 0; group < 2; group++)
+			{
+				XMVECTOR tangent = tangentSums[group];
+				if (XMVectorGetX(XMVector3LengthSq(tangent)) <= numeric_limits<float>::min())
+				{
+					tangent = PerpendicularTangent(normal);
+				}
+
+				tangent = XMVector3Normalize(tangent);
+				const float sign = (XMVectorGetX(XMVector3Dot(XMVector3Cross(normal, tangent), bitangentSums[group])) < 0.0f ? -1.0f : 1.0f);
+				XMFLOAT4& result = (group == 0 ? preservingTangents[vertex] : reversingTangents[vertex]);
+				XMStoreFloat4(&result, XMVectorSetW(tangent, sign));
+			}
+		});
+
+		// Split vertices used with both orientations; corners without texture area stay with the original.
+		vector<uint32_t> splitVertices;
+		vector<XMFLOAT4> tangents(vertexCount);
+		for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+		{
+			const uint8_t orientations = vertexOrientations[vertex];
+			tangents[vertex] = (orientations == 2 ? reversingTangents[vertex] : preservingTangents[vertex]);
+			if (orientations != 3)
+			{
+				continue;
+			}
+
+			const uint32_t splitVertex = narrow<uint32_t>(vertexCount + splitVertices.size());
+			splitVertices.push_back(vertex);
+			tangents.push_back(reversingTangents[vertex]);
+			for (uint32_t i = cornerOffsets[vertex]; i < cornerOffsets[vertex + 1]; i++)
+			{
+				const uint32_t corner = vertexCorners[i];
+				if (frames[corner / 3].TriangleOrientation == Orientation::Reversing)
+				{
+					meshData.Indices[corner] = splitVertex;
+				}
+			}
+		}
+
+		AppendVertices(meshData.Vertices, splitVertices);
+		AppendVertices(meshData.Normals, splitVertices);
+		for (auto& channel : meshData.TextureCoordinates)
+		{
+			AppendVertices(channel, splitVertices);
+		}
+
+		for (auto& channel : meshData.VertexColors)
+		{
+			AppendVertices(channel, splitVertices);
+		}
+
+		meshData.Tangents.resize(tangents.size());
+		meshData.BiNormals.resize(tangents.size());
+		for (size_t i = 0; i < tangents.size(); i++)
+		{
+			const XMVECTOR tangent = XMLoadFloat4(&tangents[i]);
+			meshData.Tangents[i] = XMFLOAT3(tangents[i].x, tangents[i].y, tangents[i].z);
+			XMStoreFloat3(&meshData.BiNormals[i], XMVectorScale(XMVector3Cross(XMLoadFloat3(&meshData.Normals[i]), tangent), tangents[i].w));
+		}
+
+		if (statistics != nullptr)
+		{
+			++statistics->MeshCount;
+			statistics->SourceVertexCount += vertexCount;
+			statistics->VertexCount += tangents.size();
+			statistics->DegenerateTriangleCount += count_if(frames.begin(), frames.end(), [](const TriangleFrame& frame) { return frame.TriangleOrientation == Orientation::Any; });
+		}
+
+		return tangents;
+	}
+
+	TangentStatistics TangentGenerator::Generate(Model& model, bool replaceExisting)
+	{
+		TangentStatistics statistics;
+		for (const auto& mesh : model.Meshes())
+		{
+			MeshData& meshData = mesh->Data();
+			const size_t vertexCount = meshData.Vertices.size();
+			if (!replaceExisting && meshData.Tangents.size() == vertexCount)
+			{
+				continue;
+			}
+
+			if (vertexCount == 0 || meshData.Normals.size() != vertexCount || meshData.TextureCoordinates.empty() || meshData.TextureCoordinates[0].size() != vertexCount)
+			{
+				++statistics.SkippedMeshCount;
+				continue;
+			}
+
+			Generate(meshData, &statistics);
+		}
+
+		return statistics;
+	}
+}
\ No newline at end of file
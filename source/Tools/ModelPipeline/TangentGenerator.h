@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <DirectXMath.h>
+
+namespace Library
+{
+	class Model;
+	struct MeshData;
+}
+
+namespace ModelPipeline
+{
+	struct TangentStatistics final
+	{
+		std::size_t MeshCount{ 0 };
+		std::size_t SkippedMeshCount{ 0 }; // Meshes without normals or texture coordinates.
+		std::size_t SourceVertexCount{ 0 };
+		std::size_t VertexCount{ 0 };
+		std::size_t DegenerateTriangleCount{ 0 }; // Triangles with no texture coordinate area; they take their neighbours' tangents.
+
+		TangentStatistics& operator+=(const TangentStatistics& rhs);
+	};
+
+	// Generates per-vertex tangents from the normals and texture coordinate channel 0, following MikkTSpace
+	// (Mikkelsen, "Simulation of Wrinkled Surfaces Revisited") with its default 180 degree angular threshold:
+	// each triangle's texture-space tangent is projected into the plane of the vertex normal and the corners
+	// around a vertex are summed, weighted by their angle. Vertices shared by triangles of opposite texture
+	// orientation (mirrored UVs) are split, as MikkTSpace would.
+	class TangentGenerator final
+	{
+	public:
+		TangentGenerator() = delete;
+
+		// Replaces the mesh's tangents and binormals, and returns the tangents with the bitangent sign in w, so that
+		// binormal = w * cross(normal, tangent) points along increasing v. Triangles are processed in parallel, then
+		// vertices.
+		static std::vector<DirectX::XMFLOAT4> Generate(Library::MeshData& meshData, TangentStatistics* statistics = nullptr);
+
+		// Meshes that already have tangents keep them unless replaceExisting is set.
+		static TangentStatistics Generate(Library::Model& model, bool replaceExisting = false);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,289 @@
+#include "pch.h"
+#include "Frustum.h"
+#include "OcclusionCuller.h"
+#include "TriangleBvh.h"
+#include "Model.h"
+#include <chrono>
+#include <random>
+
+using namespace std;
+using namespace std::chrono;
+using namespace std::string_literals;
+using namespace gsl;
+using namespace DirectX;
+using namespace Library;
+
+namespace
+{
+	const uint32_t DefaultObjectCount{ 100000 };
+	const int FrameCount{ 30 };
+	const uint32_t BlockCount{ 20 }; // Per side
+	const float BlockSize{ 30.0f };
+	const float EyeHeight{ 1.7f };
+	const uint32_t SamplesPerSide{ 5 }; // Per face edge, for validation
+
+	struct City final
+	{
+		vector<XMFLOAT4X4> BuildingMatrices;
+		vector<BoundingBox> Objects;
+	};
+
+	// A unit cube, scaled and placed by each building's world matrix.
+	const vector<XMFLOAT3> CubeVertices
+	{
+		{ -1.0f, -1.0f, -1.0f }, { 1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f, -1.0f }, { -1.0f, 1.0f, -1.0f },
+		{ -1.0f, -1.0f, 1.0f }, { 1.0f, -1.0f, 1.0f }, { 1.0f, 1.0f, 1.0f }, { -1.0f, 1.0f, 1.0f }
+	};
+
+	const vector<uint32_t> CubeIndices
+	{
+		0, 2, 1, 0, 3, 2,
+		4, 5, 6, 4, 6, 7,
+		0, 1, 5, 0, 5, 4,
+		3, 6, 2, 3, 7, 6,
+		0, 4, 7, 0, 7, 3,
+		1, 2, 6, 1, 6, 5
+	};
+
+	// One building per block of a grid of streets, and small objects scattered over the city, some in the
+	// streets and some hidden inside the buildings.
+	City CreateCity(uint32_t objectCount)
+	{
+		mt19937 generator(1);
+		uniform_real_distribution<float> footprint(0.3f * BlockSize, 0.45f * BlockSize);
+		uniform_real_distribution<float> buildingHeight(10.0f, 60.0f);
+		const float cityExtent = 0.5f * BlockCount * BlockSize;
+
+		City city;
+		for (uint32_t z = 0; z < BlockCount; z++)
+		{
+			for (uint32_t x = 0; x < BlockCount; x++)
+			{
+				const float height = buildingHeight(generator);
+				const XMMATRIX scale = XMMatrixScaling(footprint(generator), 0.5f * height, footprint(generator));
+				const XMMATRIX translation = XMMatrixTranslation((x + 0.5f) * BlockSize - cityExtent, 0.5f * height, (z + 0.5f) * BlockSize - cityExtent);
+				XMFLOAT4X4 worldMatrix;
+				XMStoreFloat4x4(&worldMatrix, XMMatrixMultiply(scale, translation));
+				city.BuildingMatrices.push_back(worldMatrix);
+			}
+		}
+
+		uniform_real_distribution<float> position(-cityExtent, cityExtent);
+		uniform_real_distribution<float> elevation(0.5f, 3.0f);
+		uniform_real_distribution<float> extent(0.3f, 1.5f);
+		city.Objects.reserve(objectCount);
+		for (uint32_t i = 0; i < objectCount; i++)
+		{
+			city.Objects.emplace_back(XMFLOAT3(position(generator), elevation(generator), position(generator)), XMFLOAT3(extent(generator), extent(generator), extent(generator)));
+		}
+
+		return city;
+	}
+
+	// Standing in a street at the edge of the city, looking down it.
+	XMFLOAT3 EyePosition()
+	{
+		return XMFLOAT3(0.0f, EyeHeight, 0.5f * BlockCount * BlockSize + 10.0f);
+	}
+
+	XMMATRIX ViewProjectionMatrix(const OcclusionCuller& culler)
+	{
+		const XMFLOAT3 eyePosition = EyePosition();
+		const XMMATRIX viewMatrix = XMMatrixLookToRH(XMLoadFloat3(&eyePosition), XMVectorSet(0.0f, 0.0f, -1.0f, 0.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+		const float aspectRatio = static_cast<float>(culler.Width()) / culler.Height();
+		const XMMATRIX projectionMatrix = XMMatrixPerspectiveFovRH(XM_PIDIV4, aspectRatio, 0.1f, 2.0f * BlockCount * BlockSize);
+		return XMMatrixMultiply(viewMatrix, projectionMatrix);
+	}
+
+	double Milliseconds(const high_resolution_clock::time_point& startTime)
+	{
+		return duration<double, milli>(high_resolution_clock::now() - startTime).count();
+	}
+
+	// Checks that every object reported occluded really is: points across its faces that are in view are traced
+	// back to the eye against the buildings' triangles, and none may reach it. Returns the number of points traced.
+	size_t ValidateOcclusion(const City& city, const vector<uint32_t>& occludedObjects, CXMMATRIX viewProjectionMatrix)
+	{
+		vector<XMFLOAT3> triangleVertices;
+		for (const XMFLOAT4X4& worldMatrix : city.BuildingMatrices)
+		{
+			const XMMATRIX transform = XMLoadFloat4x4(&worldMatrix);
+			for (uint32_t index : CubeIndices)
+			{
+				XMFLOAT3 vertex;
+				XMStoreFloat3(&vertex, XMVector3TransformCoord(XMLoadFloat3(&CubeVertices[index]), transform));
+				triangleVertices.push_back(vertex);
+			}
+		}
+
+		const TriangleBvh buildings(triangleVertices);
+		const XMFLOAT3 eyePosition = EyePosition();
+		const XMVECTOR eye = XMLoadFloat3(&eyePosition);
+		size_t tracedCount = 0;
+		for (uint32_t object : occludedObjects)
+		{
+			const BoundingBox& box = city.Objects[object];
+			for (uint32_t axis = 0; axis < 3; axis++)
+			{
+				for (float side : { -1.0f, 1.0f })
+				{
+					for (uint32_t u = 0; u < SamplesPerSide; u++)
+					{
+						for (uint32_t v = 0; v < SamplesPerSide; v++)
+						{
+							float offset[3];
+							offset[axis] = side;
+							offset[(axis + 1) % 3] = 2.0f * u / (SamplesPerSide - 1) - 1.0f;
+							offset[(axis + 2) % 3] = 2.0f * v / (SamplesPerSide - 1) - 1.0f;
+							const XMVECTOR point = XMLoadFloat3(&box.Center) + XMVectorSet(offset[0], offset[1], offset[2], 0.0f) * XMLoadFloat3(&box.Extents);
+
+							XMFLOAT4 clip;
+							XMStoreFloat4(&clip, XMVector3Transform(point, viewProjectionMatrix));
+							if (clip.w <= 0.0f || clip.z < 0.0f || clip.z > clip.w || fabs(clip.x) > clip.w || fabs(clip.y) > clip.w)
+							{
+								continue;
+							}
+
+							const XMVECTOR toPoint = point - eye;
+							const float distance = XMVectorGetX(XMVector3Length(toPoint));
+							Ray ray;
+							XMStoreFloat3(&ray.Origin, eye);
+							XMStoreFloat3(&ray.Direction, toPoint / distance);
+							ray.MaxDistance = distance;
+							++tracedCount;
+							if (!buildings.Occluded(ray))
+							{
+								throw exception("An object reported occluded is visible.");
+							}
+						}
+					}
+				}
+			}
+		}
+
+		return tracedCount;
+	}
+
+	// Writes the buildings as a model's occluder and reads the model back, checking that the occluder survives
+	// the model format unchanged. Returns the number of occluder triangles.
+	size_t ValidateOccluderRoundTrip(const City& city)
+	{
+		ModelData modelData;
+		ModelOccluder& occluder = modelData.Occluder;
+		for (const XMFLOAT4X4& worldMatrix : city.BuildingMatrices)
+		{
+			const uint32_t baseVertex = narrow<uint32_t>(occluder.Vertices.size());
+			occluder.Vertices.resize(baseVertex + CubeVertices.size());
+			XMVector3TransformCoordStream(&occluder.Vertices[baseVertex], sizeof(XMFLOAT3), CubeVertices.data(), sizeof(XMFLOAT3), CubeVertices.size(), XMLoadFloat4x4(&worldMatrix));
+			transform(CubeIndices.begin(), CubeIndices.end(), back_inserter(occluder.Indices), [baseVertex](uint32_t index) { return baseVertex + index; });
+		}
+
+		const Model model(move(modelData));
+		const string filename = (filesystem::temp_directory_path() / "OcclusionCullingBenchmark.model").string();
+		model.Save(filename);
+		const Model writtenModel(filename);
+		filesystem::remove(filename);
+
+		const ModelOccluder& writtenOccluder = writtenModel.Occluder();
+		const bool verticesMatch = equal(model.Occluder().Vertices.begin(), model.Occluder().Vertices.end(), writtenOccluder.Vertices.begin(), writtenOccluder.Vertices.end(), [](const XMFLOAT3& lhs, const XMFLOAT3& rhs)
+		{
+			return lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z;
+		});
+
+		if (!verticesMatch || writtenOccluder.Indices != model.Occluder().Indices)
+		{
+			throw exception("The occluder read back from the model does not match the one written.");
+		}
+
+		return writtenOccluder.Indices.size() / 3;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+#if defined(DEBUG) | defined(_DEBUG)
+	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+#endif
+
+	try
+	{
+		const uint32_t objectCount = (argc > 1 ? static_cast<uint32_t>(stoul(argv[1])) : DefaultObjectCount);
+		const City city = CreateCity(objectCount);
+
+		OcclusionCuller culler;
+		const XMMATRIX viewProjectionMatrix = ViewProjectionMatrix(culler);
+		const Frustum frustum(viewProjectionMatrix);
+
+		BoundingBoxArrays objects;
+		objects.Reserve(city.Objects.size());
+		for (const BoundingBox& box : city.Objects)
+		{
+			objects.Add(box);
+		}
+
+		// Only the objects in the frustum are tested for occlusion.
+		vector<uint32_t> frustumVisibility(Frustum::VisibilityWordCount(objects.Size()));
+		frustum.Cull(objects, frustumVisibility);
+		BoundingBoxArrays candidates;
+		vector<uint32_t> candidateObjects;
+		for (uint32_t i = 0; i < objectCount; i++)
+		{
+			if (Frustum::IsVisible(frustumVisibility, i))
+			{
+				candidates.Add(city.Objects[i]);
+				candidateObjects.push_back(i);
+			}
+		}
+
+		double addTime = 0.0;
+		double rasterizeTime = 0.0;
+		double testTime = 0.0;
+		vector<uint32_t> occlusionVisibility(Frustum::VisibilityWordCount(candidates.Size()));
+		for (int frame = 0; frame < FrameCount; frame++)
+		{
+			auto startTime = high_resolution_clock::now();
+			culler.Begin(viewProjectionMatrix);
+			for (const XMFLOAT4X4& worldMatrix : city.BuildingMatrices)
+			{
+				culler.AddOccluder(CubeVertices, CubeIndices, XMLoadFloat4x4(&worldMatrix));
+			}
+			addTime += Milliseconds(startTime);
+
+			startTime = high_resolution_clock::now();
+			culler.Rasterize();
+			rasterizeTime += Milliseconds(startTime);
+
+			startTime = high_resolution_clock::now();
+			culler.Test(candidates, occlusionVisibility);
+			testTime += Milliseconds(startTime);
+		}
+
+		vector<uint32_t> occludedObjects;
+		for (uint32_t i = 0; i < candidateObjects.size(); i++)
+		{
+			if (!Frustum::IsVisible(occlusionVisibility, i))
+			{
+				occludedObjects.push_back(candidateObjects[i]);
+			}
+		}
+
+		const size_t tracedCount = ValidateOcclusion(city, occludedObjects, viewProjectionMatrix);
+		const size_t roundTripTriangleCount = ValidateOccluderRoundTrip(city);
+		const OcclusionStatistics& statistics = culler.Statistics();
+
+		cout << "Depth buffer "s << culler.Width() << "x"s << culler.Height() << ", "s << city.BuildingMatrices.size() << " buildings, "s << objectCount << " objects"s << endl;
+		cout << "Occluder triangles: "s << statistics.OccluderTriangleCount << " (rasterized "s << statistics.RasterizedTriangleCount
+			<< ", binned "s << statistics.BinnedTriangleCount << ")"s << endl;
+		cout << "In frustum: "s << candidateObjects.size() << ", occluded: "s << occludedObjects.size()
+			<< " (validated with "s << tracedCount << " rays)"s << endl;
+		cout << "Model occluder round trip: "s << roundTripTriangleCount << " triangles"s << endl;
+		cout << fixed << setprecision(3) << "Average of "s << FrameCount << " frames (ms): add occluders "s << addTime / FrameCount
+			<< ", rasterize "s << rasterizeTime / FrameCount << ", test "s << testTime / FrameCount << endl;
+	}
+	catch (exception ex)
+	{
+		cout << ex.what() << endl;
+	}
+
+	return 0;
+}
\ No newline at end of file
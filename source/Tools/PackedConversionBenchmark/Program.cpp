@@ -0,0 +1,154 @@
+#include "pch.h"
+#include "PackedVectorHelper.h"
+#include <chrono>
+#include <random>
+
+using namespace std;
+using namespace std::chrono;
+using namespace std::string_literals;
+using namespace gsl;
+using namespace DirectX::PackedVector;
+using namespace Library;
+
+namespace
+{
+	const size_t DefaultElementCount{ 10000000 };
+	const int IterationCount{ 10 };
+
+	const string InstructionSetNames[]{ "Scalar"s, "F16C"s, "AVX2"s };
+
+	// Returns the fastest of several runs, in milliseconds.
+	template <typename Func>
+	double Measure(Func func)
+	{
+		double best = numeric_limits<double>::max();
+		for (int i = 0; i < IterationCount; i++)
+		{
+			auto startTime = high_resolution_clock::now();
+			func();
+			best = min(best, duration<double, milli>(high_resolution_clock::now() - startTime).count());
+		}
+
+		return best;
+	}
+
+	// Random values in the given range, followed by the special values where the vector kernels defer to the
+	// scalar ones (zeros, half denormals and overflow, infinities and NaNs).
+	vector<float> CreateSource(size_t elementCount, float minValue, float maxValue)
+	{
+		const float specialValues[]
+		{
+			0.0f, -0.0f, 1.0f, -1.0f, 65504.0f, 65519.0f, 65520.0f, 1.0e-5f, -3.0e-8f, 6.0e-5f, 1.0e-40f,
+			numeric_limits<float>::infinity(), -numeric_limits<float>::infinity(), numeric_limits<float>::quiet_NaN()
+		};
+
+		mt19937 generator(1);
+		uniform_real_distribution<float> distribution(minValue, maxValue);
+		vector<float> source(elementCount);
+		for (float& value : source)
+		{
+			value = distribution(generator);
+		}
+
+		for (size_t i = 0; i < size(specialValues) && i < elementCount; i++)
+		{
+			source[elementCount - 1 - i * 997 % elementCount] = specialValues[i];
+		}
+
+		return source;
+	}
+
+	// Runs the conversion with every supported instruction set and checks each result against the scalar
+	// (DirectXPackedVector) result bit for bit.
+	template <typename TSource, typename TDestination, typename ConvertFunc>
+	void Benchmark(const string& name, const vector<TSource>& source, ConvertFunc convert)
+	{
+		vector<TDestination> expected(source.size());
+		PackedVectorHelper::SetInstructionSet(ConversionInstructionSet::Scalar);
+		convert(source, expected);
+
+		const auto supportedInstructionSet = PackedVectorHelper::SupportedInstructionSet();
+		for (auto instructionSet = ConversionInstructionSet::Scalar; instructionSet <= supportedInstructionSet; instructionSet = static_cast<ConversionInstructionSet>(static_cast<int>(instructionSet) + 1))
+		{
+			PackedVectorHelper::SetInstructionSet(instructionSet);
+
+			vector<TDestination> destination(source.size());
+			const double time = Measure([&]() { convert(source, destination); });
+			if (memcmp(expected.data(), destination.data(), sizeof(TDestination) * destination.size()) != 0)
+			{
+				throw exception((name + " "s + InstructionSetNames[static_cast<int>(instructionSet)] + " output differs from the scalar conversion."s).c_str());
+			}
+
+			const double gigabytes = static_cast<double>((sizeof(TSource) + sizeof(TDestination)) * source.size()) / (1024.0 * 1024.0 * 1024.0);
+			cout << left << setw(16) << name << setw(8) << InstructionSetNames[static_cast<int>(instructionSet)] << right << fixed << setprecision(2)
+				<< setw(10) << time << " ms"s
+				<< setw(10) << gigabytes / (time / 1000.0) << " GB/s"s << endl;
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+#if defined(DEBUG) | defined(_DEBUG)
+	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+#endif
+
+	try
+	{
+		const size_t elementCount = (argc > 1 ? static_cast<size_t>(stoull(argv[1])) : DefaultElementCount);
+
+		cout << "Elements: "s << elementCount << " (best of "s << IterationCount << " runs)"s << endl;
+		cout << "Supported: "s << InstructionSetNames[static_cast<int>(PackedVectorHelper::SupportedInstructionSet())] << endl;
+
+		const vector<float> signedSource = CreateSource(elementCount, -1.5f, 1.5f);
+		const vector<float> unitSource = CreateSource(elementCount, 0.0f, 1.0f);
+
+		Benchmark<float, HALF>("FloatToHalf"s, signedSource, [](const vector<float>& source, vector<HALF>& destination)
+		{
+			PackedVectorHelper::FloatToHalf(source, destination);
+		});
+
+		vector<HALF> halfSource(elementCount);
+		for (size_t i = 0; i < elementCount; i++)
+		{
+			halfSource[i] = static_cast<HALF>(i);
+		}
+
+		Benchmark<HALF, float>("HalfToFloat"s, halfSource, [](const vector<HALF>& source, vector<float>& destination)
+		{
+			PackedVectorHelper::HalfToFloat(source, destination);
+		});
+
+		Benchmark<float, uint8_t>("FloatToUNorm8"s, unitSource, [](const vector<float>& source, vector<uint8_t>& destination)
+		{
+			PackedVectorHelper::FloatToUNorm8(source, destination);
+		});
+
+		Benchmark<float, int16_t>("FloatToSNorm16"s, signedSource, [](const vector<float>& source, vector<int16_t>& destination)
+		{
+			PackedVectorHelper::FloatToSNorm16(source, destination);
+		});
+
+		Benchmark<float, uint8_t>("LinearToSRGB8"s, unitSource, [](const vector<float>& source, vector<uint8_t>& destination)
+		{
+			PackedVectorHelper::LinearToSRGB8(source, destination);
+		});
+
+		vector<uint8_t> codeSource(elementCount);
+		for (size_t i = 0; i < elementCount; i++)
+		{
+			codeSource[i] = static_cast<uint8_t>(i * 7);
+		}
+
+		Benchmark<uint8_t, float>("SRGB8ToLinear"s, codeSource, [](const vector<uint8_t>& source, vector<float>& destination)
+		{
+			PackedVectorHelper::SRGB8ToLinear(source, destination);
+		});
+	}
+	catch (exception ex)
+	{
+		cout << ex.what() << endl;
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,364 @@
+#include "pch.h"
+#include "PointCloudBuilder.h"
+#include <array>
+#include <execution>
+#include <numeric>
+#include <unordered_set>
+
+using namespace std;
+using namespace std::filesystem;
+using namespace std::string_literals;
+using namespace gsl;
+using namespace DirectX;
+using namespace Library;
+
+namespace PointCloudPipeline
+{
+	namespace
+	{
+		const size_t TemporaryFileBufferSize{ 1 << 16 };
+
+		void WritePoints(ofstream& file, const vector<VertexPositionPackedColor>& points)
+		{
+			file.write(reinterpret_cast<const char*>(points.data()), points.size() * sizeof(VertexPositionPackedColor));
+			if (file.bad())
+			{
+				throw exception("Error writing point data.");
+			}
+		}
+	}
+
+	PointCloudBuilder::Bounds PointCloudBuilder::Bounds::Octant(uint32_t octant) const
+	{
+		const float halfSize = Size * 0.5f;
+		return
+		{
+			XMFLOAT3(Min.x + ((octant & 1) ? halfSize : 0.0f), Min.y + ((octant & 2) ? halfSize : 0.0f), Min.z + ((octant & 4) ? halfSize : 0.0f)),
+			halfSize
+		};
+	}
+
+	uint32_t PointCloudBuilder::Bounds::OctantOf(const XMFLOAT3& position) const
+	{
+		const float halfSize = Size * 0.5f;
+		return (position.x >= Min.x + halfSize ? 1U : 0U) | (position.y >= Min.y + halfSize ? 2U : 0U) | (position.z >= Min.z + halfSize ? 4U : 0U);
+	}
+
+	PointCloudBuilder::PointCloudBuilder(const string& outputFilename, const PointCloudBuildSettings& settings) :
+		mOutputFilename(outputFilename), mTemporaryDirectory(outputFilename + ".tmp"s), mSettings(settings)
+	{
+		if (mSettings.GridResolution == 0 || mSettings.GridResolution > 1024)
+		{
+			throw exception("Grid resolution must be between 1 and 1024.");
+		}
+	}
+
+	PointCloudBuildStatistics PointCloudBuilder::Build(const PointSource& source)
+	{
+		mNodes.clear();
+		mStatistics = PointCloudBuildStatistics();
+
+		// Pass 1: bounds and point count.
+		XMFLOAT3 boundsMin(numeric_limits<float>::max(), numeric_limits<float>::max(), numeric_limits<float>::max());
+		XMFLOAT3 boundsMax(numeric_limits<float>::lowest(), numeric_limits<float>::lowest(), numeric_limits<float>::lowest());
+		uint64_t pointCount = 0;
+		source.Read([&](span<const VertexPositionPackedColor> batch)
+		{
+			for (const auto& point : batch)
+			{
+				boundsMin.x = min(boundsMin.x, point.Position.x);
+				boundsMin.y = min(boundsMin.y, point.Position.y);
+				boundsMin.z = min(boundsMin.z, point.Position.z);
+				boundsMax.x = max(boundsMax.x, point.Position.x);
+				boundsMax.y = max(boundsMax.y, point.Position.y);
+				boundsMax.z = max(boundsMax.z, point.Position.z);
+			}
+
+			pointCount += batch.size();
+		});
+
+		if (pointCount == 0)
+		{
+			throw exception("Point source contains no points.");
+		}
+
+		// Octree cells are cubes; the root is padded slightly so that the maximum point falls inside it.
+		const float extent = max({ boundsMax.x - boundsMin.x, boundsMax.y - boundsMin.y, boundsMax.z - boundsMin.z });
+		const Bounds rootBounds{ boundsMin, max(extent * 1.0001f, numeric_limits<float>::epsilon()) };
+		mStatistics.SourcePointCount = pointCount;
+
+		create_directories(mTemporaryDirectory);
+		mOutputFile.open(mOutputFilename, ios::binary | ios::trunc);
+		if (!mOutputFile.good())
+		{
+			throw exception(("Could not open file for writing: "s + mOutputFilename).c_str());
+		}
+
+		PointCloud::Header header{ 0 };
+		mOutputFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		mOutputOffset = sizeof(header);
+
+		// Pass 2: partition and build.
+		const BuildResult root = BuildNode([&source](const PointSource::BatchCallback& callback) { source.Read(callback); }, pointCount, rootBounds, 0);
+
+		header.Magic = PointCloud::Magic;
+		header.Version = PointCloud::Version;
+		header.NodeCount = narrow<uint32_t>(mNodes.size());
+		header.RootNode = root.NodeIndex;
+		header.PointCount = pointCount;
+		header.NodeTableOffset = mOutputOffset;
+		header.BoundsMin = mNodes[root.NodeIndex].BoundsMin;
+		header.Spacing = mNodes[root.NodeIndex].Spacing;
+		header.BoundsMax = mNodes[root.NodeIndex].BoundsMax;
+
+		mOutputFile.write(reinterpret_cast<const char*>(mNodes.data()), mNodes.size() * sizeof(PointCloud::Node));
+		mOutputFile.seekp(0);
+		mOutputFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		mOutputFile.close();
+		if (mOutputFile.fail())
+		{
+			throw exception("Error writing point cloud file.");
+		}
+
+		remove_all(mTemporaryDirectory);
+
+		return mStatistics;
+	}
+
+	PointCloudBuilder::BuildResult PointCloudBuilder::BuildNode(const ChunkReader& reader, uint64_t pointCount, const Bounds& bounds, uint32_t level)
+	{
+		if (pointCount <= mSettings.InMemoryPointLimit || level >= mSettings.MaxDepth)
+		{
+			PointList points;
+			points.reserve(static_cast<size_t>(pointCount));
+			reader([&points](span<const VertexPositionPackedColor> batch) { points.insert(points.end(), batch.begin(), batch.end()); });
+			return BuildNode(move(points), bounds, level);
+		}
+
+		// Out-of-core partition: stream the points into one temporary file per octant, then build the octants one at a time.
+		array<path, 8> octantFilenames;
+		array<ofstream, 8> octantFiles;
+		array<PointList, 8> octantBuffers;
+		array<uint64_t, 8> octantCounts{ 0 };
+		for (uint32_t octant = 0; octant < 8; ++octant)
+		{
+			octantFilenames[octant] = mTemporaryDirectory / (to_string(mTemporaryFileCount++) + ".points"s);
+			octantFiles[octant].open(octantFilenames[octant], ios::binary | ios::trunc);
+			if (!octantFiles[octant].good())
+			{
+				throw exception("Could not create temporary file.");
+			}
+
+			octantBuffers[octant].reserve(TemporaryFileBufferSize);
+		}
+
+		reader([&](span<const VertexPositionPackedColor> batch)
+		{
+			for (const auto& point : batch)
+			{
+				const uint32_t octant = bounds.OctantOf(point.Position);
+				octantBuffers[octant].push_back(point);
+				if (octantBuffers[octant].size() == TemporaryFileBufferSize)
+				{
+					WritePoints(octantFiles[octant], octantBuffers[octant]);
+					octantBuffers[octant].clear();
+				}
+			}
+		});
+
+		for (uint32_t octant = 0; octant < 8; ++octant)
+		{
+			WritePoints(octantFiles[octant], octantBuffers[octant]);
+			octantCounts[octant] = static_cast<uint64_t>(octantFiles[octant].tellp()) / sizeof(VertexPositionPackedColor);
+			octantFiles[octant].close();
+			octantBuffers[octant] = PointList();
+		}
+
+		vector<BuildResult> children;
+		for (uint32_t octant = 0; octant < 8; ++octant)
+		{
+			if (octantCounts[octant] > 0)
+			{
+				const path& filename = octantFilenames[octant];
+				auto octantReader = [&filename](const PointSource::BatchCallback& callback)
+				{
+					ifstream file(filename, ios::binary);
+					PointList batch(PointSource::BatchSize);
+					while (file)
+					{
+						file.read(reinterpret_cast<char*>(batch.data()), batch.size() * sizeof(VertexPositionPackedColor));
+						const size_t count = static_cast<size_t>(file.gcount()) / sizeof(VertexPositionPackedColor);
+						if (count > 0)
+						{
+							callback(span<const VertexPositionPackedColor>(batch.data(), count));
+						}
+					}
+				};
+
+				children.push_back(BuildNode(octantReader, octantCounts[octant], bounds.Octant(octant), level + 1));
+			}
+
+			remove(octantFilenames[octant]);
+		}
+
+		return BuildInteriorNode(children, bounds, level);
+	}
+
+	PointCloudBuilder::BuildResult PointCloudBuilder::BuildNode(PointList&& points, const Bounds& bounds, uint32_t level)
+	{
+		if (points.size() <= mSettings.MaxLeafPointCount || level >= mSettings.MaxDepth)
+		{
+			static const uint32_t NoChildren[8]{ PointCloud::InvalidNode, PointCloud::InvalidNode, PointCloud::InvalidNode, PointCloud::InvalidNode, PointCloud::InvalidNode, PointCloud::InvalidNode, PointCloud::InvalidNode, PointCloud::InvalidNode };
+			const uint32_t nodeIndex = WriteNode(bounds, 0.0f, level, points, NoChildren);
+			return { nodeIndex, move(points) };
+		}
+
+		array<PointList, 8> octantPoints;
+		{
+			array<size_t, 8> octantCounts{ 0 };
+			for (const auto& point : points)
+			{
+				++octantCounts[bounds.OctantOf(point.Position)];
+			}
+
+			for (uint32_t octant = 0; octant < 8; ++octant)
+			{
+				octantPoints[octant].reserve(octantCounts[octant]);
+			}
+
+			for (const auto& point : points)
+			{
+				octantPoints[bounds.OctantOf(point.Position)].push_back(point);
+			}
+
+			points = PointList();
+		}
+
+		vector<uint32_t> octants;
+		for (uint32_t octant = 0; octant < 8; ++octant)
+		{
+			if (!octantPoints[octant].empty())
+			{
+				octants.push_back(octant);
+			}
+		}
+
+		// Exceptions must not escape the parallel algorithm; they are rethrown once all octants have finished.
+		vector<BuildResult> children(octants.size());
+		vector<exception_ptr> errors(octants.size());
+		vector<size_t> childIndices(octants.size());
+		iota(childIndices.begin(), childIndices.end(), size_t(0));
+		for_each(execution::par, childIndices.begin(), childIndices.end(), [&](size_t childIndex)
+		{
+			try
+			{
+				const uint32_t octant = octants[childIndex];
+				children[childIndex] = BuildNode(move(octantPoints[octant]), bounds.Octant(octant), level + 1);
+			}
+			catch (...)
+			{
+				errors[childIndex] = current_exception();
+			}
+		});
+
+		for (const auto& error : errors)
+		{
+			if (error != nullptr)
+			{
+				rethrow_exception(error);
+			}
+		}
+
+		return BuildInteriorNode(children, bounds, level);
+	}
+
+	PointCloudBuilder::BuildResult PointCloudBuilder::BuildInteriorNode(vector<BuildResult>& children, const Bounds& bounds, uint32_t level)
+	{
+		uint32_t childNodes[8]{ PointCloud::InvalidNode, PointCloud::InvalidNode, PointCloud::InvalidNode, PointCloud::InvalidNode, PointCloud::InvalidNode, PointCloud::InvalidNode, PointCloud::InvalidNode, PointCloud::InvalidNode };
+		for (size_t i = 0; i < children.size(); ++i)
+		{
+			childNodes[i] = children[i].NodeIndex;
+		}
+
+		PointList points = Subsample(children, bounds);
+		children.clear();
+
+		const float spacing = bounds.Size / mSettings.GridResolution;
+		const uint32_t nodeIndex = WriteNode(bounds, spacing, level, points, childNodes);
+		return { nodeIndex, move(points) };
+	}
+
+	PointCloudBuilder::PointList PointCloudBuilder::Subsample(const vector<BuildResult>& children, const Bounds& bounds) const
+	{
+		// Children occupy disjoint cells of the parent grid, so taking the first point per cell keeps the
+		// subsample spread across all of them.
+		const uint32_t resolution = mSettings.GridResolution;
+		const float scale = resolution / bounds.Size;
+		auto cellCoordinate = [&](float position, float boundsMin)
+		{
+			return min(static_cast<uint32_t>(max((position - boundsMin) * scale, 0.0f)), resolution - 1);
+		};
+
+		size_t sourcePointCount = 0;
+		for (const auto& child : children)
+		{
+			sourcePointCount += child.Points.size();
+		}
+
+		unordered_set<uint32_t> occupiedCells;
+		occupiedCells.reserve(min<size_t>(sourcePointCount, static_cast<size_t>(resolution) * resolution * 4));
+
+		PointList points;
+		for (const auto& child : children)
+		{
+			for (const auto& point : child.Points)
+			{
+				const uint32_t cell = (cellCoordinate(point.Position.x, bounds.Min.x) * resolution + cellCoordinate(point.Position.y, bounds.Min.y)) * resolution + cellCoordinate(point.Position.z, bounds.Min.z);
+				if (occupiedCells.insert(cell).second)
+				{
+					points.push_back(point);
+				}
+			}
+		}
+
+		return points;
+	}
+
+	uint32_t PointCloudBuilder::WriteNode(const Bounds& bounds, float spacing, uint32_t level, const PointList& points, const uint32_t (&children)[8])
+	{
+		PointCloud::Node node;
+		node.BoundsMin = bounds.Min;
+		node.Spacing = spacing;
+		node.BoundsMax = XMFLOAT3(bounds.Min.x + bounds.Size, bounds.Min.y + bounds.Size, bounds.Min.z + bounds.Size);
+		node.Level = level;
+		node.PointCount = narrow<uint32_t>(points.size());
+		node.Parent = PointCloud::InvalidNode;
+		copy(begin(children), end(children), begin(node.Children));
+
+		lock_guard<mutex> lock(mWriterMutex);
+
+		node.DataOffset = mOutputOffset;
+		WritePoints(mOutputFile, points);
+		mOutputOffset += points.size() * sizeof(VertexPositionPackedColor);
+
+		const uint32_t nodeIndex = narrow<uint32_t>(mNodes.size());
+		bool isLeaf = true;
+		for (uint32_t child : children)
+		{
+			if (child != PointCloud::InvalidNode)
+			{
+				mNodes[child].Parent = nodeIndex;
+				isLeaf = false;
+			}
+		}
+
+		mNodes.push_back(node);
+
+		++mStatistics.NodeCount;
+		mStatistics.LeafCount += (isLeaf ? 1 : 0);
+		mStatistics.StoredPointCount += points.size();
+		mStatistics.Depth = max(mStatistics.Depth, level + 1);
+
+		return nodeIndex;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <fstream>
+#include <filesystem>
+#include <functional>
+#include <DirectXMath.h>
+#include "PointCloud.h"
+#include "PointSource.h"
+
+namespace PointCloudPipeline
+{
+	struct PointCloudBuildSettings final
+	{
+		// Nodes with more points than this are split into octants.
+		std::uint32_t MaxLeafPointCount{ 65536 };
+
+		// Interior nodes keep one point per cell of a GridResolution^3 grid over their bounds.
+		std::uint32_t GridResolution{ 128 };
+
+		// Subtrees with more points than this are partitioned through temporary files instead of memory.
+		std::uint64_t InMemoryPointLimit{ 1 << 24 };
+
+		std::uint32_t MaxDepth{ 20 };
+	};
+
+	struct PointCloudBuildStatistics final
+	{
+		std::uint64_t SourcePointCount{ 0 };
+		std::uint64_t StoredPointCount{ 0 };
+		std::uint32_t NodeCount{ 0 };
+		std::uint32_t LeafCount{ 0 };
+		std::uint32_t Depth{ 0 };
+	};
+
+	// Builds a Library::PointCloud octree from a PointSource. The source is streamed twice: once for the
+	// bounds and once to partition the points. Subtrees that exceed the in-memory limit are partitioned
+	// into temporary files, one per octant, until they fit; the remainder of the tree is built in memory,
+	// in parallel across octants. Parent LODs are grid subsamples of their children's points, so the tree
+	// is written bottom-up.
+	class PointCloudBuilder final
+	{
+	public:
+		PointCloudBuilder(const std::string& outputFilename, const PointCloudBuildSettings& settings = PointCloudBuildSettings());
+		PointCloudBuilder(const PointCloudBuilder&) = delete;
+		PointCloudBuilder(PointCloudBuilder&&) = delete;
+		PointCloudBuilder& operator=(const PointCloudBuilder&) = delete;
+		PointCloudBuilder& operator=(PointCloudBuilder&&) = delete;
+		~PointCloudBuilder() = default;
+
+		PointCloudBuildStatistics Build(const PointSource& source);
+
+	private:
+		using PointList = std::vector<Library::VertexPositionPackedColor>;
+		using ChunkReader = std::function<void(const PointSource::BatchCallback&)>;
+
+		struct Bounds final
+		{
+			DirectX::XMFLOAT3 Min;
+			float Size;
+
+			Bounds Octant(std::uint32_t octant) const;
+			std::uint32_t OctantOf(const DirectX::XMFLOAT3& position) const;
+		};
+
+		struct BuildResult final
+		{
+			std::uint32_t NodeIndex;
+			PointList Points;
+		};
+
+		BuildResult BuildNode(const ChunkReader& reader, std::uint64_t pointCount, const Bounds& bounds, std::uint32_t level);
+		BuildResult BuildNode(PointList&& points, const Bounds& bounds, std::uint32_t level);
+		BuildResult BuildInteriorNode(std::vector<BuildResult>& children, const Bounds& bounds, std::uint32_t level);
+		PointList Subsample(const std::vector<BuildResult>& children, const Bounds& bounds) const;
+		std::uint32_t WriteNode(const Bounds& bounds, float spacing, std::uint32_t level, const PointList& points, const std::uint32_t (&children)[8]);
+
+		std::string mOutputFilename;
+		std::filesystem::path mTemporaryDirectory;
+		PointCloudBuildSettings mSettings;
+		std::uint32_t mTemporaryFileCount{ 0 };
+
+		// Guarded by mWriterMutex; subtrees are built concurrently and written as they complete.
+		std::mutex mWriterMutex;
+		std::ofstream mOutputFile;
+		std::uint64_t mOutputOffset{ 0 };
+		std::vector<Library::PointCloud::Node> mNodes;
+		PointCloudBuildStatistics mStatistics;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,365 @@
+#include "pch.h"
+#include "PointSource.h"
+#include <charconv>
+
+using namespace std;
+using namespace std::filesystem;
+using namespace std::string_literals;
+using namespace gsl;
+using namespace DirectX;
+using namespace Library;
+
+namespace PointCloudPipeline
+{
+	namespace
+	{
+		const uint32_t White{ 0xFFFFFFFF };
+
+		uint32_t PackColor(uint32_t red, uint32_t green, uint32_t blue)
+		{
+			return (red & 0xFF) | ((green & 0xFF) << 8) | ((blue & 0xFF) << 16) | 0xFF000000;
+		}
+
+		string ToLower(string text)
+		{
+			transform(text.begin(), text.end(), text.begin(), [](char c) { return static_cast<char>(tolower(static_cast<unsigned char>(c))); });
+			return text;
+		}
+
+		// Splits a line on whitespace, returning up to maxTokens parsed values. Unparseable tokens end the line.
+		size_t ParseValues(const string& line, double* values, size_t maxTokens)
+		{
+			const char* current = line.data();
+			const char* end = current + line.size();
+			size_t count = 0;
+			while (count < maxTokens)
+			{
+				while (current < end && (*current == ' ' || *current == '\t' || *current == ',' || *current == '\r'))
+				{
+					++current;
+				}
+
+				if (current == end)
+				{
+					break;
+				}
+
+				auto [next, error] = from_chars(current, end, values[count]);
+				if (error != errc())
+				{
+					break;
+				}
+
+				current = next;
+				++count;
+			}
+
+			return count;
+		}
+	}
+
+	PointSource::PointSource(const string& filename) :
+		mFilename(filename)
+	{
+		ifstream file(filename, ios::binary);
+		if (!file.good())
+		{
+			throw exception(("Could not open file: "s + filename).c_str());
+		}
+
+		if (ToLower(path(filename).extension().string()) == ".ply"s)
+		{
+			ReadPlyHeader(file);
+		}
+	}
+
+	bool PointSource::CanLoad(const string& filename)
+	{
+		const string extension = ToLower(path(filename).extension().string());
+		return (extension == ".ply"s || extension == ".xyz"s || extension == ".txt"s || extension == ".pts"s);
+	}
+
+	void PointSource::Read(const BatchCallback& callback) const
+	{
+		switch (mFormat)
+		{
+		case Format::PlyBinary:
+			ReadPlyBinary(callback);
+			break;
+
+		case Format::PlyAscii:
+			ReadPlyAscii(callback);
+			break;
+
+		default:
+			ReadXyz(callback);
+			break;
+		}
+	}
+
+	uint32_t PointSource::ToColorChannel(double value, PropertyType type)
+	{
+		// 16-bit colors keep their high byte; floating-point colors are assumed to be normalized.
+		switch (type)
+		{
+		case PropertyType::UInt16:
+			return static_cast<uint32_t>(value) >> 8;
+
+		case PropertyType::Float32:
+		case PropertyType::Float64:
+			return static_cast<uint32_t>(clamp(value, 0.0, 1.0) * 255.0 + 0.5);
+
+		default:
+			return static_cast<uint32_t>(value);
+		}
+	}
+
+	void PointSource::ReadPlyHeader(ifstream& file)
+	{
+		static const map<string, PropertyType> PropertyTypes
+		{
+			{ "char"s, PropertyType::Int8 }, { "int8"s, PropertyType::Int8 },
+			{ "uchar"s, PropertyType::UInt8 }, { "uint8"s, PropertyType::UInt8 },
+			{ "short"s, PropertyType::Int16 }, { "int16"s, PropertyType::Int16 },
+			{ "ushort"s, PropertyType::UInt16 }, { "uint16"s, PropertyType::UInt16 },
+			{ "int"s, PropertyType::Int32 }, { "int32"s, PropertyType::Int32 },
+			{ "uint"s, PropertyType::UInt32 }, { "uint32"s, PropertyType::UInt32 },
+			{ "float"s, PropertyType::Float32 }, { "float32"s, PropertyType::Float32 },
+			{ "double"s, PropertyType::Float64 }, { "float64"s, PropertyType::Float64 }
+		};
+
+		static const size_t PropertySizes[]{ 1, 1, 2, 2, 4, 4, 4, 8 };
+
+		string line;
+		getline(file, line);
+		if (line.compare(0, 3, "ply"s) != 0)
+		{
+			throw exception("Invalid PLY file.");
+		}
+
+		bool inVertexElement = false;
+		bool vertexElementSeen = false;
+		while (getline(file, line))
+		{
+			if (!line.empty() && line.back() == '\r')
+			{
+				line.pop_back();
+			}
+
+			istringstream tokens(line);
+			string keyword;
+			tokens >> keyword;
+
+			if (keyword == "format"s)
+			{
+				string format;
+				tokens >> format;
+				if (format == "ascii"s)
+				{
+					mFormat = Format::PlyAscii;
+				}
+				else if (format == "binary_little_endian"s)
+				{
+					mFormat = Format::PlyBinary;
+				}
+				else
+				{
+					throw exception(("Unsupported PLY format: "s + format).c_str());
+				}
+			}
+			else if (keyword == "element"s)
+			{
+				string name;
+				tokens >> name;
+				inVertexElement = (name == "vertex"s);
+				if (inVertexElement)
+				{
+					tokens >> mVertexCount;
+					vertexElementSeen = true;
+				}
+				else if (!vertexElementSeen)
+				{
+					// Elements are stored in declaration order; only a leading vertex element can be streamed directly.
+					throw exception("PLY files must declare the vertex element first.");
+				}
+			}
+			else if (keyword == "property"s && inVertexElement)
+			{
+				string type;
+				string name;
+				tokens >> type >> name;
+				if (type == "list"s)
+				{
+					throw exception("List properties are not supported on PLY vertices.");
+				}
+
+				auto propertyType = PropertyTypes.find(type);
+				if (propertyType == PropertyTypes.end())
+				{
+					throw exception(("Unsupported PLY property type: "s + type).c_str());
+				}
+
+				const int propertyIndex = narrow_cast<int>(mProperties.size());
+				if (name == "x"s || name == "y"s || name == "z"s)
+				{
+					mPositionProperties[name[0] - 'x'] = propertyIndex;
+				}
+				else if (name == "red"s || name == "r"s)
+				{
+					mColorProperties[0] = propertyIndex;
+				}
+				else if (name == "green"s || name == "g"s)
+				{
+					mColorProperties[1] = propertyIndex;
+				}
+				else if (name == "blue"s || name == "b"s)
+				{
+					mColorProperties[2] = propertyIndex;
+				}
+
+				mProperties.push_back({ name, propertyType->second, mVertexStride });
+				mVertexStride += PropertySizes[static_cast<size_t>(propertyType->second)];
+			}
+			else if (keyword == "end_header"s)
+			{
+				mDataOffset = file.tellg();
+				break;
+			}
+		}
+
+		if (!vertexElementSeen || mDataOffset == 0)
+		{
+			throw exception("Invalid PLY header.");
+		}
+
+		if (any_of(begin(mPositionProperties), end(mPositionProperties), [](int property) { return property < 0; }))
+		{
+			throw exception("PLY vertices must have x, y and z properties.");
+		}
+	}
+
+	void PointSource::ReadXyz(const BatchCallback& callback) const
+	{
+		ifstream file(mFilename);
+		vector<VertexPositionPackedColor> batch;
+		batch.reserve(BatchSize);
+
+		string line;
+		double values[6];
+		while (getline(file, line))
+		{
+			// Headers and comments are skipped; colors are taken from the fourth to sixth columns when present.
+			const size_t count = ParseValues(line, values, size(values));
+			if (count < 3)
+			{
+				continue;
+			}
+
+			const uint32_t color = (count == 6 ? PackColor(static_cast<uint32_t>(values[3]), static_cast<uint32_t>(values[4]), static_cast<uint32_t>(values[5])) : White);
+			batch.push_back({ XMFLOAT3(static_cast<float>(values[0]), static_cast<float>(values[1]), static_cast<float>(values[2])), color });
+			if (batch.size() == BatchSize)
+			{
+				callback(batch);
+				batch.clear();
+			}
+		}
+
+		if (!batch.empty())
+		{
+			callback(batch);
+		}
+	}
+
+	void PointSource::ReadPlyAscii(const BatchCallback& callback) const
+	{
+		ifstream file(mFilename, ios::binary);
+		file.seekg(mDataOffset);
+
+		vector<VertexPositionPackedColor> batch;
+		batch.reserve(BatchSize);
+		vector<double> values(mProperties.size());
+
+		string line;
+		for (uint64_t i = 0; i < mVertexCount; ++i)
+		{
+			if (!getline(file, line) || ParseValues(line, values.data(), values.size()) != values.size())
+			{
+				throw exception("Unexpected end of PLY vertex data.");
+			}
+
+			XMFLOAT3 position(static_cast<float>(values[mPositionProperties[0]]), static_cast<float>(values[mPositionProperties[1]]), static_cast<float>(values[mPositionProperties[2]]));
+			uint32_t color = White;
+			if (mColorProperties[0] >= 0 && mColorProperties[1] >= 0 && mColorProperties[2] >= 0)
+			{
+				color = PackColor(ToColorChannel(values[mColorProperties[0]], mProperties[mColorProperties[0]].Type), ToColorChannel(values[mColorProperties[1]], mProperties[mColorProperties[1]].Type), ToColorChannel(values[mColorProperties[2]], mProperties[mColorProperties[2]].Type));
+			}
+
+			batch.push_back({ position, color });
+			if (batch.size() == BatchSize)
+			{
+				callback(batch);
+				batch.clear();
+			}
+		}
+
+		if (!batch.empty())
+		{
+			callback(batch);
+		}
+	}
+
+	void PointSource::ReadPlyBinary(const BatchCallback& callback) const
+	{
+		auto readScalar = [](const char* data, PropertyType type) -> double
+		{
+			switch (type)
+			{
+			case PropertyType::Int8: { int8_t value; memcpy(&value, data, sizeof(value)); return value; }
+			case PropertyType::UInt8: { uint8_t value; memcpy(&value, data, sizeof(value)); return value; }
+			case PropertyType::Int16: { int16_t value; memcpy(&value, data, sizeof(value)); return value; }
+			case PropertyType::UInt16: { uint16_t value; memcpy(&value, data, sizeof(value)); return value; }
+			case PropertyType::Int32: { int32_t value; memcpy(&value, data, sizeof(value)); return value; }
+			case PropertyType::UInt32: { uint32_t value; memcpy(&value, data, sizeof(value)); return value; }
+			case PropertyType::Float32: { float value; memcpy(&value, data, sizeof(value)); return value; }
+			default: { double value; memcpy(&value, data, sizeof(value)); return value; }
+			}
+		};
+
+		auto readColor = [&](const char* vertex, int propertyIndex)
+		{
+			const Property& property = mProperties[propertyIndex];
+			return ToColorChannel(readScalar(vertex + property.Offset, property.Type), property.Type);
+		};
+
+		const bool hasColor = (mColorProperties[0] >= 0 && mColorProperties[1] >= 0 && mColorProperties[2] >= 0);
+		const Property* positionProperties[]{ &mProperties[mPositionProperties[0]], &mProperties[mPositionProperties[1]], &mProperties[mPositionProperties[2]] };
+
+		ifstream file(mFilename, ios::binary);
+		file.seekg(mDataOffset);
+
+		vector<char> data(BatchSize * mVertexStride);
+		vector<VertexPositionPackedColor> batch(BatchSize);
+		for (uint64_t remaining = mVertexCount; remaining > 0;)
+		{
+			const size_t count = static_cast<size_t>(min<uint64_t>(remaining, BatchSize));
+			file.read(data.data(), count * mVertexStride);
+			if (file.gcount() != static_cast<streamsize>(count * mVertexStride))
+			{
+				throw exception("Unexpected end of PLY vertex data.");
+			}
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				const char* vertex = &data[i * mVertexStride];
+				VertexPositionPackedColor& point = batch[i];
+				point.Position.x = static_cast<float>(readScalar(vertex + positionProperties[0]->Offset, positionProperties[0]->Type));
+				point.Position.y = static_cast<float>(readScalar(vertex + positionProperties[1]->Offset, positionProperties[1]->Type));
+				point.Position.z = static_cast<float>(readScalar(vertex + positionProperties[2]->Offset, positionProperties[2]->Type));
+				point.Color = (hasColor ? PackColor(readColor(vertex, mColorProperties[0]), readColor(vertex, mColorProperties[1]), readColor(vertex, mColorProperties[2])) : White);
+			}
+
+			callback(span<const VertexPositionPackedColor>(batch.data(), count));
+			remaining -= count;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <functional>
+#include <fstream>
+#include <gsl\gsl>
+#include "VertexDeclarations.h"
+
+namespace PointCloudPipeline
+{
+	// Streams points from a PLY (ascii or binary_little_endian) or whitespace-separated XYZ file in
+	// fixed-size batches, so that files much larger than memory can be processed.
+	class PointSource final
+	{
+	public:
+		using BatchCallback = std::function<void(gsl::span<const Library::VertexPositionPackedColor>)>;
+
+		explicit PointSource(const std::string& filename);
+		PointSource(const PointSource&) = delete;
+		PointSource(PointSource&&) = default;
+		PointSource& operator=(const PointSource&) = delete;
+		PointSource& operator=(PointSource&&) = default;
+		~PointSource() = default;
+
+		static bool CanLoad(const std::string& filename);
+
+		// Invokes the callback once per batch, in file order. May be called more than once.
+		void Read(const BatchCallback& callback) const;
+
+		inline static const std::size_t BatchSize{ 1 << 20 };
+
+	private:
+		enum class Format
+		{
+			Xyz,
+			PlyAscii,
+			PlyBinary
+		};
+
+		enum class PropertyType
+		{
+			Int8,
+			UInt8,
+			Int16,
+			UInt16,
+			Int32,
+			UInt32,
+			Float32,
+			Float64
+		};
+
+		struct Property final
+		{
+			std::string Name;
+			PropertyType Type;
+			std::size_t Offset;
+		};
+
+		static std::uint32_t ToColorChannel(double value, PropertyType type);
+
+		void ReadPlyHeader(std::ifstream& file);
+		void ReadXyz(const BatchCallback& callback) const;
+		void ReadPlyAscii(const BatchCallback& callback) const;
+		void ReadPlyBinary(const BatchCallback& callback) const;
+
+		std::string mFilename;
+		Format mFormat{ Format::Xyz };
+		std::vector<Property> mProperties;
+		std::size_t mVertexStride{ 0 };
+		std::uint64_t mVertexCount{ 0 };
+		std::streamoff mDataOffset{ 0 };
+		int mPositionProperties[3]{ -1, -1, -1 };
+		int mColorProperties[3]{ -1, -1, -1 };
+	};
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include "pch.h"
+#include "PointCloudBuilder.h"
+#include "PointSource.h"
+#include <chrono>
+
+using namespace std;
+using namespace std::chrono;
+using namespace std::filesystem;
+using namespace std::string_literals;
+using namespace PointCloudPipeline;
+
+int main(int argc, char* argv[])
+{
+#if defined(DEBUG) | defined(_DEBUG)
+	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+#endif
+
+	try
+	{
+		if (argc < 2 || argc > 3)
+		{
+			throw exception("Usage: PointCloudPipeline.exe inputfilename [maxleafpoints]");
+		}
+
+		path inputFile(argv[1]);
+		if (!PointSource::CanLoad(inputFile.string()))
+		{
+			throw exception("Unsupported point cloud format. Supported formats are .ply, .xyz, .txt and .pts.");
+		}
+
+		current_path(absolute(inputFile).parent_path());
+
+		PointCloudBuildSettings settings;
+		if (argc == 3)
+		{
+			settings.MaxLeafPointCount = static_cast<uint32_t>(stoul(argv[2]));
+		}
+
+		cout << "Reading: "s << inputFile.filename() << endl;
+		auto startTime = high_resolution_clock::now();
+		PointSource source(inputFile.filename().string());
+
+		string outputFilename = inputFile.stem().string() + ".pointcloud"s;
+		PointCloudBuilder builder(outputFilename, settings);
+		PointCloudBuildStatistics statistics = builder.Build(source);
+		auto elapsedTime = duration_cast<milliseconds>(high_resolution_clock::now() - startTime);
+
+		cout << "Points: "s << statistics.SourcePointCount << " ("s << statistics.StoredPointCount << " stored, including LODs)"s << endl;
+		cout << "Nodes: "s << statistics.NodeCount << " ("s << statistics.LeafCount << " leaves, depth "s << statistics.Depth << ")"s << endl;
+		cout << "Wrote: "s << outputFilename << " in "s << elapsedTime.count() << " ms ("s << fixed << setprecision(1) << statistics.SourcePointCount / max(elapsedTime.count() / 1000.0, 0.001) / 1000000.0 << " M points/s)"s << endl;
+		cout << "Finished."s << endl;
+	}
+	catch (exception ex)
+	{
+		cout << ex.what() << endl;
+	}
+
+	return 0;
+}
\ No newline at end of file
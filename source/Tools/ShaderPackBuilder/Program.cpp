@@ -0,0 +1,81 @@
+#include "pch.h"
+#include "ShaderPackWriter.h"
+#include "ShaderPermutationCompiler.h"
+#include "Utility.h"
+#include <chrono>
+
+using namespace std;
+using namespace std::chrono;
+using namespace std::filesystem;
+using namespace std::string_literals;
+using namespace ShaderPackBuilder;
+using namespace Library;
+
+int main(int argc, char* argv[])
+{
+#if defined(DEBUG) | defined(_DEBUG)
+	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+#endif
+
+	try
+	{
+		const string usage = "Usage: ShaderPackBuilder.exe contentdirectory [output.shaderpack] [-permutations manifest]"s;
+		if (argc < 2)
+		{
+			throw exception(usage.c_str());
+		}
+
+		path contentDirectory = absolute(path(argv[1]));
+		path outputFile = contentDirectory / ShaderPack::DefaultAssetName;
+		path permutationManifest;
+		for (int i = 2; i < argc; i++)
+		{
+			if (argv[i] == "-permutations"s && i + 1 < argc)
+			{
+				permutationManifest = absolute(path(argv[++i]));
+			}
+			else if (argv[i][0] != '-')
+			{
+				outputFile = absolute(path(argv[i]));
+			}
+			else
+			{
+				throw exception(usage.c_str());
+			}
+		}
+
+		auto startTime = high_resolution_clock::now();
+		ShaderPackWriter writer;
+
+		if (!permutationManifest.empty())
+		{
+			cout << "Reading: "s << permutationManifest.filename() << endl;
+			for (const auto& entry : ShaderPermutationCompiler::LoadManifest(permutationManifest))
+			{
+				auto compileStartTime = high_resolution_clock::now();
+				auto variants = ShaderPermutationCompiler::CompileVariants(entry);
+				cout << "Compiled "s << variants.size() << " variants of "s << entry.SourceFile.filename() << " in "s << duration_cast<milliseconds>(high_resolution_clock::now() - compileStartTime).count() << " ms"s << endl;
+
+				for (auto& variant : variants)
+				{
+					writer.Add(variant.AssetName, move(variant.Bytecode));
+				}
+			}
+		}
+
+		cout << "Reading: "s << contentDirectory.string() << endl;
+		writer.AddDirectory(contentDirectory);
+
+		cout << "Writing: "s << outputFile.filename() << endl;
+		ShaderPackStatistics statistics = writer.Save(outputFile);
+
+		cout << statistics.EntryCount << " shaders, "s << statistics.BlobCount << " unique blobs, "s << statistics.InputBytes << " bytes in, "s << statistics.OutputBytes << " bytes out"s << endl;
+		cout << "Finished in "s << duration_cast<milliseconds>(high_resolution_clock::now() - startTime).count() << " ms"s << endl;
+	}
+	catch (exception ex)
+	{
+		cout << ex.what() << endl;
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "pch.h"
+#include "ShaderPackWriter.h"
+#include "Utility.h"
+
+using namespace std;
+using namespace std::filesystem;
+using namespace gsl;
+using namespace Library;
+
+namespace ShaderPackBuilder
+{
+	void ShaderPackWriter::Add(const wstring& assetName, vector<char>&& bytecode)
+	{
+		const uint64_t nameHash = ShaderPack::HashName(assetName);
+		auto it = mEntryIndicesByNameHash.find(nameHash);
+		if (it != mEntryIndicesByNameHash.end())
+		{
+			throw exception(("Shader name hash collision: " + Utility::ToString(mEntries[it->second].AssetName) + " and " + Utility::ToString(assetName)).c_str());
+		}
+
+		mInputBytes += bytecode.size();
+		const uint32_t blobIndex = FindOrAddBlob(move(bytecode));
+		mEntryIndicesByNameHash.emplace(nameHash, narrow<uint32_t>(mEntries.size()));
+		mEntries.push_back({ { nameHash, blobIndex, 0 }, assetName });
+	}
+
+	bool ShaderPackWriter::Contains(const wstring& assetName) const
+	{
+		return mEntryIndicesByNameHash.find(ShaderPack::HashName(assetName)) != mEntryIndicesByNameHash.end();
+	}
+
+	void ShaderPackWriter::AddDirectory(const path& contentDirectory, const path& extension)
+	{
+		for (const auto& directoryEntry : recursive_directory_iterator(contentDirectory))
+		{
+			if (directoryEntry.is_regular_file() && directoryEntry.path().extension() == extension)
+			{
+				// Explicitly added entries (e.g. permutation variants) take precedence over loose files.
+				const wstring assetName = relative(directoryEntry.path(), contentDirectory).wstring();
+				if (Contains(assetName) == false)
+				{
+					vector<char> bytecode;
+					Utility::LoadBinaryFile(directoryEntry.path().wstring(), bytecode);
+					Add(assetName, move(bytecode));
+				}
+			}
+		}
+	}
+
+	ShaderPackStatistics ShaderPackWriter::Save(const path& filename) const
+	{
+		vector<ShaderPack::Entry> entries;
+		entries.reserve(mEntries.size());
+		for (const auto& namedEntry : mEntries)
+		{
+			entries.push_back(namedEntry.Entry);
+		}
+
+		sort(entries.begin(), entries.end(), [](const ShaderPack::Entry& lhs, const ShaderPack::Entry& rhs) { return lhs.NameHash < rhs.NameHash; });
+
+		const auto alignOffset = [](uint64_t offset)
+		{
+			return (offset + ShaderPack::BlobAlignment - 1) & ~static_cast<uint64_t>(ShaderPack::BlobAlignment - 1);
+		};
+
+		uint64_t offset = sizeof(ShaderPack::Header) + sizeof(ShaderPack::Entry) * entries.size() + sizeof(ShaderPack::Blob) * mBlobs.size();
+		vector<ShaderPack::Blob> blobs;
+		blobs.reserve(mBlobs.size());
+		for (size_t i = 0; i < mBlobs.size(); i++)
+		{
+			offset = alignOffset(offset);
+			blobs.push_back({ mBlobHashes[i], narrow<uint32_t>(offset), narrow<uint32_t>(mBlobs[i].size()) });
+			offset += mBlobs[i].size();
+		}
+
+		ofstream file(filename, ios::binary);
+		if (!file.good())
+		{
+			throw exception("Could not open file.");
+		}
+
+		const ShaderPack::Header header{ ShaderPack::Magic, ShaderPack::Version, narrow<uint32_t>(entries.size()), narrow<uint32_t>(blobs.size()) };
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(entries.data()), sizeof(ShaderPack::Entry) * entries.size());
+		file.write(reinterpret_cast<const char*>(blobs.data()), sizeof(ShaderPack::Blob) * blobs.size());
+
+		const char padding[ShaderPack::BlobAlignment]{ 0 };
+		for (size_t i = 0; i < mBlobs.size(); i++)
+		{
+			const uint64_t position = static_cast<uint64_t>(file.tellp());
+			file.write(padding, narrow_cast<streamsize>(blobs[i].Offset - position));
+			file.write(mBlobs[i].data(), mBlobs[i].size());
+		}
+
+		ShaderPackStatistics statistics;
+		statistics.EntryCount = header.EntryCount;
+		statistics.BlobCount = header.BlobCount;
+		statistics.InputBytes = mInputBytes;
+		statistics.OutputBytes = static_cast<uint64_t>(file.tellp());
+
+		return statistics;
+	}
+
+	uint32_t ShaderPackWriter::FindOrAddBlob(vector<char>&& bytecode)
+	{
+		// Identical bytecode (e.g. a shader compiled under several names) is stored once.
+		const uint64_t contentHash = ShaderPack::HashContent(bytecode);
+		auto range = mBlobIndicesByHash.equal_range(contentHash);
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			if (mBlobs[it->second] == bytecode)
+			{
+				return it->second;
+			}
+		}
+
+		const uint32_t blobIndex = narrow<uint32_t>(mBlobs.size());
+		mBlobs.push_back(move(bytecode));
+		mBlobHashes.push_back(contentHash);
+		mBlobIndicesByHash.emplace(contentHash, blobIndex);
+
+		return blobIndex;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <filesystem>
+#include "ShaderPack.h"
+
+namespace ShaderPackBuilder
+{
+	struct ShaderPackStatistics final
+	{
+		std::uint32_t EntryCount{ 0 };
+		std::uint32_t BlobCount{ 0 };
+		std::uint64_t InputBytes{ 0 };
+		std::uint64_t OutputBytes{ 0 };
+	};
+
+	class ShaderPackWriter final
+	{
+	public:
+		void Add(const std::wstring& assetName, std::vector<char>&& bytecode);
+		bool Contains(const std::wstring& assetName) const;
+		void AddDirectory(const std::filesystem::path& contentDirectory, const std::filesystem::path& extension = L".cso");
+
+		ShaderPackStatistics Save(const std::filesystem::path& filename) const;
+
+	private:
+		struct NamedEntry final
+		{
+			Library::ShaderPack::Entry Entry;
+			std::wstring AssetName;
+		};
+
+		std::uint32_t FindOrAddBlob(std::vector<char>&& bytecode);
+
+		std::vector<NamedEntry> mEntries;
+		std::unordered_map<std::uint64_t, std::uint32_t> mEntryIndicesByNameHash;
+		std::vector<std::vector<char>> mBlobs;
+		std::vector<std::uint64_t> mBlobHashes;
+		std::unordered_multimap<std::uint64_t, std::uint32_t> mBlobIndicesByHash;
+		std::uint64_t mInputBytes{ 0 };
+	};
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "pch.h"
+#include "ShaderPermutationCompiler.h"
+#include "ShaderPack.h"
+#include "Utility.h"
+#include <d3dcompiler.h>
+#include <execution>
+#include <numeric>
+
+using namespace std;
+using namespace std::filesystem;
+using namespace std::string_literals;
+using namespace gsl;
+using namespace winrt;
+using namespace Library;
+
+namespace ShaderPackBuilder
+{
+	vector<ShaderPermutationEntry> ShaderPermutationCompiler::LoadManifest(const path& filename)
+	{
+		ifstream file(filename);
+		if (!file.good())
+		{
+			throw exception("Could not open file.");
+		}
+
+		vector<ShaderPermutationEntry> entries;
+		string line;
+		while (getline(file, line))
+		{
+			istringstream lineStream(line);
+			string sourceFile;
+			string assetName;
+			ShaderPermutationEntry entry;
+			if (!(lineStream >> sourceFile) || sourceFile[0] == '#')
+			{
+				continue;
+			}
+
+			if (!(lineStream >> assetName >> entry.Profile))
+			{
+				throw exception(("Malformed permutation manifest line: "s + line).c_str());
+			}
+
+			string feature;
+			while (lineStream >> feature)
+			{
+				entry.Features.push_back(feature);
+			}
+
+			if (entry.Features.size() > ShaderPack::MaxFeatureCount)
+			{
+				throw exception(("Too many shader features: "s + sourceFile).c_str());
+			}
+
+			entry.SourceFile = filename.parent_path() / sourceFile;
+			entry.AssetName = Utility::ToWideString(assetName);
+			entries.push_back(move(entry));
+		}
+
+		return entries;
+	}
+
+	vector<ShaderVariant> ShaderPermutationCompiler::CompileVariants(const ShaderPermutationEntry& entry)
+	{
+		const uint32_t variantCount = 1U << entry.Features.size();
+		vector<uint32_t> featureMasks(variantCount);
+		iota(featureMasks.begin(), featureMasks.end(), 0U);
+
+		// Exceptions cannot leave a parallel algorithm, so compile errors are collected and rethrown afterwards.
+		vector<ShaderVariant> variants(variantCount);
+		vector<string> compileErrors(variantCount);
+		for_each(execution::par, featureMasks.begin(), featureMasks.end(), [&](uint32_t featureMask)
+		{
+			// Every feature is defined (to 0 or 1) so shaders can use #if rather than #ifdef.
+			vector<D3D_SHADER_MACRO> defines;
+			for (size_t i = 0; i < entry.Features.size(); i++)
+			{
+				defines.push_back({ entry.Features[i].c_str(), (featureMask & (1U << i)) != 0 ? "1" : "0" });
+			}
+			defines.push_back({ nullptr, nullptr });
+
+			const uint32_t compileFlags = D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_OPTIMIZATION_LEVEL3;
+			com_ptr<ID3DBlob> bytecode;
+			com_ptr<ID3DBlob> errors;
+			HRESULT hr = D3DCompileFromFile(entry.SourceFile.c_str(), defines.data(), D3D_COMPILE_STANDARD_FILE_INCLUDE, "main", entry.Profile.c_str(), compileFlags, 0, bytecode.put(), errors.put());
+			if (FAILED(hr))
+			{
+				compileErrors[featureMask] = (errors != nullptr ? string(reinterpret_cast<const char*>(errors->GetBufferPointer()), errors->GetBufferSize()) : "D3DCompileFromFile() failed: "s + entry.SourceFile.string());
+				return;
+			}
+
+			const char* data = reinterpret_cast<const char*>(bytecode->GetBufferPointer());
+			ShaderVariant& variant = variants[featureMask];
+			variant.AssetName = ShaderPack::VariantAssetName(entry.AssetName, featureMask);
+			variant.Bytecode.assign(data, data + bytecode->GetBufferSize());
+		});
+
+		auto compileError = find_if(compileErrors.begin(), compileErrors.end(), [](const string& error) { return !error.empty(); });
+		if (compileError != compileErrors.end())
+		{
+			throw exception(compileError->c_str());
+		}
+
+		return variants;
+	}
+}
\ No newline at end of file
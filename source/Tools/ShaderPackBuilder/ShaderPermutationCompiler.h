@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <filesystem>
+
+namespace ShaderPackBuilder
+{
+	// One manifest line: <source.hlsl> <asset name> <profile> [feature defines...]
+	// Feature defines map to mask bits in declaration order.
+	struct ShaderPermutationEntry final
+	{
+		std::filesystem::path SourceFile;
+		std::wstring AssetName;
+		std::string Profile;
+		std::vector<std::string> Features;
+	};
+
+	struct ShaderVariant final
+	{
+		std::wstring AssetName;
+		std::vector<char> Bytecode;
+	};
+
+	class ShaderPermutationCompiler final
+	{
+	public:
+		ShaderPermutationCompiler() = delete;
+
+		static std::vector<ShaderPermutationEntry> LoadManifest(const std::filesystem::path& filename);
+		static std::vector<ShaderVariant> CompileVariants(const ShaderPermutationEntry& entry);
+	};
+}
\ No newline at end of file
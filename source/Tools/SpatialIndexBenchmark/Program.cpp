@@ -0,0 +1,196 @@
+#include "pch.h"
+#include "Frustum.h"
+#include "LooseOctree.h"
+#include "SceneBvh.h"
+#include <chrono>
+#include <random>
+
+using namespace std;
+using namespace std::chrono;
+using namespace std::string_literals;
+using namespace gsl;
+using namespace DirectX;
+using namespace Library;
+
+namespace
+{
+	const uint32_t DefaultMaxObjectCount{ 100000 };
+	const int FrameCount{ 30 };
+	const float WorldExtent{ 500.0f };
+	const float MaxSpeed{ 1.0f }; // Per frame
+	const float MaxRadius{ 2.0f };
+
+	struct Scene final
+	{
+		vector<BoundingSphere> Bounds;
+		vector<XMFLOAT3> Velocities;
+	};
+
+	struct Timings final
+	{
+		double Update{ 0.0 }; // Milliseconds per frame
+		double Query{ 0.0 };
+		size_t Visible{ 0 };
+	};
+
+	Scene CreateScene(uint32_t objectCount)
+	{
+		mt19937 generator(1);
+		uniform_real_distribution<float> position(-WorldExtent, WorldExtent);
+		uniform_real_distribution<float> velocity(-MaxSpeed, MaxSpeed);
+		uniform_real_distribution<float> radius(0.1f, MaxRadius);
+
+		Scene scene;
+		scene.Bounds.resize(objectCount);
+		scene.Velocities.resize(objectCount);
+		for (uint32_t i = 0; i < objectCount; i++)
+		{
+			scene.Bounds[i] = BoundingSphere(XMFLOAT3(position(generator), 0.1f * position(generator), position(generator)), radius(generator));
+			scene.Velocities[i] = XMFLOAT3(velocity(generator), 0.1f * velocity(generator), velocity(generator));
+		}
+
+		return scene;
+	}
+
+	// Moves every object, reflecting it off the sides of the world.
+	void Step(Scene& scene)
+	{
+		for (size_t i = 0; i < scene.Bounds.size(); i++)
+		{
+			float* center = &scene.Bounds[i].Center.x;
+			float* velocity = &scene.Velocities[i].x;
+			for (uint32_t axis = 0; axis < 3; axis++)
+			{
+				center[axis] += velocity[axis];
+				if (fabs(center[axis]) > WorldExtent)
+				{
+					velocity[axis] = -velocity[axis];
+				}
+			}
+		}
+	}
+
+	// A camera at the edge of the world, looking across it.
+	Frustum CreateFrustum()
+	{
+		const XMMATRIX viewMatrix = XMMatrixLookToRH(XMVectorSet(0.0f, 20.0f, WorldExtent, 1.0f), XMVectorSet(0.0f, 0.0f, -1.0f, 0.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+		const XMMATRIX projectionMatrix = XMMatrixPerspectiveFovRH(XM_PIDIV4, 16.0f / 9.0f, 0.1f, 2.0f * WorldExtent);
+		return Frustum(XMMatrixMultiply(viewMatrix, projectionMatrix));
+	}
+
+	double Milliseconds(const high_resolution_clock::time_point& startTime)
+	{
+		return duration<double, milli>(high_resolution_clock::now() - startTime).count();
+	}
+
+	// Updates every object each frame with one batch, then queries the frustum; the last query is checked
+	// against testing every object.
+	Timings BenchmarkOctree(Scene scene, const Frustum& frustum, uint32_t depth)
+	{
+		LooseOctree octree(BoundingBox(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(WorldExtent, WorldExtent, WorldExtent)), depth);
+		vector<LooseOctree::Handle> handles;
+		handles.reserve(scene.Bounds.size());
+		for (const BoundingSphere& bounds : scene.Bounds)
+		{
+			handles.push_back(octree.Insert(bounds));
+		}
+
+		Timings timings;
+		vector<LooseOctree::Handle> visible;
+		for (int frame = 0; frame < FrameCount; frame++)
+		{
+			Step(scene);
+
+			auto startTime = high_resolution_clock::now();
+			octree.Update(handles, scene.Bounds);
+			timings.Update += Milliseconds(startTime);
+
+			visible.clear();
+			startTime = high_resolution_clock::now();
+			octree.Query(frustum, visible);
+			timings.Query += Milliseconds(startTime);
+		}
+
+		sort(visible.begin(), visible.end());
+		for (size_t i = 0; i < handles.size(); i++)
+		{
+			if (frustum.Intersects(scene.Bounds[i]) != binary_search(visible.begin(), visible.end(), handles[i]))
+			{
+				throw exception("Octree frustum query differs from testing every object.");
+			}
+		}
+
+		timings.Update /= FrameCount;
+		timings.Query /= FrameCount;
+		timings.Visible = visible.size();
+
+		return timings;
+	}
+
+	// Rebuilds the hierarchy each frame, which is what a static index would require of moving objects.
+	Timings BenchmarkBvh(Scene scene, const Frustum& frustum)
+	{
+		Timings timings;
+		vector<BoundingBox> boxes(scene.Bounds.size());
+		vector<uint32_t> visible;
+		for (int frame = 0; frame < FrameCount; frame++)
+		{
+			Step(scene);
+
+			auto startTime = high_resolution_clock::now();
+			for (size_t i = 0; i < boxes.size(); i++)
+			{
+				BoundingBox::CreateFromSphere(boxes[i], scene.Bounds[i]);
+			}
+
+			const SceneBvh bvh(boxes);
+			timings.Update += Milliseconds(startTime);
+
+			visible.clear();
+			startTime = high_resolution_clock::now();
+			bvh.Query(frustum, visible);
+			timings.Query += Milliseconds(startTime);
+		}
+
+		timings.Update /= FrameCount;
+		timings.Query /= FrameCount;
+		timings.Visible = visible.size();
+
+		return timings;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+#if defined(DEBUG) | defined(_DEBUG)
+	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+#endif
+
+	try
+	{
+		const uint32_t maxObjectCount = (argc > 1 ? static_cast<uint32_t>(stoul(argv[1])) : DefaultMaxObjectCount);
+		const uint32_t octreeDepth = (argc > 2 ? static_cast<uint32_t>(stoul(argv[2])) : LooseOctree::DefaultDepth);
+		const Frustum frustum = CreateFrustum();
+
+		cout << "Moving objects, average of "s << FrameCount << " frames (ms per frame); octree depth "s << octreeDepth << endl;
+		cout << setw(10) << "Objects"s << setw(10) << "Visible"s << setw(16) << "Octree update"s << setw(15) << "Octree query"s
+			<< setw(15) << "BVH rebuild"s << setw(12) << "BVH query"s << endl;
+
+		for (uint32_t objectCount = 1000; objectCount <= maxObjectCount; objectCount *= 10)
+		{
+			const Scene scene = CreateScene(objectCount);
+			const Timings octree = BenchmarkOctree(scene, frustum, octreeDepth);
+			const Timings bvh = BenchmarkBvh(scene, frustum);
+
+			cout << fixed << setprecision(3) << setw(10) << objectCount << setw(10) << octree.Visible
+				<< setw(16) << octree.Update << setw(15) << octree.Query
+				<< setw(15) << bvh.Update << setw(12) << bvh.Query << endl;
+		}
+	}
+	catch (exception ex)
+	{
+		cout << ex.what() << endl;
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,198 @@
+#include "pch.h"
+#include "Model.h"
+#include "Mesh.h"
+#include "VertexDeclarations.h"
+#include <chrono>
+#include <random>
+
+using namespace std;
+using namespace std::chrono;
+using namespace std::string_literals;
+using namespace gsl;
+using namespace DirectX;
+using namespace Library;
+
+namespace
+{
+	const size_t DefaultVertexCount{ 1000000 };
+	const int IterationCount{ 10 };
+
+	Mesh CreateMesh(Model& model, size_t vertexCount)
+	{
+		mt19937 generator(1);
+		uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+		auto randomFloat3 = [&]() { return XMFLOAT3(distribution(generator), distribution(generator), distribution(generator)); };
+
+		MeshData meshData;
+		meshData.Vertices.resize(vertexCount);
+		meshData.Normals.resize(vertexCount);
+		meshData.Tangents.resize(vertexCount);
+		meshData.TextureCoordinates.emplace_back(vertexCount);
+		meshData.VertexColors.emplace_back(vertexCount);
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			meshData.Vertices[i] = randomFloat3();
+			meshData.Normals[i] = randomFloat3();
+			meshData.Tangents[i] = randomFloat3();
+			meshData.TextureCoordinates[0][i] = randomFloat3();
+			const XMFLOAT3 color = randomFloat3();
+			meshData.VertexColors[0][i] = XMFLOAT4(color.x, color.y, color.z, 1.0f);
+		}
+
+		return Mesh(model, move(meshData));
+	}
+
+	// Returns the fastest of several runs, in milliseconds.
+	template <typename Func>
+	double Measure(Func func)
+	{
+		double best = numeric_limits<double>::max();
+		for (int i = 0; i < IterationCount; i++)
+		{
+			auto startTime = high_resolution_clock::now();
+			func();
+			best = min(best, duration<double, milli>(high_resolution_clock::now() - startTime).count());
+		}
+
+		return best;
+	}
+
+	// The baseline reproduces the previous CreateVertexBuffer(device, mesh) conversion: a temporary vector filled
+	// through bounds-checked element access. Both paths then hand the same memory to ID3D11Device::CreateBuffer,
+	// so the device copy is excluded from the comparison.
+	template <typename T, typename BaselineFunc>
+	void Benchmark(const string& name, const Mesh& mesh, BaselineFunc baseline)
+	{
+		const size_t vertexCount = mesh.Vertices().size();
+		vector<T> destination(vertexCount);
+
+		const double baselineTime = Measure([&]()
+		{
+			vector<T> vertices = baseline(mesh);
+			if (vertices.size() != vertexCount)
+			{
+				throw exception("Baseline produced the wrong number of vertices.");
+			}
+		});
+
+		const double directTime = Measure([&]() { T::WriteVertices(mesh, destination); });
+
+		vector<T> expected = baseline(mesh);
+		if (memcmp(expected.data(), destination.data(), sizeof(T) * vertexCount) != 0)
+		{
+			throw exception(("WriteVertices output differs from the baseline for "s + name).c_str());
+		}
+
+		const double megabytes = static_cast<double>(T::VertexBufferByteWidth(vertexCount)) / (1024.0 * 1024.0);
+		cout << left << setw(36) << name << right << fixed << setprecision(2)
+			<< setw(10) << baselineTime << " ms"s
+			<< setw(10) << directTime << " ms"s
+			<< setw(10) << megabytes / (directTime / 1000.0) << " MB/s"s
+			<< setw(8) << setprecision(1) << baselineTime / directTime << "x"s << endl;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+#if defined(DEBUG) | defined(_DEBUG)
+	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+#endif
+
+	try
+	{
+		const size_t vertexCount = (argc > 1 ? static_cast<size_t>(stoull(argv[1])) : DefaultVertexCount);
+
+		Model model;
+		const Mesh mesh = CreateMesh(model, vertexCount);
+
+		cout << "Vertices: "s << vertexCount << " (best of "s << IterationCount << " runs)"s << endl;
+		cout << left << setw(36) << "Declaration"s << right << setw(13) << "Baseline"s << setw(13) << "Direct"s << setw(15) << "Throughput"s << setw(9) << "Speedup"s << endl;
+
+		Benchmark<VertexPosition>("VertexPosition"s, mesh, [](const Mesh& mesh)
+		{
+			vector<VertexPosition> vertices;
+			vertices.reserve(mesh.Vertices().size());
+			for (size_t i = 0; i < mesh.Vertices().size(); i++)
+			{
+				const XMFLOAT3& position = mesh.Vertices().at(i);
+				vertices.emplace_back(XMFLOAT4(position.x, position.y, position.z, 1.0f));
+			}
+
+			return vertices;
+		});
+
+		Benchmark<VertexPositionColor>("VertexPositionColor"s, mesh, [](const Mesh& mesh)
+		{
+			vector<VertexPositionColor> vertices;
+			vertices.reserve(mesh.Vertices().size());
+			for (size_t i = 0; i < mesh.Vertices().size(); i++)
+			{
+				const XMFLOAT3& position = mesh.Vertices().at(i);
+				vertices.emplace_back(XMFLOAT4(position.x, position.y, position.z, 1.0f), mesh.VertexColors().at(0).at(i));
+			}
+
+			return vertices;
+		});
+
+		Benchmark<VertexPositionTexture>("VertexPositionTexture"s, mesh, [](const Mesh& mesh)
+		{
+			vector<VertexPositionTexture> vertices;
+			vertices.reserve(mesh.Vertices().size());
+			for (size_t i = 0; i < mesh.Vertices().size(); i++)
+			{
+				const XMFLOAT3& position = mesh.Vertices().at(i);
+				const XMFLOAT3& uv = mesh.TextureCoordinates().at(0).at(i);
+				vertices.emplace_back(XMFLOAT4(position.x, position.y, position.z, 1.0f), XMFLOAT2(uv.x, uv.y));
+			}
+
+			return vertices;
+		});
+
+		Benchmark<VertexPositionNormal>("VertexPositionNormal"s, mesh, [](const Mesh& mesh)
+		{
+			vector<VertexPositionNormal> vertices;
+			vertices.reserve(mesh.Vertices().size());
+			for (size_t i = 0; i < mesh.Vertices().size(); i++)
+			{
+				const XMFLOAT3& position = mesh.Vertices().at(i);
+				vertices.emplace_back(XMFLOAT4(position.x, position.y, position.z, 1.0f), mesh.Normals().at(i));
+			}
+
+			return vertices;
+		});
+
+		Benchmark<VertexPositionTextureNormal>("VertexPositionTextureNormal"s, mesh, [](const Mesh& mesh)
+		{
+			vector<VertexPositionTextureNormal> vertices;
+			vertices.reserve(mesh.Vertices().size());
+			for (size_t i = 0; i < mesh.Vertices().size(); i++)
+			{
+				const XMFLOAT3& position = mesh.Vertices().at(i);
+				const XMFLOAT3& uv = mesh.TextureCoordinates().at(0).at(i);
+				vertices.emplace_back(XMFLOAT4(position.x, position.y, position.z, 1.0f), XMFLOAT2(uv.x, uv.y), mesh.Normals().at(i));
+			}
+
+			return vertices;
+		});
+
+		Benchmark<VertexPositionTextureNormalTangent>("VertexPositionTextureNormalTangent"s, mesh, [](const Mesh& mesh)
+		{
+			vector<VertexPositionTextureNormalTangent> vertices;
+			vertices.reserve(mesh.Vertices().size());
+			for (size_t i = 0; i < mesh.Vertices().size(); i++)
+			{
+				const XMFLOAT3& position = mesh.Vertices().at(i);
+				const XMFLOAT3& uv = mesh.TextureCoordinates().at(0).at(i);
+				vertices.emplace_back(XMFLOAT4(position.x, position.y, position.z, 1.0f), XMFLOAT2(uv.x, uv.y), mesh.Normals().at(i), mesh.Tangents().at(i));
+			}
+
+			return vertices;
+		});
+	}
+	catch (exception ex)
+	{
+		cout << ex.what() << endl;
+	}
+
+	return 0;
+}
\ No newline at end of file